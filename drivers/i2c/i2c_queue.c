@@ -0,0 +1,267 @@
+/****************************************************************************
+ * drivers/i2c/i2c_queue.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/irq.h>
+#include <nuttx/wqueue.h>
+#include <nuttx/i2c/i2c_master.h>
+
+#ifdef CONFIG_I2C_ASYNC
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The work queue that runs the transfers */
+
+#if defined(CONFIG_I2C_ASYNC_HPWORK)
+#  define I2C_ASYNC_WORK HPWORK
+#else
+#  define I2C_ASYNC_WORK LPWORK
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: i2c_async_worker
+ *
+ * Description:
+ *   Perform the queued transfers until the queue is empty.
+ *
+ ****************************************************************************/
+
+static void i2c_async_worker(FAR void *arg)
+{
+  FAR struct i2c_queue_s *queue = (FAR struct i2c_queue_s *)arg;
+  FAR struct i2c_async_s *req;
+  irqstate_t flags;
+  int ret;
+
+  for (; ; )
+    {
+      /* Take the highest priority transfer from the queue */
+
+      flags = enter_critical_section();
+      req = queue->head;
+      if (req != NULL)
+        {
+          queue->head = req->flink;
+          req->flink  = NULL;
+        }
+
+      leave_critical_section(flags);
+
+      if (req == NULL)
+        {
+          break;
+        }
+
+      /* Perform the transfer and report the result */
+
+      ret = I2C_TRANSFER(queue->i2c, req->msgv, req->msgc);
+      if (ret < 0)
+        {
+          i2cerr("ERROR: I2C_TRANSFER failed: %d\n", ret);
+        }
+
+      if (req->callback != NULL)
+        {
+          req->callback(req, ret);
+        }
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: i2c_queue_initialize
+ *
+ * Description:
+ *   Initialize an empty queue of asynchronous transfers for an I2C bus.
+ *   All users of the bus that want asynchronous transfers should share
+ *   the same queue so that their transfers are ordered by priority.
+ *
+ * Input Parameters:
+ *   queue - The queue to initialize
+ *   i2c   - An instance of the lower half I2C driver
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void i2c_queue_initialize(FAR struct i2c_queue_s *queue,
+                          FAR struct i2c_master_s *i2c)
+{
+  DEBUGASSERT(queue != NULL && i2c != NULL);
+
+  memset(queue, 0, sizeof(struct i2c_queue_s));
+  queue->i2c = i2c;
+}
+
+/****************************************************************************
+ * Name: i2c_transfer_async
+ *
+ * Description:
+ *   Queue a transfer of one or more I2C messages and return without
+ *   waiting for it.  Queued transfers are passed to I2C_TRANSFER() one at
+ *   a time, highest priority first and in order of submission for equal
+ *   priorities.  All of the messages of a transfer are given to the lower
+ *   half in one call.  This function may be called from an interrupt
+ *   handler.
+ *
+ * Input Parameters:
+ *   queue - The queue of the I2C bus to use
+ *   req   - Describes the messages and the completion callback
+ *
+ * Returned Value:
+ *   0: success, <0: A negated errno
+ *
+ ****************************************************************************/
+
+int i2c_transfer_async(FAR struct i2c_queue_s *queue,
+                       FAR struct i2c_async_s *req)
+{
+  FAR struct i2c_async_s *prev;
+  FAR struct i2c_async_s *next;
+  irqstate_t flags;
+  int ret = OK;
+
+  DEBUGASSERT(queue != NULL && req != NULL && req->msgv != NULL &&
+              req->msgc > 0);
+
+  /* Insert the transfer after all pending transfers of the same or higher
+   * priority.
+   */
+
+  flags = enter_critical_section();
+
+  for (prev = NULL, next = queue->head;
+       next != NULL && next->priority >= req->priority;
+       prev = next, next = next->flink)
+    {
+    }
+
+  req->flink = next;
+  if (prev == NULL)
+    {
+      queue->head = req;
+    }
+  else
+    {
+      prev->flink = req;
+    }
+
+  /* Start the worker unless it is already scheduled.  If it is running,
+   * scheduling it again is harmless; it will find the queue empty.
+   */
+
+  if (work_available(&queue->work))
+    {
+      ret = work_queue(I2C_ASYNC_WORK, &queue->work, i2c_async_worker,
+                       queue, 0);
+      if (ret < 0)
+        {
+          /* Take the transfer back out of the queue */
+
+          if (prev == NULL)
+            {
+              queue->head = next;
+            }
+          else
+            {
+              prev->flink = next;
+            }
+        }
+    }
+
+  leave_critical_section(flags);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: i2c_cancel_async
+ *
+ * Description:
+ *   Remove a transfer from the queue before it is started.  The callback
+ *   of a cancelled transfer is not called.
+ *
+ * Input Parameters:
+ *   queue - The queue of the I2C bus
+ *   req   - The transfer to cancel
+ *
+ * Returned Value:
+ *   0: success, -ENOENT if the transfer is not pending, because it has
+ *   already been started or was never queued.
+ *
+ ****************************************************************************/
+
+int i2c_cancel_async(FAR struct i2c_queue_s *queue,
+                     FAR struct i2c_async_s *req)
+{
+  FAR struct i2c_async_s *prev;
+  FAR struct i2c_async_s *curr;
+  irqstate_t flags;
+  int ret = -ENOENT;
+
+  DEBUGASSERT(queue != NULL && req != NULL);
+
+  flags = enter_critical_section();
+
+  for (prev = NULL, curr = queue->head;
+       curr != NULL;
+       prev = curr, curr = curr->flink)
+    {
+      if (curr == req)
+        {
+          if (prev == NULL)
+            {
+              queue->head = req->flink;
+            }
+          else
+            {
+              prev->flink = req->flink;
+            }
+
+          req->flink = NULL;
+          ret = OK;
+          break;
+        }
+    }
+
+  leave_critical_section(flags);
+  return ret;
+}
+
+#endif /* CONFIG_I2C_ASYNC */
@@ -31,7 +31,12 @@
 #include <debug.h>
 
 #include <nuttx/board.h>
+#include <nuttx/clock.h>
+#include <nuttx/irq.h>
 #include <nuttx/kmalloc.h>
+#include <nuttx/semaphore.h>
+#include <nuttx/signal.h>
+#include <nuttx/wqueue.h>
 #include <nuttx/lcd/lcd.h>
 #include <nuttx/video/fb.h>
 
@@ -45,10 +50,24 @@
 
 #define VIDEO_PLANE 0
 
+/* Polling interval while up_fbuninitialize() waits for the worker (usec) */
+
+#define LCDFB_STOPWAIT 10000
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
 
+/* A rectangle in the framebuffer.  All coordinates are inclusive. */
+
+struct lcdfb_rect_s
+{
+  fb_coord_t x1;                    /* Leftmost column */
+  fb_coord_t y1;                    /* Top row */
+  fb_coord_t x2;                    /* Rightmost column */
+  fb_coord_t y2;                    /* Bottom row */
+};
+
 /* This structure describes the LCD framebuffer */
 
 struct lcdfb_dev_s
@@ -63,6 +82,25 @@ struct lcdfb_dev_s
   fb_coord_t yres;                  /* Vertical resolution in pixel rows */
   fb_coord_t stride;                /* Width of a row in bytes */
   uint8_t display;                  /* Display number */
+
+#ifdef CONFIG_LCD_FBDAMAGE
+  /* Damage not yet written to the LCD */
+
+  struct lcdfb_rect_s damage[CONFIG_LCD_FBDAMAGE_NRECTS];
+  uint8_t ndamage;                  /* Number of damage rectangles */
+  bool flushing;                    /* A frame is being sent */
+  bool closing;                     /* up_fbuninitialize() in progress */
+  volatile uint8_t nworks;          /* Frames queued or being sent */
+#ifdef CONFIG_FB_SYNC
+  uint8_t nwaiters;                 /* Threads waiting for the frame */
+  sem_t vsyncsem;                   /* Posted when the frame was sent */
+#endif
+  sem_t exclsem;                    /* Protects the damage list */
+  struct work_s work;               /* Sends the frame */
+#ifdef CONFIG_LCD_FBDAMAGE_SHADOW
+  FAR uint8_t *shadow;              /* What was last sent to the LCD */
+#endif
+#endif
 };
 
 /****************************************************************************
@@ -74,6 +112,10 @@ struct lcdfb_dev_s
 static int lcdfb_updateearea(FAR struct fb_vtable_s *vtable,
              FAR const struct fb_area_s *area);
 
+#ifdef CONFIG_FB_SYNC
+static int lcdfb_waitforvsync(FAR struct fb_vtable_s *vtable);
+#endif
+
 /* Get information about the video controller configuration and the
  * configuration of each color plane.
  */
@@ -150,81 +192,101 @@ static FAR struct lcdfb_dev_s *lcdfb_find(int display)
 }
 
 /****************************************************************************
- * Name: lcdfb_updateearea
+ * Name: lcdfb_clip
  *
  * Description:
- * Update the LCD when there is a change to the framebuffer.
+ *   Clip an area to the framebuffer.  Returns false if nothing is left.
  *
  ****************************************************************************/
 
-static int lcdfb_updateearea(FAR struct fb_vtable_s *vtable,
-                             FAR const struct fb_area_s *area)
+static bool lcdfb_clip(FAR struct lcdfb_dev_s *priv,
+                       FAR const struct fb_area_s *area,
+                       FAR struct lcdfb_rect_s *rect)
 {
-  FAR struct lcdfb_dev_s *priv = (FAR struct lcdfb_dev_s *)vtable;
-  FAR struct lcd_planeinfo_s *pinfo = &priv->pinfo;
-  FAR uint8_t *run;
-  fb_coord_t row;
-  fb_coord_t startx;
-  fb_coord_t endx;
-  fb_coord_t width;
-  fb_coord_t starty;
-  fb_coord_t endy;
-  int ret;
-
   DEBUGASSERT(area != NULL);
   DEBUGASSERT(area->w >= 1);
   DEBUGASSERT(area->h >= 1);
 
   /* Clip to fit in the framebuffer */
 
-  startx = area->x;
-  if (startx < 0)
+  rect->x1 = area->x;
+  if (rect->x1 < 0)
     {
-      startx = 0;
+      rect->x1 = 0;
     }
 
-  endx = startx + area->w - 1;
-  if (endx >= priv->xres)
+  rect->x2 = rect->x1 + area->w - 1;
+  if (rect->x2 >= priv->xres)
     {
-      endx = priv->xres - 1;
+      rect->x2 = priv->xres - 1;
     }
 
-  starty = area->y;
-  if (starty < 0)
+  rect->y1 = area->y;
+  if (rect->y1 < 0)
     {
-      starty = 0;
+      rect->y1 = 0;
     }
 
-  endy = starty + area->h - 1;
-  if (endy >= priv->yres)
+  rect->y2 = rect->y1 + area->h - 1;
+  if (rect->y2 >= priv->yres)
     {
-      endy = priv->yres - 1;
+      rect->y2 = priv->yres - 1;
     }
 
   /* If the display uses a value of BPP < 8, then we may have to extend the
    * rectangle on the left so that it is byte aligned.  Works for BPP={1,2,4}
    */
 
-  if (pinfo->bpp < 8)
+  if (priv->pinfo.bpp < 8)
     {
-      unsigned int pixperbyte = 8 / pinfo->bpp;
-      startx &= ~(pixperbyte - 1);
+      unsigned int pixperbyte = 8 / priv->pinfo.bpp;
+      rect->x1 &= ~(pixperbyte - 1);
     }
 
-  width = endx - startx + 1;
+  return rect->x1 <= rect->x2 && rect->y1 <= rect->y2;
+}
+
+/****************************************************************************
+ * Name: lcdfb_putrect
+ *
+ * Description:
+ *   Write a rectangle of the provided framebuffer memory to the LCD.
+ *
+ ****************************************************************************/
+
+static int lcdfb_putrect(FAR struct lcdfb_dev_s *priv,
+                         FAR const uint8_t *fbmem,
+                         FAR const struct lcdfb_rect_s *rect)
+{
+  FAR struct lcd_planeinfo_s *pinfo = &priv->pinfo;
+  FAR const uint8_t *run;
+  fb_coord_t width;
+  fb_coord_t row;
+  int ret;
+
+  width = rect->x2 - rect->x1 + 1;
 
   /* Get the starting position in the framebuffer */
 
-  run  = priv->fbmem + starty * priv->stride;
-  run += (startx * pinfo->bpp + 7) >> 3;
+  run  = fbmem + rect->y1 * priv->stride;
+  run += (rect->x1 * pinfo->bpp + 7) >> 3;
+
+  /* Whole rows are contiguous in the framebuffer, so they can be sent in a
+   * single transfer if the LCD supports it.
+   */
 
-  for (row = starty; row <= endy; row++)
+  if (pinfo->putarea != NULL && pinfo->bpp >= 8 && width == priv->xres)
+    {
+      return pinfo->putarea(rect->y1, rect->y2, rect->x1, rect->x2, run);
+    }
+
+  for (row = rect->y1; row <= rect->y2; row++)
     {
       /* REVISIT: Some LCD hardware certain alignment requirements on DMA
        * memory.
        */
 
-      ret = pinfo->putrun(row, startx, run, width);
+      ret = pinfo->putrun(row, rect->x1, run, width);
       if (ret < 0)
         {
           return ret;
@@ -236,6 +298,319 @@ static int lcdfb_updateearea(FAR struct fb_vtable_s *vtable,
   return OK;
 }
 
+#ifdef CONFIG_LCD_FBDAMAGE
+
+/****************************************************************************
+ * Name: lcdfb_rectsize
+ *
+ * Description:
+ *   Return the number of pixels in a rectangle.
+ *
+ ****************************************************************************/
+
+static uint32_t lcdfb_rectsize(FAR const struct lcdfb_rect_s *rect)
+{
+  return (uint32_t)(rect->x2 - rect->x1 + 1) * (rect->y2 - rect->y1 + 1);
+}
+
+/****************************************************************************
+ * Name: lcdfb_union
+ *
+ * Description:
+ *   Return the bounding box of two rectangles.
+ *
+ ****************************************************************************/
+
+static void lcdfb_union(FAR const struct lcdfb_rect_s *rect1,
+                        FAR const struct lcdfb_rect_s *rect2,
+                        FAR struct lcdfb_rect_s *result)
+{
+  result->x1 = rect1->x1 < rect2->x1 ? rect1->x1 : rect2->x1;
+  result->y1 = rect1->y1 < rect2->y1 ? rect1->y1 : rect2->y1;
+  result->x2 = rect1->x2 > rect2->x2 ? rect1->x2 : rect2->x2;
+  result->y2 = rect1->y2 > rect2->y2 ? rect1->y2 : rect2->y2;
+}
+
+/****************************************************************************
+ * Name: lcdfb_adddamage
+ *
+ * Description:
+ *   Add a rectangle to the damage list.  The caller holds exclsem.
+ *
+ ****************************************************************************/
+
+static void lcdfb_adddamage(FAR struct lcdfb_dev_s *priv,
+                            FAR const struct lcdfb_rect_s *rect)
+{
+  struct lcdfb_rect_s merged;
+  struct lcdfb_rect_s damage = *rect;
+  uint32_t growth;
+  uint32_t best;
+  int bestndx;
+  int i;
+
+  /* Merge with every damage rectangle where sending the bounding box is no
+   * more costly than sending both.  A merge grows the rectangle, so start
+   * over after each one.
+   */
+
+  i = 0;
+  while (i < priv->ndamage)
+    {
+      lcdfb_union(&priv->damage[i], &damage, &merged);
+      if (lcdfb_rectsize(&merged) <=
+          lcdfb_rectsize(&priv->damage[i]) + lcdfb_rectsize(&damage))
+        {
+          damage = merged;
+          priv->damage[i] = priv->damage[--priv->ndamage];
+          i = 0;
+        }
+      else
+        {
+          i++;
+        }
+    }
+
+  if (priv->ndamage < CONFIG_LCD_FBDAMAGE_NRECTS)
+    {
+      priv->damage[priv->ndamage++] = damage;
+      return;
+    }
+
+  /* The list is full.  Merge with the rectangle that grows the least. */
+
+  best    = UINT32_MAX;
+  bestndx = 0;
+
+  for (i = 0; i < priv->ndamage; i++)
+    {
+      lcdfb_union(&priv->damage[i], &damage, &merged);
+      growth = lcdfb_rectsize(&merged) - lcdfb_rectsize(&priv->damage[i]);
+      if (growth < best)
+        {
+          best    = growth;
+          bestndx = i;
+        }
+    }
+
+  lcdfb_union(&priv->damage[bestndx], &damage, &merged);
+  priv->damage[bestndx] = priv->damage[--priv->ndamage];
+  lcdfb_adddamage(priv, &merged);
+}
+
+/****************************************************************************
+ * Name: lcdfb_putshadow
+ *
+ * Description:
+ *   Copy the rows of a damaged rectangle that differ from the shadow
+ *   framebuffer into it, then write them to the LCD from the shadow.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_LCD_FBDAMAGE_SHADOW
+static int lcdfb_putshadow(FAR struct lcdfb_dev_s *priv,
+                           FAR const struct lcdfb_rect_s *rect)
+{
+  struct lcdfb_rect_s changed = *rect;
+  FAR const uint8_t *src;
+  FAR uint8_t *dest;
+  fb_coord_t row;
+  size_t offset;
+  size_t nbytes;
+  bool dirty = false;
+
+  offset = (rect->x1 * priv->pinfo.bpp) >> 3;
+  nbytes = ((rect->x2 + 1) * priv->pinfo.bpp + 7) / 8 - offset;
+
+  for (row = rect->y1; row <= rect->y2; row++)
+    {
+      src  = priv->fbmem + row * priv->stride + offset;
+      dest = priv->shadow + row * priv->stride + offset;
+
+      if (memcmp(src, dest, nbytes) != 0)
+        {
+          memcpy(dest, src, nbytes);
+
+          if (!dirty)
+            {
+              changed.y1 = row;
+              dirty      = true;
+            }
+
+          changed.y2 = row;
+        }
+    }
+
+  if (!dirty)
+    {
+      return OK;
+    }
+
+  return lcdfb_putrect(priv, priv->shadow, &changed);
+}
+#endif
+
+/****************************************************************************
+ * Name: lcdfb_worker
+ *
+ * Description:
+ *   Write all damage accumulated during the frame interval to the LCD.
+ *
+ ****************************************************************************/
+
+static void lcdfb_worker(FAR void *arg)
+{
+  FAR struct lcdfb_dev_s *priv = (FAR struct lcdfb_dev_s *)arg;
+  struct lcdfb_rect_s damage[CONFIG_LCD_FBDAMAGE_NRECTS];
+  irqstate_t flags;
+  int ndamage;
+  int ret;
+  int i;
+
+  /* Take the damage list so that drawing can go on while it is sent */
+
+  nxsem_wait_uninterruptible(&priv->exclsem);
+  ndamage = priv->closing ? 0 : priv->ndamage;
+  memcpy(damage, priv->damage, ndamage * sizeof(struct lcdfb_rect_s));
+  priv->ndamage  = 0;
+  priv->flushing = true;
+  nxsem_post(&priv->exclsem);
+
+  for (i = 0; i < ndamage; i++)
+    {
+#ifdef CONFIG_LCD_FBDAMAGE_SHADOW
+      ret = lcdfb_putshadow(priv, &damage[i]);
+#else
+      ret = lcdfb_putrect(priv, priv->fbmem, &damage[i]);
+#endif
+      if (ret < 0)
+        {
+          lcderr("ERROR: Failed to update the LCD: %d\n", ret);
+        }
+    }
+
+  nxsem_wait_uninterruptible(&priv->exclsem);
+  priv->flushing = false;
+
+#ifdef CONFIG_FB_SYNC
+  /* Wake up everyone waiting for this frame */
+
+  while (priv->nwaiters > 0)
+    {
+      priv->nwaiters--;
+      nxsem_post(&priv->vsyncsem);
+    }
+#endif
+
+  nxsem_post(&priv->exclsem);
+
+  /* This must be the last access to priv:  up_fbuninitialize() may free it
+   * as soon as nworks drops to zero.
+   */
+
+  flags = enter_critical_section();
+  priv->nworks--;
+  leave_critical_section(flags);
+}
+#endif /* CONFIG_LCD_FBDAMAGE */
+
+/****************************************************************************
+ * Name: lcdfb_updateearea
+ *
+ * Description:
+ * Update the LCD when there is a change to the framebuffer.
+ *
+ ****************************************************************************/
+
+static int lcdfb_updateearea(FAR struct fb_vtable_s *vtable,
+                             FAR const struct fb_area_s *area)
+{
+  FAR struct lcdfb_dev_s *priv = (FAR struct lcdfb_dev_s *)vtable;
+  struct lcdfb_rect_s rect;
+#ifdef CONFIG_LCD_FBDAMAGE
+  irqstate_t flags;
+  int ret;
+#endif
+
+  if (!lcdfb_clip(priv, area, &rect))
+    {
+      return OK;
+    }
+
+#ifdef CONFIG_LCD_FBDAMAGE
+  /* Record the damage and send it with the next frame */
+
+  ret = nxsem_wait(&priv->exclsem);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  lcdfb_adddamage(priv, &rect);
+
+  flags = enter_critical_section();
+  if (!priv->closing && work_available(&priv->work))
+    {
+      ret = work_queue(LPWORK, &priv->work, lcdfb_worker, priv,
+                       MSEC2TICK(CONFIG_LCD_FBDAMAGE_INTERVAL));
+      if (ret >= 0)
+        {
+          priv->nworks++;
+        }
+    }
+
+  leave_critical_section(flags);
+
+  nxsem_post(&priv->exclsem);
+  return ret;
+#else
+  return lcdfb_putrect(priv, priv->fbmem, &rect);
+#endif
+}
+
+/****************************************************************************
+ * Name: lcdfb_waitforvsync
+ *
+ * Description:
+ *   Wait until the updates made so far have been written to the LCD.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FB_SYNC
+static int lcdfb_waitforvsync(FAR struct fb_vtable_s *vtable)
+{
+#ifdef CONFIG_LCD_FBDAMAGE
+  FAR struct lcdfb_dev_s *priv = (FAR struct lcdfb_dev_s *)vtable;
+  int ret;
+
+  ret = nxsem_wait(&priv->exclsem);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  if (priv->closing || (priv->ndamage == 0 && !priv->flushing))
+    {
+      nxsem_post(&priv->exclsem);
+      return OK;
+    }
+
+  /* If a frame is being sent, this waits for that frame only.  Damage
+   * added meanwhile goes out with the following frame.
+   */
+
+  priv->nwaiters++;
+  nxsem_post(&priv->exclsem);
+
+  return nxsem_wait_uninterruptible(&priv->vsyncsem);
+#else
+  /* Updates are written synchronously */
+
+  return OK;
+#endif
+}
+#endif
+
 /****************************************************************************
  * Name: lcdfb_getvideoinfo
  ****************************************************************************/
@@ -461,7 +836,7 @@ int up_fbinitialize(int display)
   FAR struct lcdfb_dev_s *priv;
   FAR struct lcd_dev_s *lcd;
   struct fb_videoinfo_s vinfo;
-  struct fb_area_s area;
+  struct lcdfb_rect_s rect;
   int ret;
 
   lcdinfo("display=%d\n", display);
@@ -491,6 +866,17 @@ int up_fbinitialize(int display)
   priv->vtable.setcursor    = lcdfb_setcursor,
 #endif
   priv->vtable.updatearea   = lcdfb_updateearea,
+#ifdef CONFIG_FB_SYNC
+  priv->vtable.waitforvsync = lcdfb_waitforvsync,
+#endif
+
+#ifdef CONFIG_LCD_FBDAMAGE
+  nxsem_init(&priv->exclsem, 0, 1);
+#ifdef CONFIG_FB_SYNC
+  nxsem_init(&priv->vsyncsem, 0, 0);
+  nxsem_set_protocol(&priv->vsyncsem, SEM_PRIO_NONE);
+#endif
+#endif
 
 #ifdef CONFIG_LCD_EXTERNINIT
   /* Use external graphics driver initialization */
@@ -559,6 +945,18 @@ int up_fbinitialize(int display)
       goto errout_with_lcd;
     }
 
+#ifdef CONFIG_LCD_FBDAMAGE_SHADOW
+  /* The shadow framebuffer matches the LCD after the first update below */
+
+  priv->shadow = (FAR uint8_t *)kmm_zalloc(priv->fblen);
+  if (priv->shadow == NULL)
+    {
+      lcderr("ERROR: Failed to allocate shadow frame buffer memory\n");
+      ret = -ENOMEM;
+      goto errout_with_fbmem;
+    }
+#endif
+
   /* Add the state structure to the list of framebuffer interfaces */
 
   priv->flink = g_lcdfb;
@@ -566,12 +964,12 @@ int up_fbinitialize(int display)
 
   /* Write the entire framebuffer to the LCD */
 
-  area.x = 0;
-  area.y = 0;
-  area.w = priv->xres;
-  area.h = priv->yres;
+  rect.x1 = 0;
+  rect.y1 = 0;
+  rect.x2 = priv->xres - 1;
+  rect.y2 = priv->yres - 1;
 
-  ret = lcdfb_updateearea(&priv->vtable, &area);
+  ret = lcdfb_putrect(priv, priv->fbmem, &rect);
   if (ret < 0)
     {
       lcderr("FB update failed: %d\n", ret);
@@ -582,12 +980,24 @@ int up_fbinitialize(int display)
   priv->lcd->setpower(priv->lcd, ((3*CONFIG_LCD_MAXPOWER + 3) / 4));
   return OK;
 
+#ifdef CONFIG_LCD_FBDAMAGE_SHADOW
+errout_with_fbmem:
+  kmm_free(priv->fbmem);
+#endif
+
 errout_with_lcd:
 #ifndef CONFIG_LCD_EXTERNINIT
   board_lcd_uninitialize();
 #endif
 
 errout_with_state:
+#ifdef CONFIG_LCD_FBDAMAGE
+  nxsem_destroy(&priv->exclsem);
+#ifdef CONFIG_FB_SYNC
+  nxsem_destroy(&priv->vsyncsem);
+#endif
+#endif
+
   kmm_free(priv);
   return ret;
 }
@@ -649,6 +1059,9 @@ void up_fbuninitialize(int display)
 {
   FAR struct lcdfb_dev_s *priv;
   FAR struct lcdfb_dev_s *prev;
+#ifdef CONFIG_LCD_FBDAMAGE
+  irqstate_t flags;
+#endif
 
   /* Find the LCD framebuffer state associated with this display.
    * REVISIT: Semaphore protections is needed if there is concurrent access.
@@ -671,6 +1084,40 @@ void up_fbuninitialize(int display)
               g_lcdfb = priv->flink;
             }
 
+#ifdef CONFIG_LCD_FBDAMAGE
+          /* Stop sending frames.  work_cancel() would not wait for a frame
+           * that is already being sent and would leave the threads waiting
+           * for a pending frame blocked.  Run the pending frame now instead
+           * (it sends nothing once closing is set, but releases the
+           * waiters) and wait until the worker has let go of priv.
+           */
+
+          nxsem_wait_uninterruptible(&priv->exclsem);
+          priv->closing = true;
+          nxsem_post(&priv->exclsem);
+
+          flags = enter_critical_section();
+          if (!work_available(&priv->work))
+            {
+              work_queue(LPWORK, &priv->work, lcdfb_worker, priv, 0);
+            }
+
+          leave_critical_section(flags);
+
+          while (priv->nworks > 0)
+            {
+              nxsig_usleep(LCDFB_STOPWAIT);
+            }
+
+          nxsem_destroy(&priv->exclsem);
+#ifdef CONFIG_FB_SYNC
+          nxsem_destroy(&priv->vsyncsem);
+#endif
+#ifdef CONFIG_LCD_FBDAMAGE_SHADOW
+          kmm_free(priv->shadow);
+#endif
+#endif
+
 #ifndef CONFIG_LCD_EXTERNINIT
           /* Uninitialize the LCD */
 
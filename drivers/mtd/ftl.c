@@ -37,7 +37,12 @@
 #include <debug.h>
 #include <errno.h>
 
+#include <nuttx/clock.h>
+#include <nuttx/irq.h>
 #include <nuttx/kmalloc.h>
+#include <nuttx/semaphore.h>
+#include <nuttx/signal.h>
+#include <nuttx/wqueue.h>
 #include <nuttx/fs/fs.h>
 #include <nuttx/fs/ioctl.h>
 #include <nuttx/mtd/mtd.h>
@@ -59,6 +64,14 @@
 
 #define DEV_NAME_MAX    (NAME_MAX + 5)
 
+/* No erase block is held in the in-memory erase block buffer */
+
+#define FTL_NO_EBLOCK   ((off_t)-1)
+
+/* Polling interval while ftl_free() waits for the write-back work (usec) */
+
+#define FTL_STOPWAIT    10000
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -73,13 +86,26 @@ struct ftl_struct_s
   uint16_t              blkper;   /* R/W blocks per erase block */
   uint16_t              refs;     /* Number of references */
   bool                  unlinked; /* The driver has been unlinked */
+  bool                  dirty;    /* eblock differs from FLASH */
+  off_t                 eblkno;   /* Erase block held in eblock */
   FAR uint8_t          *eblock;   /* One, in-memory erase block */
+#ifdef CONFIG_FTL_ERASEMAP
+  FAR uint8_t          *erased;   /* Bitmap of R/W blocks known erased */
+#endif
+#ifdef CONFIG_FTL_WRITEBACK
+  bool                  closing;  /* ftl_free() is tearing the device down */
+  volatile uint8_t      wbcount;  /* Write-back work queued or running */
+  struct work_s         work;     /* Delayed write-back of eblock */
+#endif
+  sem_t                 exclsem;  /* Protects eblock and the FLASH */
 };
 
 /****************************************************************************
  * Private Function Prototypes
  ****************************************************************************/
 
+static int     ftl_sync(FAR struct ftl_struct_s *dev);
+static void    ftl_free(FAR struct ftl_struct_s *dev);
 static int     ftl_open(FAR struct inode *inode);
 static int     ftl_close(FAR struct inode *inode);
 static ssize_t ftl_reload(FAR void *priv, FAR uint8_t *buffer,
@@ -156,17 +182,11 @@ static int ftl_close(FAR struct inode *inode)
   rwb_flush(&dev->rwb);
 #endif
 
+  ftl_sync(dev);
+
   if (--dev->refs == 0 && dev->unlinked)
     {
-#ifdef FTL_HAVE_RWBUFFER
-      rwb_uninitialize(&dev->rwb);
-#endif
-      if (dev->eblock)
-        {
-          kmm_free(dev->eblock);
-        }
-
-      kmm_free(dev);
+      ftl_free(dev);
     }
 
   return OK;
@@ -183,8 +203,13 @@ static ssize_t ftl_reload(FAR void *priv, FAR uint8_t *buffer,
                           off_t startblock, size_t nblocks)
 {
   struct ftl_struct_s *dev = (struct ftl_struct_s *)priv;
+  off_t ebstart;
+  off_t start;
+  off_t end;
   ssize_t nread;
 
+  nxsem_wait_uninterruptible(&dev->exclsem);
+
   /* Read the full erase block into the buffer */
 
   nread   = MTD_BREAD(dev->mtd, startblock, nblocks, buffer);
@@ -193,7 +218,29 @@ static ssize_t ftl_reload(FAR void *priv, FAR uint8_t *buffer,
       ferr("ERROR: Read %zu blocks starting at block %jd failed: %zd\n",
             nblocks, (intmax_t)startblock, nread);
     }
+  else if (dev->dirty)
+    {
+      /* Replace any blocks that have been modified in the in-memory erase
+       * block but not yet written back.
+       */
+
+      ebstart = dev->eblkno * dev->blkper;
+      start   = startblock > ebstart ? startblock : ebstart;
+      end     = startblock + (off_t)nblocks;
+      if (end > ebstart + dev->blkper)
+        {
+          end = ebstart + dev->blkper;
+        }
 
+      if (start < end)
+        {
+          memcpy(buffer + (start - startblock) * dev->geo.blocksize,
+                 dev->eblock + (start - ebstart) * dev->geo.blocksize,
+                 (end - start) * dev->geo.blocksize);
+        }
+    }
+
+  nxsem_post(&dev->exclsem);
   return nread;
 }
 
@@ -222,9 +269,9 @@ static ssize_t ftl_read(FAR struct inode *inode, unsigned char *buffer,
 }
 
 /****************************************************************************
- * Name: ftl_flush
+ * Name: ftl_alloc_eblock
  *
- * Description: Write the specified number of sectors
+ * Description: Allocate the in-memory erase block buffer
  *
  ****************************************************************************/
 
@@ -240,147 +287,353 @@ static int ftl_alloc_eblock(FAR struct ftl_struct_s *dev)
   return dev->eblock != NULL ? OK : -ENOMEM;
 }
 
-static ssize_t ftl_flush(FAR void *priv, FAR const uint8_t *buffer,
-                         off_t startblock, size_t nblocks)
+/****************************************************************************
+ * Name: ftl_iserased and ftl_markerased
+ *
+ * Description: Query and update the bitmap of R/W blocks that are known to
+ *   be erased.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FTL_ERASEMAP
+static bool ftl_iserased(FAR struct ftl_struct_s *dev, off_t block,
+                         size_t nblocks)
 {
-  struct ftl_struct_s *dev = (struct ftl_struct_s *)priv;
-  off_t  alignedblock;
-  off_t  mask;
-  off_t  rwblock;
-  off_t  eraseblock;
-  off_t  offset;
-  size_t remaining;
+  for (; nblocks > 0; block++, nblocks--)
+    {
+      if ((dev->erased[block >> 3] & (1 << (block & 7))) == 0)
+        {
+          return false;
+        }
+    }
+
+  return true;
+}
+
+static void ftl_markerased(FAR struct ftl_struct_s *dev, off_t block,
+                           size_t nblocks, bool erased)
+{
+  for (; nblocks > 0; block++, nblocks--)
+    {
+      if (erased)
+        {
+          dev->erased[block >> 3] |= 1 << (block & 7);
+        }
+      else
+        {
+          dev->erased[block >> 3] &= ~(1 << (block & 7));
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: ftl_isblank
+ *
+ * Description: Return true if the R/W block holds only erased data.
+ *
+ ****************************************************************************/
+
+static bool ftl_isblank(FAR struct ftl_struct_s *dev,
+                        FAR const uint8_t *buffer)
+{
+  uint32_t i;
+
+  for (i = 0; i < dev->geo.blocksize; i++)
+    {
+      if (buffer[i] != CONFIG_FTL_ERASEDSTATE)
+        {
+          return false;
+        }
+    }
+
+  return true;
+}
+#endif
+
+/****************************************************************************
+ * Name: ftl_program
+ *
+ * Description: Erase one erase block and write a full erase block of data
+ *   to it.  With CONFIG_FTL_ERASEMAP, blocks holding only erased data are
+ *   left erased and the rest are written in multi-block runs.
+ *
+ ****************************************************************************/
+
+static int ftl_program(FAR struct ftl_struct_s *dev, off_t eraseblock,
+                       FAR const uint8_t *buffer)
+{
+  off_t  rwblock = eraseblock * dev->blkper;
   size_t nxfrd;
-  int    nbytes;
   int    ret;
+#ifdef CONFIG_FTL_ERASEMAP
+  size_t start;
+  size_t end;
+#endif
 
-  /* Get the aligned block.  Here is is assumed: (1) The number of R/W blocks
-   * per erase block is a power of 2, and (2) the erase begins with that same
-   * alignment.
-   */
-
-  mask         = dev->blkper - 1;
-  alignedblock = (startblock + mask) & ~mask;
+  ret = MTD_ERASE(dev->mtd, eraseblock, 1);
+  if (ret < 0)
+    {
+      ferr("ERROR: Erase block=%jd failed: %d\n",
+           (intmax_t)eraseblock, ret);
+      return ret;
+    }
 
-  /* Handle partial erase blocks before the first unaligned block */
+#ifdef CONFIG_FTL_ERASEMAP
+  ftl_markerased(dev, rwblock, dev->blkper, true);
 
-  remaining = nblocks;
-  if (alignedblock > startblock)
+  for (end = 0; end < dev->blkper; )
     {
-      /* Check if the write is shorter than to the end of the erase block */
+      /* Skip over blocks that need not be programmed */
 
-      bool short_write = (remaining < (alignedblock - startblock));
+      for (start = end;
+           start < dev->blkper &&
+           ftl_isblank(dev, buffer + start * dev->geo.blocksize);
+           start++);
 
-      ret = ftl_alloc_eblock(dev);
-      if (ret < 0)
-        {
-          ferr("ERROR: Failed to allocate an erase block buffer\n");
-          return ret;
-        }
+      /* Then write the run of blocks that follows them */
 
-      /* Read the full erase block into the buffer */
+      for (end = start;
+           end < dev->blkper &&
+           !ftl_isblank(dev, buffer + end * dev->geo.blocksize);
+           end++);
 
-      rwblock = startblock & ~mask;
-      nxfrd   = MTD_BREAD(dev->mtd, rwblock, dev->blkper, dev->eblock);
-      if (nxfrd != dev->blkper)
+      if (end > start)
         {
-          ferr("ERROR: Read erase block %jd failed: %zd\n",
-               (intmax_t)rwblock, nxfrd);
-          return -EIO;
+          nxfrd = MTD_BWRITE(dev->mtd, rwblock + start, end - start,
+                             buffer + start * dev->geo.blocksize);
+          ftl_markerased(dev, rwblock + start, end - start, false);
+          if (nxfrd != end - start)
+            {
+              ferr("ERROR: Write block %jd failed: %zu\n",
+                   (intmax_t)(rwblock + start), nxfrd);
+              return -EIO;
+            }
         }
+    }
+#else
+  nxfrd = MTD_BWRITE(dev->mtd, rwblock, dev->blkper, buffer);
+  if (nxfrd != dev->blkper)
+    {
+      ferr("ERROR: Write erase block %jd failed: %zu\n",
+           (intmax_t)rwblock, nxfrd);
+      return -EIO;
+    }
+#endif
 
-      /* Then erase the erase block */
+  return OK;
+}
 
-      eraseblock = rwblock / dev->blkper;
-      ret        = MTD_ERASE(dev->mtd, eraseblock, 1);
-      if (ret < 0)
-        {
-          ferr("ERROR: Erase block=%jd failed: %d\n",
-               (intmax_t)eraseblock, ret);
-          return ret;
-        }
+/****************************************************************************
+ * Name: ftl_cancel
+ *
+ * Description: Cancel the pending write-back work, if any.  A write-back
+ *   that is already running is not affected; it still accounts for itself
+ *   in wbcount.
+ *
+ ****************************************************************************/
 
-      /* Copy the user data at the end of the buffered erase block */
+#ifdef CONFIG_FTL_WRITEBACK
+static void ftl_cancel(FAR struct ftl_struct_s *dev)
+{
+  irqstate_t flags;
 
-      offset = (startblock & mask) * dev->geo.blocksize;
+  flags = enter_critical_section();
+  if (work_cancel(LPWORK, &dev->work) == OK)
+    {
+      dev->wbcount--;
+    }
 
-      if (short_write)
-        {
-          nbytes = remaining * dev->geo.blocksize;
-        }
-      else
-        {
-          nbytes = dev->geo.erasesize - offset;
-        }
+  leave_critical_section(flags);
+}
+#endif
 
-      finfo("Copy %d bytes into erase block=%jd at offset=%jd\n",
-             nbytes, (intmax_t)eraseblock, (intmax_t)offset);
+/****************************************************************************
+ * Name: ftl_writeback
+ *
+ * Description: Write the in-memory erase block back to FLASH if it has
+ *   been modified.  The caller must hold exclsem.
+ *
+ ****************************************************************************/
 
-      memcpy(dev->eblock + offset, buffer, nbytes);
+static int ftl_writeback(FAR struct ftl_struct_s *dev)
+{
+  int ret;
 
-      /* And write the erase block back to flash */
+#ifdef CONFIG_FTL_WRITEBACK
+  ftl_cancel(dev);
+#endif
 
-      nxfrd = MTD_BWRITE(dev->mtd, rwblock, dev->blkper, dev->eblock);
-      if (nxfrd != dev->blkper)
-        {
-          ferr("ERROR: Write erase block %jd failed: %zu\n",
-               (intmax_t)rwblock, nxfrd);
-          return -EIO;
-        }
+  if (!dev->dirty)
+    {
+      return OK;
+    }
 
-      /* Then update for amount written */
+  finfo("Write back erase block=%jd\n", (intmax_t)dev->eblkno);
 
-      if (short_write)
-        {
-          remaining = 0;
-        }
-      else
-        {
-          remaining -= dev->blkper - (startblock & mask);
-        }
+  ret = ftl_program(dev, dev->eblkno, dev->eblock);
+  if (ret < 0)
+    {
+      /* The erase block contents on FLASH are now unknown */
+
+      dev->eblkno = FTL_NO_EBLOCK;
+    }
+
+  dev->dirty = false;
+  return ret;
+}
+
+/****************************************************************************
+ * Name: ftl_timeout
+ *
+ * Description: Write back the in-memory erase block when it has been held
+ *   for CONFIG_FTL_WRITEBACK_DELAY.  Runs on the low priority work queue.
+ *
+ ****************************************************************************/
 
-      buffer += nbytes;
+#ifdef CONFIG_FTL_WRITEBACK
+static void ftl_timeout(FAR void *arg)
+{
+  FAR struct ftl_struct_s *dev = (FAR struct ftl_struct_s *)arg;
+  irqstate_t flags;
+
+  nxsem_wait_uninterruptible(&dev->exclsem);
+  if (!dev->closing)
+    {
+      ftl_writeback(dev);
     }
 
-  /* How handle full erase pages in the middle */
+  nxsem_post(&dev->exclsem);
+
+  /* This must be the last access to dev:  ftl_free() may release it as
+   * soon as wbcount drops to zero.
+   */
+
+  flags = enter_critical_section();
+  dev->wbcount--;
+  leave_critical_section(flags);
+}
+#endif
+
+/****************************************************************************
+ * Name: ftl_sync
+ *
+ * Description: Write back the in-memory erase block
+ *
+ ****************************************************************************/
+
+static int ftl_sync(FAR struct ftl_struct_s *dev)
+{
+  int ret;
+
+  nxsem_wait_uninterruptible(&dev->exclsem);
+  ret = ftl_writeback(dev);
+  nxsem_post(&dev->exclsem);
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: ftl_free
+ *
+ * Description: Release the FTL device structure
+ *
+ ****************************************************************************/
+
+static void ftl_free(FAR struct ftl_struct_s *dev)
+{
+#ifdef FTL_HAVE_RWBUFFER
+  rwb_uninitialize(&dev->rwb);
+#endif
+#ifdef CONFIG_FTL_WRITEBACK
+  /* Write back whatever the write buffer flush left in eblock and stop the
+   * write-back work.  work_cancel() does not wait for ftl_timeout() if it
+   * is already running (possibly blocked on exclsem), so wait until it has
+   * let go of the device.
+   */
+
+  nxsem_wait_uninterruptible(&dev->exclsem);
+  dev->closing = true;
+  ftl_writeback(dev);
+  nxsem_post(&dev->exclsem);
 
-  while (remaining >= dev->blkper)
+  while (dev->wbcount > 0)
     {
-      /* Erase the erase block */
+      nxsig_usleep(FTL_STOPWAIT);
+    }
+#endif
 
-      eraseblock = alignedblock / dev->blkper;
-      ret        = MTD_ERASE(dev->mtd, eraseblock, 1);
-      if (ret < 0)
-        {
-          ferr("ERROR: Erase block=%jd failed: %d\n",
-               (intmax_t)eraseblock, ret);
-          return ret;
-        }
+#ifdef CONFIG_FTL_ERASEMAP
+  kmm_free(dev->erased);
+#endif
+  if (dev->eblock)
+    {
+      kmm_free(dev->eblock);
+    }
 
-      /* Write a full erase back to flash */
+  nxsem_destroy(&dev->exclsem);
+  kmm_free(dev);
+}
 
-      finfo("Write %" PRId32 " bytes into erase block=%jd at offset=0\n",
-             dev->geo.erasesize, (intmax_t)alignedblock);
+/****************************************************************************
+ * Name: ftl_update
+ *
+ * Description: Write part of one erase block.  The data is merged into the
+ *   in-memory erase block, which is written back immediately or, with
+ *   CONFIG_FTL_WRITEBACK, later.
+ *
+ ****************************************************************************/
 
-      nxfrd = MTD_BWRITE(dev->mtd, alignedblock, dev->blkper, buffer);
-      if (nxfrd != dev->blkper)
+static int ftl_update(FAR struct ftl_struct_s *dev, off_t startblock,
+                      size_t nblocks, FAR const uint8_t *buffer)
+{
+  off_t  eraseblock = startblock / dev->blkper;
+  off_t  offset;
+  size_t nxfrd;
+  int    ret;
+
+#ifdef CONFIG_FTL_ERASEMAP
+  /* If the blocks are known to be erased, just program them unless they
+   * are part of an erase block that is already waiting to be written back.
+   */
+
+  if ((eraseblock != dev->eblkno || !dev->dirty) &&
+      ftl_iserased(dev, startblock, nblocks))
+    {
+      finfo("Program %zu erased blocks at block=%jd\n",
+            nblocks, (intmax_t)startblock);
+
+      nxfrd = MTD_BWRITE(dev->mtd, startblock, nblocks, buffer);
+      ftl_markerased(dev, startblock, nblocks, false);
+      if (nxfrd != nblocks)
         {
-          ferr("ERROR: Write erase block %jd failed: %zu\n",
-               (intmax_t)alignedblock, nxfrd);
+          ferr("ERROR: Write block %jd failed: %zu\n",
+               (intmax_t)startblock, nxfrd);
+          dev->eblkno = FTL_NO_EBLOCK;
           return -EIO;
         }
 
-      /* Then update for amount written */
+      /* Keep any in-memory copy of the erase block current */
 
-      alignedblock += dev->blkper;
-      remaining    -= dev->blkper;
-      buffer       += dev->geo.erasesize;
+      if (eraseblock == dev->eblkno)
+        {
+          memcpy(dev->eblock + (startblock % dev->blkper) *
+                 dev->geo.blocksize, buffer, nblocks * dev->geo.blocksize);
+        }
+
+      return OK;
     }
+#endif
 
-  /* Finally, handle any partial blocks after the last full erase block */
+  /* Otherwise bring the erase block into memory */
 
-  if (remaining > 0)
+  if (eraseblock != dev->eblkno)
     {
+      ret = ftl_writeback(dev);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
       ret = ftl_alloc_eblock(dev);
       if (ret < 0)
         {
@@ -390,44 +643,117 @@ static ssize_t ftl_flush(FAR void *priv, FAR const uint8_t *buffer,
 
       /* Read the full erase block into the buffer */
 
-      nxfrd = MTD_BREAD(dev->mtd, alignedblock, dev->blkper, dev->eblock);
+      dev->eblkno = FTL_NO_EBLOCK;
+      nxfrd = MTD_BREAD(dev->mtd, eraseblock * dev->blkper, dev->blkper,
+                        dev->eblock);
       if (nxfrd != dev->blkper)
         {
           ferr("ERROR: Read erase block %jd failed: %zu\n",
-               (intmax_t)alignedblock, nxfrd);
+               (intmax_t)eraseblock, nxfrd);
           return -EIO;
         }
 
-      /* Then erase the erase block */
+      dev->eblkno = eraseblock;
+    }
 
-      eraseblock = alignedblock / dev->blkper;
-      ret        = MTD_ERASE(dev->mtd, eraseblock, 1);
-      if (ret < 0)
+  /* Copy the user data into the buffered erase block */
+
+  offset = (startblock % dev->blkper) * dev->geo.blocksize;
+
+  finfo("Copy %zu blocks into erase block=%jd at offset=%jd\n",
+        nblocks, (intmax_t)eraseblock, (intmax_t)offset);
+
+  memcpy(dev->eblock + offset, buffer, nblocks * dev->geo.blocksize);
+  dev->dirty = true;
+
+#ifdef CONFIG_FTL_WRITEBACK
+  /* Write it back when the deadline of its first modification expires */
+
+  if (!dev->closing)
+    {
+      irqstate_t flags = enter_critical_section();
+
+      if (work_available(&dev->work))
         {
-          ferr("ERROR: Erase block=%jd failed: %d\n",
-               (intmax_t)eraseblock, ret);
-          return ret;
+          work_queue(LPWORK, &dev->work, ftl_timeout, dev,
+                     MSEC2TICK(CONFIG_FTL_WRITEBACK_DELAY));
+          dev->wbcount++;
         }
 
-      /* Copy the user data at the beginning the buffered erase block */
+      leave_critical_section(flags);
+    }
 
-      nbytes = remaining * dev->geo.blocksize;
-      finfo("Copy %d bytes into erase block=%jd at offset=0\n",
-             nbytes, (intmax_t)alignedblock);
-      memcpy(dev->eblock, buffer, nbytes);
+  return OK;
+#else
+  return ftl_writeback(dev);
+#endif
+}
 
-      /* And write the erase back to flash */
+/****************************************************************************
+ * Name: ftl_flush
+ *
+ * Description: Write the specified number of sectors
+ *
+ ****************************************************************************/
 
-      nxfrd = MTD_BWRITE(dev->mtd, alignedblock, dev->blkper, dev->eblock);
-      if (nxfrd != dev->blkper)
+static ssize_t ftl_flush(FAR void *priv, FAR const uint8_t *buffer,
+                         off_t startblock, size_t nblocks)
+{
+  struct ftl_struct_s *dev = (struct ftl_struct_s *)priv;
+  off_t  eraseblock;
+  size_t remaining;
+  size_t count;
+  int    ret = OK;
+
+  nxsem_wait_uninterruptible(&dev->exclsem);
+
+  for (remaining = nblocks; remaining > 0; remaining -= count)
+    {
+      eraseblock = startblock / dev->blkper;
+      count      = dev->blkper - startblock % dev->blkper;
+      if (count > remaining)
         {
-          ferr("ERROR: Write erase block %jd failed: %zu\n",
-               (intmax_t)alignedblock, nxfrd);
-          return -EIO;
+          count = remaining;
         }
+
+      if (count < dev->blkper)
+        {
+          /* Handle partial erase blocks */
+
+          ret = ftl_update(dev, startblock, count, buffer);
+        }
+      else
+        {
+          /* Write a full erase block back to flash, replacing any copy of
+           * it held in memory.
+           */
+
+          finfo("Write %" PRId32 " bytes into erase block=%jd\n",
+                dev->geo.erasesize, (intmax_t)eraseblock);
+
+          if (eraseblock == dev->eblkno)
+            {
+#ifdef CONFIG_FTL_WRITEBACK
+              ftl_cancel(dev);
+#endif
+              dev->eblkno = FTL_NO_EBLOCK;
+              dev->dirty  = false;
+            }
+
+          ret = ftl_program(dev, eraseblock, buffer);
+        }
+
+      if (ret < 0)
+        {
+          break;
+        }
+
+      startblock += count;
+      buffer     += count * dev->geo.blocksize;
     }
 
-  return nblocks;
+  nxsem_post(&dev->exclsem);
+  return ret < 0 ? ret : nblocks;
 }
 
 /****************************************************************************
@@ -536,6 +862,12 @@ static int ftl_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
       rwb_flush(&dev->rwb);
 #endif
 
+      ret = ftl_sync(dev);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
       /* Change the BIOC_FLUSH command to the MTDIOC_FLUSH command. */
 
       cmd = MTDIOC_FLUSH;
@@ -573,15 +905,8 @@ static int ftl_unlink(FAR struct inode *inode)
   dev->unlinked = true;
   if (dev->refs == 0)
     {
-#ifdef FTL_HAVE_RWBUFFER
-      rwb_uninitialize(&dev->rwb);
-#endif
-      if (dev->eblock)
-        {
-          kmm_free(dev->eblock);
-        }
-
-      kmm_free(dev);
+      ftl_sync(dev);
+      ftl_free(dev);
     }
 
   return OK;
@@ -625,7 +950,8 @@ int ftl_initialize_by_path(FAR const char *path, FAR struct mtd_dev_s *mtd)
     {
       /* Initialize the FTL device structure */
 
-      dev->mtd = mtd;
+      dev->mtd    = mtd;
+      dev->eblkno = FTL_NO_EBLOCK;
 
       /* Get the device geometry. (casting to uintptr_t first eliminates
        * complaints on some architectures where the sizeof long is different
@@ -646,6 +972,20 @@ int ftl_initialize_by_path(FAR const char *path, FAR struct mtd_dev_s *mtd)
       dev->blkper = dev->geo.erasesize / dev->geo.blocksize;
       DEBUGASSERT(dev->blkper * dev->geo.blocksize == dev->geo.erasesize);
 
+#ifdef CONFIG_FTL_ERASEMAP
+      /* Nothing is known to be erased until the FTL erases it */
+
+      dev->erased = (FAR uint8_t *)
+        kmm_zalloc((dev->geo.neraseblocks * dev->blkper + 7) / 8);
+      if (dev->erased == NULL)
+        {
+          kmm_free(dev);
+          return -ENOMEM;
+        }
+#endif
+
+      nxsem_init(&dev->exclsem, 0, 1);
+
       /* Configure read-ahead/write buffering */
 
 #ifdef FTL_HAVE_RWBUFFER
@@ -668,6 +1008,10 @@ int ftl_initialize_by_path(FAR const char *path, FAR struct mtd_dev_s *mtd)
       if (ret < 0)
         {
           ferr("ERROR: rwb_initialize failed: %d\n", ret);
+          nxsem_destroy(&dev->exclsem);
+#ifdef CONFIG_FTL_ERASEMAP
+          kmm_free(dev->erased);
+#endif
           kmm_free(dev);
           return ret;
         }
@@ -679,10 +1023,7 @@ int ftl_initialize_by_path(FAR const char *path, FAR struct mtd_dev_s *mtd)
       if (ret < 0)
         {
           ferr("ERROR: register_blockdriver failed: %d\n", -ret);
-#ifdef FTL_HAVE_RWBUFFER
-          rwb_uninitialize(&dev->rwb);
-#endif
-          kmm_free(dev);
+          ftl_free(dev);
         }
     }
 
@@ -43,7 +43,11 @@
 #include <crc32.h>
 #include <debug.h>
 
+#include <nuttx/irq.h>
 #include <nuttx/kmalloc.h>
+#include <nuttx/semaphore.h>
+#include <nuttx/signal.h>
+#include <nuttx/wqueue.h>
 #include <nuttx/fs/fs.h>
 #include <nuttx/fs/ioctl.h>
 #include <nuttx/mtd/mtd.h>
@@ -97,6 +101,14 @@
 #define SMART_FMT_VERSION_POS     (SMART_FMT_POS1 + 4)
 #define SMART_FMT_NAMESIZE_POS    (SMART_FMT_POS1 + 5)
 #define SMART_FMT_ROOTDIRS_POS    (SMART_FMT_POS1 + 6)
+#define SMART_FMT_FLAGS_POS       (SMART_FMT_POS1 + 7)
+#define SMART_FMT_CPBLOCKS_POS    (SMART_FMT_POS1 + 8)
+
+/* Format flags, stored inverted against the erased state so that volumes
+ * formatted before the flags existed read as having none of them set.
+ */
+
+#define SMART_FMT_FLAG_CHECKPOINT 0x01
 #define SMARTFS_FMT_WEAR_POS      36
 #define SMART_WEAR_LEVEL_FORMAT_SIG 32
 #define SMART_PARTNAME_SIZE         4
@@ -132,6 +144,43 @@
 #define smart_free(d, p)        kmm_free(p)
 #endif
 
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+#  define SMART_CP_MAGIC        "SMCP"
+#  define SMART_CP_RECSIZE      4       /* Size of a journal record */
+#  define SMART_CP_AREA(d, a)   ((uint32_t)((d)->cpblock + (a) * \
+                                 (d)->cpnblocks) * (d)->geo.erasesize)
+#else
+#  define smart_bwrite(d, s, n, b) MTD_BWRITE((d)->mtd, s, n, b)
+#  define smart_erase(d, b)        MTD_ERASE((d)->mtd, b, 1)
+#endif
+
+/* Background garbage collection.  The watermarks are in erase blocks worth
+ * of free sectors above the level where smart_garbagecollect() starts
+ * collecting in the foreground.
+ */
+
+#ifdef CONFIG_MTD_SMART_BGGC
+#  if CONFIG_MTD_SMART_BGGC_HIWATER <= CONFIG_MTD_SMART_BGGC_LOWATER
+#    error CONFIG_MTD_SMART_BGGC_HIWATER must exceed the low watermark
+#  endif
+
+#  define SMART_BGGC_FLOOR(d) \
+     ((d)->totalsectors >> 5 > (d)->sectorsperblk + 4 ? \
+      (uint32_t)(d)->totalsectors >> 5 : (uint32_t)(d)->sectorsperblk + 4)
+#  define SMART_BGGC_LOWATER(d) (SMART_BGGC_FLOOR(d) + \
+     (uint32_t)CONFIG_MTD_SMART_BGGC_LOWATER * (d)->availsectperblk)
+#  define SMART_BGGC_HIWATER(d) (SMART_BGGC_FLOOR(d) + \
+     (uint32_t)CONFIG_MTD_SMART_BGGC_HIWATER * (d)->availsectperblk)
+#  define SMART_BGGC_DELAY      MSEC2TICK(CONFIG_MTD_SMART_BGGC_DELAY)
+#  define SMART_BGGC_STOPWAIT   10000 /* Microseconds */
+
+#  define smart_lock(d)         nxsem_wait_uninterruptible(&(d)->exclsem)
+#  define smart_unlock(d)       nxsem_post(&(d)->exclsem)
+#else
+#  define smart_lock(d)         OK
+#  define smart_unlock(d)
+#endif
+
 #define SMART_WEAR_FULL_RELOCATE_THRESHOLD  8
 #define SMART_WEAR_REORG_THRESHOLD          14
 #define SMART_WEAR_MIN_LEVEL                5
@@ -218,6 +267,42 @@ struct smart_allocsector_s
 };
 #endif
 
+/* The checkpoint header occupies the first MTD block of a checkpoint area
+ * and is written last, so a valid header implies a complete image.  The
+ * image (sector map, release and free counts, wear status) follows in the
+ * next MTD blocks, then the journal: one record per erase block modified
+ * since the checkpoint was written, each holding the block number and its
+ * complement.
+ */
+
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+struct smart_cphdr_s
+{
+  uint8_t               magic[4];         /* SMART_CP_MAGIC */
+  uint32_t              seq;              /* The newest checkpoint wins */
+  uint32_t              imgsize;          /* Size of the image in bytes */
+  uint32_t              imgcrc;           /* CRC-32 of the image */
+  uint32_t              blockerases;      /* Total block erase count */
+  uint32_t              uneven_wearcount; /* Uneven wear count */
+  uint16_t              sectorsize;       /* Sector size of the volume */
+  uint16_t              totalsectors;     /* Total number of sectors */
+  uint16_t              neraseblocks;     /* Number of erase blocks */
+  uint16_t              freesectors;      /* Total number of free sectors */
+  uint16_t              releasesectors;   /* Total number of released sectors */
+  uint16_t              reserved;
+  uint32_t              hdrcrc;           /* CRC-32 of the fields above */
+};
+
+/* State of a sequential transfer to or from a checkpoint area */
+
+struct smart_cpstream_s
+{
+  off_t                 block;            /* Next MTD block */
+  uint32_t              pos;              /* Position in the block buffer */
+  uint32_t              crc;              /* Running CRC-32 */
+};
+#endif
+
 struct smart_struct_s
 {
   FAR struct mtd_dev_s *mtd;              /* Contained MTD interface */
@@ -272,6 +357,23 @@ struct smart_struct_s
 #ifdef CONFIG_MTD_SMART_SECTOR_ERASE_DEBUG
   FAR uint8_t          *erasecounts;      /* Number of erases for each erase block */
 #endif
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+  FAR uint8_t          *cpbuffer;         /* Checkpoint I/O buffer (one MTD block) */
+  FAR uint8_t          *cpdirty;          /* Erase blocks journaled since the checkpoint */
+  uint32_t              cpseq;            /* Sequence number of the newest checkpoint */
+  uint32_t              cpjournal;        /* Offset of the journal in a checkpoint area */
+  uint16_t              cpblock;          /* First erase block of the checkpoint areas */
+  uint16_t              cpnblocks;        /* Erase blocks per checkpoint area (0=disabled) */
+  uint16_t              cpndirty;         /* Number of journaled erase blocks */
+  uint8_t               cparea;           /* Area holding the active checkpoint */
+  bool                  cpactive;         /* Modifications are being journaled */
+#endif
+#ifdef CONFIG_MTD_SMART_BGGC
+  sem_t                 exclsem;          /* Serializes the device with the GC worker */
+  struct work_s         gcwork;           /* Background garbage collection work */
+  volatile bool         gcactive;         /* GC work is queued or running */
+  bool                  gcstop;           /* GC may not be queued again */
+#endif
 #ifdef CONFIG_MTD_SMART_ALLOC_DEBUG
   size_t                bytesalloc;
   struct smart_alloc_s  alloc[SMART_MAX_ALLOCS];   /* Array of memory allocations */
@@ -428,6 +530,17 @@ static int     smart_relocate_sector(FAR struct smart_struct_s *dev,
 #ifdef CONFIG_MTD_SMART_FSCK
 static int     smart_fsck(FAR struct smart_struct_s *dev);
 #endif
+#ifdef CONFIG_MTD_SMART_BGGC
+static void    smart_bggc_worker(FAR void *arg);
+static void    smart_bggc_kick(FAR struct smart_struct_s *dev);
+#endif
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+static int     smart_checkpoint_touch(FAR struct smart_struct_s *dev,
+                 uint32_t offset, size_t nbytes);
+static ssize_t smart_bwrite(FAR struct smart_struct_s *dev, off_t startblock,
+                 size_t nblocks, FAR const uint8_t *buffer);
+static int     smart_erase(FAR struct smart_struct_s *dev, off_t block);
+#endif
 
 #ifdef CONFIG_SMART_DEV_LOOP
 static ssize_t smart_loop_read(FAR struct file *filep, FAR char *buffer,
@@ -878,6 +991,7 @@ static ssize_t smart_read(FAR struct inode *inode, unsigned char *buffer,
                           blkcnt_t start_sector, unsigned int nsectors)
 {
   FAR struct smart_struct_s *dev;
+  ssize_t ret;
 
   finfo("SMART: sector: %" PRIu32 " nsectors: %u\n", start_sector, nsectors);
 
@@ -887,7 +1001,16 @@ static ssize_t smart_read(FAR struct inode *inode, unsigned char *buffer,
 #else
   dev = (struct smart_struct_s *)inode->i_private;
 #endif
-  return smart_reload(dev, buffer, start_sector, nsectors);
+
+  ret = smart_lock(dev);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  ret = smart_reload(dev, buffer, start_sector, nsectors);
+  smart_unlock(dev);
+  return ret;
 }
 
 /****************************************************************************
@@ -924,7 +1047,11 @@ static ssize_t smart_write(FAR struct inode *inode,
   dev = (FAR struct smart_struct_s *)inode->i_private;
 #endif
 
-  /* I think maybe we need to lock on a mutex here */
+  ret = smart_lock(dev);
+  if (ret < 0)
+    {
+      return ret;
+    }
 
   /* Get the aligned block.  Here is is assumed: (1) The number of R/W blocks
    * per erase block is a power of 2, and (2) the erase begins with that same
@@ -960,15 +1087,12 @@ static ssize_t smart_write(FAR struct inode *inode,
           /* Erase the erase block */
 
           eraseblock = alignedblock / mtdblkspererase;
-          ret = MTD_ERASE(dev->mtd, eraseblock, 1);
+          ret = smart_erase(dev, eraseblock);
           if (ret < 0)
             {
               ferr("ERROR: Erase block=%jd failed: %d\n",
                    (intmax_t)eraseblock, ret);
-
-              /* Unlock the mutex if we add one */
-
-              return ret;
+              goto errout;
             }
         }
 
@@ -989,17 +1113,15 @@ static ssize_t smart_write(FAR struct inode *inode,
 
       finfo("Write MTD block %jd from offset %jd\n",
             (intmax_t)nextblock, (intmax_t)offset);
-      nxfrd = MTD_BWRITE(dev->mtd, nextblock, blkstowrite, &buffer[offset]);
+      nxfrd = smart_bwrite(dev, nextblock, blkstowrite, &buffer[offset]);
       if (nxfrd != blkstowrite)
         {
           /* The block is not empty!!  What to do? */
 
           ferr("ERROR: Write block %jd failed: %zd.\n",
                (intmax_t)nextblock, nxfrd);
-
-          /* Unlock the mutex if we add one */
-
-          return -EIO;
+          ret = -EIO;
+          goto errout;
         }
 
       /* Then update for amount written */
@@ -1010,7 +1132,11 @@ static ssize_t smart_write(FAR struct inode *inode,
       alignedblock += mtdblkspererase;
     }
 
-  return nsectors;
+  ret = nsectors;
+
+errout:
+  smart_unlock(dev);
+  return ret;
 }
 
 /****************************************************************************
@@ -1376,6 +1502,14 @@ static ssize_t smart_bytewrite(FAR struct smart_struct_s *dev, size_t offset,
 {
   ssize_t       ret;
 
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+  ret = smart_checkpoint_touch(dev, offset, nbytes);
+  if (ret < 0)
+    {
+      goto errout;
+    }
+
+#endif
 #ifdef CONFIG_MTD_BYTE_WRITE
   /* Check if the underlying MTD device supports write */
 
@@ -1903,569 +2037,1486 @@ static int smart_set_wear_level(FAR struct smart_struct_s *dev,
 #endif
 
 /****************************************************************************
- * Name: smart_scan
+ * Name: smart_scan_format
  *
- * Description: Performs a scan of the MTD device searching for format
- *              information and fills in logical sector mapping, freesector
- *              count, etc.
+ * Description: Reads the format signature from the physical sector holding
+ *              logical sector zero and sets up the volume's format
+ *              information.  Returns -EINVAL if the signature is invalid
+ *              or if the volume was formatted with a different checkpoint
+ *              reservation.
  *
  ****************************************************************************/
 
-static int smart_scan(FAR struct smart_struct_s *dev)
+static int smart_scan_format(FAR struct smart_struct_s *dev, uint16_t sector)
 {
-  int       sector;
-  int       ret;
-  uint16_t  totalsectors;
-  uint16_t  sectorsize;
-  uint16_t  prerelease;
-  uint16_t  logicalsector;
-  uint16_t  winner;
-  uint16_t  loser;
   uint32_t  readaddress;
-  uint32_t  offset;
-  uint16_t  seq1;
-  uint16_t  seq2;
-  uint16_t  seqwrap;
-  struct    smart_sect_header_s header;
-#ifdef CONFIG_MTD_SMART_MINIMIZE_RAM
-  int       dupsector;
-  uint16_t  duplogsector;
-#endif
+  uint16_t  cpnblocks;
+  int       ret;
 #ifdef CONFIG_SMARTFS_MULTI_ROOT_DIRS
   int       x;
   char      devname[22];
   FAR struct smart_multiroot_device_s *rootdirdev;
 #endif
-  static const short sizetbl[8] =
-  {
-    CONFIG_MTD_SMART_SECTOR_SIZE,
-    512, 1024, 4096, 2048, 8192, 16384, 32768
-  };
-
-  finfo("Entry\n");
 
-  /* Find the sector size on the volume by reading headers from
-   * sectors of decreasing size.  On a formatted volume, the sector
-   * size is saved in the header status byte of search sector, so
-   * by starting with the largest supported sector size and
-   * decreasing from there, we will be sure to find data that is
-   * a header and not sector data.
-   */
+  readaddress = sector * dev->mtdblkspersector * dev->geo.blocksize;
 
-  sectorsize = 0xffff;
-  offset = 16384;
+  /* Read the sector data */
 
-  while (sectorsize == 0xffff)
+  ret = MTD_READ(dev->mtd, readaddress, 32,
+                 (FAR uint8_t *)dev->rwbuffer);
+  if (ret != 32)
     {
-      readaddress = 0;
-
-      while (readaddress < dev->erasesize * dev->geo.neraseblocks)
-        {
-          /* Read the next sector from the device */
-
-          ret = MTD_READ(dev->mtd, readaddress,
-                         sizeof(struct smart_sect_header_s),
-                         (FAR uint8_t *) &header);
-          if (ret != sizeof(struct smart_sect_header_s))
-            {
-              goto err_out;
-            }
-
-          if (header.status != CONFIG_SMARTFS_ERASEDSTATE)
-            {
-              sectorsize =
-                sizetbl[(header.status & SMART_STATUS_SIZEBITS) >> 2];
-              break;
-            }
+      ferr("ERROR: Error reading physical sector %d.\n", sector);
+      return -EIO;
+    }
 
-          readaddress += offset;
-        }
+  /* Validate the format signature */
 
-      if (sectorsize == 0xffff)
-        {
-          sectorsize = CONFIG_MTD_SMART_SECTOR_SIZE;
-        }
+  if (dev->rwbuffer[SMART_FMT_POS1] != SMART_FMT_SIG1 ||
+      dev->rwbuffer[SMART_FMT_POS2] != SMART_FMT_SIG2 ||
+      dev->rwbuffer[SMART_FMT_POS3] != SMART_FMT_SIG3 ||
+      dev->rwbuffer[SMART_FMT_POS4] != SMART_FMT_SIG4)
+    {
+      return -EINVAL;
+    }
 
-      offset >>= 1;
-      if (offset < 256 && sectorsize == 0xffff)
-        {
-          /* No valid sectors found on device.  Default the
-           * sector size to the CONFIG value
-           */
+  /* The checkpoint areas are taken from the end of the device, so the
+   * volume must be mounted with the same reservation it was formatted
+   * with.  Otherwise the last erase blocks would be used both as sectors
+   * and as checkpoint areas.
+   */
 
-          sectorsize = CONFIG_MTD_SMART_SECTOR_SIZE;
-        }
+  cpnblocks = 0;
+  if ((dev->rwbuffer[SMART_FMT_FLAGS_POS] ^ CONFIG_SMARTFS_ERASEDSTATE) &
+      SMART_FMT_FLAG_CHECKPOINT)
+    {
+      cpnblocks = dev->rwbuffer[SMART_FMT_CPBLOCKS_POS] |
+                  (dev->rwbuffer[SMART_FMT_CPBLOCKS_POS + 1] << 8);
     }
 
-  /* Now set the sectorsize and other sectorsize derived variables */
-
-  ret = smart_setsectorsize(dev, sectorsize);
-  if (ret != OK)
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+  if (cpnblocks != dev->cpnblocks)
+#else
+  if (cpnblocks != 0)
+#endif
     {
-      goto err_out;
+      ferr("ERROR: Volume has %u checkpoint blocks, reformat needed\n",
+           cpnblocks);
+      return -EINVAL;
     }
 
-  /* Initialize the device variables */
+  /* Mark the volume as formatted and set the sector size */
 
-  totalsectors        = dev->totalsectors;
-  dev->formatstatus   = SMART_FMT_STAT_NOFMT;
-  dev->freesectors    = dev->availsectperblk * dev->geo.neraseblocks;
-  dev->releasesectors = 0;
+  dev->formatstatus = SMART_FMT_STAT_FORMATTED;
+  dev->namesize = dev->rwbuffer[SMART_FMT_NAMESIZE_POS];
+  dev->formatversion = dev->rwbuffer[SMART_FMT_VERSION_POS];
 
-  /* Initialize the freecount and releasecount arrays */
+#ifdef CONFIG_SMARTFS_MULTI_ROOT_DIRS
+  dev->rootdirentries = dev->rwbuffer[SMART_FMT_ROOTDIRS_POS];
 
-  for (sector = 0; sector < dev->neraseblocks; sector++)
+  /* If rootdirentries is greater than 1, then we need to register
+   * additional block devices.
+   */
+
+  for (x = 1; x < dev->rootdirentries; x++)
     {
-      if (sector == dev->neraseblocks - 1 && dev->totalsectors == 65534)
+      if (dev->partname[0] != '\0')
         {
-          prerelease = 2;
+          snprintf(dev->rwbuffer, sizeof(devname),
+                   "/dev/smart%d%sd%d",
+                   dev->minor, dev->partname, x + 1);
         }
       else
         {
-          prerelease = 0;
+          snprintf(devname, sizeof(devname), "/dev/smart%dd%d",
+                   dev->minor, x + 1);
         }
 
-#ifdef CONFIG_MTD_SMART_PACK_COUNTS
-      smart_set_count(dev, dev->freecount, sector,
-                      dev->availsectperblk - prerelease);
-      smart_set_count(dev, dev->releasecount, sector, prerelease);
-#else
-      dev->freecount[sector] = dev->availsectperblk - prerelease;
-      dev->releasecount[sector] = prerelease;
-#endif
-    }
+      /* Inode private data is a reference to a struct containing
+       * the SMART device structure and the root directory number.
+       */
 
-  /* Initialize the sector map */
+      rootdirdev = (struct smart_multiroot_device_s *)
+        smart_malloc(dev, sizeof(*rootdirdev), "Root Dir");
+      if (rootdirdev == NULL)
+        {
+          ferr("ERROR: Memory alloc failed\n");
+          return -ENOMEM;
+        }
 
-#ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
-  for (sector = 0; sector < totalsectors; sector++)
-    {
-      dev->smap[sector] = -1;
-    }
-#else
-  /* Clear all logical sector used bits */
+      /* Populate the rootdirdev */
 
-  memset(dev->sbitmap, 0, (dev->totalsectors + 7) >> 3);
+      rootdirdev->dev = dev;
+      rootdirdev->rootdirnum = x;
+      ret = register_blockdriver(dev->rwbuffer, &g_bops, 0,
+                                 rootdirdev);
+
+      /* Inode private data is a reference to the SMART device
+       * structure.
+       */
+
+      ret = register_blockdriver(devname, &g_bops, 0, rootdirdev);
+    }
 #endif
 
-  /* Now scan the MTD device */
+  return OK;
+}
+
+/****************************************************************************
+ * Name: smart_scan_sector
+ *
+ * Description: Reads the header of one physical sector and accounts for it
+ *              in the logical sector map and the free and released sector
+ *              counts, resolving duplicate logical sectors as it goes.
+ *
+ ****************************************************************************/
+
+static int smart_scan_sector(FAR struct smart_struct_s *dev, uint16_t sector)
+{
+  int       ret;
+  uint16_t  logicalsector;
+  uint16_t  winner;
+  uint16_t  loser;
+  uint32_t  readaddress;
+  uint32_t  offset;
+  uint16_t  seq1;
+  uint16_t  seq2;
+  uint16_t  seqwrap;
+  struct    smart_sect_header_s header;
+#ifdef CONFIG_MTD_SMART_MINIMIZE_RAM
+  int       dupsector;
+  uint16_t  duplogsector;
+#endif
 
   /* At first, set the loser sector as the invalid value */
 
-  loser = totalsectors;
+  loser = dev->totalsectors;
 
-  for (sector = 0; sector < totalsectors; sector++)
-    {
-      finfo("Scan sector %d\n", sector);
+  finfo("Scan sector %d\n", sector);
 
-      winner = sector;
+  winner = sector;
 
-      /* Calculate the read address for this sector */
+  /* Calculate the read address for this sector */
 
-      readaddress = sector * dev->mtdblkspersector * dev->geo.blocksize;
+  readaddress = sector * dev->mtdblkspersector * dev->geo.blocksize;
 
-      /* Read the header for this sector */
+  /* Read the header for this sector */
 
-      ret = MTD_READ(dev->mtd, readaddress,
-                     sizeof(struct smart_sect_header_s),
-                     (FAR uint8_t *)&header);
-      if (ret != sizeof(struct smart_sect_header_s))
-        {
-          goto err_out;
-        }
+  ret = MTD_READ(dev->mtd, readaddress,
+                 sizeof(struct smart_sect_header_s),
+                 (FAR uint8_t *)&header);
+  if (ret != sizeof(struct smart_sect_header_s))
+    {
+      return -EIO;
+    }
 
-      /* Get the logical sector number for this physical sector */
+  /* Get the logical sector number for this physical sector */
 
-      logicalsector = *((FAR uint16_t *) header.logicalsector);
+  logicalsector = *((FAR uint16_t *) header.logicalsector);
 #if CONFIG_SMARTFS_ERASEDSTATE == 0x00
-      if (logicalsector == 0)
-        {
-          logicalsector = -1;
-        }
+  if (logicalsector == 0)
+    {
+      logicalsector = -1;
+    }
 #endif
 
-      /* Test if this sector has been committed */
+  /* Test if this sector has been committed */
 
-      if ((header.status & SMART_STATUS_COMMITTED) ==
-              (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_COMMITTED))
-        {
-          continue;
-        }
+  if ((header.status & SMART_STATUS_COMMITTED) ==
+          (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_COMMITTED))
+    {
+      return OK;
+    }
 
-      /* This block is committed, therefore not free.  Update the
-       * erase block's freecount.
-       */
+  /* This block is committed, therefore not free.  Update the
+   * erase block's freecount.
+   */
 
 #ifdef CONFIG_MTD_SMART_PACK_COUNTS
-      smart_add_count(dev, dev->freecount, sector / dev->sectorsperblk, -1);
+  smart_add_count(dev, dev->freecount, sector / dev->sectorsperblk, -1);
 #else
-      dev->freecount[sector / dev->sectorsperblk]--;
+  dev->freecount[sector / dev->sectorsperblk]--;
 #endif
-      dev->freesectors--;
+  dev->freesectors--;
 
-      /* Test if this sector has been release and if it has,
-       * update the erase block's releasecount.
-       */
+  /* Test if this sector has been release and if it has,
+   * update the erase block's releasecount.
+   */
 
-      if ((header.status & SMART_STATUS_RELEASED) !=
-              (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_RELEASED))
-        {
-          /* Keep track of the total number of released sectors and
-           * released sectors per erase block.
-           */
+  if ((header.status & SMART_STATUS_RELEASED) !=
+          (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_RELEASED))
+    {
+      /* Keep track of the total number of released sectors and
+       * released sectors per erase block.
+       */
 
-          dev->releasesectors++;
+      dev->releasesectors++;
 #ifdef CONFIG_MTD_SMART_PACK_COUNTS
-          smart_add_count(dev, dev->releasecount,
-                          sector / dev->sectorsperblk, 1);
+      smart_add_count(dev, dev->releasecount,
+                      sector / dev->sectorsperblk, 1);
 #else
-          dev->releasecount[sector / dev->sectorsperblk]++;
+      dev->releasecount[sector / dev->sectorsperblk]++;
 #endif
-          continue;
-        }
+      return OK;
+    }
 
-      if ((header.status & SMART_STATUS_VERBITS) != SMART_STATUS_VERSION)
-        {
-          continue;
-        }
+  if ((header.status & SMART_STATUS_VERBITS) != SMART_STATUS_VERSION)
+    {
+      return OK;
+    }
+
+  /* Validate the logical sector number is in bounds */
+
+  if (logicalsector >= dev->totalsectors)
+    {
+      /* Error in logical sector read from the MTD device */
 
-      /* Validate the logical sector number is in bounds */
+      ferr("ERROR: Invalid logical sector %d at physical %d.\n",
+           logicalsector, sector);
+      return OK;
+    }
+
+  /* If this is logical sector zero, then read in the signature
+   * information to validate the format signature.
+   */
 
-      if (logicalsector >= totalsectors)
+  if (logicalsector == 0)
+    {
+      ret = smart_scan_format(dev, sector);
+      if (ret == -EINVAL)
         {
-          /* Error in logical sector read from the MTD device */
+          /* Invalid signature on a sector claiming to be sector 0!
+           * What should we do?  Release it?
+           */
 
-          ferr("ERROR: Invalid logical sector %d at physical %d.\n",
-               logicalsector, sector);
-          continue;
+          return OK;
+        }
+      else if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  /* Test for duplicate logical sectors on the device */
+
+#ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
+  if (dev->smap[logicalsector] != 0xffff)
+#else
+  if (dev->sbitmap[logicalsector >> 3] & (1 << (logicalsector & 0x07)))
+#endif
+    {
+      /* Uh-oh, we found more than 1 physical sector claiming to be
+       * the same logical sector.  Use the sequence number information
+       * to resolve who wins.
+       */
+
+#if SMART_STATUS_VERSION == 1
+      if ((header.status & SMART_STATUS_CRC) !=
+              (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_CRC))
+        {
+          seq2 = header.seq;
+        }
+      else
+        {
+          seq2 = *((FAR uint16_t *) &header.seq);
         }
+#else
+      seq2 = header.seq;
+#endif
 
-      /* If this is logical sector zero, then read in the signature
-       * information to validate the format signature.
+      /* We must re-read the 1st physical sector to get it's seq number */
+
+#ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
+      readaddress = dev->smap[logicalsector] * dev->mtdblkspersector *
+                    dev->geo.blocksize;
+#else
+      /* For minimize RAM, we have to rescan to find the 1st sector
+       * claiming to be this logical sector.
        */
 
-      if (logicalsector == 0)
+      for (dupsector = 0; dupsector < sector; dupsector++)
         {
-          /* Read the sector data */
+          /* Calculate the read address for this sector */
+
+          readaddress = dupsector * dev->mtdblkspersector *
+                        dev->geo.blocksize;
+
+          /* Read the header for this sector */
 
-          ret = MTD_READ(dev->mtd, readaddress, 32,
-                         (FAR uint8_t *)dev->rwbuffer);
-          if (ret != 32)
+          ret = MTD_READ(dev->mtd, readaddress,
+                         sizeof(struct smart_sect_header_s),
+                         (FAR uint8_t *) &header);
+          if (ret != sizeof(struct smart_sect_header_s))
             {
-              ferr("ERROR: Error reading physical sector %d.\n", sector);
-              goto err_out;
+              return -EIO;
             }
 
-          /* Validate the format signature */
+          /* Get the logical sector number for this physical sector */
+
+          duplogsector = *((FAR uint16_t *) header.logicalsector);
 
-          if (dev->rwbuffer[SMART_FMT_POS1] != SMART_FMT_SIG1 ||
-              dev->rwbuffer[SMART_FMT_POS2] != SMART_FMT_SIG2 ||
-              dev->rwbuffer[SMART_FMT_POS3] != SMART_FMT_SIG3 ||
-              dev->rwbuffer[SMART_FMT_POS4] != SMART_FMT_SIG4)
+#if CONFIG_SMARTFS_ERASEDSTATE == 0x00
+          if (duplogsector == 0)
             {
-              /* Invalid signature on a sector claiming to be sector 0!
-               * What should we do?  Release it?
-               */
+              duplogsector = -1;
+            }
+#endif
 
+          /* Test if this sector has been committed */
+
+          if ((header.status & SMART_STATUS_COMMITTED) ==
+                  (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_COMMITTED))
+            {
               continue;
             }
 
-          /* Mark the volume as formatted and set the sector size */
+          /* Test if this sector has been release and skip it if it has */
 
-          dev->formatstatus = SMART_FMT_STAT_FORMATTED;
-          dev->namesize = dev->rwbuffer[SMART_FMT_NAMESIZE_POS];
-          dev->formatversion = dev->rwbuffer[SMART_FMT_VERSION_POS];
+          if ((header.status & SMART_STATUS_RELEASED) !=
+                  (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_RELEASED))
+            {
+              continue;
+            }
 
-#ifdef CONFIG_SMARTFS_MULTI_ROOT_DIRS
-          dev->rootdirentries = dev->rwbuffer[SMART_FMT_ROOTDIRS_POS];
+          if ((header.status & SMART_STATUS_VERBITS) !=
+              SMART_STATUS_VERSION)
+            {
+              continue;
+            }
 
-          /* If rootdirentries is greater than 1, then we need to register
-           * additional block devices.
+          /* Now compare if this logical sector matches the current
+           * sector
            */
 
-          for (x = 1; x < dev->rootdirentries; x++)
+          if (duplogsector == logicalsector)
             {
-              if (dev->partname[0] != '\0')
-                {
-                  snprintf(dev->rwbuffer, sizeof(devname),
-                           "/dev/smart%d%sd%d",
-                           dev->minor, dev->partname, x + 1);
-                }
-              else
-                {
-                  snprintf(devname, sizeof(devname), "/dev/smart%dd%d",
-                           dev->minor, x + 1);
-                }
-
-              /* Inode private data is a reference to a struct containing
-               * the SMART device structure and the root directory number.
-               */
+              break;
+            }
+        }
+#endif
 
-              rootdirdev = (struct smart_multiroot_device_s *)
-                smart_malloc(dev, sizeof(*rootdirdev), "Root Dir");
-              if (rootdirdev == NULL)
-                {
-                  ferr("ERROR: Memory alloc failed\n");
-                  ret = -ENOMEM;
-                  goto err_out;
-                }
+      ret = MTD_READ(dev->mtd, readaddress,
+                     sizeof(struct smart_sect_header_s),
+                     (FAR uint8_t *) &header);
+      if (ret != sizeof(struct smart_sect_header_s))
+        {
+          return -EIO;
+        }
 
-              /* Populate the rootdirdev */
+#if SMART_STATUS_VERSION == 1
+      if ((header.status & SMART_STATUS_CRC) !=
+              (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_CRC))
+        {
+          seq1 = header.seq;
+          seqwrap = 0xf0;
+        }
+      else
+        {
+          seq1 = *((FAR uint16_t *) &header.seq);
+          seqwrap = 0xfff0;
+        }
+#else
+      seq1 = header.seq;
+      seqwrap = 0xf0;
+#endif
 
-              rootdirdev->dev = dev;
-              rootdirdev->rootdirnum = x;
-              ret = register_blockdriver(dev->rwbuffer, &g_bops, 0,
-                                         rootdirdev);
+      /* Now determine who wins */
 
-              /* Inode private data is a reference to the SMART device
-               * structure.
-               */
+      if ((seq1 > seqwrap && seq2 < 10) || seq2 > seq1)
+        {
+          /* Seq 2 is the winner ... bigger or it wrapped */
 
-              ret = register_blockdriver(devname, &g_bops, 0, rootdirdev);
-            }
+          winner = sector;
+#ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
+          loser = dev->smap[logicalsector];
+#else
+          loser = dupsector;
 #endif
         }
+      else
+        {
+          /* We keep the original mapping and seq2 is the loser */
 
-      /* Test for duplicate logical sectors on the device */
-
+          loser = sector;
 #ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
-      if (dev->smap[logicalsector] != 0xffff)
+          winner = dev->smap[logicalsector];
 #else
-      if (dev->sbitmap[logicalsector >> 3] & (1 << (logicalsector & 0x07)))
+          winner = smart_cache_lookup(dev, logicalsector);
 #endif
+        }
+
+      finfo("Duplicate Sector winner=%d, loser=%d\n", winner, loser);
+
+#ifdef CONFIG_MTD_SMART_ENABLE_CRC
+      /* Check CRC of the winner sector just in case */
+
+      ret = MTD_BREAD(dev->mtd, winner * dev->mtdblkspersector,
+                      dev->mtdblkspersector,
+                      (FAR uint8_t *) dev->rwbuffer);
+      if (ret == dev->mtdblkspersector)
+        {
+          /* Validate the CRC of the read-back data */
+
+          ret = smart_validate_crc(dev);
+        }
+
+      if (ret != OK)
         {
-          /* Uh-oh, we found more than 1 physical sector claiming to be
-           * the same logical sector.  Use the sequence number information
-           * to resolve who wins.
+          /* The winner sector has CRC error, so we select the loser
+           * sector.  After swapping the winner and the loser sector, we
+           * will release the loser sector with CRC error.
            */
 
-#if SMART_STATUS_VERSION == 1
-          if ((header.status & SMART_STATUS_CRC) !=
-                  (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_CRC))
+          if (sector == winner)
             {
-              seq2 = header.seq;
+              /* winner: sector(CRC error) -> origin
+               * loser : origin            -> sector(CRC error)
+               */
+
+              winner = loser;
+              loser = sector;
             }
           else
             {
-              seq2 = *((FAR uint16_t *) &header.seq);
+              /* winner: origin(CRC error) -> sector
+               * loser : sector            -> origin(CRC error)
+               */
+
+              loser = winner;
+              winner = sector;
             }
+
+          finfo("Duplicate Sector winner=%d, loser=%d\n", winner, loser);
+        }
+#endif /* CONFIG_MTD_SMART_ENABLE_CRC */
+
+      /* Now release the loser sector */
+
+      readaddress = loser  * dev->mtdblkspersector * dev->geo.blocksize;
+      ret = MTD_READ(dev->mtd, readaddress,
+                     sizeof(struct smart_sect_header_s),
+                    (FAR uint8_t *)&header);
+      if (ret != sizeof(struct smart_sect_header_s))
+        {
+          return -EIO;
+        }
+
+#if CONFIG_SMARTFS_ERASEDSTATE == 0xff
+      header.status &= ~SMART_STATUS_RELEASED;
 #else
-          seq2 = header.seq;
+      header.status |= SMART_STATUS_RELEASED;
 #endif
+      offset = readaddress +
+               offsetof(struct smart_sect_header_s, status);
+      ret    = smart_bytewrite(dev, offset, 1, &header.status);
+      if (ret < 0)
+        {
+          ferr("ERROR: Error %d releasing duplicate sector\n", -ret);
+          return ret;
+        }
+    }
 
-          /* We must re-read the 1st physical sector to get it's seq number */
+  /* Test if this sector is loser of duplicate logical sector */
+
+  if (sector == loser)
+    {
+      return OK;
+    }
 
 #ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
-          readaddress = dev->smap[logicalsector] * dev->mtdblkspersector *
-                        dev->geo.blocksize;
+  /* Update the logical to physical sector map */
+
+  dev->smap[logicalsector] = winner;
 #else
-          /* For minimize RAM, we have to rescan to find the 1st sector
-           * claiming to be this logical sector.
-           */
+  /* Mark the logical sector as used in the bitmap */
 
-          for (dupsector = 0; dupsector < sector; dupsector++)
-            {
-              /* Calculate the read address for this sector */
+  dev->sbitmap[logicalsector >> 3] |= 1 << (logicalsector & 0x07);
 
-              readaddress = dupsector * dev->mtdblkspersector *
-                            dev->geo.blocksize;
+  if (logicalsector < SMART_FIRST_ALLOC_SECTOR)
+    {
+      smart_add_sector_to_cache(dev, logicalsector, winner, __LINE__);
+    }
+#endif
 
-              /* Read the header for this sector */
+  return OK;
+}
 
-              ret = MTD_READ(dev->mtd, readaddress,
-                             sizeof(struct smart_sect_header_s),
-                             (FAR uint8_t *) &header);
-              if (ret != sizeof(struct smart_sect_header_s))
-                {
-                  goto err_out;
-                }
+/****************************************************************************
+ * Name: smart_checkpoint_initialize
+ *
+ * Description: Reserves the erase blocks at the end of the device that hold
+ *              the two checkpoint areas and allocates the checkpoint
+ *              buffers.  The areas are sized for the configured sector size;
+ *              a volume formatted with a smaller sector size simply runs
+ *              without a checkpoint.  The reservation is recorded in the
+ *              format sector and a volume formatted with a different one
+ *              is treated as unformatted by smart_scan_format().
+ *
+ ****************************************************************************/
 
-              /* Get the logical sector number for this physical sector */
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+static int smart_checkpoint_initialize(FAR struct smart_struct_s *dev)
+{
+  uint32_t  totalsectors;
+  uint32_t  size;
+  uint32_t  nblocks;
 
-              duplogsector = *((FAR uint16_t *) header.logicalsector);
+  /* The header block, the image, the padding of its last block and one
+   * journal record per erase block.
+   */
 
-#if CONFIG_SMARTFS_ERASEDSTATE == 0x00
-              if (duplogsector == 0)
-                {
-                  duplogsector = -1;
-                }
-#endif
+  totalsectors = dev->geo.neraseblocks *
+                 (dev->geo.erasesize / CONFIG_MTD_SMART_SECTOR_SIZE);
+  if (totalsectors > 65536)
+    {
+      totalsectors = 65536;
+    }
 
-              /* Test if this sector has been committed */
+  size = 2 * dev->geo.blocksize + totalsectors * sizeof(uint16_t) +
+         dev->geo.neraseblocks * (2 + SMART_CP_RECSIZE) +
+         (dev->geo.neraseblocks >> SMART_WEAR_BIT_DIVIDE);
+  nblocks = (size + dev->geo.erasesize - 1) / dev->geo.erasesize;
 
-              if ((header.status & SMART_STATUS_COMMITTED) ==
-                      (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_COMMITTED))
-                {
-                  continue;
-                }
+  if (4 * nblocks > dev->geo.neraseblocks)
+    {
+      fwarn("WARNING: Device too small for a checkpoint\n");
+      dev->cpnblocks = 0;
+      return OK;
+    }
 
-              /* Test if this sector has been release and skip it if it has */
+  dev->geo.neraseblocks -= 2 * nblocks;
+  dev->cpblock   = dev->geo.neraseblocks;
+  dev->cpnblocks = nblocks;
 
-              if ((header.status & SMART_STATUS_RELEASED) !=
-                      (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_RELEASED))
-                {
-                  continue;
-                }
+  dev->cpbuffer = (FAR uint8_t *)
+    smart_malloc(dev, dev->geo.blocksize, "Checkpoint buffer");
+  dev->cpdirty = (FAR uint8_t *)
+    smart_zalloc(dev, (dev->geo.neraseblocks + 7) >> 3, "Checkpoint map");
+  if (dev->cpbuffer == NULL || dev->cpdirty == NULL)
+    {
+      ferr("ERROR: Error allocating checkpoint buffers\n");
+      return -ENOMEM;
+    }
 
-              if ((header.status & SMART_STATUS_VERBITS) !=
-                  SMART_STATUS_VERSION)
-                {
-                  continue;
-                }
+  return OK;
+}
+#endif
 
-              /* Now compare if this logical sector matches the current
-               * sector
-               */
+/****************************************************************************
+ * Name: smart_checkpoint_layout
+ *
+ * Description: Computes the image size and the offset of the journal
+ *              within a checkpoint area for the current sector size.
+ *
+ ****************************************************************************/
 
-              if (duplogsector == logicalsector)
-                {
-                  break;
-                }
-            }
-#endif
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+static int smart_checkpoint_layout(FAR struct smart_struct_s *dev,
+                                   FAR uint32_t *imgsize)
+{
+  uint32_t  size;
 
-          ret = MTD_READ(dev->mtd, readaddress,
-                         sizeof(struct smart_sect_header_s),
-                         (FAR uint8_t *) &header);
-          if (ret != sizeof(struct smart_sect_header_s))
-            {
-              goto err_out;
-            }
+  /* The sector map is allocated together with the release and free
+   * counts, so they are saved as one piece.
+   */
 
-#if SMART_STATUS_VERSION == 1
-          if ((header.status & SMART_STATUS_CRC) !=
-                  (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_CRC))
-            {
-              seq1 = header.seq;
-              seqwrap = 0xf0;
-            }
-          else
-            {
-              seq1 = *((FAR uint16_t *) &header.seq);
-              seqwrap = 0xfff0;
-            }
-#else
-          seq1 = header.seq;
-          seqwrap = 0xf0;
+  size = dev->totalsectors * sizeof(uint16_t) + (dev->neraseblocks << 1);
+#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
+  size += dev->neraseblocks >> SMART_WEAR_BIT_DIVIDE;
 #endif
 
-          /* Now determine who wins */
-
-          if ((seq1 > seqwrap && seq2 < 10) || seq2 > seq1)
-            {
-              /* Seq 2 is the winner ... bigger or it wrapped */
+  *imgsize       = size;
+  dev->cpjournal = (1 + (size + dev->geo.blocksize - 1) /
+                   dev->geo.blocksize) * dev->geo.blocksize;
 
-              winner = sector;
-#ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
-              loser = dev->smap[logicalsector];
-#else
-              loser = dupsector;
-#endif
-            }
-          else
-            {
-              /* We keep the original mapping and seq2 is the loser */
+  if (dev->cpjournal + dev->neraseblocks * SMART_CP_RECSIZE >
+      dev->cpnblocks * dev->geo.erasesize)
+    {
+      return -ENOSPC;
+    }
 
-              loser = sector;
-#ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
-              winner = dev->smap[logicalsector];
-#else
-              winner = smart_cache_lookup(dev, logicalsector);
+  return OK;
+}
 #endif
-            }
 
-          finfo("Duplicate Sector winner=%d, loser=%d\n", winner, loser);
+/****************************************************************************
+ * Name: smart_checkpoint_put
+ *
+ * Description: Appends data to a checkpoint image being written.
+ *
+ ****************************************************************************/
 
-#ifdef CONFIG_MTD_SMART_ENABLE_CRC
-          /* Check CRC of the winner sector just in case */
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+static int smart_checkpoint_put(FAR struct smart_struct_s *dev,
+                                FAR struct smart_cpstream_s *stream,
+                                FAR const uint8_t *data, size_t len)
+{
+  ssize_t   ret;
+  size_t    n;
 
-          ret = MTD_BREAD(dev->mtd, winner * dev->mtdblkspersector,
-                          dev->mtdblkspersector,
-                          (FAR uint8_t *) dev->rwbuffer);
-          if (ret == dev->mtdblkspersector)
-            {
-              /* Validate the CRC of the read-back data */
+  stream->crc = crc32part(data, len, stream->crc);
 
-              ret = smart_validate_crc(dev);
+  while (len > 0)
+    {
+      n = dev->geo.blocksize - stream->pos;
+      if (n > len)
+        {
+          n = len;
+        }
+
+      memcpy(&dev->cpbuffer[stream->pos], data, n);
+      stream->pos += n;
+      data        += n;
+      len         -= n;
+
+      if (stream->pos == dev->geo.blocksize)
+        {
+          ret = MTD_BWRITE(dev->mtd, stream->block, 1, dev->cpbuffer);
+          if (ret != 1)
+            {
+              return ret < 0 ? ret : -EIO;
             }
 
-          if (ret != OK)
+          stream->block++;
+          stream->pos = 0;
+        }
+    }
+
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_checkpoint_get
+ *
+ * Description: Reads data from a checkpoint image.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+static int smart_checkpoint_get(FAR struct smart_struct_s *dev,
+                                FAR struct smart_cpstream_s *stream,
+                                FAR uint8_t *data, size_t len)
+{
+  FAR uint8_t *start = data;
+  size_t    total = len;
+  ssize_t   ret;
+  size_t    n;
+
+  while (len > 0)
+    {
+      if (stream->pos == 0)
+        {
+          ret = MTD_BREAD(dev->mtd, stream->block, 1, dev->cpbuffer);
+          if (ret != 1)
             {
-              /* The winner sector has CRC error, so we select the loser
-               * sector.  After swapping the winner and the loser sector, we
-               * will release the loser sector with CRC error.
-               */
+              return ret < 0 ? ret : -EIO;
+            }
+        }
 
-              if (sector == winner)
-                {
-                  /* winner: sector(CRC error) -> origin
-                   * loser : origin            -> sector(CRC error)
-                   */
+      n = dev->geo.blocksize - stream->pos;
+      if (n > len)
+        {
+          n = len;
+        }
 
-                  winner = loser;
-                  loser = sector;
-                }
-              else
-                {
-                  /* winner: origin(CRC error) -> sector
-                   * loser : sector            -> origin(CRC error)
-                   */
+      memcpy(data, &dev->cpbuffer[stream->pos], n);
+      stream->pos += n;
+      data        += n;
+      len         -= n;
 
-                  loser = winner;
-                  winner = sector;
-                }
+      if (stream->pos == dev->geo.blocksize)
+        {
+          stream->block++;
+          stream->pos = 0;
+        }
+    }
+
+  stream->crc = crc32part(start, total, stream->crc);
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_checkpoint_program
+ *
+ * Description: Programs a few bytes of a checkpoint area that is known to
+ *              be erased at that location (journal records), or that only
+ *              need bits moved away from the erased state (invalidation).
+ *              The bytes must not straddle an MTD block.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+static int smart_checkpoint_program(FAR struct smart_struct_s *dev,
+                                    uint32_t offset, size_t nbytes,
+                                    FAR const uint8_t *buffer)
+{
+  ssize_t   ret;
+  off_t     block;
+
+#ifdef CONFIG_MTD_BYTE_WRITE
+  if (dev->mtd->write != NULL)
+    {
+      ret = dev->mtd->write(dev->mtd, offset, nbytes, buffer);
+      return ret < 0 ? ret : OK;
+    }
+#endif
+
+  /* Read-modify-write the block.  The SMART read/write buffer may be in
+   * use by the caller, so the checkpoint buffer is used instead.
+   */
+
+  block = offset / dev->geo.blocksize;
+  ret   = MTD_BREAD(dev->mtd, block, 1, dev->cpbuffer);
+  if (ret != 1)
+    {
+      return ret < 0 ? ret : -EIO;
+    }
+
+  memcpy(&dev->cpbuffer[offset - block * dev->geo.blocksize], buffer,
+         nbytes);
+
+  ret = MTD_BWRITE(dev->mtd, block, 1, dev->cpbuffer);
+  if (ret != 1)
+    {
+      return ret < 0 ? ret : -EIO;
+    }
+
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_checkpoint_invalidate
+ *
+ * Description: Destroys the magic of the checkpoint in the given area so it
+ *              is never used again.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+static int smart_checkpoint_invalidate(FAR struct smart_struct_s *dev,
+                                       uint8_t area)
+{
+  uint8_t   magic[4];
+
+  memset(magic, (uint8_t)~CONFIG_SMARTFS_ERASEDSTATE, sizeof(magic));
+  return smart_checkpoint_program(dev, SMART_CP_AREA(dev, area),
+                                  sizeof(magic), magic);
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_checkpoint_touch
+ *
+ * Description: Called before the erase blocks covering the given range of
+ *              the device are modified.  The first modification of an erase
+ *              block after a checkpoint appends the block to the journal so
+ *              that the next mount rescans it.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+static int smart_checkpoint_touch(FAR struct smart_struct_s *dev,
+                                  uint32_t offset, size_t nbytes)
+{
+  uint16_t  block;
+  uint16_t  last;
+  uint16_t  rec[2];
+  int       ret;
+
+  if (!dev->cpactive || nbytes == 0)
+    {
+      return OK;
+    }
+
+  block = offset / dev->geo.erasesize;
+  last  = (offset + nbytes - 1) / dev->geo.erasesize;
+
+  for (; block <= last; block++)
+    {
+      if (ISSET_BITMAP(dev->cpdirty, block))
+        {
+          continue;
+        }
+
+      DEBUGASSERT(block < dev->neraseblocks &&
+                  dev->cpndirty < dev->neraseblocks);
+
+      rec[0] = block;
+      rec[1] = ~block;
+      ret = smart_checkpoint_program(dev, SMART_CP_AREA(dev, dev->cparea) +
+                                     dev->cpjournal +
+                                     dev->cpndirty * SMART_CP_RECSIZE,
+                                     SMART_CP_RECSIZE, (FAR uint8_t *)rec);
+      if (ret < 0)
+        {
+          /* The modification can't be recorded.  Carry on without a
+           * checkpoint, but only if the stale one is gone for sure.
+           */
+
+          ferr("ERROR: Error %d writing checkpoint journal\n", -ret);
+          ret = smart_checkpoint_invalidate(dev, dev->cparea);
+          if (ret < 0)
+            {
+              return ret;
+            }
+
+          dev->cpactive = false;
+          return OK;
+        }
+
+      SET_BITMAP(dev->cpdirty, block);
+      dev->cpndirty++;
+    }
+
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_bwrite / smart_erase
+ *
+ * Description: MTD block write and erase of the SMART area of the device,
+ *              recording the modified erase blocks in the checkpoint
+ *              journal first.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+static ssize_t smart_bwrite(FAR struct smart_struct_s *dev, off_t startblock,
+                            size_t nblocks, FAR const uint8_t *buffer)
+{
+  int       ret;
+
+  ret = smart_checkpoint_touch(dev, startblock * dev->geo.blocksize,
+                               nblocks * dev->geo.blocksize);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  return MTD_BWRITE(dev->mtd, startblock, nblocks, buffer);
+}
+
+static int smart_erase(FAR struct smart_struct_s *dev, off_t block)
+{
+  int       ret;
+
+  ret = smart_checkpoint_touch(dev, block * dev->geo.erasesize,
+                               dev->geo.erasesize);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  return MTD_ERASE(dev->mtd, block, 1);
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_checkpoint_write
+ *
+ * Description: Writes a checkpoint of the current state into the inactive
+ *              checkpoint area and starts a new, empty journal.  Must only
+ *              be called between operations, when the in-memory state
+ *              matches the device.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+static int smart_checkpoint_write(FAR struct smart_struct_s *dev)
+{
+  struct smart_cpstream_s stream;
+  struct smart_cphdr_s hdr;
+#ifdef CONFIG_MTD_SMART_ENABLE_CRC
+  FAR struct smart_allocsector_s *allocsect;
+#endif
+  uint32_t  imgsize;
+  uint8_t   area;
+  int       ret;
+
+  if (dev->cpnblocks == 0)
+    {
+      return OK;
+    }
+
+  ret = smart_checkpoint_layout(dev, &imgsize);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  /* The active checkpoint and its journal stay valid until the new header
+   * is written.
+   */
+
+  area = dev->cparea ^ 1;
+  ret  = MTD_ERASE(dev->mtd, dev->cpblock + area * dev->cpnblocks,
+                   dev->cpnblocks);
+  if (ret < 0)
+    {
+      goto errout;
+    }
+
+  stream.block = SMART_CP_AREA(dev, area) / dev->geo.blocksize + 1;
+  stream.pos   = 0;
+  stream.crc   = 0;
+
+  ret = smart_checkpoint_put(dev, &stream, (FAR const uint8_t *)dev->smap,
+                             dev->totalsectors * sizeof(uint16_t) +
+                             (dev->neraseblocks << 1));
+#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
+  if (ret == OK)
+    {
+      ret = smart_checkpoint_put(dev, &stream, dev->wearstatus,
+                                 dev->neraseblocks >> SMART_WEAR_BIT_DIVIDE);
+    }
+#endif
+
+  /* Write out the partial last block */
+
+  if (ret == OK && stream.pos > 0)
+    {
+      memset(&dev->cpbuffer[stream.pos], CONFIG_SMARTFS_ERASEDSTATE,
+             dev->geo.blocksize - stream.pos);
+      ret = MTD_BWRITE(dev->mtd, stream.block, 1, dev->cpbuffer);
+      ret = ret == 1 ? OK : ret < 0 ? ret : -EIO;
+    }
+
+  if (ret < 0)
+    {
+      goto errout;
+    }
+
+  /* Commit the checkpoint by writing its header */
+
+  memset(&hdr, 0, sizeof(hdr));
+  memcpy(hdr.magic, SMART_CP_MAGIC, sizeof(hdr.magic));
+  hdr.seq            = dev->cpseq + 1;
+  hdr.imgsize        = imgsize;
+  hdr.imgcrc         = stream.crc;
+#if defined(CONFIG_FS_PROCFS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_SMARTFS)
+  hdr.blockerases    = dev->blockerases;
+#endif
+#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
+  hdr.uneven_wearcount = dev->uneven_wearcount;
+#endif
+  hdr.sectorsize     = dev->sectorsize;
+  hdr.totalsectors   = dev->totalsectors;
+  hdr.neraseblocks   = dev->neraseblocks;
+  hdr.freesectors    = dev->freesectors;
+  hdr.releasesectors = dev->releasesectors;
+  hdr.hdrcrc         = crc32((FAR const uint8_t *)&hdr,
+                             offsetof(struct smart_cphdr_s, hdrcrc));
+
+  memset(dev->cpbuffer, CONFIG_SMARTFS_ERASEDSTATE, dev->geo.blocksize);
+  memcpy(dev->cpbuffer, &hdr, sizeof(hdr));
+  ret = MTD_BWRITE(dev->mtd, SMART_CP_AREA(dev, area) / dev->geo.blocksize,
+                   1, dev->cpbuffer);
+  if (ret != 1)
+    {
+      ret = ret < 0 ? ret : -EIO;
+      goto errout;
+    }
+
+  /* Retire the previous checkpoint, its journal ends here */
+
+  smart_checkpoint_invalidate(dev, area ^ 1);
+
+  dev->cparea   = area;
+  dev->cpseq    = hdr.seq;
+  dev->cpndirty = 0;
+  dev->cpactive = true;
+  memset(dev->cpdirty, 0, (dev->neraseblocks + 7) >> 3);
+
+#ifdef CONFIG_MTD_SMART_ENABLE_CRC
+  /* Sectors that are allocated but not yet written are in the saved map,
+   * but have no header on the device yet.  Journal their erase blocks so
+   * that they are rescanned if they are never written.
+   */
+
+  for (allocsect = dev->allocsector; allocsect != NULL;
+       allocsect = allocsect->next)
+    {
+      smart_checkpoint_touch(dev, allocsect->physical *
+                             dev->mtdblkspersector * dev->geo.blocksize, 1);
+    }
+#endif
+
+  finfo("Checkpoint %" PRIu32 " written to area %d\n", dev->cpseq, area);
+  return OK;
+
+errout:
+  ferr("ERROR: Error %d writing checkpoint\n", -ret);
+  return ret;
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_checkpoint_sync
+ *
+ * Description: Writes a new checkpoint if there is none or if enough erase
+ *              blocks have been modified since the last one.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+static void smart_checkpoint_sync(FAR struct smart_struct_s *dev)
+{
+  if (dev->cpnblocks > 0 &&
+      (!dev->cpactive || dev->cpndirty >= CONFIG_MTD_SMART_CHECKPOINT_DIRTY))
+    {
+      smart_checkpoint_write(dev);
+    }
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_checkpoint_load
+ *
+ * Description: Loads the image of the checkpoint in the given area.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+static int smart_checkpoint_load(FAR struct smart_struct_s *dev,
+                                 uint8_t area,
+                                 FAR const struct smart_cphdr_s *hdr)
+{
+  struct smart_cpstream_s stream;
+  uint32_t  imgsize;
+  int       ret;
+
+  ret = smart_setsectorsize(dev, hdr->sectorsize);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  ret = smart_checkpoint_layout(dev, &imgsize);
+  if (ret < 0 || dev->erasesize == 0 ||
+      dev->totalsectors != hdr->totalsectors || imgsize != hdr->imgsize)
+    {
+      return -EINVAL;
+    }
+
+  stream.block = SMART_CP_AREA(dev, area) / dev->geo.blocksize + 1;
+  stream.pos   = 0;
+  stream.crc   = 0;
+
+  ret = smart_checkpoint_get(dev, &stream, (FAR uint8_t *)dev->smap,
+                             dev->totalsectors * sizeof(uint16_t) +
+                             (dev->neraseblocks << 1));
+#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
+  if (ret == OK)
+    {
+      ret = smart_checkpoint_get(dev, &stream, dev->wearstatus,
+                                 dev->neraseblocks >> SMART_WEAR_BIT_DIVIDE);
+    }
+#endif
+
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  if (stream.crc != hdr->imgcrc)
+    {
+      ferr("ERROR: Checkpoint %" PRIu32 " CRC error\n", hdr->seq);
+      return -EINVAL;
+    }
+
+  dev->freesectors      = hdr->freesectors;
+  dev->releasesectors   = hdr->releasesectors;
+#if defined(CONFIG_FS_PROCFS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_SMARTFS)
+  dev->blockerases      = hdr->blockerases;
+#endif
+#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
+  dev->uneven_wearcount = hdr->uneven_wearcount;
+#endif
+
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_checkpoint_replay
+ *
+ * Description: Reads the journal of the active checkpoint and rescans the
+ *              erase blocks modified since the checkpoint was written.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+static int smart_checkpoint_replay(FAR struct smart_struct_s *dev)
+{
+  uint32_t  offset;
+  uint16_t  rec[2];
+  uint16_t  block;
+  uint16_t  prerelease;
+  uint32_t  sector;
+  ssize_t   ret;
+
+  memset(dev->cpdirty, 0, (dev->neraseblocks + 7) >> 3);
+  dev->cpndirty = 0;
+
+  offset = SMART_CP_AREA(dev, dev->cparea) + dev->cpjournal;
+  while (dev->cpndirty < dev->neraseblocks)
+    {
+      if (offset % dev->geo.blocksize == 0)
+        {
+          ret = MTD_BREAD(dev->mtd, offset / dev->geo.blocksize, 1,
+                          dev->cpbuffer);
+          if (ret != 1)
+            {
+              return ret < 0 ? ret : -EIO;
+            }
+        }
+
+      /* The journal ends at the first record that isn't valid, including
+       * one torn by a power loss: its block was not modified yet.
+       */
+
+      memcpy(rec, &dev->cpbuffer[offset % dev->geo.blocksize], sizeof(rec));
+      if (rec[1] != (uint16_t)~rec[0] || rec[0] >= dev->neraseblocks ||
+          ISSET_BITMAP(dev->cpdirty, rec[0]))
+        {
+          break;
+        }
+
+      SET_BITMAP(dev->cpdirty, rec[0]);
+      dev->cpndirty++;
+      offset += SMART_CP_RECSIZE;
+    }
+
+  /* New modifications are appended to this journal from here on, which
+   * includes any duplicate sector the rescan below releases.
+   */
+
+  dev->cpactive = true;
+
+  if (dev->cpndirty == 0)
+    {
+      return OK;
+    }
+
+  /* Forget what the checkpoint says about the journaled blocks */
+
+  for (sector = 0; sector < dev->totalsectors; sector++)
+    {
+      if (dev->smap[sector] != 0xffff &&
+          ISSET_BITMAP(dev->cpdirty, dev->smap[sector] / dev->sectorsperblk))
+        {
+          dev->smap[sector] = 0xffff;
+        }
+    }
+
+  /* And rescan them the same way smart_scan() does */
+
+  for (block = 0; block < dev->neraseblocks; block++)
+    {
+      if (!ISSET_BITMAP(dev->cpdirty, block))
+        {
+          continue;
+        }
+
+      if (block == dev->neraseblocks - 1 && dev->totalsectors == 65534)
+        {
+          prerelease = 2;
+        }
+      else
+        {
+          prerelease = 0;
+        }
+
+      dev->freesectors    -= dev->freecount[block] + prerelease -
+                             dev->availsectperblk;
+      dev->releasesectors -= dev->releasecount[block] - prerelease;
+      dev->freecount[block]    = dev->availsectperblk - prerelease;
+      dev->releasecount[block] = prerelease;
+
+      for (sector = block * dev->sectorsperblk;
+           sector < (block + 1) * dev->sectorsperblk &&
+           sector < dev->totalsectors; sector++)
+        {
+          ret = smart_scan_sector(dev, sector);
+          if (ret < 0)
+            {
+              return ret;
+            }
+        }
+    }
+
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_checkpoint_restore
+ *
+ * Description: Rebuilds the sector map from the newest valid checkpoint and
+ *              its journal instead of scanning the whole device.  Returns a
+ *              negated errno value if the full scan is needed.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+static int smart_checkpoint_restore(FAR struct smart_struct_s *dev)
+{
+  struct smart_cphdr_s hdr[2];
+  bool      valid[2];
+  uint8_t   area;
+  int       ret;
+  int       i;
+
+  if (dev->cpnblocks == 0)
+    {
+      return -ENOENT;
+    }
+
+  dev->cpactive = false;
+
+  for (area = 0; area < 2; area++)
+    {
+      ret = MTD_BREAD(dev->mtd, SMART_CP_AREA(dev, area) /
+                      dev->geo.blocksize, 1, dev->cpbuffer);
+      memcpy(&hdr[area], dev->cpbuffer, sizeof(hdr[area]));
+
+      valid[area] = ret == 1 &&
+                    hdr[area].hdrcrc ==
+                    crc32((FAR const uint8_t *)&hdr[area],
+                          offsetof(struct smart_cphdr_s, hdrcrc));
+      if (valid[area] && hdr[area].seq > dev->cpseq)
+        {
+          dev->cpseq = hdr[area].seq;
+        }
+
+      valid[area] = valid[area] &&
+                    memcmp(hdr[area].magic, SMART_CP_MAGIC,
+                           sizeof(hdr[area].magic)) == 0 &&
+                    hdr[area].neraseblocks == dev->geo.neraseblocks;
+    }
+
+  /* Try the newest checkpoint first */
+
+  area = hdr[1].seq > hdr[0].seq;
+  for (i = 0; i < 2; i++, area ^= 1)
+    {
+      if (valid[area] && smart_checkpoint_load(dev, area, &hdr[area]) == OK)
+        {
+          break;
+        }
+    }
+
+  if (i == 2)
+    {
+      return -ENOENT;
+    }
+
+  dev->cparea       = area;
+  dev->formatstatus = SMART_FMT_STAT_NOFMT;
+
+  ret = smart_checkpoint_replay(dev);
+  if (ret < 0)
+    {
+      dev->cpactive = false;
+      return ret;
+    }
+
+  /* Logical sector zero is only read by the rescan if its block was
+   * modified.
+   */
+
+  if (dev->formatstatus != SMART_FMT_STAT_FORMATTED &&
+      dev->smap[0] != 0xffff)
+    {
+      ret = smart_scan_format(dev, dev->smap[0]);
+      if (ret < 0 && ret != -EINVAL)
+        {
+          dev->cpactive = false;
+          return ret;
+        }
+    }
+
+#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
+  /* The saved wear status is current unless blocks were modified since
+   * the checkpoint, in which case the copy kept in the format sectors is
+   * used, as after a full scan.
+   */
+
+  if (dev->cpndirty > 0)
+    {
+      smart_read_wearstatus(dev);
+    }
+  else
+    {
+      smart_find_wear_minmax(dev);
+    }
+#endif
+
+#ifdef CONFIG_MTD_SMART_FSCK
+  smart_fsck(dev);
+#endif
+
+  finfo("Checkpoint %" PRIu32 " restored, %d erase blocks rescanned\n",
+        hdr[area].seq, dev->cpndirty);
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_scan
+ *
+ * Description: Performs a scan of the MTD device searching for format
+ *              information and fills in logical sector mapping, freesector
+ *              count, etc.
+ *
+ ****************************************************************************/
+
+static int smart_scan(FAR struct smart_struct_s *dev)
+{
+  int       sector;
+  int       ret;
+  uint16_t  totalsectors;
+  uint16_t  sectorsize;
+  uint16_t  prerelease;
+  uint32_t  readaddress;
+  uint32_t  offset;
+  struct    smart_sect_header_s header;
+  static const short sizetbl[8] =
+  {
+    CONFIG_MTD_SMART_SECTOR_SIZE,
+    512, 1024, 4096, 2048, 8192, 16384, 32768
+  };
+
+  finfo("Entry\n");
+
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+  /* Use the checkpoint if there is a valid one.  Only the erase blocks
+   * modified since it was written need to be scanned then.
+   */
+
+  if (smart_checkpoint_restore(dev) == OK)
+    {
+      return OK;
+    }
+#endif
+
+  /* Find the sector size on the volume by reading headers from
+   * sectors of decreasing size.  On a formatted volume, the sector
+   * size is saved in the header status byte of search sector, so
+   * by starting with the largest supported sector size and
+   * decreasing from there, we will be sure to find data that is
+   * a header and not sector data.
+   */
+
+  sectorsize = 0xffff;
+  offset = 16384;
 
-              finfo("Duplicate Sector winner=%d, loser=%d\n", winner, loser);
-            }
-#endif /* CONFIG_MTD_SMART_ENABLE_CRC */
+  while (sectorsize == 0xffff)
+    {
+      readaddress = 0;
 
-          /* Now release the loser sector */
+      while (readaddress < dev->erasesize * dev->geo.neraseblocks)
+        {
+          /* Read the next sector from the device */
 
-          readaddress = loser  * dev->mtdblkspersector * dev->geo.blocksize;
           ret = MTD_READ(dev->mtd, readaddress,
                          sizeof(struct smart_sect_header_s),
-                        (FAR uint8_t *)&header);
+                         (FAR uint8_t *) &header);
           if (ret != sizeof(struct smart_sect_header_s))
             {
               goto err_out;
             }
 
-#if CONFIG_SMARTFS_ERASEDSTATE == 0xff
-          header.status &= ~SMART_STATUS_RELEASED;
-#else
-          header.status |= SMART_STATUS_RELEASED;
-#endif
-          offset = readaddress +
-                   offsetof(struct smart_sect_header_s, status);
-          ret    = smart_bytewrite(dev, offset, 1, &header.status);
-          if (ret < 0)
+          if (header.status != CONFIG_SMARTFS_ERASEDSTATE)
             {
-              ferr("ERROR: Error %d releasing duplicate sector\n", -ret);
-              goto err_out;
+              sectorsize =
+                sizetbl[(header.status & SMART_STATUS_SIZEBITS) >> 2];
+              break;
             }
+
+          readaddress += offset;
         }
 
-      /* Test if this sector is loser of duplicate logical sector */
+      if (sectorsize == 0xffff)
+        {
+          sectorsize = CONFIG_MTD_SMART_SECTOR_SIZE;
+        }
 
-      if (sector == loser)
+      offset >>= 1;
+      if (offset < 256 && sectorsize == 0xffff)
         {
-          continue;
+          /* No valid sectors found on device.  Default the
+           * sector size to the CONFIG value
+           */
+
+          sectorsize = CONFIG_MTD_SMART_SECTOR_SIZE;
         }
+    }
 
-#ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
-      /* Update the logical to physical sector map */
+  /* Now set the sectorsize and other sectorsize derived variables */
 
-      dev->smap[logicalsector] = winner;
-#else
-      /* Mark the logical sector as used in the bitmap */
+  ret = smart_setsectorsize(dev, sectorsize);
+  if (ret != OK)
+    {
+      goto err_out;
+    }
+
+  /* Initialize the device variables */
+
+  totalsectors        = dev->totalsectors;
+  dev->formatstatus   = SMART_FMT_STAT_NOFMT;
+  dev->freesectors    = dev->availsectperblk * dev->geo.neraseblocks;
+  dev->releasesectors = 0;
 
-      dev->sbitmap[logicalsector >> 3] |= 1 << (logicalsector & 0x07);
+  /* Initialize the freecount and releasecount arrays */
 
-      if (logicalsector < SMART_FIRST_ALLOC_SECTOR)
+  for (sector = 0; sector < dev->neraseblocks; sector++)
+    {
+      if (sector == dev->neraseblocks - 1 && dev->totalsectors == 65534)
+        {
+          prerelease = 2;
+        }
+      else
         {
-          smart_add_sector_to_cache(dev, logicalsector, winner, __LINE__);
+          prerelease = 0;
         }
+
+#ifdef CONFIG_MTD_SMART_PACK_COUNTS
+      smart_set_count(dev, dev->freecount, sector,
+                      dev->availsectperblk - prerelease);
+      smart_set_count(dev, dev->releasecount, sector, prerelease);
+#else
+      dev->freecount[sector] = dev->availsectperblk - prerelease;
+      dev->releasecount[sector] = prerelease;
+#endif
+    }
+
+  /* Initialize the sector map */
+
+#ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
+  for (sector = 0; sector < totalsectors; sector++)
+    {
+      dev->smap[sector] = -1;
+    }
+#else
+  /* Clear all logical sector used bits */
+
+  memset(dev->sbitmap, 0, (dev->totalsectors + 7) >> 3);
 #endif
+
+  /* Now scan the MTD device */
+
+  for (sector = 0; sector < totalsectors; sector++)
+    {
+      ret = smart_scan_sector(dev, sector);
+      if (ret < 0)
+        {
+          goto err_out;
+        }
     }
 
 #if defined (CONFIG_MTD_SMART_WEAR_LEVEL) && (SMART_STATUS_VERSION == 1)
@@ -2582,6 +3633,12 @@ static int smart_scan(FAR struct smart_struct_s *dev)
     }
 #endif
 
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+  /* Save the result so that the next mount doesn't need a full scan */
+
+  smart_checkpoint_write(dev);
+#endif
+
   ret = OK;
 
 err_out:
@@ -2693,7 +3750,7 @@ static void smart_erase_block_if_empty(FAR struct smart_struct_s *dev,
       dev->unusedsectors += freecount;
       dev->blockerases++;
 #endif
-      MTD_ERASE(dev->mtd, block, 1);
+      smart_erase(dev, block);
 
 #ifdef CONFIG_MTD_SMART_SECTOR_ERASE_DEBUG
       if (dev->erasecounts)
@@ -3134,6 +4191,12 @@ static inline int smart_llformat(FAR struct smart_struct_s *dev,
       return ret;
     }
 
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+  /* The checkpoint was erased along with everything else */
+
+  dev->cpactive = false;
+#endif
+
   /* Now construct a logical sector zero header to write to the device. */
 
   sectorheader = (FAR struct smart_sect_header_s *) dev->rwbuffer;
@@ -3196,6 +4259,17 @@ static inline int smart_llformat(FAR struct smart_struct_s *dev,
 
   dev->rwbuffer[SMART_FMT_ROOTDIRS_POS] = (uint8_t) (arg & 0xff);
 
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+  /* Record the checkpoint reservation, it must match at every mount */
+
+  if (dev->cpnblocks > 0)
+    {
+      dev->rwbuffer[SMART_FMT_FLAGS_POS]       ^= SMART_FMT_FLAG_CHECKPOINT;
+      dev->rwbuffer[SMART_FMT_CPBLOCKS_POS]     = dev->cpnblocks & 0xff;
+      dev->rwbuffer[SMART_FMT_CPBLOCKS_POS + 1] = dev->cpnblocks >> 8;
+    }
+#endif
+
 #ifdef CONFIG_SMART_CRC_8
   sectorheader->crc8 = smart_calc_sector_crc(dev);
 #elif defined(CONFIG_SMART_CRC_16)
@@ -3367,8 +4441,8 @@ static int smart_relocate_sector(FAR struct smart_struct_s *dev,
 
   /* Write the data to the new physical sector location */
 
-  ret = MTD_BWRITE(dev->mtd, newsector * dev->mtdblkspersector,
-                   dev->mtdblkspersector, (FAR uint8_t *) dev->rwbuffer);
+  ret = smart_bwrite(dev, newsector * dev->mtdblkspersector,
+                     dev->mtdblkspersector, (FAR uint8_t *) dev->rwbuffer);
   if (ret != dev->mtdblkspersector)
     {
       ferr("Error writing to new sector %d\n", newsector);
@@ -3385,8 +4459,8 @@ static int smart_relocate_sector(FAR struct smart_struct_s *dev,
 
   /* Write the data to the new physical sector location */
 
-  ret = MTD_BWRITE(dev->mtd, newsector * dev->mtdblkspersector,
-                   dev->mtdblkspersector, (FAR uint8_t *) dev->rwbuffer);
+  ret = smart_bwrite(dev, newsector * dev->mtdblkspersector,
+                     dev->mtdblkspersector, (FAR uint8_t *) dev->rwbuffer);
   if (ret != dev->mtdblkspersector)
     {
       ferr("Error writing to new sector %d\n", newsector);
@@ -3610,7 +4684,7 @@ static int smart_relocate_block(FAR struct smart_struct_s *dev,
 
   /* Now erase the erase block */
 
-  MTD_ERASE(dev->mtd, block, 1);
+  smart_erase(dev, block);
 #if defined(CONFIG_FS_PROCFS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_SMARTFS)
   dev->unusedsectors += freecount;
   dev->blockerases++;
@@ -3948,7 +5022,7 @@ retry:
 
           if (1 == dev->availsectperblk)
             {
-              MTD_ERASE(dev->mtd, allocblock, 1);
+              smart_erase(dev, allocblock);
               physicalsector = i;
               dev->lastallocblock = allocblock;
               break;
@@ -4371,6 +5445,244 @@ errout:
 }
 #endif
 
+/****************************************************************************
+ * Name: smart_bggc_victim
+ *
+ * Description:  Selects the erase block the background garbage collection
+ *               should collect next.  This is a cost-benefit choice: the
+ *               released sectors reclaimed by collecting a block are
+ *               weighed against the cost of reading the block, moving its
+ *               live sectors and erasing it.  Returns -ENOENT if no block
+ *               would gain enough.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_BGGC
+static int smart_bggc_victim(FAR struct smart_struct_s *dev)
+{
+  uint32_t  score;
+  uint32_t  bestscore = 0;
+  uint16_t  freecount;
+  uint16_t  releasecount;
+  uint16_t  livecount;
+  int       victim = -ENOENT;
+  int       block;
+#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
+  uint8_t   wearlevel;
+  uint8_t   bestwear = 0;
+#endif
+
+  for (block = 0; block < dev->neraseblocks; block++)
+    {
+#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
+      /* Don't collect blocks that have been worn completely */
+
+      wearlevel = smart_get_wear_level(dev, block);
+      if (wearlevel >= SMART_WEAR_REORG_THRESHOLD)
+        {
+          continue;
+        }
+#endif
+
+#ifdef CONFIG_MTD_SMART_PACK_COUNTS
+      freecount    = smart_get_count(dev, dev->freecount, block);
+      releasecount = smart_get_count(dev, dev->releasecount, block);
+#else
+      freecount    = dev->freecount[block];
+      releasecount = dev->releasecount[block];
+#endif
+
+      /* Moving a nearly full block for a sector or two only adds wear,
+       * leave those to the foreground collection.
+       */
+
+      if (releasecount == 0 || releasecount < dev->availsectperblk >> 2)
+        {
+          continue;
+        }
+
+      /* The live sectors must fit in the free sectors of the other
+       * blocks.
+       */
+
+      livecount = dev->availsectperblk - freecount - releasecount;
+      if (freecount + livecount >= dev->freesectors)
+        {
+          continue;
+        }
+
+      /* Benefit over cost: each live sector is read and written once,
+       * the block itself is read and erased once.  Prefer the less worn
+       * block between equals.
+       */
+
+      score = ((uint32_t)releasecount << 8) /
+              (dev->availsectperblk + livecount);
+
+#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
+      if (score > bestscore ||
+          (score == bestscore && wearlevel < bestwear))
+#else
+      if (score > bestscore)
+#endif
+        {
+          bestscore = score;
+          victim    = block;
+#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
+          bestwear  = wearlevel;
+#endif
+        }
+    }
+
+  return victim;
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_bggc_done
+ *
+ * Description:  Called at the end of each run of the background garbage
+ *               collection worker.  Queues the next run, unless the device
+ *               is being torn down, and updates gcactive.  This is the last
+ *               access of the worker to the device: once gcactive is clear,
+ *               smart_loteardown() may free it.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_BGGC
+static void smart_bggc_done(FAR struct smart_struct_s *dev, bool again,
+                            clock_t delay)
+{
+  irqstate_t flags;
+
+  flags = enter_critical_section();
+
+  if (again && !dev->gcstop)
+    {
+      work_queue(LPWORK, &dev->gcwork, smart_bggc_worker, dev, delay);
+    }
+
+  dev->gcactive = !work_available(&dev->gcwork);
+  leave_critical_section(flags);
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_bggc_worker
+ *
+ * Description:  Background garbage collection worker.  Collects a single
+ *               erase block per run so the device lock is held no longer
+ *               than one foreground collection step, then runs again while
+ *               the free sectors are below the high watermark.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_BGGC
+static void smart_bggc_worker(FAR void *arg)
+{
+  FAR struct smart_struct_s *dev = (FAR struct smart_struct_s *)arg;
+  bool again = false;
+  int victim;
+  int ret;
+
+  /* Do nothing more if the device is being torn down */
+
+  if (dev->gcstop)
+    {
+      smart_bggc_done(dev, false, 0);
+      return;
+    }
+
+  /* Never block the work queue on the device.  If it is busy, try again
+   * once it has been idle for a while.
+   */
+
+  if (nxsem_trywait(&dev->exclsem) < 0)
+    {
+      smart_bggc_done(dev, true, SMART_BGGC_DELAY);
+      return;
+    }
+
+  if (dev->formatstatus != SMART_FMT_STAT_FORMATTED ||
+      dev->freesectors >= SMART_BGGC_HIWATER(dev))
+    {
+      goto out;
+    }
+
+  victim = smart_bggc_victim(dev);
+  if (victim < 0)
+    {
+      goto out;
+    }
+
+  finfo("Background collecting block %d, free=%d released=%d\n",
+        victim, dev->freesectors, dev->releasesectors);
+
+  ret = smart_relocate_block(dev, victim);
+  if (ret < 0)
+    {
+      ferr("ERROR: Error %d collecting block %d\n", -ret, victim);
+      goto out;
+    }
+
+#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
+  if (dev->wearflags & SMART_WEARFLAGS_WRITE_NEEDED)
+    {
+      /* Write new wear status bits to the device */
+
+      smart_write_wearstatus(dev);
+    }
+#endif
+
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+  smart_checkpoint_sync(dev);
+#endif
+
+  again = dev->freesectors < SMART_BGGC_HIWATER(dev);
+
+out:
+  smart_unlock(dev);
+  smart_bggc_done(dev, again, 0);
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_bggc_kick
+ *
+ * Description:  Called with the device locked at the end of each sector
+ *               operation.  Starts the background garbage collection when
+ *               the free sectors are below the high watermark: right away
+ *               below the low watermark, otherwise once the device has been
+ *               idle for CONFIG_MTD_SMART_BGGC_DELAY milliseconds.  Each
+ *               operation pushes the idle start back.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_BGGC
+static void smart_bggc_kick(FAR struct smart_struct_s *dev)
+{
+  irqstate_t flags;
+
+  if (dev->formatstatus != SMART_FMT_STAT_FORMATTED ||
+      dev->releasesectors == 0 ||
+      dev->freesectors >= SMART_BGGC_HIWATER(dev))
+    {
+      return;
+    }
+
+  flags = enter_critical_section();
+  if (!dev->gcstop)
+    {
+      work_queue(LPWORK, &dev->gcwork, smart_bggc_worker, dev,
+                 dev->freesectors < SMART_BGGC_LOWATER(dev) ?
+                 0 : SMART_BGGC_DELAY);
+      dev->gcactive = true;
+    }
+
+  leave_critical_section(flags);
+}
+#endif
+
 /****************************************************************************
  * Name: smart_write_alloc_sector
  *
@@ -4432,7 +5744,7 @@ static int smart_write_alloc_sector(FAR struct smart_struct_s *dev,
 
 #ifndef CONFIG_MTD_SMART_ENABLE_CRC
   finfo("Write MTD block %d\n", physical * dev->mtdblkspersector);
-  ret = MTD_BWRITE(dev->mtd, physical * dev->mtdblkspersector, 1,
+  ret = smart_bwrite(dev, physical * dev->mtdblkspersector, 1,
       (FAR uint8_t *) dev->rwbuffer);
   if (ret != 1)
     {
@@ -4787,7 +6099,7 @@ static int smart_writesector(FAR struct smart_struct_s *dev,
     {
       /* Write the entire sector to the new physical location, uncommitted. */
 
-      ret = MTD_BWRITE(dev->mtd, physsector * dev->mtdblkspersector,
+      ret = smart_bwrite(dev, physsector * dev->mtdblkspersector,
               dev->mtdblkspersector, (FAR uint8_t *) dev->rwbuffer);
       if (ret != dev->mtdblkspersector)
         {
@@ -4874,7 +6186,7 @@ static int smart_writesector(FAR struct smart_struct_s *dev,
 #ifdef CONFIG_MTD_SMART_ENABLE_CRC
       /* Write the entire sector to FLASH when CRC enabled */
 
-      ret = MTD_BWRITE(dev->mtd, physsector * dev->mtdblkspersector,
+      ret = smart_bwrite(dev, physsector * dev->mtdblkspersector,
               dev->mtdblkspersector, (FAR uint8_t *) dev->rwbuffer);
       if (ret != dev->mtdblkspersector)
         {
@@ -5459,6 +6771,12 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
   dev = (FAR struct smart_struct_s *)inode->i_private;
 #endif
 
+  ret = smart_lock(dev);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
   /* Process the ioctl's we care about first, pass any we don't respond
    * to directly to the underlying MTD device.
    */
@@ -5475,7 +6793,8 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
       if (arg == 0)
         {
           ferr("ERROR: BIOC_XIPBASE argument is NULL\n");
-          return -EINVAL;
+          ret = -EINVAL;
+          goto ok_out;
         }
 #endif
 
@@ -5525,6 +6844,9 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
       /* Allocate a logical sector for the upper layer file system */
 
       ret = smart_allocsector(dev, arg);
+#ifdef CONFIG_MTD_SMART_BGGC
+      smart_bggc_kick(dev);
+#endif
       goto ok_out;
 
     case BIOC_FREESECT:
@@ -5532,6 +6854,12 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
       /* Free the specified logical sector */
 
       ret = smart_freesector(dev, arg);
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+      smart_checkpoint_sync(dev);
+#endif
+#ifdef CONFIG_MTD_SMART_BGGC
+      smart_bggc_kick(dev);
+#endif
       goto ok_out;
 
     case BIOC_WRITESECT:
@@ -5549,6 +6877,12 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
         }
 #endif
 
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+      smart_checkpoint_sync(dev);
+#endif
+#ifdef CONFIG_MTD_SMART_BGGC
+      smart_bggc_kick(dev);
+#endif
       goto ok_out;
 
 #if defined(CONFIG_FS_PROCFS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_SMARTFS)
@@ -5619,6 +6953,7 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
     }
 
 ok_out:
+  smart_unlock(dev);
   return ret;
 }
 
@@ -6160,6 +7495,9 @@ int smart_initialize(int minor, FAR struct mtd_dev_s *mtd,
       /* Initialize the SMART device structure */
 
       dev->mtd = mtd;
+#ifdef CONFIG_MTD_SMART_BGGC
+      nxsem_init(&dev->exclsem, 0, 1);
+#endif
 
       /* Get the device geometry. (casting to uintptr_t first eliminates
        * complaints on some architectures where the sizeof long is different
@@ -6176,6 +7514,16 @@ int smart_initialize(int minor, FAR struct mtd_dev_s *mtd,
           goto errout;
         }
 
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+      /* Set aside the checkpoint areas at the end of the device */
+
+      ret = smart_checkpoint_initialize(dev);
+      if (ret < 0)
+        {
+          goto errout;
+        }
+#endif
+
       /* Set the sector size to the default for now */
 
       dev->sectorsize = 0;
@@ -6304,6 +7652,10 @@ errout:
 #ifdef CONFIG_MTD_SMART_SECTOR_ERASE_DEBUG
   smart_free(dev, dev->erasecounts);
 #endif
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+  smart_free(dev, dev->cpbuffer);
+  smart_free(dev, dev->cpdirty);
+#endif
 #ifdef CONFIG_SMARTFS_MULTI_ROOT_DIRS
   if (rootdirdev)
     {
@@ -6311,6 +7663,10 @@ errout:
     }
 #endif
 
+#ifdef CONFIG_MTD_SMART_BGGC
+  nxsem_destroy(&dev->exclsem);
+#endif
+
   kmm_free(dev);
   return ret;
 }
@@ -6389,6 +7745,9 @@ static int smart_loteardown(FAR const char *devname)
 {
   FAR struct smart_struct_s *dev;
   FAR struct inode *inode;
+#ifdef CONFIG_MTD_SMART_BGGC
+  irqstate_t flags;
+#endif
   int ret;
 
   /* Sanity check */
@@ -6425,6 +7784,33 @@ static int smart_loteardown(FAR const char *devname)
 
   close_blockdriver(inode);
 
+#ifdef CONFIG_MTD_SMART_BGGC
+  /* Stop the background garbage collection before the device goes away.
+   * work_cancel() cannot stop a worker that is already running, so instead
+   * any queued run is made to happen now.  It sees gcstop and does not
+   * queue itself again.  Wait until the last run has finished.
+   */
+
+  smart_lock(dev);
+
+  flags = enter_critical_section();
+  dev->gcstop = true;
+  if (dev->gcactive)
+    {
+      work_queue(LPWORK, &dev->gcwork, smart_bggc_worker, dev, 0);
+    }
+
+  leave_critical_section(flags);
+
+  while (dev->gcactive)
+    {
+      nxsig_usleep(SMART_BGGC_STOPWAIT);
+    }
+
+  smart_unlock(dev);
+  nxsem_destroy(&dev->exclsem);
+#endif
+
   /* Now teardown the filemtd */
 
   filemtd_teardown(dev->mtd);
@@ -31,22 +31,63 @@
 #include <errno.h>
 #include <string.h>
 
+#include <nuttx/arch.h>
 #include <nuttx/spinlock.h>
 #include <nuttx/sched.h>
 #include <nuttx/sched_note.h>
+#include <nuttx/semaphore.h>
 #include <nuttx/note/noteram_driver.h>
 #include <nuttx/fs/fs.h>
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* With CONFIG_DRIVER_NOTERAM_PERCPU each CPU owns a private ring.  Only the
+ * owning CPU ever adds notes to its ring (with local interrupts disabled),
+ * so no lock is needed on the producer side.  Otherwise all CPUs share a
+ * single ring serialized by g_noteram_lock.
+ */
+
+#ifdef CONFIG_DRIVER_NOTERAM_PERCPU
+#  define NOTERAM_NRINGS          CONFIG_SMP_NCPUS
+#else
+#  define NOTERAM_NRINGS          1
+#endif
+
+/* The head, tail and read indices are free-running counters; the buffer
+ * offset is obtained by masking them with the buffer size.  This lets the
+ * reader detect that a note was overwritten while it was being copied
+ * without holding any lock shared with the producers.  The buffer size
+ * must be a power of two so that the offset stays continuous when the
+ * counters wrap around.
+ */
+
+#if (CONFIG_DRIVER_NOTERAM_BUFSIZE & (CONFIG_DRIVER_NOTERAM_BUFSIZE - 1)) != 0
+#  error CONFIG_DRIVER_NOTERAM_BUFSIZE must be a power of two
+#endif
+
+#define NOTERAM_OFFSET(ndx)       ((ndx) & (CONFIG_DRIVER_NOTERAM_BUFSIZE - 1))
+
+/* Orders the index updates against the accesses to the note data */
+
+#ifdef CONFIG_SMP
+#  define noteram_barrier()       SP_DMB()
+#else
+#  define noteram_barrier()
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
 
 struct noteram_info_s
 {
-  volatile unsigned int ni_head;
-  volatile unsigned int ni_tail;
-  volatile unsigned int ni_read;
-  unsigned int ni_overwrite;
+  volatile unsigned int ni_head;   /* Producer: next write position */
+  volatile unsigned int ni_tail;   /* Producer: oldest note retained */
+  volatile unsigned int ni_read;   /* Reader: next note to read */
+  volatile bool ni_overflow;       /* Recording stopped, ring is full */
+  volatile bool ni_reset;          /* Reader requests the ring be emptied */
   uint8_t ni_buffer[CONFIG_DRIVER_NOTERAM_BUFSIZE];
 };
 
@@ -92,22 +133,30 @@ static const struct file_operations g_noteram_fops =
 #endif
 };
 
-static struct noteram_info_s g_noteram_info =
-{
+static struct noteram_info_s g_noteram_info[NOTERAM_NRINGS];
+
 #ifdef CONFIG_DRIVER_NOTERAM_DEFAULT_NOOVERWRITE
-  .ni_overwrite = NOTERAM_MODE_OVERWRITE_DISABLE
+static volatile unsigned int g_noteram_mode = NOTERAM_MODE_OVERWRITE_DISABLE;
 #else
-  .ni_overwrite = NOTERAM_MODE_OVERWRITE_ENABLE
+static volatile unsigned int g_noteram_mode = NOTERAM_MODE_OVERWRITE_ENABLE;
 #endif
-};
 
 #if CONFIG_DRIVER_NOTERAM_TASKNAME_BUFSIZE > 0
 static struct noteram_taskname_s g_noteram_taskname;
 #endif
 
+/* Serializes the readers.  Only the reader holding it may modify ni_read. */
+
+static sem_t g_noteram_readsem = SEM_INITIALIZER(1);
+
 #ifdef CONFIG_SMP
+#ifndef CONFIG_DRIVER_NOTERAM_PERCPU
 static volatile spinlock_t g_noteram_lock;
 #endif
+#if CONFIG_DRIVER_NOTERAM_TASKNAME_BUFSIZE > 0
+static volatile spinlock_t g_noteram_taskname_lock;
+#endif
+#endif
 
 /****************************************************************************
  * Private Functions
@@ -232,6 +281,35 @@ static void noteram_remove_taskname(pid_t pid)
 }
 #endif
 
+/****************************************************************************
+ * Name: noteram_taskname_lock / noteram_taskname_unlock
+ *
+ * Description:
+ *   The task name buffer is shared by all rings and is touched both by
+ *   producers (NOTE_START/NOTE_STOP) and by the reader.  These notes are
+ *   rare, so a dedicated lock here does not perturb the hot path.
+ *
+ ****************************************************************************/
+
+#if CONFIG_DRIVER_NOTERAM_TASKNAME_BUFSIZE > 0
+static irqstate_t noteram_taskname_lock(void)
+{
+  irqstate_t flags = up_irq_save();
+#ifdef CONFIG_SMP
+  spin_lock_wo_note(&g_noteram_taskname_lock);
+#endif
+  return flags;
+}
+
+static void noteram_taskname_unlock(irqstate_t flags)
+{
+#ifdef CONFIG_SMP
+  spin_unlock_wo_note(&g_noteram_taskname_lock);
+#endif
+  up_irq_restore(flags);
+}
+#endif
+
 /****************************************************************************
  * Name: noteram_get_taskname
  *
@@ -255,7 +333,7 @@ static const char *noteram_get_taskname(pid_t pid)
   FAR struct noteram_taskname_info_s *ti;
   FAR struct tcb_s *tcb;
 
-  irq_mask = enter_critical_section();
+  irq_mask = noteram_taskname_lock();
 
   ti = noteram_find_taskname(pid);
   if (ti != NULL)
@@ -272,7 +350,7 @@ static const char *noteram_get_taskname(pid_t pid)
         }
     }
 
-  leave_critical_section(irq_mask);
+  noteram_taskname_unlock(irq_mask);
   return ret;
 }
 #endif
@@ -281,7 +359,15 @@ static const char *noteram_get_taskname(pid_t pid)
  * Name: noteram_buffer_clear
  *
  * Description:
- *   Clear all contents of the circular buffer.
+ *   Clear all contents of the circular buffers.
+ *
+ *   The reader may not modify the producer indices, so each ring is only
+ *   marked for reset here; the owning producer empties it when it adds its
+ *   next note.  The read indices are advanced immediately so that the
+ *   old notes are no longer returned.
+ *
+ * Assumptions:
+ *   The caller holds g_noteram_readsem.
  *
  * Input Parameters:
  *   None.
@@ -293,299 +379,394 @@ static const char *noteram_get_taskname(pid_t pid)
 
 static void noteram_buffer_clear(void)
 {
+  FAR struct noteram_info_s *ni;
+#if CONFIG_DRIVER_NOTERAM_TASKNAME_BUFSIZE > 0
   irqstate_t flags;
+#endif
+  int i;
 
-  flags = enter_critical_section();
-
-  g_noteram_info.ni_tail = g_noteram_info.ni_head;
-  g_noteram_info.ni_read = g_noteram_info.ni_head;
-
-  if (g_noteram_info.ni_overwrite == NOTERAM_MODE_OVERWRITE_OVERFLOW)
+  for (i = 0; i < NOTERAM_NRINGS; i++)
     {
-      g_noteram_info.ni_overwrite = NOTERAM_MODE_OVERWRITE_DISABLE;
+      ni           = &g_noteram_info[i];
+      ni->ni_read  = ni->ni_head;
+      ni->ni_reset = true;
     }
 
 #if CONFIG_DRIVER_NOTERAM_TASKNAME_BUFSIZE > 0
+  flags = noteram_taskname_lock();
   g_noteram_taskname.buffer_used = 0;
+  noteram_taskname_unlock(flags);
 #endif
-
-  leave_critical_section(flags);
 }
 
 /****************************************************************************
- * Name: noteram_next
+ * Name: noteram_copy
  *
  * Description:
- *   Return the circular buffer index at offset from the specified index
- *   value, handling wraparound
+ *   Copy data out of the circular buffer, handling wraparound.
  *
  * Input Parameters:
- *   ndx - Old circular buffer index
+ *   ni     - The ring to copy from
+ *   ndx    - Free-running index of the first byte to copy
+ *   buffer - Location to return the data
+ *   len    - Number of bytes to copy
  *
  * Returned Value:
- *   New circular buffer index
+ *   None
  *
  ****************************************************************************/
 
-static inline unsigned int noteram_next(unsigned int ndx,
-                                        unsigned int offset)
+static void noteram_copy(FAR struct noteram_info_s *ni, unsigned int ndx,
+                         FAR uint8_t *buffer, size_t len)
 {
-  ndx += offset;
-  if (ndx >= CONFIG_DRIVER_NOTERAM_BUFSIZE)
+  unsigned int offset = NOTERAM_OFFSET(ndx);
+  size_t chunk = CONFIG_DRIVER_NOTERAM_BUFSIZE - offset;
+
+  if (chunk > len)
     {
-      ndx -= CONFIG_DRIVER_NOTERAM_BUFSIZE;
+      chunk = len;
     }
 
-  return ndx;
+  memcpy(buffer, &ni->ni_buffer[offset], chunk);
+  if (chunk < len)
+    {
+      memcpy(buffer + chunk, ni->ni_buffer, len - chunk);
+    }
 }
 
 /****************************************************************************
- * Name: noteram_length
+ * Name: noteram_remove
  *
  * Description:
- *   Length of data currently in circular buffer.
+ *   Remove the variable length note from the tail of the circular buffer
  *
  * Input Parameters:
- *   None
+ *   ni - The ring to remove the note from
  *
  * Returned Value:
- *   Length of data currently in circular buffer.
+ *   None
+ *
+ * Assumptions:
+ *   Called only by the producer that owns the ring.
  *
  ****************************************************************************/
 
-static unsigned int noteram_length(void)
+static void noteram_remove(FAR struct noteram_info_s *ni)
 {
-  unsigned int head = g_noteram_info.ni_head;
-  unsigned int tail = g_noteram_info.ni_tail;
+  struct note_common_s note;
+  unsigned int tail;
+
+  /* Get the header of the note at the tail index */
 
-  if (tail > head)
+  tail = ni->ni_tail;
+  noteram_copy(ni, tail, (FAR uint8_t *)&note, sizeof(note));
+  DEBUGASSERT(note.nc_length > 0 && note.nc_length <= ni->ni_head - tail);
+
+#if CONFIG_DRIVER_NOTERAM_TASKNAME_BUFSIZE > 0
+  if (note.nc_type == NOTE_STOP)
     {
-      head += CONFIG_DRIVER_NOTERAM_BUFSIZE;
+      irqstate_t flags;
+
+      /* The name of the task is no longer needed because the task is deleted
+       * and the corresponding notes are lost.
+       */
+
+      flags = noteram_taskname_lock();
+      noteram_remove_taskname(note.nc_pid[0] + (note.nc_pid[1] << 8));
+      noteram_taskname_unlock(flags);
     }
+#endif
 
-  return head - tail;
+  /* Increment the tail index to remove the entire note from the circular
+   * buffer.  The reader notices that its read index fell behind the tail
+   * and skips forward.
+   */
+
+  ni->ni_tail = tail + note.nc_length;
 }
 
 /****************************************************************************
- * Name: noteram_unread_length
+ * Name: noteram_valid
  *
  * Description:
- *   Length of unread data currently in circular buffer.
+ *   Check the length byte found at the read index against the number of
+ *   bytes that the producer has published after it.
  *
  * Input Parameters:
- *   None
+ *   notelen - The length byte at the read index
+ *   used    - The number of bytes between the read index and the head
  *
  * Returned Value:
- *   Length of unread data currently in circular buffer.
+ *   true if the length byte can start a note; false if it cannot.
  *
  ****************************************************************************/
 
-static unsigned int noteram_unread_length(void)
+static bool noteram_valid(size_t notelen, unsigned int used)
 {
-  unsigned int head = g_noteram_info.ni_head;
-  unsigned int read = g_noteram_info.ni_read;
-
-  if (read > head)
-    {
-      head += CONFIG_DRIVER_NOTERAM_BUFSIZE;
-    }
-
-  return head - read;
+  return notelen >= sizeof(struct note_common_s) && notelen <= used;
 }
 
 /****************************************************************************
- * Name: noteram_remove
+ * Name: noteram_resync
  *
  * Description:
- *   Remove the variable length note from the tail of the circular buffer
+ *   Recover from a read index that does not point to the start of a note,
+ *   e.g. after the ring was reset while a note was being read.  The
+ *   remaining unread notes cannot be delimited, so they are dropped and
+ *   reading resumes with the next note that the producer adds.
  *
  * Input Parameters:
- *   None
+ *   ni   - The ring to resynchronize
+ *   head - The head index sampled before the bad length byte was read
  *
  * Returned Value:
  *   None
  *
- * Assumptions:
- *   We are within a critical section.
+ ****************************************************************************/
+
+static void noteram_resync(FAR struct noteram_info_s *ni, unsigned int head)
+{
+  ni->ni_read = head;
+}
+
+/****************************************************************************
+ * Name: noteram_peek
+ *
+ * Description:
+ *   Return the common header of the next unread note of a ring without
+ *   consuming it.
+ *
+ * Input Parameters:
+ *   ni   - The ring to examine
+ *   note - Location to return the common note header
+ *
+ * Returned Value:
+ *   true if an unread note is available; false if the ring is empty.
  *
  ****************************************************************************/
 
-static void noteram_remove(void)
+static bool noteram_peek(FAR struct noteram_info_s *ni,
+                         FAR struct note_common_s *note)
 {
-  FAR struct note_common_s *note;
-  unsigned int tail;
-  unsigned int length;
+  unsigned int head;
+  unsigned int read;
 
-  /* Get the tail index of the circular buffer */
+  for (; ; )
+    {
+      read = ni->ni_read;
+      if ((int)(read - ni->ni_tail) < 0)
+        {
+          read = ni->ni_tail;
+        }
 
-  tail = g_noteram_info.ni_tail;
-  DEBUGASSERT(tail < CONFIG_DRIVER_NOTERAM_BUFSIZE);
+      head = ni->ni_head;
+      if (read == head)
+        {
+          return false;
+        }
 
-  /* Get the length of the note at the tail index */
+      noteram_barrier();
+      noteram_copy(ni, read, (FAR uint8_t *)note, sizeof(*note));
+      noteram_barrier();
 
-  note   = (FAR struct note_common_s *)&g_noteram_info.ni_buffer[tail];
-  length = note->nc_length;
-  DEBUGASSERT(length <= noteram_length());
+      /* Retry if the producer overwrote the note while it was copied */
 
-#if CONFIG_DRIVER_NOTERAM_TASKNAME_BUFSIZE > 0
-  if (note->nc_type == NOTE_STOP)
-    {
-      /* The name of the task is no longer needed because the task is deleted
-       * and the corresponding notes are lost.
-       */
+      if ((int)(read - ni->ni_tail) < 0)
+        {
+          continue;
+        }
+
+      if (noteram_valid(note->nc_length, head - read))
+        {
+          return true;
+        }
+
+      /* The read index does not point to the start of a note */
 
-      noteram_remove_taskname(note->nc_pid[0] + (note->nc_pid[1] << 8));
+      noteram_resync(ni, head);
     }
-#endif
+}
 
-  /* Increment the tail index to remove the entire note from the circular
-   * buffer.
-   */
+/****************************************************************************
+ * Name: noteram_before
+ *
+ * Description:
+ *   Return true if note a was taken before note b.  Used to merge the
+ *   per-CPU rings into a single, time ordered stream.
+ *
+ ****************************************************************************/
 
-  if (g_noteram_info.ni_read == g_noteram_info.ni_tail)
+#ifdef CONFIG_DRIVER_NOTERAM_PERCPU
+static bool noteram_before(FAR const struct note_common_s *a,
+                           FAR const struct note_common_s *b)
+{
+#ifdef CONFIG_SCHED_INSTRUMENTATION_HIRES
+  int32_t sec_a = a->nc_systime_sec[0] | a->nc_systime_sec[1] << 8 |
+                  a->nc_systime_sec[2] << 16 |
+                  (uint32_t)a->nc_systime_sec[3] << 24;
+  int32_t sec_b = b->nc_systime_sec[0] | b->nc_systime_sec[1] << 8 |
+                  b->nc_systime_sec[2] << 16 |
+                  (uint32_t)b->nc_systime_sec[3] << 24;
+
+  if (sec_a != sec_b)
     {
-      /* The read index also needs increment. */
-
-      g_noteram_info.ni_read = noteram_next(tail, length);
+      return sec_a - sec_b < 0;
     }
 
-  g_noteram_info.ni_tail = noteram_next(tail, length);
+  return (a->nc_systime_nsec[0] | a->nc_systime_nsec[1] << 8 |
+          a->nc_systime_nsec[2] << 16 |
+          (uint32_t)a->nc_systime_nsec[3] << 24) <
+         (b->nc_systime_nsec[0] | b->nc_systime_nsec[1] << 8 |
+          b->nc_systime_nsec[2] << 16 |
+          (uint32_t)b->nc_systime_nsec[3] << 24);
+#else
+  uint32_t time_a = a->nc_systime[0] | a->nc_systime[1] << 8 |
+                    a->nc_systime[2] << 16 |
+                    (uint32_t)a->nc_systime[3] << 24;
+  uint32_t time_b = b->nc_systime[0] | b->nc_systime[1] << 8 |
+                    b->nc_systime[2] << 16 |
+                    (uint32_t)b->nc_systime[3] << 24;
+
+  return (int32_t)(time_a - time_b) < 0;
+#endif
 }
+#endif
 
 /****************************************************************************
- * Name: noteram_get
+ * Name: noteram_next_ring
  *
  * Description:
- *   Get the next note from the read index of the circular buffer.
+ *   Select the ring holding the oldest unread note.
  *
  * Input Parameters:
- *   buffer - Location to return the next note
- *   buflen - The length of the user provided buffer.
+ *   notelen - Location to return the length of that note
  *
  * Returned Value:
- *   On success, the positive, non-zero length of the return note is
- *   provided.  Zero is returned only if the circular buffer is empty.  A
- *   negated errno value is returned in the event of any failure.
+ *   The selected ring or NULL if all rings are empty.
  *
  ****************************************************************************/
 
-static ssize_t noteram_get(FAR uint8_t *buffer, size_t buflen)
+static FAR struct noteram_info_s *noteram_next_ring(FAR size_t *notelen)
 {
-  FAR struct note_common_s *note;
-  irqstate_t flags;
-  unsigned int remaining;
-  unsigned int read;
-  ssize_t notelen;
-  size_t circlen;
-
-  DEBUGASSERT(buffer != NULL);
-  flags = enter_critical_section();
+  FAR struct noteram_info_s *oldest = NULL;
+  struct note_common_s best;
+  struct note_common_s note;
+  int i;
 
-  /* Verify that the circular buffer is not empty */
-
-  circlen = noteram_unread_length();
-  if (circlen <= 0)
-    {
-      notelen = 0;
-      goto errout_with_csection;
-    }
-
-  /* Get the read index of the circular buffer */
-
-  read    = g_noteram_info.ni_read;
-  DEBUGASSERT(read < CONFIG_DRIVER_NOTERAM_BUFSIZE);
-
-  /* Get the length of the note at the read index */
-
-  note    = (FAR struct note_common_s *)&g_noteram_info.ni_buffer[read];
-  notelen = note->nc_length;
-  DEBUGASSERT(notelen <= circlen);
-
-  /* Is the user buffer large enough to hold the note? */
-
-  if (buflen < notelen)
+  for (i = 0; i < NOTERAM_NRINGS; i++)
     {
-      /* Skip the large note so that we do not get constipated. */
-
-      g_noteram_info.ni_read = noteram_next(read, notelen);
+      if (!noteram_peek(&g_noteram_info[i], &note))
+        {
+          continue;
+        }
 
-      /* and return an error */
+#ifdef CONFIG_DRIVER_NOTERAM_PERCPU
+      if (oldest != NULL && !noteram_before(&note, &best))
+        {
+          continue;
+        }
+#endif
 
-      notelen = -EFBIG;
-      goto errout_with_csection;
+      oldest = &g_noteram_info[i];
+      best   = note;
     }
 
-  /* Loop until the note has been transferred to the user buffer */
-
-  remaining = (unsigned int)notelen;
-  while (remaining > 0)
+  if (oldest != NULL)
     {
-      /* Copy the next byte at the read index */
-
-      *buffer++ = g_noteram_info.ni_buffer[read];
-
-      /* Adjust indices and counts */
-
-      read = noteram_next(read, 1);
-      remaining--;
+      *notelen = best.nc_length;
     }
 
-  g_noteram_info.ni_read = read;
-
-errout_with_csection:
-  leave_critical_section(flags);
-  return notelen;
+  return oldest;
 }
 
 /****************************************************************************
- * Name: noteram_size
+ * Name: noteram_get
  *
  * Description:
- *   Return the size of the next note at the read index of the circular
- *   buffer.
+ *   Get the next note from the read index of the circular buffer.
  *
  * Input Parameters:
- *   None.
+ *   ni     - The ring to read from
+ *   buffer - Location to return the next note
+ *   buflen - The length of the user provided buffer.
  *
  * Returned Value:
- *   Zero is returned if the circular buffer is empty.  Otherwise, the size
- *   of the next note is returned.
+ *   On success, the positive, non-zero length of the return note is
+ *   provided.  Zero is returned only if the circular buffer is empty.  A
+ *   negated errno value is returned in the event of any failure.
  *
  ****************************************************************************/
 
-static ssize_t noteram_size(void)
+static ssize_t noteram_get(FAR struct noteram_info_s *ni,
+                           FAR uint8_t *buffer, size_t buflen)
 {
-  FAR struct note_common_s *note;
-  irqstate_t flags;
+  unsigned int head;
   unsigned int read;
   ssize_t notelen;
-  size_t circlen;
 
-  flags = enter_critical_section();
-
-  /* Verify that the circular buffer is not empty */
+  DEBUGASSERT(buffer != NULL);
 
-  circlen = noteram_unread_length();
-  if (circlen <= 0)
+  for (; ; )
     {
-      notelen = 0;
-      goto errout_with_csection;
-    }
+      /* Skip any notes that the producer has already overwritten */
 
-  /* Get the read index of the circular buffer */
+      read = ni->ni_read;
+      if ((int)(read - ni->ni_tail) < 0)
+        {
+          read = ni->ni_tail;
+        }
 
-  read = g_noteram_info.ni_read;
-  DEBUGASSERT(read < CONFIG_DRIVER_NOTERAM_BUFSIZE);
+      /* Verify that the circular buffer is not empty */
 
-  /* Get the length of the note at the read index */
+      head = ni->ni_head;
+      if (read == head)
+        {
+          ni->ni_read = read;
+          return 0;
+        }
+
+      noteram_barrier();
+
+      /* Get the length of the note at the read index.  Do not trust it
+       * before it has been checked against the published data:  a bogus
+       * length would make us skip or copy out unrelated bytes.
+       */
+
+      notelen = ni->ni_buffer[NOTERAM_OFFSET(read)];
+      if (!noteram_valid(notelen, head - read))
+        {
+          noteram_barrier();
+          if ((int)(read - ni->ni_tail) >= 0)
+            {
+              noteram_resync(ni, head);
+            }
+
+          continue;
+        }
+
+      /* Is the user buffer large enough to hold the note? */
 
-  note    = (FAR struct note_common_s *)&g_noteram_info.ni_buffer[read];
-  notelen = note->nc_length;
-  DEBUGASSERT(notelen <= circlen);
+      if (buflen < notelen)
+        {
+          /* Skip the large note so that we do not get constipated. */
+
+          ni->ni_read = read + notelen;
+          return -EFBIG;
+        }
 
-errout_with_csection:
-  leave_critical_section(flags);
-  return notelen;
+      noteram_copy(ni, read, buffer, notelen);
+      noteram_barrier();
+
+      /* If the producer overwrote the note while it was being copied, then
+       * the copy is torn.  Discard it and start over at the new tail.
+       */
+
+      if ((int)(read - ni->ni_tail) >= 0)
+        {
+          ni->ni_read = read + notelen;
+          return notelen;
+        }
+    }
 }
 
 /****************************************************************************
@@ -594,34 +775,64 @@ errout_with_csection:
 
 static int noteram_open(FAR struct file *filep)
 {
-  /* Reset the read index of the circular buffer */
+  int i;
+
+  /* Reset the read index of the circular buffers */
 
-  g_noteram_info.ni_read = g_noteram_info.ni_tail;
+  nxsem_wait_uninterruptible(&g_noteram_readsem);
+  for (i = 0; i < NOTERAM_NRINGS; i++)
+    {
+      g_noteram_info[i].ni_read = g_noteram_info[i].ni_tail;
+    }
 
+  nxsem_post(&g_noteram_readsem);
   return OK;
 }
 
 /****************************************************************************
  * Name: noteram_read
+ *
+ * Description:
+ *   Return as many whole notes as fit into the user buffer.  The notes are
+ *   packed back to back, each one starting with its nc_length byte, which
+ *   is the binary format consumed by tools/notejson.c.  With per-CPU rings
+ *   the notes of all CPUs are merged in time order.
+ *
  ****************************************************************************/
 
 static ssize_t noteram_read(FAR struct file *filep,
                             FAR char *buffer, size_t buflen)
 {
+  FAR struct noteram_info_s *ni;
   ssize_t notelen;
   ssize_t retlen ;
+  size_t nextlen;
 
   DEBUGASSERT(filep != 0 && buffer != NULL && buflen > 0);
 
   /* Then loop, adding as many notes as possible to the user buffer. */
 
-  retlen = 0;
+  retlen = nxsem_wait(&g_noteram_readsem);
+  if (retlen < 0)
+    {
+      return retlen;
+    }
+
   sched_lock();
-  do
+  while ((ni = noteram_next_ring(&nextlen)) != NULL)
     {
+      /* Will the next note fit?  If not, return what we have without
+       * trying to get the next note (which would cause it to be skipped).
+       */
+
+      if (retlen > 0 && nextlen > buflen)
+        {
+          break;
+        }
+
       /* Get the next note (removing it from the buffer) */
 
-      notelen = noteram_get((FAR uint8_t *)buffer, buflen);
+      notelen = noteram_get(ni, (FAR uint8_t *)buffer, buflen);
       if (notelen < 0)
         {
           /* We were unable to read the next note, probably because it will
@@ -645,19 +856,10 @@ static ssize_t noteram_read(FAR struct file *filep,
       retlen += notelen;
       buffer += notelen;
       buflen -= notelen;
-
-      /* Will the next note fit?  There is a race here and even if the next
-       * note will fit, it may fail still when noteram_get() is called.
-       *
-       * It won't fit (or an error occurred).  Return what we have without
-       * trying to get the next note (which would cause it to be deleted).
-       */
-
-      notelen = noteram_size();
     }
-  while (notelen > 0 && notelen <= buflen);
 
   sched_unlock();
+  nxsem_post(&g_noteram_readsem);
   return retlen;
 }
 
@@ -668,6 +870,7 @@ static ssize_t noteram_read(FAR struct file *filep,
 static int noteram_ioctl(struct file *filep, int cmd, unsigned long arg)
 {
   int ret = -ENOSYS;
+  int i;
 
   /* Handle the ioctl commands */
 
@@ -679,7 +882,9 @@ static int noteram_ioctl(struct file *filep, int cmd, unsigned long arg)
        */
 
       case NOTERAM_CLEAR:
+        nxsem_wait_uninterruptible(&g_noteram_readsem);
         noteram_buffer_clear();
+        nxsem_post(&g_noteram_readsem);
         ret = OK;
         break;
 
@@ -695,7 +900,15 @@ static int noteram_ioctl(struct file *filep, int cmd, unsigned long arg)
           }
         else
           {
-            *(unsigned int *)arg = g_noteram_info.ni_overwrite;
+            *(unsigned int *)arg = g_noteram_mode;
+            for (i = 0; i < NOTERAM_NRINGS; i++)
+              {
+                if (g_noteram_info[i].ni_overflow)
+                  {
+                    *(unsigned int *)arg = NOTERAM_MODE_OVERWRITE_OVERFLOW;
+                  }
+              }
+
             ret = OK;
           }
         break;
@@ -712,7 +925,19 @@ static int noteram_ioctl(struct file *filep, int cmd, unsigned long arg)
           }
         else
           {
-            g_noteram_info.ni_overwrite = *(unsigned int *)arg;
+            unsigned int mode = *(unsigned int *)arg;
+
+            for (i = 0; i < NOTERAM_NRINGS; i++)
+              {
+                g_noteram_info[i].ni_overflow =
+                  (mode == NOTERAM_MODE_OVERWRITE_OVERFLOW);
+              }
+
+            if (mode != NOTERAM_MODE_OVERWRITE_OVERFLOW)
+              {
+                g_noteram_mode = mode;
+              }
+
             ret = OK;
           }
         break;
@@ -753,6 +978,70 @@ static int noteram_ioctl(struct file *filep, int cmd, unsigned long arg)
         break;
 #endif
 
+      /* NOTERAM_GETNRINGS
+       *      - Get the number of note rings
+       *        Argument: A writable pointer to unsigned int
+       */
+
+      case NOTERAM_GETNRINGS:
+        if (arg == 0)
+          {
+            ret = -EINVAL;
+          }
+        else
+          {
+            *(FAR unsigned int *)arg = NOTERAM_NRINGS;
+            ret = OK;
+          }
+        break;
+
+      /* NOTERAM_GETRING
+       *      - Snapshot the indices of one ring
+       *        Argument: A writable pointer to struct noteram_ring_s
+       */
+
+      case NOTERAM_GETRING:
+        {
+          FAR struct noteram_ring_s *ring =
+            (FAR struct noteram_ring_s *)((uintptr_t)arg);
+
+          if (ring == NULL || ring->nr_index >= NOTERAM_NRINGS)
+            {
+              ret = -EINVAL;
+              break;
+            }
+
+          ring->nr_bufsize = CONFIG_DRIVER_NOTERAM_BUFSIZE;
+          ring->nr_buffer  = g_noteram_info[ring->nr_index].ni_buffer;
+          ring->nr_tail    = g_noteram_info[ring->nr_index].ni_tail;
+          ring->nr_head    = g_noteram_info[ring->nr_index].ni_head;
+          ret = OK;
+        }
+        break;
+
+#ifdef CONFIG_BUILD_FLAT
+      /* FIOC_MMAP
+       *      - Map the buffer of the first ring.  Use NOTERAM_GETRING to
+       *        locate the buffers of the other rings.
+       *        Argument: Location to return the address (void **)
+       */
+
+      case FIOC_MMAP:
+        {
+          FAR void **addr = (FAR void **)((uintptr_t)arg);
+
+          if (addr == NULL)
+            {
+              ret = -EINVAL;
+              break;
+            }
+
+          *addr = g_noteram_info[0].ni_buffer;
+          ret = OK;
+        }
+        break;
+#endif
+
       default:
           break;
     }
@@ -784,23 +1073,36 @@ static int noteram_ioctl(struct file *filep, int cmd, unsigned long arg)
 
 void sched_note_add(FAR const void *note, size_t notelen)
 {
-  FAR const char *buf = note;
+  FAR struct noteram_info_s *ni;
   unsigned int head;
-  unsigned int next;
+  unsigned int offset;
+  size_t chunk;
   irqstate_t flags;
 
+  DEBUGASSERT(note != NULL && notelen < CONFIG_DRIVER_NOTERAM_BUFSIZE);
+
   flags = up_irq_save();
-#ifdef CONFIG_SMP
+#ifdef CONFIG_DRIVER_NOTERAM_PERCPU
+  ni = &g_noteram_info[up_cpu_index()];
+#else
+  ni = &g_noteram_info[0];
+#  ifdef CONFIG_SMP
   spin_lock_wo_note(&g_noteram_lock);
+#  endif
 #endif
 
-  if (g_noteram_info.ni_overwrite == NOTERAM_MODE_OVERWRITE_OVERFLOW)
+  /* Honor a pending clear request from the reader */
+
+  if (ni->ni_reset)
     {
-#ifdef CONFIG_SMP
-      spin_unlock_wo_note(&g_noteram_lock);
-#endif
-      up_irq_restore(flags);
-      return;
+      ni->ni_tail     = ni->ni_head;
+      ni->ni_overflow = false;
+      ni->ni_reset    = false;
+    }
+
+  if (ni->ni_overflow)
+    {
+      goto out;
     }
 
 #if CONFIG_DRIVER_NOTERAM_TASKNAME_BUFSIZE > 0
@@ -812,58 +1114,60 @@ void sched_note_add(FAR const void *note, size_t notelen)
       note_st = (FAR struct note_start_s *)note;
       if (note_st->nst_cmn.nc_type == NOTE_START)
         {
+          irqstate_t tflags = noteram_taskname_lock();
           noteram_record_taskname(note_st->nst_cmn.nc_pid[0] +
                                   (note_st->nst_cmn.nc_pid[1] << 8),
                                   note_st->nst_name);
+          noteram_taskname_unlock(tflags);
         }
     }
 #endif
 
-  /* Get the index to the head of the circular buffer */
+  /* Make room for the whole note at the head of the circular buffer */
 
-  DEBUGASSERT(note != NULL && notelen < CONFIG_DRIVER_NOTERAM_BUFSIZE);
-  head = g_noteram_info.ni_head;
-
-  /* Loop until all bytes have been transferred to the circular buffer */
-
-  while (notelen > 0)
+  head = ni->ni_head;
+  while (head - ni->ni_tail + notelen > CONFIG_DRIVER_NOTERAM_BUFSIZE)
     {
-      /* Get the next head index.  Would it collide with the current tail
-       * index?
-       */
-
-      next = noteram_next(head, 1);
-      if (next == g_noteram_info.ni_tail)
+      if (g_noteram_mode == NOTERAM_MODE_OVERWRITE_DISABLE)
         {
-          if (g_noteram_info.ni_overwrite == NOTERAM_MODE_OVERWRITE_DISABLE)
-            {
-              /* Stop recording if not in overwrite mode */
+          /* Stop recording if not in overwrite mode */
 
-              g_noteram_info.ni_overwrite = NOTERAM_MODE_OVERWRITE_OVERFLOW;
+          ni->ni_overflow = true;
+          goto out;
+        }
 
-#ifdef CONFIG_SMP
-              spin_unlock_wo_note(&g_noteram_lock);
-#endif
-              up_irq_restore(flags);
-              return;
-            }
+      /* Remove the note at the tail index */
 
-          /* Yes, then remove the note at the tail index */
+      noteram_remove(ni);
+    }
 
-          noteram_remove();
-        }
+  /* The new tail must be visible before the old notes are overwritten */
 
-      /* Save the next byte at the head index */
+  noteram_barrier();
 
-      g_noteram_info.ni_buffer[head] = *buf++;
+  /* Copy the note into the circular buffer, handling wraparound */
+
+  offset = NOTERAM_OFFSET(head);
+  chunk  = CONFIG_DRIVER_NOTERAM_BUFSIZE - offset;
+  if (chunk > notelen)
+    {
+      chunk = notelen;
+    }
 
-      head = next;
-      notelen--;
+  memcpy(&ni->ni_buffer[offset], note, chunk);
+  if (chunk < notelen)
+    {
+      memcpy(ni->ni_buffer, (FAR const uint8_t *)note + chunk,
+             notelen - chunk);
     }
 
-  g_noteram_info.ni_head = head;
+  /* And publish the note to the reader */
 
-#ifdef CONFIG_SMP
+  noteram_barrier();
+  ni->ni_head = head + notelen;
+
+out:
+#if !defined(CONFIG_DRIVER_NOTERAM_PERCPU) && defined(CONFIG_SMP)
   spin_unlock_wo_note(&g_noteram_lock);
 #endif
   up_irq_restore(flags);
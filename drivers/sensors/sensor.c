@@ -35,6 +35,7 @@
 #include <poll.h>
 #include <fcntl.h>
 #include <nuttx/kmalloc.h>
+#include <nuttx/list.h>
 #include <nuttx/mm/circbuf.h>
 #include <nuttx/sensors/sensor.h>
 
@@ -61,29 +62,43 @@ struct sensor_info
   FAR char *name;
 };
 
-/* This structure describes the state of the upper half driver */
+/* This structure describes a user of the sensor, one per opened file.
+ * Every user reads the events of the shared circular buffer from its own
+ * position, so that each one sees all of the events.
+ */
 
-struct sensor_upperhalf_s
+struct sensor_user_s
 {
   /* poll structures of threads waiting for driver events. */
 
-  FAR struct pollfd             *fds[CONFIG_SENSORS_NPOLLWAITERS];
+  FAR struct pollfd *fds[CONFIG_SENSORS_NPOLLWAITERS];
+  struct list_node   node;               /* Node of the upper half user list */
+  size_t             cursor;             /* Buffer position of the next read */
+  unsigned int       watermark;          /* Events pending before wakeup */
+  sem_t              buffersem;          /* Wakeup user waiting for data in circular buffer */
+};
+
+/* This structure describes the state of the upper half driver */
+
+struct sensor_upperhalf_s
+{
   FAR struct sensor_lowerhalf_s *lower;  /* the handle of lower half driver */
+  struct list_node   users;              /* The users of the sensor device */
   struct circbuf_s   buffer;             /* The circular buffer of sensor device */
   uint8_t            esize;              /* The element size of circular buffer */
   uint8_t            crefs;              /* Number of times the device has been opened */
   sem_t              exclsem;            /* Manages exclusive access to file operations */
-  sem_t              buffersem;          /* Wakeup user waiting for data in circular buffer */
   bool               enabled;            /* The status of sensor enable or disable */
   unsigned int       interval;           /* The sample interval for sensor, in us */
   unsigned int       latency;            /* The batch latency for sensor, in us */
+  unsigned int       batchnum;           /* Events batched by the upper half */
 };
 
 /****************************************************************************
  * Private Function Prototypes
  ****************************************************************************/
 
-static void    sensor_pollnotify(FAR struct sensor_upperhalf_s *upper,
+static void    sensor_pollnotify(FAR struct sensor_user_s *user,
                                  pollevent_t eventset);
 static int     sensor_open(FAR struct file *filep);
 static int     sensor_close(FAR struct file *filep);
@@ -142,7 +157,7 @@ static const struct file_operations g_sensor_fops =
  * Private Functions
  ****************************************************************************/
 
-static void sensor_pollnotify(FAR struct sensor_upperhalf_s *upper,
+static void sensor_pollnotify(FAR struct sensor_user_s *user,
                               pollevent_t eventset)
 {
   FAR struct pollfd *fd;
@@ -151,7 +166,7 @@ static void sensor_pollnotify(FAR struct sensor_upperhalf_s *upper,
 
   for (i = 0; i < CONFIG_SENSORS_NPOLLWAITERS; i++)
     {
-      fd = upper->fds[i];
+      fd = user->fds[i];
       if (fd)
         {
           fd->revents |= (fd->events & eventset);
@@ -170,18 +185,125 @@ static void sensor_pollnotify(FAR struct sensor_upperhalf_s *upper,
     }
 }
 
+/* Return the number of bytes the user has not read yet, skipping any
+ * events that were overwritten before the user could read them.
+ */
+
+static size_t sensor_pending(FAR struct sensor_upperhalf_s *upper,
+                             FAR struct sensor_user_s *user)
+{
+  FAR struct circbuf_s *buffer = &upper->buffer;
+
+  if (user->cursor - buffer->tail > buffer->head - buffer->tail)
+    {
+      user->cursor = buffer->tail;
+    }
+
+  return buffer->head - user->cursor;
+}
+
+/* Return true if enough events are pending to wake up the user.  That is
+ * the larger of the user watermark and the events batched by the upper
+ * half, but never more than the buffer can hold.
+ */
+
+static bool sensor_is_ready(FAR struct sensor_upperhalf_s *upper,
+                            FAR struct sensor_user_s *user)
+{
+  size_t nevents = user->watermark;
+  size_t maxevents;
+
+  if (nevents < upper->batchnum)
+    {
+      nevents = upper->batchnum;
+    }
+
+  maxevents = circbuf_size(&upper->buffer) / upper->esize;
+  if (nevents > maxevents)
+    {
+      nevents = maxevents;
+    }
+
+  if (nevents == 0)
+    {
+      nevents = 1;
+    }
+
+  return sensor_pending(upper, user) >= nevents * upper->esize;
+}
+
+/* Wake up the users that have enough events pending */
+
+static void sensor_wakeup(FAR struct sensor_upperhalf_s *upper)
+{
+  FAR struct sensor_user_s *user;
+  int semcount;
+
+  list_for_every_entry(&upper->users, user, struct sensor_user_s, node)
+    {
+      if (upper->lower->ops->fetch || sensor_is_ready(upper, user))
+        {
+          sensor_pollnotify(user, POLLIN);
+          nxsem_get_value(&user->buffersem, &semcount);
+          if (semcount < 1)
+            {
+              nxsem_post(&user->buffersem);
+            }
+        }
+    }
+}
+
+/* Resize the circular buffer, keeping the read position of every user on
+ * the same event where that event is still held.
+ */
+
+static int sensor_resize(FAR struct sensor_upperhalf_s *upper,
+                         size_t bytes)
+{
+  FAR struct sensor_user_s *user;
+  size_t pending;
+  int ret;
+
+  /* circbuf_resize() keeps the newest events and restarts the positions
+   * at zero, so remember how far behind the head each user is.
+   */
+
+  list_for_every_entry(&upper->users, user, struct sensor_user_s, node)
+    {
+      user->cursor = sensor_pending(upper, user);
+    }
+
+  ret = circbuf_resize(&upper->buffer, bytes);
+
+  list_for_every_entry(&upper->users, user, struct sensor_user_s, node)
+    {
+      pending = user->cursor < upper->buffer.head ?
+                user->cursor : upper->buffer.head;
+      user->cursor = upper->buffer.head - pending;
+    }
+
+  return ret;
+}
+
 static int sensor_open(FAR struct file *filep)
 {
   FAR struct inode *inode = filep->f_inode;
   FAR struct sensor_upperhalf_s *upper = inode->i_private;
   FAR struct sensor_lowerhalf_s *lower = upper->lower;
+  FAR struct sensor_user_s *user;
   uint8_t tmp;
   int ret;
 
+  user = kmm_zalloc(sizeof(struct sensor_user_s));
+  if (!user)
+    {
+      return -ENOMEM;
+    }
+
   ret = nxsem_wait(&upper->exclsem);
   if (ret < 0)
     {
-      return ret;
+      goto err_user;
     }
 
   tmp = upper->crefs + 1;
@@ -204,9 +326,24 @@ static int sensor_open(FAR struct file *filep)
         }
     }
 
+  /* The new user only sees the events pushed after it opened the sensor */
+
+  user->cursor    = upper->buffer.head;
+  user->watermark = 1;
+  nxsem_init(&user->buffersem, 0, 0);
+  nxsem_set_protocol(&user->buffersem, SEM_PRIO_NONE);
+
+  list_add_tail(&upper->users, &user->node);
+  filep->f_priv = user;
+
   upper->crefs = tmp;
+  nxsem_post(&upper->exclsem);
+  return ret;
+
 err:
   nxsem_post(&upper->exclsem);
+err_user:
+  kmm_free(user);
   return ret;
 }
 
@@ -215,6 +352,7 @@ static int sensor_close(FAR struct file *filep)
   FAR struct inode *inode = filep->f_inode;
   FAR struct sensor_upperhalf_s *upper = inode->i_private;
   FAR struct sensor_lowerhalf_s *lower = upper->lower;
+  FAR struct sensor_user_s *user = filep->f_priv;
   int ret;
 
   ret = nxsem_wait(&upper->exclsem);
@@ -223,6 +361,10 @@ static int sensor_close(FAR struct file *filep)
       return ret;
     }
 
+  list_delete(&user->node);
+  nxsem_destroy(&user->buffersem);
+  kmm_free(user);
+
   if (--upper->crefs <= 0 && upper->enabled)
     {
       ret = lower->ops->activate ?
@@ -244,6 +386,9 @@ static ssize_t sensor_read(FAR struct file *filep, FAR char *buffer,
   FAR struct inode *inode = filep->f_inode;
   FAR struct sensor_upperhalf_s *upper = inode->i_private;
   FAR struct sensor_lowerhalf_s *lower = upper->lower;
+  FAR struct sensor_user_s *user = filep->f_priv;
+  FAR struct sensor_user_s *tmp;
+  size_t pending;
   ssize_t ret;
 
   if (!buffer || !len)
@@ -262,7 +407,7 @@ static ssize_t sensor_read(FAR struct file *filep, FAR char *buffer,
       if (!(filep->f_oflags & O_NONBLOCK))
         {
           nxsem_post(&upper->exclsem);
-          ret = nxsem_wait_uninterruptible(&upper->buffersem);
+          ret = nxsem_wait_uninterruptible(&user->buffersem);
           if (ret < 0)
             {
               return ret;
@@ -284,13 +429,14 @@ static ssize_t sensor_read(FAR struct file *filep, FAR char *buffer,
     }
   else
     {
-      /* We must make sure that when the semaphore is equal to 1, there must
-       * be events available in the buffer, so we use a while statement to
-       * synchronize this case that other read operations consume events
-       * that have just entered the buffer.
+      /* A blocking read waits until the watermark of events is pending.
+       * The semaphore may have been posted before this user read the
+       * events that caused it, so check again after every wakeup.
        */
 
-      while (circbuf_is_empty(&upper->buffer))
+      while (sensor_pending(upper, user) == 0 ||
+             (!(filep->f_oflags & O_NONBLOCK) &&
+              !sensor_is_ready(upper, user)))
         {
           if (filep->f_oflags & O_NONBLOCK)
             {
@@ -300,7 +446,7 @@ static ssize_t sensor_read(FAR struct file *filep, FAR char *buffer,
           else
             {
               nxsem_post(&upper->exclsem);
-              ret = nxsem_wait_uninterruptible(&upper->buffersem);
+              ret = nxsem_wait_uninterruptible(&user->buffersem);
               if (ret < 0)
                 {
                   return ret;
@@ -314,19 +460,37 @@ static ssize_t sensor_read(FAR struct file *filep, FAR char *buffer,
             }
         }
 
-      ret = circbuf_read(&upper->buffer, buffer, len);
+      /* Copy out as many pending events as fit in one read */
+
+      ret = circbuf_peekat(&upper->buffer, user->cursor, buffer, len);
+      if (ret > 0)
+        {
+          user->cursor += ret;
+        }
 
       /* Release some buffer space when current mode isn't batch mode
-       * and last mode is batch mode, and the number of bytes available
-       * in buffer is less than the number of bytes origin.
+       * and last mode is batch mode, and no user has more bytes pending
+       * than the origin buffer holds.
        */
 
       uint32_t buffer_size = lower->buffer_number * upper->esize;
       if (upper->latency == 0 &&
-          circbuf_size(&upper->buffer) > buffer_size &&
-          circbuf_used(&upper->buffer) <= buffer_size)
+          circbuf_size(&upper->buffer) > buffer_size)
         {
-          ret = circbuf_resize(&upper->buffer, buffer_size);
+          pending = 0;
+          list_for_every_entry(&upper->users, tmp, struct sensor_user_s,
+                               node)
+            {
+              if (pending < sensor_pending(upper, tmp))
+                {
+                  pending = sensor_pending(upper, tmp);
+                }
+            }
+
+          if (pending <= buffer_size)
+            {
+              sensor_resize(upper, buffer_size);
+            }
         }
     }
 
@@ -340,6 +504,7 @@ static int sensor_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
   FAR struct inode *inode = filep->f_inode;
   FAR struct sensor_upperhalf_s *upper = inode->i_private;
   FAR struct sensor_lowerhalf_s *lower = upper->lower;
+  FAR struct sensor_user_s *user = filep->f_priv;
   FAR unsigned int *val = (unsigned int *)(uintptr_t)arg;
   int ret;
 
@@ -381,6 +546,18 @@ static int sensor_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
           if (ret >= 0)
             {
               upper->interval = *val;
+
+              /* A batch emulated by the upper half covers a latency worth
+               * of events at the new interval.
+               */
+
+              if (upper->batchnum != 0)
+                {
+                  upper->batchnum = ROUNDUP(upper->latency, *val) / *val;
+                  ret = sensor_resize(upper, (upper->batchnum +
+                                              lower->buffer_number) *
+                                             upper->esize);
+                }
             }
         }
         break;
@@ -398,22 +575,45 @@ static int sensor_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
               break;
             }
 
-          ret = lower->ops->batch ?
-                lower->ops->batch(lower, val) : -ENOTSUP;
-          if (ret >= 0)
+          if (lower->ops->batch)
             {
-              upper->latency = *val;
-              if (*val != 0)
+              /* The hardware FIFO batches the events */
+
+              ret = lower->ops->batch(lower, val);
+              if (ret < 0)
                 {
-                  /* Adjust length of buffer in batch mode */
+                  break;
+                }
 
-                  uint32_t buffer_size = (ROUNDUP(*val, upper->interval) /
-                                         upper->interval +
-                                         lower->buffer_number) *
-                                         upper->esize;
+              upper->batchnum = 0;
+            }
+          else if (!lower->ops->fetch)
+            {
+              /* Without a hardware FIFO, batch in the upper half by
+               * holding back wakeups until a latency worth of events is
+               * buffered.
+               */
 
-                  ret = circbuf_resize(&upper->buffer, buffer_size);
-                }
+              upper->batchnum = ROUNDUP(*val, upper->interval) /
+                                upper->interval;
+            }
+          else
+            {
+              ret = -ENOTSUP;
+              break;
+            }
+
+          upper->latency = *val;
+          if (*val != 0)
+            {
+              /* Adjust length of buffer in batch mode */
+
+              uint32_t buffer_size = (ROUNDUP(*val, upper->interval) /
+                                     upper->interval +
+                                     lower->buffer_number) *
+                                     upper->esize;
+
+              ret = sensor_resize(upper, buffer_size);
             }
         }
         break;
@@ -429,11 +629,70 @@ static int sensor_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
           if (arg != 0)
             {
               lower->buffer_number = arg;
-              ret = circbuf_resize(&upper->buffer, arg * upper->esize);
+              ret = sensor_resize(upper, arg * upper->esize);
             }
         }
         break;
 
+      case SNIOC_SET_WATERMARK:
+        {
+          if (arg == 0)
+            {
+              ret = -EINVAL;
+            }
+          else
+            {
+              user->watermark = arg;
+            }
+        }
+        break;
+
+      case SNIOC_GET_RING:
+        {
+          FAR struct sensor_ring_s *ring =
+            (FAR struct sensor_ring_s *)((uintptr_t)arg);
+
+          if (ring == NULL)
+            {
+              ret = -EINVAL;
+              break;
+            }
+
+          ring->base  = upper->buffer.base;
+          ring->size  = upper->buffer.size;
+          ring->head  = upper->buffer.head;
+          ring->esize = upper->esize;
+        }
+        break;
+
+#ifdef CONFIG_BUILD_FLAT
+      /* FIOC_MMAP
+       *      - Map the event ring.  Use SNIOC_GET_RING to locate the
+       *        events in it.  Sensors that are fetched directly from the
+       *        lower half have no ring.
+       *        Argument: Location to return the address (void **)
+       */
+
+      case FIOC_MMAP:
+        {
+          FAR void **addr = (FAR void **)((uintptr_t)arg);
+
+          if (addr == NULL)
+            {
+              ret = -EINVAL;
+            }
+          else if (lower->ops->fetch || upper->buffer.base == NULL)
+            {
+              ret = -ENOTSUP;
+            }
+          else
+            {
+              *addr = upper->buffer.base;
+            }
+        }
+        break;
+#endif
+
       default:
 
         /* Lowerhalf driver process other cmd. */
@@ -460,6 +719,7 @@ static int sensor_poll(FAR struct file *filep,
   FAR struct inode *inode = filep->f_inode;
   FAR struct sensor_upperhalf_s *upper = inode->i_private;
   FAR struct sensor_lowerhalf_s *lower = upper->lower;
+  FAR struct sensor_user_s *user = filep->f_priv;
   pollevent_t eventset = 0;
   int semcount;
   int ret;
@@ -475,10 +735,10 @@ static int sensor_poll(FAR struct file *filep,
     {
       for (i = 0; i < CONFIG_SENSORS_NPOLLWAITERS; i++)
         {
-          if (NULL == upper->fds[i])
+          if (NULL == user->fds[i])
             {
-              upper->fds[i] = fds;
-              fds->priv = &upper->fds[i];
+              user->fds[i] = fds;
+              fds->priv = &user->fds[i];
               break;
             }
         }
@@ -501,30 +761,30 @@ static int sensor_poll(FAR struct file *filep,
             }
           else
             {
-              nxsem_get_value(&upper->buffersem, &semcount);
+              nxsem_get_value(&user->buffersem, &semcount);
               if (semcount > 0)
                 {
                   eventset |= (fds->events & POLLIN);
                 }
             }
         }
-      else if (!circbuf_is_empty(&upper->buffer))
+      else if (sensor_is_ready(upper, user))
         {
           eventset |= (fds->events & POLLIN);
         }
 
       if (eventset)
         {
-          sensor_pollnotify(upper, eventset);
+          sensor_pollnotify(user, eventset);
         }
     }
   else if (fds->priv != NULL)
     {
       for (i = 0; i < CONFIG_SENSORS_NPOLLWAITERS; i++)
         {
-          if (fds == upper->fds[i])
+          if (fds == user->fds[i])
             {
-              upper->fds[i] = NULL;
+              user->fds[i] = NULL;
               fds->priv = NULL;
               break;
             }
@@ -540,41 +800,31 @@ static void sensor_push_event(FAR void *priv, FAR const void *data,
                               size_t bytes)
 {
   FAR struct sensor_upperhalf_s *upper = priv;
-  int semcount;
 
   if (!bytes || nxsem_wait(&upper->exclsem) < 0)
     {
       return;
     }
 
-  circbuf_overwrite(&upper->buffer, data, bytes);
-  sensor_pollnotify(upper, POLLIN);
-  nxsem_get_value(&upper->buffersem, &semcount);
-  if (semcount < 1)
-    {
-      nxsem_post(&upper->buffersem);
-    }
+  /* A lower half with a hardware FIFO may push a whole batch of events at
+   * once; the users are then woken up only once for all of them.
+   */
 
+  circbuf_overwrite(&upper->buffer, data, bytes);
+  sensor_wakeup(upper);
   nxsem_post(&upper->exclsem);
 }
 
 static void sensor_notify_event(FAR void *priv)
 {
   FAR struct sensor_upperhalf_s *upper = priv;
-  int semcount;
 
   if (nxsem_wait(&upper->exclsem) < 0)
     {
       return;
     }
 
-  sensor_pollnotify(upper, POLLIN);
-  nxsem_get_value(&upper->buffersem, &semcount);
-  if (semcount < 1)
-    {
-      nxsem_post(&upper->buffersem);
-    }
-
+  sensor_wakeup(upper);
   nxsem_post(&upper->exclsem);
 }
 
@@ -673,10 +923,8 @@ int sensor_custom_register(FAR struct sensor_lowerhalf_s *lower,
   upper->lower = lower;
   upper->esize = esize;
 
+  list_initialize(&upper->users);
   nxsem_init(&upper->exclsem, 0, 1);
-  nxsem_init(&upper->buffersem, 0, 0);
-
-  nxsem_set_protocol(&upper->buffersem, SEM_PRIO_NONE);
 
   /* Bind the lower half data structure member */
 
@@ -708,7 +956,6 @@ int sensor_custom_register(FAR struct sensor_lowerhalf_s *lower,
 
 drv_err:
   nxsem_destroy(&upper->exclsem);
-  nxsem_destroy(&upper->buffersem);
 
   kmm_free(upper);
 
@@ -768,7 +1015,6 @@ void sensor_custom_unregister(FAR struct sensor_lowerhalf_s *lower,
   unregister_driver(path);
 
   nxsem_destroy(&upper->exclsem);
-  nxsem_destroy(&upper->buffersem);
 
   kmm_free(upper);
 }
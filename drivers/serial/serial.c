@@ -321,6 +321,73 @@ static int uart_putxmitchar(FAR uart_dev_t *dev, int ch, bool oktoblock)
   return OK;
 }
 
+/****************************************************************************
+ * Name: uart_putxmitbuf
+ *
+ * Description:
+ *   Copy as much of the user buffer as will fit into the TX buffer without
+ *   blocking.  Used when no output processing is needed so that data is
+ *   moved with memcpy() rather than one character at a time.
+ *
+ ****************************************************************************/
+
+static size_t uart_putxmitbuf(FAR uart_dev_t *dev, FAR const char *buffer,
+                              size_t buflen)
+{
+  FAR struct uart_buffer_s *txbuf = &dev->xmit;
+  size_t nwritten = 0;
+  size_t nbytes;
+  int16_t head;
+  int16_t tail;
+
+  while (nwritten < buflen)
+    {
+      /* Find the contiguous free space at the head of the buffer.  One
+       * byte is always left free so that a full buffer can be told from
+       * an empty one.
+       */
+
+      head = txbuf->head;
+      tail = txbuf->tail;
+
+      if (head >= tail)
+        {
+          nbytes = txbuf->size - head;
+          if (tail == 0)
+            {
+              nbytes--;
+            }
+        }
+      else
+        {
+          nbytes = tail - head - 1;
+        }
+
+      if (nbytes == 0)
+        {
+          break;
+        }
+
+      if (nbytes > buflen - nwritten)
+        {
+          nbytes = buflen - nwritten;
+        }
+
+      memcpy(&txbuf->buffer[head], &buffer[nwritten], nbytes);
+
+      head += nbytes;
+      if (head >= txbuf->size)
+        {
+          head = 0;
+        }
+
+      txbuf->head = head;
+      nwritten   += nbytes;
+    }
+
+  return nwritten;
+}
+
 /****************************************************************************
  * Name: uart_putc
  ****************************************************************************/
@@ -702,10 +769,17 @@ static ssize_t uart_read(FAR struct file *filep,
 #ifdef CONFIG_SERIAL_IFLOWCONTROL_WATERMARKS
   unsigned int nbuffered;
   unsigned int watermark;
+#endif
+#ifdef CONFIG_SERIAL_TERMIOS
+  size_t minrecv;
+  bool expired = false;
 #endif
   irqstate_t flags;
   ssize_t recvd = 0;
+  size_t nbytes;
+  int16_t head;
   int16_t tail;
+  bool bulk = true;
   char ch;
   int ret;
 
@@ -722,6 +796,43 @@ static ssize_t uart_read(FAR struct file *filep,
       return ret;
     }
 
+#ifdef CONFIG_SERIAL_TERMIOS
+  /* Input processing has to look at every character */
+
+  bulk = (dev->tc_iflag & (INLCR | IGNCR | ICRNL)) == 0;
+
+  /* VMIN is the number of bytes to wait for before returning.  It is
+   * limited to what the caller asked for and to what the RX buffer can
+   * hold.  VMIN == 0 behaves like VMIN == 1 unless VTIME is also set.
+   */
+
+  minrecv = dev->tc_vmin > 1 ? dev->tc_vmin : 1;
+  if (minrecv > buflen)
+    {
+      minrecv = buflen;
+    }
+
+  if (minrecv > (size_t)rxbuf->size - 1)
+    {
+      minrecv = rxbuf->size - 1;
+    }
+
+#ifdef CONFIG_SERIAL_IFLOWCONTROL_WATERMARKS
+  /* With RX flow control, reception is paused once the buffer reaches the
+   * upper watermark, so no more than that can ever be waited for.
+   */
+
+  watermark = (CONFIG_SERIAL_IFLOWCONTROL_UPPER_WATERMARK * rxbuf->size) /
+              100;
+  if (watermark > 0 && minrecv > watermark)
+    {
+      minrecv = watermark;
+    }
+#endif
+
+  dev->recvidle = false;
+#endif
+
   /* Loop while we still have data to copy to the receive buffer.
    * we add data to the head of the buffer; uart_xmitchars takes the
    * data from the end of the buffer.
@@ -756,8 +867,33 @@ static ssize_t uart_read(FAR struct file *filep,
        * 8-bit accesses to obtain the 16-bit head index.
        */
 
+      head = rxbuf->head;
       tail = rxbuf->tail;
-      if (rxbuf->head != tail)
+      if (head != tail && bulk)
+        {
+          /* No input processing.  Copy the contiguous run of data at the
+           * tail of the buffer in one go.
+           */
+
+          nbytes = head > tail ? head - tail : rxbuf->size - tail;
+          if (nbytes > buflen - recvd)
+            {
+              nbytes = buflen - recvd;
+            }
+
+          memcpy(buffer, &rxbuf->buffer[tail], nbytes);
+
+          tail += nbytes;
+          if (tail >= rxbuf->size)
+            {
+              tail = 0;
+            }
+
+          rxbuf->tail = tail;
+          buffer     += nbytes;
+          recvd      += nbytes;
+        }
+      else if (head != tail)
         {
           /* Take the next character from the tail of the buffer */
 
@@ -834,12 +970,26 @@ static ssize_t uart_read(FAR struct file *filep,
 
           break;
         }
+
+#  ifdef CONFIG_SERIAL_TERMIOS
+      /* Or, if VTIME expired, return what we have */
+
+      else if (expired)
+        {
+          break;
+        }
+#  endif
 #else
       /* No... the circular buffer is empty.  Have we returned anything
        * to the caller?
        */
 
+#ifdef CONFIG_SERIAL_TERMIOS
+      else if ((size_t)recvd >= minrecv || expired ||
+               (recvd > 0 && dev->recvidle))
+#else
       else if (recvd > 0)
+#endif
         {
           /* Yes.. break out of the loop and return the number of bytes
            * received up to the wait condition.
@@ -942,7 +1092,40 @@ static ssize_t uart_read(FAR struct file *filep,
                    */
 
                   dev->recvwaiting = true;
-                  ret = uart_takesem(&dev->recvsem, true);
+#ifdef CONFIG_SERIAL_TERMIOS
+                  /* Don't wake up until the rest of VMIN has arrived.  With
+                   * VTIME, give up if the line stays quiet for that long.
+                   * Bytes that arrive before VMIN is reached don't wake
+                   * us, so on a timeout the wait is restarted from the
+                   * last reception until the line really was quiet.
+                   */
+
+                  dev->recvwakeup = minrecv - recvd;
+                  if (dev->tc_vtime > 0 && (recvd > 0 || dev->tc_vmin == 0))
+                    {
+                      clock_t start;
+
+                      dev->recvtick = clock_systime_ticks();
+                      do
+                        {
+                          start = dev->recvtick;
+                          ret   = nxsem_tickwait(&dev->recvsem, start,
+                                                 DSEC2TICK(dev->tc_vtime));
+                        }
+                      while (ret == -ETIMEDOUT && dev->recvtick != start);
+
+                      if (ret == -ETIMEDOUT)
+                        {
+                          dev->recvwaiting = false;
+                          expired = true;
+                          ret = OK;
+                        }
+                    }
+                  else
+#endif
+                    {
+                      ret = uart_takesem(&dev->recvsem, true);
+                    }
                 }
 
               leave_critical_section(flags);
@@ -1060,7 +1243,9 @@ static ssize_t uart_write(FAR struct file *filep, FAR const char *buffer,
   FAR struct inode *inode    = filep->f_inode;
   FAR uart_dev_t   *dev      = inode->i_private;
   ssize_t           nwritten = buflen;
+  size_t            nbytes;
   bool              oktoblock;
+  bool              bulk;
   int               ret;
   char              ch;
 
@@ -1124,6 +1309,17 @@ static ssize_t uart_write(FAR struct file *filep, FAR const char *buffer,
 
   oktoblock = ((filep->f_oflags & O_NONBLOCK) == 0);
 
+  /* Can the data be copied to the TX buffer as-is, without any output
+   * processing?
+   */
+
+#ifdef CONFIG_SERIAL_TERMIOS
+  bulk = (dev->tc_oflag & OPOST) == 0 ||
+         (dev->tc_oflag & (OCRNL | ONLCR | ONLRET)) == 0;
+#else
+  bulk = !dev->isconsole;
+#endif
+
   /* Loop while we still have data to copy to the transmit buffer.
    * we add data to the head of the buffer; uart_xmitchars takes the
    * data from the end of the buffer.
@@ -1132,6 +1328,22 @@ static ssize_t uart_write(FAR struct file *filep, FAR const char *buffer,
   uart_disabletxint(dev);
   for (; buflen; buflen--)
     {
+      if (bulk)
+        {
+          /* Copy whatever fits in one go.  The character path below is
+           * only used to wait for space when the TX buffer is full.
+           */
+
+          nbytes  = uart_putxmitbuf(dev, buffer, buflen);
+          buffer += nbytes;
+          buflen -= nbytes;
+
+          if (buflen == 0)
+            {
+              break;
+            }
+        }
+
       ch  = *buffer++;
       ret = OK;
 
@@ -1407,6 +1619,8 @@ static int uart_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
               termiosp->c_iflag = dev->tc_iflag;
               termiosp->c_oflag = dev->tc_oflag;
               termiosp->c_lflag = dev->tc_lflag;
+              termiosp->c_cc[VMIN]  = dev->tc_vmin;
+              termiosp->c_cc[VTIME] = dev->tc_vtime;
             }
             break;
 
@@ -1425,6 +1639,8 @@ static int uart_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
               dev->tc_iflag = termiosp->c_iflag;
               dev->tc_oflag = termiosp->c_oflag;
               dev->tc_lflag = termiosp->c_lflag;
+              dev->tc_vmin  = termiosp->c_cc[VMIN];
+              dev->tc_vtime = termiosp->c_cc[VTIME];
             }
             break;
         }
@@ -1643,13 +1859,34 @@ int uart_register(FAR const char *path, FAR uart_dev_t *dev)
 
 void uart_datareceived(FAR uart_dev_t *dev)
 {
+#ifdef CONFIG_SERIAL_TERMIOS
+  int16_t nbuffered;
+
+  nbuffered = dev->recv.head - dev->recv.tail;
+  if (nbuffered < 0)
+    {
+      nbuffered += dev->recv.size;
+    }
+
+  /* Restart the VTIME inter-byte timer of a waiting reader */
+
+  dev->recvtick = clock_systime_ticks();
+#endif
+
   /* Notify all poll/select waiters that they can read from the recv buffer */
 
   uart_pollnotify(dev, POLLIN);
 
-  /* Is there a thread waiting for read data?  */
+  /* Is there a thread waiting for read data?  With termios, don't wake it
+   * for each character but only once it has enough data to return.
+   */
 
+#ifdef CONFIG_SERIAL_TERMIOS
+  if (dev->recvwaiting &&
+      (nbuffered >= dev->recvwakeup || dev->recvidle))
+#else
   if (dev->recvwaiting)
+#endif
     {
       /* Yes... wake it up */
 
@@ -369,6 +369,18 @@ void uart_recvchars_done(FAR uart_dev_t *dev)
     }
 #endif
 
+#ifdef CONFIG_SERIAL_TERMIOS
+  /* A transfer that ends before it used all of the space it was given was
+   * cut short by an idle line (or a receive timeout).  Let a reader that
+   * is waiting for VMIN bytes return what has arrived so far.
+   */
+
+  if (nbytes < xfer->length + xfer->nlength)
+    {
+      dev->recvidle = true;
+    }
+#endif
+
   /* Move head for nbytes. */
 
   rxbuf->head  = (rxbuf->head + nbytes) % rxbuf->size;
@@ -0,0 +1,347 @@
+/****************************************************************************
+ * drivers/spi/spi_queue.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/irq.h>
+#include <nuttx/wqueue.h>
+#include <nuttx/spi/spi.h>
+#include <nuttx/spi/spi_transfer.h>
+
+#ifdef CONFIG_SPI_ASYNC
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The work queue that runs the transfers */
+
+#if defined(CONFIG_SPI_ASYNC_HPWORK)
+#  define SPI_ASYNC_WORK HPWORK
+#else
+#  define SPI_ASYNC_WORK LPWORK
+#endif
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static void spi_async_worker(FAR void *arg);
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: spi_async_done
+ *
+ * Description:
+ *   Called by the lower half when a sequence started with SPI_SEQUENCE()
+ *   completes.  The result is reported and the next sequence started on
+ *   the work queue.
+ *
+ ****************************************************************************/
+
+static void spi_async_done(FAR void *arg, int result)
+{
+  FAR struct spi_queue_s *queue = (FAR struct spi_queue_s *)arg;
+  irqstate_t flags;
+
+  flags = enter_critical_section();
+  queue->done   = queue->active;
+  queue->active = NULL;
+  queue->result = result;
+  leave_critical_section(flags);
+
+  work_queue(SPI_ASYNC_WORK, &queue->work, spi_async_worker, queue, 0);
+}
+
+/****************************************************************************
+ * Name: spi_async_report
+ *
+ * Description:
+ *   Report the result of a sequence to its owner.
+ *
+ ****************************************************************************/
+
+static void spi_async_report(FAR struct spi_async_s *req, int result)
+{
+  if (result < 0)
+    {
+      spierr("ERROR: SPI sequence failed: %d\n", result);
+    }
+
+  if (req->callback != NULL)
+    {
+      req->callback(req, result);
+    }
+}
+
+/****************************************************************************
+ * Name: spi_async_worker
+ *
+ * Description:
+ *   Report the sequence completed by the lower half, if any, and perform
+ *   the queued sequences until the queue is empty or the lower half is
+ *   running one.
+ *
+ ****************************************************************************/
+
+static void spi_async_worker(FAR void *arg)
+{
+  FAR struct spi_queue_s *queue = (FAR struct spi_queue_s *)arg;
+  FAR struct spi_async_s *req;
+  irqstate_t flags;
+  int ret;
+
+  flags = enter_critical_section();
+  req         = queue->done;
+  ret         = queue->result;
+  queue->done = NULL;
+  leave_critical_section(flags);
+
+  if (req != NULL)
+    {
+      spi_async_report(req, ret);
+    }
+
+  for (; ; )
+    {
+      /* Take the highest priority sequence from the queue, unless the
+       * lower half is still busy with the previous one.
+       */
+
+      flags = enter_critical_section();
+      req = queue->active == NULL ? queue->head : NULL;
+      if (req != NULL)
+        {
+          queue->head   = req->flink;
+          queue->active = req;
+          req->flink    = NULL;
+        }
+
+      leave_critical_section(flags);
+
+      if (req == NULL)
+        {
+          break;
+        }
+
+      /* Let the lower half run the whole sequence so that the work queue
+       * is not blocked meanwhile.  spi_async_done() reports the result.
+       */
+
+      ret = SPI_SEQUENCE(queue->spi, req->seq, spi_async_done, queue);
+      if (ret >= 0)
+        {
+          break;
+        }
+
+      /* Otherwise perform the sequence here and report the result */
+
+      if (ret == -ENOSYS)
+        {
+          ret = spi_transfer(queue->spi, req->seq);
+        }
+
+      queue->active = NULL;
+      spi_async_report(req, ret);
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: spi_queue_initialize
+ *
+ * Description:
+ *   Initialize an empty queue of asynchronous transfers for an SPI bus.
+ *   All users of the bus that want asynchronous transfers should share
+ *   the same queue so that their sequences are ordered by priority.
+ *
+ * Input Parameters:
+ *   queue - The queue to initialize
+ *   spi   - An instance of the SPI device to use for the transfers
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void spi_queue_initialize(FAR struct spi_queue_s *queue,
+                          FAR struct spi_dev_s *spi)
+{
+  DEBUGASSERT(queue != NULL && spi != NULL);
+
+  memset(queue, 0, sizeof(struct spi_queue_s));
+  queue->spi = spi;
+}
+
+/****************************************************************************
+ * Name: spi_transfer_async
+ *
+ * Description:
+ *   Queue a sequence of SPI transfers and return without waiting for it.
+ *   Queued sequences are performed one at a time, highest priority first
+ *   and in order of submission for equal priorities.  This function may be
+ *   called from an interrupt handler.
+ *
+ *   If the lower half implements SPI_SEQUENCE(), the work queue only
+ *   starts each sequence.  Otherwise the work queue performs it with
+ *   spi_transfer(), which occupies the work queue thread (and delays the
+ *   queues of other buses served by that thread) until the sequence
+ *   completes.
+ *
+ * Input Parameters:
+ *   queue - The queue of the SPI bus to use
+ *   req   - Describes the sequence and the completion callback
+ *
+ * Returned Value:
+ *   Zero (OK) on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int spi_transfer_async(FAR struct spi_queue_s *queue,
+                       FAR struct spi_async_s *req)
+{
+  FAR struct spi_async_s *prev;
+  FAR struct spi_async_s *next;
+  irqstate_t flags;
+  int ret = OK;
+
+  DEBUGASSERT(queue != NULL && req != NULL && req->seq != NULL &&
+              req->seq->trans != NULL);
+
+  /* Insert the sequence after all pending sequences of the same or higher
+   * priority.
+   */
+
+  flags = enter_critical_section();
+
+  for (prev = NULL, next = queue->head;
+       next != NULL && next->priority >= req->priority;
+       prev = next, next = next->flink)
+    {
+    }
+
+  req->flink = next;
+  if (prev == NULL)
+    {
+      queue->head = req;
+    }
+  else
+    {
+      prev->flink = req;
+    }
+
+  /* Start the worker unless it is already scheduled or the lower half is
+   * running a sequence.  If it is running, scheduling it again is
+   * harmless; it will find the queue empty.
+   */
+
+  if (work_available(&queue->work) && queue->active == NULL)
+    {
+      ret = work_queue(SPI_ASYNC_WORK, &queue->work, spi_async_worker,
+                       queue, 0);
+      if (ret < 0)
+        {
+          /* Take the sequence back out of the queue */
+
+          if (prev == NULL)
+            {
+              queue->head = next;
+            }
+          else
+            {
+              prev->flink = next;
+            }
+        }
+    }
+
+  leave_critical_section(flags);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: spi_cancel_async
+ *
+ * Description:
+ *   Remove a sequence from the queue before it is started.  The callback
+ *   of a cancelled sequence is not called.
+ *
+ * Input Parameters:
+ *   queue - The queue of the SPI bus
+ *   req   - The sequence to cancel
+ *
+ * Returned Value:
+ *   Zero (OK) on success; -ENOENT if the sequence is not pending, because
+ *   it has already been started or was never queued.
+ *
+ ****************************************************************************/
+
+int spi_cancel_async(FAR struct spi_queue_s *queue,
+                     FAR struct spi_async_s *req)
+{
+  FAR struct spi_async_s *prev;
+  FAR struct spi_async_s *curr;
+  irqstate_t flags;
+  int ret = -ENOENT;
+
+  DEBUGASSERT(queue != NULL && req != NULL);
+
+  flags = enter_critical_section();
+
+  for (prev = NULL, curr = queue->head;
+       curr != NULL;
+       prev = curr, curr = curr->flink)
+    {
+      if (curr == req)
+        {
+          if (prev == NULL)
+            {
+              queue->head = req->flink;
+            }
+          else
+            {
+              prev->flink = req->flink;
+            }
+
+          req->flink = NULL;
+          ret = OK;
+          break;
+        }
+    }
+
+  leave_critical_section(flags);
+  return ret;
+}
+
+#endif /* CONFIG_SPI_ASYNC */
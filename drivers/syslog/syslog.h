@@ -27,7 +27,10 @@
 
 #include <nuttx/config.h>
 
+#include <sys/types.h>
 #include <stdbool.h>
+#include <stdarg.h>
+#include <time.h>
 
 /****************************************************************************
  * Public Data
@@ -282,6 +285,110 @@ ssize_t syslog_write(FAR const char *buffer, size_t buflen);
 
 int syslog_force(int ch);
 
+/****************************************************************************
+ * Name: syslog_gettime
+ *
+ * Description:
+ *   Get the time used to stamp a SYSLOG message.
+ *
+ * Input Parameters:
+ *   ts - Location to return the time
+ *
+ * Returned Value:
+ *   None.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SYSLOG_TIMESTAMP
+void syslog_gettime(FAR struct timespec *ts);
+#endif
+
+/****************************************************************************
+ * Name: syslog_header
+ *
+ * Description:
+ *   Emit the configured message prefix (timestamp, process ID, color,
+ *   priority, prefix string and process name) to the SYSLOG stream.
+ *
+ * Input Parameters:
+ *   stream   - The SYSLOG stream to write to
+ *   priority - The message priority
+ *   pid      - The ID of the task that generated the message
+ *   ts       - The time the message was generated (may be NULL if
+ *              CONFIG_SYSLOG_TIMESTAMP is not selected)
+ *
+ * Returned Value:
+ *   The number of characters emitted.
+ *
+ ****************************************************************************/
+
+struct lib_syslogstream_s; /* Forward reference */
+int syslog_header(FAR struct lib_syslogstream_s *stream, int priority,
+                  pid_t pid, FAR const struct timespec *ts);
+
+/****************************************************************************
+ * Name: syslog_trailer
+ *
+ * Description:
+ *   Emit the configured message suffix to the SYSLOG stream.
+ *
+ * Input Parameters:
+ *   stream - The SYSLOG stream to write to
+ *
+ * Returned Value:
+ *   The number of characters emitted.
+ *
+ ****************************************************************************/
+
+int syslog_trailer(FAR struct lib_syslogstream_s *stream);
+
+/****************************************************************************
+ * Name: syslog_deferred_add
+ *
+ * Description:
+ *   Record a SYSLOG message in the per-CPU deferred ring.  Only copies of
+ *   the format string and the argument values are saved; the message is
+ *   formatted and sent to the SYSLOG channels later by a low priority
+ *   worker.
+ *
+ * Input Parameters:
+ *   priority - The message priority
+ *   fmt      - The format string
+ *   ap       - The format arguments
+ *
+ * Returned Value:
+ *   Zero (OK) is returned if the message was recorded or dropped because
+ *   the ring is full.  A negated errno value is returned if the message
+ *   cannot be deferred and must be formatted synchronously by the caller.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SYSLOG_DEFERRED
+int syslog_deferred_add(int priority, FAR const IPTR char *fmt,
+                        FAR va_list *ap);
+#endif
+
+/****************************************************************************
+ * Name: syslog_deferred_flush
+ *
+ * Description:
+ *   Format and output all messages pending in the deferred rings.  Called
+ *   by the worker and by crash-handling logic.
+ *
+ * Input Parameters:
+ *   crash - True if called from crash-handling logic.  The rings are then
+ *           drained even if another consumer was interrupted while
+ *           draining them.
+ *
+ * Returned Value:
+ *   None.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SYSLOG_DEFERRED
+void syslog_deferred_flush(bool crash);
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
@@ -0,0 +1,1025 @@
+/****************************************************************************
+ * drivers/syslog/syslog_deferred.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <assert.h>
+#include <errno.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/init.h>
+#include <nuttx/irq.h>
+#include <nuttx/clock.h>
+#include <nuttx/spinlock.h>
+#include <nuttx/streams.h>
+#include <nuttx/wqueue.h>
+#include <nuttx/syslog/syslog.h>
+
+#include "syslog.h"
+
+#ifdef CONFIG_SYSLOG_DEFERRED
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifdef CONFIG_SMP
+#  define SYSLOG_DEFERRED_NRINGS  CONFIG_SMP_NCPUS
+#  define syslog_deferred_barrier() SP_DMB()
+#else
+#  define SYSLOG_DEFERRED_NRINGS  1
+#  define syslog_deferred_barrier()
+#endif
+
+#define SYSLOG_DEFERRED_ALIGN     sizeof(uintptr_t)
+#define SYSLOG_DEFERRED_ALIGNUP(n) \
+  (((n) + SYSLOG_DEFERRED_ALIGN - 1) & ~(SYSLOG_DEFERRED_ALIGN - 1))
+
+/* The ring offsets are derived from free-running counters, so the ring
+ * size must divide their range.
+ */
+
+#if (CONFIG_SYSLOG_DEFERRED_BUFSIZE & \
+     (CONFIG_SYSLOG_DEFERRED_BUFSIZE - 1)) != 0
+#  error CONFIG_SYSLOG_DEFERRED_BUFSIZE must be a power of two
+#endif
+
+#define SYSLOG_DEFERRED_BUFSIZE   CONFIG_SYSLOG_DEFERRED_BUFSIZE
+#define SYSLOG_DEFERRED_OFFSET(n) ((n) & (SYSLOG_DEFERRED_BUFSIZE - 1))
+
+#define SYSLOG_DEFERRED_HDRSIZE \
+  SYSLOG_DEFERRED_ALIGNUP(sizeof(struct syslog_record_s))
+
+/* Longest conversion specification that can be replayed, e.g. "%-*.*llx"
+ * with both '*' replaced by their decimal values.
+ */
+
+#define SYSLOG_DEFERRED_SPECLEN   32
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* The type of the argument consumed by a conversion specification */
+
+enum syslog_argtype_e
+{
+  SYSLOG_ARG_NONE = 0,            /* "%%" */
+  SYSLOG_ARG_INT,
+  SYSLOG_ARG_LONG,
+#ifdef CONFIG_HAVE_LONG_LONG
+  SYSLOG_ARG_LLONG,
+#endif
+  SYSLOG_ARG_INTMAX,
+  SYSLOG_ARG_SIZE,
+  SYSLOG_ARG_PTRDIFF,
+  SYSLOG_ARG_PTR,
+  SYSLOG_ARG_STRING,
+#ifdef CONFIG_HAVE_DOUBLE
+  SYSLOG_ARG_DOUBLE,
+#endif
+#ifdef CONFIG_HAVE_LONG_DOUBLE
+  SYSLOG_ARG_LDOUBLE,
+#endif
+};
+
+/* One deferred message.  The captured argument values follow the header
+ * back to back in the order in which the format string consumes them,
+ * followed by a copy of the format string.  A record with a NULL format is
+ * padding before the end of the ring.
+ */
+
+struct syslog_record_s
+{
+  uint16_t dr_length;             /* Length of the record incl. header */
+  uint8_t  dr_priority;           /* Message priority */
+  pid_t    dr_pid;                /* Task that generated the message */
+#ifdef CONFIG_SYSLOG_TIMESTAMP
+  struct timespec dr_ts;          /* Time the message was generated */
+#endif
+  FAR const IPTR char *dr_fmt;    /* Copied format, NULL for padding */
+};
+
+/* A single-producer, single-consumer ring.  Only the owning CPU (with
+ * local interrupts disabled) advances sr_head; only the consumer that owns
+ * g_syslog_draining advances sr_tail.  Both are free-running byte counters.
+ */
+
+struct syslog_ring_s
+{
+  volatile size_t sr_head;
+  volatile size_t sr_tail;
+  volatile uint32_t sr_dropped;   /* Messages lost because the ring was full */
+  uint32_t sr_reported;           /* Drops already reported by the consumer */
+  uintptr_t sr_buffer[SYSLOG_DEFERRED_BUFSIZE / sizeof(uintptr_t)];
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct syslog_ring_s g_syslog_rings[SYSLOG_DEFERRED_NRINGS];
+static struct work_s g_syslog_work;
+
+/* Set while a consumer (the worker or syslog_flush()) drains the rings */
+
+static volatile bool g_syslog_draining;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: syslog_deferred_spec
+ *
+ * Description:
+ *   Parse one conversion specification.
+ *
+ * Input Parameters:
+ *   fmt    - Points just past the '%' introducing the specification
+ *   type   - Location to return the type of the argument consumed
+ *   nstars - Location to return the number of '*' width/precision
+ *            arguments consumed before the value
+ *
+ * Returned Value:
+ *   A pointer just past the conversion character, or NULL if the
+ *   specification cannot be deferred.
+ *
+ ****************************************************************************/
+
+static FAR const IPTR char *
+syslog_deferred_spec(FAR const IPTR char *fmt, FAR int *type,
+                     FAR int *nstars)
+{
+  int length = 0;
+
+  *nstars = 0;
+
+  /* Flags */
+
+  while (*fmt == '-' || *fmt == '+' || *fmt == ' ' || *fmt == '#' ||
+         *fmt == '0')
+    {
+      fmt++;
+    }
+
+  /* Field width */
+
+  if (*fmt == '*')
+    {
+      (*nstars)++;
+      fmt++;
+    }
+
+  while (*fmt >= '0' && *fmt <= '9')
+    {
+      fmt++;
+    }
+
+  /* Numbered arguments ("%1$d") can not be replayed sequentially */
+
+  if (*fmt == '$')
+    {
+      return NULL;
+    }
+
+  /* Precision */
+
+  if (*fmt == '.')
+    {
+      fmt++;
+      if (*fmt == '*')
+        {
+          (*nstars)++;
+          fmt++;
+        }
+
+      while (*fmt >= '0' && *fmt <= '9')
+        {
+          fmt++;
+        }
+    }
+
+  /* Length modifier */
+
+  switch (*fmt)
+    {
+      case 'h':
+        fmt += fmt[1] == 'h' ? 2 : 1;
+        break;
+
+      case 'l':
+        if (fmt[1] == 'l')
+          {
+            length = 'q';
+            fmt += 2;
+            break;
+          }
+
+        /* Fall through */
+
+      case 'j':
+      case 'z':
+      case 't':
+      case 'L':
+        length = *fmt++;
+        break;
+
+      default:
+        break;
+    }
+
+  /* Conversion */
+
+  switch (*fmt)
+    {
+      case '%':
+        *type = SYSLOG_ARG_NONE;
+        break;
+
+      case 'd':
+      case 'i':
+      case 'u':
+      case 'o':
+      case 'x':
+      case 'X':
+      case 'c':
+        switch (length)
+          {
+            case 'l':
+              *type = SYSLOG_ARG_LONG;
+              break;
+
+#ifdef CONFIG_HAVE_LONG_LONG
+            case 'q':
+              *type = SYSLOG_ARG_LLONG;
+              break;
+#endif
+
+            case 'j':
+              *type = SYSLOG_ARG_INTMAX;
+              break;
+
+            case 'z':
+              *type = SYSLOG_ARG_SIZE;
+              break;
+
+            case 't':
+              *type = SYSLOG_ARG_PTRDIFF;
+              break;
+
+            case 0:
+              *type = SYSLOG_ARG_INT;
+              break;
+
+            default:
+              return NULL;
+          }
+        break;
+
+      case 'p':
+        *type = SYSLOG_ARG_PTR;
+        break;
+
+      case 's':
+        *type = SYSLOG_ARG_STRING;
+        break;
+
+#ifdef CONFIG_HAVE_DOUBLE
+      case 'e':
+      case 'E':
+      case 'f':
+      case 'F':
+      case 'g':
+      case 'G':
+#ifdef CONFIG_HAVE_LONG_DOUBLE
+        if (length == 'L')
+          {
+            *type = SYSLOG_ARG_LDOUBLE;
+            break;
+          }
+#endif
+
+        *type = SYSLOG_ARG_DOUBLE;
+        break;
+#endif
+
+      /* %n, wide characters and anything unknown are formatted
+       * synchronously.
+       */
+
+      default:
+        return NULL;
+    }
+
+  return fmt + 1;
+}
+
+/****************************************************************************
+ * Name: syslog_deferred_put
+ *
+ * Description:
+ *   Append one argument value to the capture buffer.
+ *
+ ****************************************************************************/
+
+static int syslog_deferred_put(FAR uint8_t *buffer, size_t buflen,
+                               FAR size_t *offset, FAR const void *value,
+                               size_t size)
+{
+  if (*offset + size > buflen)
+    {
+      return -E2BIG;
+    }
+
+  memcpy(&buffer[*offset], value, size);
+  *offset += size;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: syslog_deferred_capture
+ *
+ * Description:
+ *   Walk the format string and copy the argument values into the capture
+ *   buffer.  String arguments are copied (truncated to
+ *   CONFIG_SYSLOG_DEFERRED_STRLEN) because the caller's buffer may be gone
+ *   by the time the message is formatted.
+ *
+ * Returned Value:
+ *   The number of bytes captured or a negated errno value if the message
+ *   can not be deferred.
+ *
+ ****************************************************************************/
+
+static ssize_t syslog_deferred_capture(FAR const IPTR char *fmt,
+                                       va_list ap, FAR uint8_t *buffer,
+                                       size_t buflen)
+{
+  FAR const IPTR char *start;
+  size_t offset = 0;
+  int nstars;
+  int type;
+  int ret;
+
+  while (*fmt != '\0')
+    {
+      if (*fmt++ != '%')
+        {
+          continue;
+        }
+
+      /* Leave room in the replayed specification for the '*' values */
+
+      start = fmt;
+      fmt   = syslog_deferred_spec(fmt, &type, &nstars);
+      if (fmt == NULL || fmt - start > SYSLOG_DEFERRED_SPECLEN - 24)
+        {
+          return -ENOTSUP;
+        }
+
+      while (nstars-- > 0)
+        {
+          int star = va_arg(ap, int);
+
+          ret = syslog_deferred_put(buffer, buflen, &offset, &star,
+                                    sizeof(star));
+          if (ret < 0)
+            {
+              return ret;
+            }
+        }
+
+      switch (type)
+        {
+          case SYSLOG_ARG_NONE:
+            ret = OK;
+            break;
+
+          case SYSLOG_ARG_INT:
+            {
+              int value = va_arg(ap, int);
+              ret = syslog_deferred_put(buffer, buflen, &offset, &value,
+                                        sizeof(value));
+            }
+            break;
+
+          case SYSLOG_ARG_LONG:
+            {
+              long value = va_arg(ap, long);
+              ret = syslog_deferred_put(buffer, buflen, &offset, &value,
+                                        sizeof(value));
+            }
+            break;
+
+#ifdef CONFIG_HAVE_LONG_LONG
+          case SYSLOG_ARG_LLONG:
+            {
+              long long value = va_arg(ap, long long);
+              ret = syslog_deferred_put(buffer, buflen, &offset, &value,
+                                        sizeof(value));
+            }
+            break;
+#endif
+
+          case SYSLOG_ARG_INTMAX:
+            {
+              intmax_t value = va_arg(ap, intmax_t);
+              ret = syslog_deferred_put(buffer, buflen, &offset, &value,
+                                        sizeof(value));
+            }
+            break;
+
+          case SYSLOG_ARG_SIZE:
+            {
+              size_t value = va_arg(ap, size_t);
+              ret = syslog_deferred_put(buffer, buflen, &offset, &value,
+                                        sizeof(value));
+            }
+            break;
+
+          case SYSLOG_ARG_PTRDIFF:
+            {
+              ptrdiff_t value = va_arg(ap, ptrdiff_t);
+              ret = syslog_deferred_put(buffer, buflen, &offset, &value,
+                                        sizeof(value));
+            }
+            break;
+
+          case SYSLOG_ARG_PTR:
+            {
+              FAR void *value = va_arg(ap, FAR void *);
+              ret = syslog_deferred_put(buffer, buflen, &offset, &value,
+                                        sizeof(value));
+            }
+            break;
+
+          case SYSLOG_ARG_STRING:
+            {
+              FAR const char *str = va_arg(ap, FAR const char *);
+              size_t len;
+
+              if (str == NULL)
+                {
+                  str = "(null)";
+                }
+
+              len = strnlen(str, CONFIG_SYSLOG_DEFERRED_STRLEN);
+              ret = syslog_deferred_put(buffer, buflen, &offset, str, len);
+              if (ret >= 0)
+                {
+                  ret = syslog_deferred_put(buffer, buflen, &offset, "", 1);
+                }
+            }
+            break;
+
+#ifdef CONFIG_HAVE_DOUBLE
+          case SYSLOG_ARG_DOUBLE:
+            {
+              double value = va_arg(ap, double);
+              ret = syslog_deferred_put(buffer, buflen, &offset, &value,
+                                        sizeof(value));
+            }
+            break;
+#endif
+
+#ifdef CONFIG_HAVE_LONG_DOUBLE
+          case SYSLOG_ARG_LDOUBLE:
+            {
+              long double value = va_arg(ap, long double);
+              ret = syslog_deferred_put(buffer, buflen, &offset, &value,
+                                        sizeof(value));
+            }
+            break;
+#endif
+
+          default:
+            ret = -ENOTSUP;
+            break;
+        }
+
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  return offset;
+}
+
+/****************************************************************************
+ * Name: syslog_deferred_get
+ *
+ * Description:
+ *   Fetch the next captured argument value.
+ *
+ ****************************************************************************/
+
+static FAR const uint8_t *syslog_deferred_get(FAR const uint8_t *args,
+                                              FAR void *value, size_t size)
+{
+  memcpy(value, args, size);
+  return args + size;
+}
+
+/****************************************************************************
+ * Name: syslog_deferred_format
+ *
+ * Description:
+ *   Format a deferred message by replaying the format string one
+ *   conversion specification at a time against the captured values.
+ *
+ ****************************************************************************/
+
+static void syslog_deferred_format(FAR struct lib_outstream_s *stream,
+                                   FAR const IPTR char *fmt,
+                                   FAR const uint8_t *args)
+{
+  char spec[SYSLOG_DEFERRED_SPECLEN];
+  FAR const IPTR char *start;
+  FAR const IPTR char *end;
+  size_t len;
+  int nstars;
+  int type;
+
+  while (*fmt != '\0')
+    {
+      if (*fmt != '%')
+        {
+          stream->put(stream, *fmt++);
+          continue;
+        }
+
+      start = fmt++;
+      end   = syslog_deferred_spec(fmt, &type, &nstars);
+      DEBUGASSERT(end != NULL);
+
+      /* Copy the specification, replacing each '*' with its value */
+
+      len = 0;
+      for (fmt = start; fmt < end; fmt++)
+        {
+          if (*fmt == '*')
+            {
+              int star;
+
+              args = syslog_deferred_get(args, &star, sizeof(star));
+              if (star < 0 && *(fmt - 1) == '.')
+                {
+                  /* A negative precision is taken as if omitted */
+
+                  len--;
+                  continue;
+                }
+
+              len += snprintf(&spec[len], sizeof(spec) - len, "%d", star);
+            }
+          else
+            {
+              spec[len++] = *fmt;
+            }
+        }
+
+      spec[len] = '\0';
+      fmt = end;
+
+      switch (type)
+        {
+          case SYSLOG_ARG_NONE:
+            stream->put(stream, '%');
+            break;
+
+          case SYSLOG_ARG_INT:
+            {
+              int value;
+              args = syslog_deferred_get(args, &value, sizeof(value));
+              lib_sprintf(stream, spec, value);
+            }
+            break;
+
+          case SYSLOG_ARG_LONG:
+            {
+              long value;
+              args = syslog_deferred_get(args, &value, sizeof(value));
+              lib_sprintf(stream, spec, value);
+            }
+            break;
+
+#ifdef CONFIG_HAVE_LONG_LONG
+          case SYSLOG_ARG_LLONG:
+            {
+              long long value;
+              args = syslog_deferred_get(args, &value, sizeof(value));
+              lib_sprintf(stream, spec, value);
+            }
+            break;
+#endif
+
+          case SYSLOG_ARG_INTMAX:
+            {
+              intmax_t value;
+              args = syslog_deferred_get(args, &value, sizeof(value));
+              lib_sprintf(stream, spec, value);
+            }
+            break;
+
+          case SYSLOG_ARG_SIZE:
+            {
+              size_t value;
+              args = syslog_deferred_get(args, &value, sizeof(value));
+              lib_sprintf(stream, spec, value);
+            }
+            break;
+
+          case SYSLOG_ARG_PTRDIFF:
+            {
+              ptrdiff_t value;
+              args = syslog_deferred_get(args, &value, sizeof(value));
+              lib_sprintf(stream, spec, value);
+            }
+            break;
+
+          case SYSLOG_ARG_PTR:
+            {
+              FAR void *value;
+              args = syslog_deferred_get(args, &value, sizeof(value));
+              lib_sprintf(stream, spec, value);
+            }
+            break;
+
+          case SYSLOG_ARG_STRING:
+            lib_sprintf(stream, spec, (FAR const char *)args);
+            args += strlen((FAR const char *)args) + 1;
+            break;
+
+#ifdef CONFIG_HAVE_DOUBLE
+          case SYSLOG_ARG_DOUBLE:
+            {
+              double value;
+              args = syslog_deferred_get(args, &value, sizeof(value));
+              lib_sprintf(stream, spec, value);
+            }
+            break;
+#endif
+
+#ifdef CONFIG_HAVE_LONG_DOUBLE
+          case SYSLOG_ARG_LDOUBLE:
+            {
+              long double value;
+              args = syslog_deferred_get(args, &value, sizeof(value));
+              lib_sprintf(stream, spec, value);
+            }
+            break;
+#endif
+
+          default:
+            break;
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: syslog_deferred_emit
+ *
+ * Description:
+ *   Format one record and send it to the SYSLOG channels.
+ *
+ ****************************************************************************/
+
+static void syslog_deferred_emit(FAR const struct syslog_record_s *record)
+{
+  struct lib_syslogstream_s stream;
+
+  syslogstream_create(&stream);
+
+#ifdef CONFIG_SYSLOG_TIMESTAMP
+  syslog_header(&stream, record->dr_priority, record->dr_pid,
+                &record->dr_ts);
+#else
+  syslog_header(&stream, record->dr_priority, record->dr_pid, NULL);
+#endif
+
+  syslog_deferred_format(&stream.public, record->dr_fmt,
+                         (FAR const uint8_t *)record +
+                         SYSLOG_DEFERRED_HDRSIZE);
+  syslog_trailer(&stream);
+
+#ifdef CONFIG_SYSLOG_BUFFER
+  syslogstream_destroy(&stream);
+#endif
+}
+
+/****************************************************************************
+ * Name: syslog_deferred_worker
+ ****************************************************************************/
+
+static void syslog_deferred_worker(FAR void *arg)
+{
+  syslog_deferred_flush(false);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: syslog_deferred_add
+ *
+ * Description:
+ *   Record a SYSLOG message in the per-CPU deferred ring.  Only copies of
+ *   the format string and the argument values are saved; the message is
+ *   formatted and sent to the SYSLOG channels later by a low priority
+ *   worker.
+ *
+ * Input Parameters:
+ *   priority - The message priority
+ *   fmt      - The format string
+ *   ap       - The format arguments
+ *
+ * Returned Value:
+ *   Zero (OK) is returned if the message was recorded or dropped because
+ *   the ring is full.  A negated errno value is returned if the message
+ *   cannot be deferred and must be formatted synchronously by the caller.
+ *
+ ****************************************************************************/
+
+int syslog_deferred_add(int priority, FAR const IPTR char *fmt,
+                        FAR va_list *ap)
+{
+  uintptr_t args[SYSLOG_DEFERRED_ALIGNUP(CONFIG_SYSLOG_DEFERRED_ARGSIZE) /
+                 sizeof(uintptr_t)];
+  FAR struct syslog_ring_s *ring;
+  FAR struct syslog_record_s *record;
+  FAR char *copy;
+  irqstate_t flags;
+  ssize_t arglen;
+  size_t fmtlen;
+  size_t reclen;
+  size_t offset;
+  size_t head;
+  size_t pad;
+  size_t i;
+  va_list ap2;
+
+  /* Urgent messages, messages generated before the worker can run and
+   * messages emitted while the system is going down are formatted now.
+   */
+
+  if (priority <= CONFIG_SYSLOG_DEFERRED_SYNCPRIO || !OSINIT_OS_READY())
+    {
+      return -EAGAIN;
+    }
+
+  /* Capture the arguments.  Work on a copy of the argument list so that
+   * the caller can still format the message if this fails.
+   */
+
+  va_copy(ap2, *ap);
+  arglen = syslog_deferred_capture(fmt, ap2, (FAR uint8_t *)args,
+                                   sizeof(args));
+  va_end(ap2);
+
+  if (arglen < 0)
+    {
+      return arglen;
+    }
+
+  /* The format string is copied too, since the caller's may be gone by the
+   * time the worker runs.
+   */
+
+  for (fmtlen = 0; fmt[fmtlen] != '\0'; fmtlen++)
+    {
+      if (fmtlen >= CONFIG_SYSLOG_DEFERRED_FMTLEN)
+        {
+          return -E2BIG;
+        }
+    }
+
+  reclen = SYSLOG_DEFERRED_ALIGNUP(SYSLOG_DEFERRED_HDRSIZE + arglen +
+                                   fmtlen + 1);
+
+  /* Reserve space in this CPU's ring.  Nothing else writes to it while
+   * local interrupts are disabled.
+   */
+
+  flags = up_irq_save();
+  ring  = &g_syslog_rings[up_cpu_index()];
+  head  = ring->sr_head;
+
+  /* Records are contiguous, so skip the end of the buffer if the record
+   * does not fit there.
+   */
+
+  offset = SYSLOG_DEFERRED_OFFSET(head);
+  pad    = SYSLOG_DEFERRED_BUFSIZE - offset;
+  if (pad >= reclen)
+    {
+      pad = 0;
+    }
+
+  if (head + pad + reclen - ring->sr_tail > SYSLOG_DEFERRED_BUFSIZE)
+    {
+      ring->sr_dropped++;
+      up_irq_restore(flags);
+      return OK;
+    }
+
+  if (pad >= SYSLOG_DEFERRED_HDRSIZE)
+    {
+      record            = (FAR struct syslog_record_s *)
+                          ((FAR uint8_t *)ring->sr_buffer + offset);
+      record->dr_length = pad;
+      record->dr_fmt    = NULL;
+    }
+
+  offset = SYSLOG_DEFERRED_OFFSET(head + pad);
+  record = (FAR struct syslog_record_s *)
+           ((FAR uint8_t *)ring->sr_buffer + offset);
+
+  record->dr_length   = reclen;
+  record->dr_priority = priority;
+  record->dr_pid      = getpid();
+#ifdef CONFIG_SYSLOG_TIMESTAMP
+  syslog_gettime(&record->dr_ts);
+#endif
+
+  memcpy((FAR uint8_t *)record + SYSLOG_DEFERRED_HDRSIZE, args, arglen);
+
+  copy = (FAR char *)record + SYSLOG_DEFERRED_HDRSIZE + arglen;
+  for (i = 0; i <= fmtlen; i++)
+    {
+      copy[i] = fmt[i];
+    }
+
+  record->dr_fmt = copy;
+
+  /* Publish the record to the worker */
+
+  syslog_deferred_barrier();
+  ring->sr_head = head + pad + reclen;
+  up_irq_restore(flags);
+
+  /* Kick the worker unless it is already pending.  The delay lets more
+   * messages accumulate so that they are written out as one batch.
+   */
+
+  if (work_available(&g_syslog_work))
+    {
+      work_queue(LPWORK, &g_syslog_work, syslog_deferred_worker, NULL,
+                 MSEC2TICK(CONFIG_SYSLOG_DEFERRED_DELAY));
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: syslog_deferred_flush
+ *
+ * Description:
+ *   Format and output all messages pending in the deferred rings.  Called
+ *   by the worker and by crash-handling logic.
+ *
+ *   Only one consumer may drain the rings at a time.  This must not block
+ *   because it is also called from the crash path.  Normally, if another
+ *   consumer is already draining, this returns immediately and leaves the
+ *   messages to that consumer.  On the crash path that consumer may never
+ *   run again, so the rings are drained regardless; at worst the message
+ *   it was formatting is output twice.
+ *
+ * Input Parameters:
+ *   crash - True if called from crash-handling logic.
+ *
+ * Returned Value:
+ *   None.
+ *
+ ****************************************************************************/
+
+void syslog_deferred_flush(bool crash)
+{
+  FAR struct syslog_ring_s *ring;
+  FAR struct syslog_record_s *record;
+  irqstate_t flags;
+  uint32_t dropped;
+  size_t offset;
+  size_t tail;
+  bool owner;
+  int i;
+
+  flags = enter_critical_section();
+  if (g_syslog_draining && !crash)
+    {
+      leave_critical_section(flags);
+      return;
+    }
+
+  owner = !g_syslog_draining;
+  g_syslog_draining = true;
+  leave_critical_section(flags);
+
+  for (i = 0; i < SYSLOG_DEFERRED_NRINGS; i++)
+    {
+      ring = &g_syslog_rings[i];
+      tail = ring->sr_tail;
+
+      while (tail != ring->sr_head)
+        {
+          syslog_deferred_barrier();
+
+          offset = SYSLOG_DEFERRED_OFFSET(tail);
+          if (SYSLOG_DEFERRED_BUFSIZE - offset < SYSLOG_DEFERRED_HDRSIZE)
+            {
+              /* Too little room was left for even a padding record */
+
+              tail += SYSLOG_DEFERRED_BUFSIZE - offset;
+              continue;
+            }
+
+          record = (FAR struct syslog_record_s *)
+                   ((FAR uint8_t *)ring->sr_buffer + offset);
+          if (record->dr_fmt != NULL)
+            {
+              syslog_deferred_emit(record);
+            }
+
+          /* Release the space back to the producer */
+
+          tail += record->dr_length;
+          syslog_deferred_barrier();
+          ring->sr_tail = tail;
+        }
+
+      dropped = ring->sr_dropped;
+      if (dropped != ring->sr_reported)
+        {
+          struct lib_syslogstream_s stream;
+
+          syslogstream_create(&stream);
+          lib_sprintf(&stream.public,
+                      "syslog: CPU%d dropped %" PRIu32 " messages\n",
+                      i, dropped - ring->sr_reported);
+#ifdef CONFIG_SYSLOG_BUFFER
+          syslogstream_destroy(&stream);
+#endif
+          ring->sr_reported = dropped;
+        }
+    }
+
+  if (owner)
+    {
+      g_syslog_draining = false;
+    }
+}
+
+/****************************************************************************
+ * Name: syslog_deferred_dropped
+ *
+ * Description:
+ *   Return the total number of messages dropped because a deferred ring
+ *   was full.
+ *
+ ****************************************************************************/
+
+uint32_t syslog_deferred_dropped(void)
+{
+  uint32_t dropped = 0;
+  int i;
+
+  for (i = 0; i < SYSLOG_DEFERRED_NRINGS; i++)
+    {
+      dropped += g_syslog_rings[i].sr_dropped;
+    }
+
+  return dropped;
+}
+
+#endif /* CONFIG_SYSLOG_DEFERRED */
@@ -34,6 +34,8 @@
 #include <nuttx/streams.h>
 #include <nuttx/syslog/syslog.h>
 
+#include "syslog.h"
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
@@ -51,33 +53,17 @@ static FAR const char * g_priority_str[] =
  ****************************************************************************/
 
 /****************************************************************************
- * Name: nx_vsyslog
+ * Name: syslog_gettime
  *
  * Description:
- *   nx_vsyslog() handles the system logging system calls. It is functionally
- *   equivalent to vsyslog() except that (1) the per-process priority
- *   filtering has already been performed and the va_list parameter is
- *   passed by reference.  That is because the va_list is a structure in
- *   some compilers and passing of structures in the NuttX sycalls does
- *   not work.
+ *   Get the time used to stamp a SYSLOG message.
  *
  ****************************************************************************/
 
-int nx_vsyslog(int priority, FAR const IPTR char *fmt, FAR va_list *ap)
+#ifdef CONFIG_SYSLOG_TIMESTAMP
+void syslog_gettime(FAR struct timespec *ts)
 {
-  struct lib_syslogstream_s stream;
   int ret;
-#if CONFIG_TASK_NAME_SIZE > 0 && defined(CONFIG_SYSLOG_PROCESS_NAME)
-  struct tcb_s *tcb;
-#endif
-#if defined(CONFIG_SYSLOG_TIMESTAMP_FORMATTED)
-  time_t time;
-  struct tm tm;
-  char date_buf[CONFIG_SYSLOG_TIMESTAMP_BUFFER];
-#endif
-
-#ifdef CONFIG_SYSLOG_TIMESTAMP
-  struct timespec ts;
 
   /* Get the current time.  Since debug output may be generated very early
    * in the start-up sequence, hardware timer support may not yet be
@@ -90,19 +76,19 @@ int nx_vsyslog(int priority, FAR const IPTR char *fmt, FAR va_list *ap)
 #if defined(CONFIG_SYSLOG_TIMESTAMP_REALTIME)
       /* Use CLOCK_REALTIME if so configured */
 
-      ret = clock_gettime(CLOCK_REALTIME, &ts);
+      ret = clock_gettime(CLOCK_REALTIME, ts);
 
 #elif defined(CONFIG_CLOCK_MONOTONIC)
       /* Prefer monotonic when enabled, as it can be synchronized to
        * RTC with clock_resynchronize.
        */
 
-      ret = clock_gettime(CLOCK_MONOTONIC, &ts);
+      ret = clock_gettime(CLOCK_MONOTONIC, ts);
 
 #else
       /* Otherwise, fall back to the system timer */
 
-      ret = clock_systime_timespec(&ts);
+      ret = clock_systime_timespec(ts);
 #endif
     }
 
@@ -110,22 +96,49 @@ int nx_vsyslog(int priority, FAR const IPTR char *fmt, FAR va_list *ap)
     {
       /* Timer hardware is not available, or clock function failed */
 
-      ts.tv_sec  = 0;
-      ts.tv_nsec = 0;
+      ts->tv_sec  = 0;
+      ts->tv_nsec = 0;
     }
+}
 #endif
 
-  /* Wrap the low-level output in a stream object and let lib_vsprintf
-   * do the work.
-   */
+/****************************************************************************
+ * Name: syslog_header
+ *
+ * Description:
+ *   Emit the configured message prefix (timestamp, process ID, color,
+ *   priority, prefix string and process name) to the SYSLOG stream.
+ *
+ * Input Parameters:
+ *   stream   - The SYSLOG stream to write to
+ *   priority - The message priority
+ *   pid      - The ID of the task that generated the message
+ *   ts       - The time the message was generated (may be NULL if
+ *              CONFIG_SYSLOG_TIMESTAMP is not selected)
+ *
+ * Returned Value:
+ *   The number of characters emitted.
+ *
+ ****************************************************************************/
 
-  syslogstream_create(&stream);
+int syslog_header(FAR struct lib_syslogstream_s *stream, int priority,
+                  pid_t pid, FAR const struct timespec *ts)
+{
+  int ret;
+#if CONFIG_TASK_NAME_SIZE > 0 && defined(CONFIG_SYSLOG_PROCESS_NAME)
+  struct tcb_s *tcb;
+#endif
+#if defined(CONFIG_SYSLOG_TIMESTAMP_FORMATTED)
+  time_t time;
+  struct tm tm;
+  char date_buf[CONFIG_SYSLOG_TIMESTAMP_BUFFER];
+#endif
 
 #if defined(CONFIG_SYSLOG_TIMESTAMP)
   /* Prepend the message with the current time, if available */
 
 #if defined(CONFIG_SYSLOG_TIMESTAMP_FORMATTED)
-  time = ts.tv_sec;
+  time = ts->tv_sec;
 #if defined(CONFIG_SYSLOG_TIMESTAMP_LOCALTIME)
   localtime_r(&time, &tm);
 #else
@@ -137,11 +150,11 @@ int nx_vsyslog(int priority, FAR const IPTR char *fmt, FAR va_list *ap)
 
   if (ret > 0)
     {
-      ret = lib_sprintf(&stream.public, "[%s] ", date_buf);
+      ret = lib_sprintf(&stream->public, "[%s] ", date_buf);
     }
 #else
-  ret = lib_sprintf(&stream.public, "[%5jd.%06ld] ",
-                    (uintmax_t)ts.tv_sec, ts.tv_nsec / 1000);
+  ret = lib_sprintf(&stream->public, "[%5jd.%06ld] ",
+                    (uintmax_t)ts->tv_sec, ts->tv_nsec / 1000);
 #endif
 #else
   ret = 0;
@@ -150,7 +163,7 @@ int nx_vsyslog(int priority, FAR const IPTR char *fmt, FAR va_list *ap)
 #if defined(CONFIG_SYSLOG_PROCESSID)
   /* Prepend the Process ID */
 
-  ret += lib_sprintf(&stream.public, "[%2d] ", (int)getpid());
+  ret += lib_sprintf(&stream->public, "[%2d] ", (int)pid);
 #endif
 
 #if defined(CONFIG_SYSLOG_COLOR_OUTPUT)
@@ -159,34 +172,34 @@ int nx_vsyslog(int priority, FAR const IPTR char *fmt, FAR va_list *ap)
   switch (priority)
     {
       case LOG_EMERG:   /* Red, Bold, Blinking */
-        ret += lib_sprintf(&stream.public, "\e[31;1;5m");
+        ret += lib_sprintf(&stream->public, "\e[31;1;5m");
         break;
 
       case LOG_ALERT:   /* Red, Bold */
-        ret += lib_sprintf(&stream.public, "\e[31;1m");
+        ret += lib_sprintf(&stream->public, "\e[31;1m");
         break;
 
       case LOG_CRIT:    /* Red, Bold */
-        ret += lib_sprintf(&stream.public, "\e[31;1m");
+        ret += lib_sprintf(&stream->public, "\e[31;1m");
         break;
 
       case LOG_ERR:     /* Red */
-        ret += lib_sprintf(&stream.public, "\e[31m");
+        ret += lib_sprintf(&stream->public, "\e[31m");
         break;
 
       case LOG_WARNING: /* Yellow */
-        ret += lib_sprintf(&stream.public, "\e[33m");
+        ret += lib_sprintf(&stream->public, "\e[33m");
         break;
 
       case LOG_NOTICE:  /* Bold */
-        ret += lib_sprintf(&stream.public, "\e[1m");
+        ret += lib_sprintf(&stream->public, "\e[1m");
         break;
 
       case LOG_INFO:    /* Normal */
         break;
 
       case LOG_DEBUG:   /* Dim */
-        ret += lib_sprintf(&stream.public, "\e[2m");
+        ret += lib_sprintf(&stream->public, "\e[2m");
         break;
     }
 #endif
@@ -194,32 +207,102 @@ int nx_vsyslog(int priority, FAR const IPTR char *fmt, FAR va_list *ap)
 #if defined(CONFIG_SYSLOG_PRIORITY)
   /* Prepend the message priority. */
 
-  ret += lib_sprintf(&stream.public, "[%6s] ", g_priority_str[priority]);
+  ret += lib_sprintf(&stream->public, "[%6s] ", g_priority_str[priority]);
 #endif
 
 #if defined(CONFIG_SYSLOG_PREFIX)
   /* Prepend the prefix, if available */
 
-  ret += lib_sprintf(&stream.public, "%s", CONFIG_SYSLOG_PREFIX_STRING);
+  ret += lib_sprintf(&stream->public, "%s", CONFIG_SYSLOG_PREFIX_STRING);
 #endif
 
 #if CONFIG_TASK_NAME_SIZE > 0 && defined(CONFIG_SYSLOG_PROCESS_NAME)
-  /* Prepend the process name */
+  /* Prepend the process name.  A deferred message may outlive its task. */
 
-  tcb = nxsched_get_tcb(getpid());
-  ret += lib_sprintf(&stream.public, "%s: ", tcb->name);
+  tcb = nxsched_get_tcb(pid);
+  ret += lib_sprintf(&stream->public, "%s: ",
+                     tcb != NULL ? tcb->name : "???");
 #endif
 
-  /* Generate the output */
+  return ret;
+}
 
-  ret += lib_vsprintf(&stream.public, fmt, *ap);
+/****************************************************************************
+ * Name: syslog_trailer
+ *
+ * Description:
+ *   Emit the configured message suffix to the SYSLOG stream.
+ *
+ * Returned Value:
+ *   The number of characters emitted.
+ *
+ ****************************************************************************/
 
+int syslog_trailer(FAR struct lib_syslogstream_s *stream)
+{
 #if defined(CONFIG_SYSLOG_COLOR_OUTPUT)
   /* Reset the terminal style back to normal. */
 
-  ret += lib_sprintf(&stream.public, "\e[0m");
+  return lib_sprintf(&stream->public, "\e[0m");
+#else
+  return 0;
+#endif
+}
+
+/****************************************************************************
+ * Name: nx_vsyslog
+ *
+ * Description:
+ *   nx_vsyslog() handles the system logging system calls. It is functionally
+ *   equivalent to vsyslog() except that (1) the per-process priority
+ *   filtering has already been performed and the va_list parameter is
+ *   passed by reference.  That is because the va_list is a structure in
+ *   some compilers and passing of structures in the NuttX sycalls does
+ *   not work.
+ *
+ ****************************************************************************/
+
+int nx_vsyslog(int priority, FAR const IPTR char *fmt, FAR va_list *ap)
+{
+  struct lib_syslogstream_s stream;
+  int ret;
+#ifdef CONFIG_SYSLOG_TIMESTAMP
+  struct timespec ts;
+#endif
+
+#ifdef CONFIG_SYSLOG_DEFERRED
+  /* Record the format and arguments and let the worker format the message
+   * later, unless the message must go out immediately.
+   */
+
+  ret = syslog_deferred_add(priority, fmt, ap);
+  if (ret >= 0)
+    {
+      return ret;
+    }
+#endif
+
+#ifdef CONFIG_SYSLOG_TIMESTAMP
+  syslog_gettime(&ts);
 #endif
 
+  /* Wrap the low-level output in a stream object and let lib_vsprintf
+   * do the work.
+   */
+
+  syslogstream_create(&stream);
+
+#ifdef CONFIG_SYSLOG_TIMESTAMP
+  ret = syslog_header(&stream, priority, getpid(), &ts);
+#else
+  ret = syslog_header(&stream, priority, getpid(), NULL);
+#endif
+
+  /* Generate the output */
+
+  ret += lib_vsprintf(&stream.public, fmt, *ap);
+  ret += syslog_trailer(&stream);
+
 #ifdef CONFIG_SYSLOG_BUFFER
   /* Flush and destroy the syslog stream buffer */
 
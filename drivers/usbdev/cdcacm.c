@@ -310,23 +310,40 @@ static uint16_t cdcacm_fillrequest(FAR struct cdcacm_dev_s *priv,
   FAR struct uart_buffer_s *xmit = &serdev->xmit;
   irqstate_t flags;
   uint16_t nbytes = 0;
+  uint16_t ncopy;
 
   /* Disable interrupts */
 
   flags = enter_critical_section();
 
   /* Transfer bytes while we have bytes available and there is room in the
-   * request.
+   * request.  The TX buffer is circular, so this takes at most two copies.
    */
 
   while (xmit->head != xmit->tail && nbytes < reqlen)
     {
-      *reqbuf++ = xmit->buffer[xmit->tail];
-      nbytes++;
+      if (xmit->head > xmit->tail)
+        {
+          ncopy = xmit->head - xmit->tail;
+        }
+      else
+        {
+          ncopy = xmit->size - xmit->tail;
+        }
+
+      if (ncopy > reqlen - nbytes)
+        {
+          ncopy = reqlen - nbytes;
+        }
+
+      memcpy(reqbuf, &xmit->buffer[xmit->tail], ncopy);
+      reqbuf += ncopy;
+      nbytes += ncopy;
 
       /* Increment the tail pointer */
 
-      if (++(xmit->tail) >= xmit->size)
+      xmit->tail += ncopy;
+      if (xmit->tail >= xmit->size)
         {
           xmit->tail = 0;
         }
@@ -464,10 +481,15 @@ static int cdcacm_recvpacket(FAR struct cdcacm_dev_s *priv,
   FAR uint8_t *reqbuf;
 #ifdef CONFIG_SERIAL_IFLOWCONTROL_WATERMARKS
   unsigned int watermark;
+#endif
+#if defined(CONFIG_SERIAL_IFLOWCONTROL) && \
+    defined(CONFIG_SERIAL_IFLOWCONTROL_WATERMARKS)
+  unsigned int nbuffered;
 #endif
   uint16_t reqlen;
   uint16_t nexthead;
   uint16_t nbytes = 0;
+  uint16_t ncopy;
 
   DEBUGASSERT(priv != NULL && rdcontainer != NULL);
 
@@ -525,10 +547,26 @@ static int cdcacm_recvpacket(FAR struct cdcacm_dev_s *priv,
 
   while (nexthead != recv->tail && nbytes < reqlen)
     {
+      /* How much will fit contiguously at the head of the RX buffer?  One
+       * slot is always left empty to distinguish full from empty.
+       */
+
+      if (recv->tail > recv->head)
+        {
+          ncopy = recv->tail - recv->head - 1;
+        }
+      else
+        {
+          ncopy = recv->size - recv->head - (recv->tail == 0 ? 1 : 0);
+        }
+
+      if (ncopy > reqlen - nbytes)
+        {
+          ncopy = reqlen - nbytes;
+        }
+
 #if defined(CONFIG_SERIAL_IFLOWCONTROL) && \
     defined(CONFIG_SERIAL_IFLOWCONTROL_WATERMARKS)
-      unsigned int nbuffered;
-
       /* How many bytes are buffered */
 
       if (recv->head >= recv->tail)
@@ -555,17 +593,30 @@ static int cdcacm_recvpacket(FAR struct cdcacm_dev_s *priv,
               break;
             }
         }
+      else if (ncopy > watermark - nbuffered)
+        {
+          /* Stop at the watermark so that it is tested again */
+
+          ncopy = watermark - nbuffered;
+        }
 #endif
 
-      /* Copy one byte to the head of the circular RX buffer */
+      /* Copy to the head of the circular RX buffer */
 
-      recv->buffer[recv->head] = *reqbuf++;
-      nbytes++;
+      memcpy(&recv->buffer[recv->head], reqbuf, ncopy);
+      reqbuf += ncopy;
+      nbytes += ncopy;
 
       /* Increment the head index and check for wrap around */
 
-      recv->head = nexthead;
-      if (++nexthead >= recv->size)
+      recv->head += ncopy;
+      if (recv->head >= recv->size)
+        {
+          recv->head = 0;
+        }
+
+      nexthead = recv->head + 1;
+      if (nexthead >= recv->size)
         {
           nexthead = 0;
         }
@@ -628,11 +679,22 @@ static int cdcacm_requeue_rdrequest(FAR struct cdcacm_dev_s *priv,
   req      = rdcontainer->req;
   DEBUGASSERT(req != NULL);
 
-  /* Requeue the read request */
+  /* Requeue the read request.  Use a whole number of packets so that the
+   * request only completes early on a short packet.  By default this is a
+   * single packet:  the host does not send a ZLP after a transfer that
+   * fills the packets exactly, so a larger request could hold the data
+   * until more arrives (see CONFIG_CDCACM_BULKOUT_REQLEN).
+   */
 
   ep       = priv->epbulkout;
-  req->len = ep->maxpacket;
-  ret      = EP_SUBMIT(ep, req);
+  req->len = CONFIG_CDCACM_BULKOUT_REQLEN -
+             CONFIG_CDCACM_BULKOUT_REQLEN % ep->maxpacket;
+  if (req->len < ep->maxpacket)
+    {
+      req->len = ep->maxpacket;
+    }
+
+  ret = EP_SUBMIT(ep, req);
   if (ret != OK)
     {
       usbtrace(TRACE_CLSERROR(USBSER_TRACEERR_RDSUBMIT),
@@ -1380,7 +1442,9 @@ static int cdcacm_bind(FAR struct usbdevclass_driver_s *driver,
 
   priv->epbulkout->priv = priv;
 
-  /* Pre-allocate read requests.  The buffer size is one full packet. */
+  /* Pre-allocate read requests.  The buffer size is at least one full
+   * packet.
+   */
 
 #ifdef CONFIG_USBDEV_DUALSPEED
   reqlen = CONFIG_CDCACM_EPBULKOUT_HSSIZE;
@@ -1388,6 +1452,11 @@ static int cdcacm_bind(FAR struct usbdevclass_driver_s *driver,
   reqlen = CONFIG_CDCACM_EPBULKOUT_FSSIZE;
 #endif
 
+  if (CONFIG_CDCACM_BULKOUT_REQLEN > reqlen)
+    {
+      reqlen = CONFIG_CDCACM_BULKOUT_REQLEN;
+    }
+
   for (i = 0; i < CONFIG_CDCACM_NRDREQS; i++)
     {
       rdcontainer      = &priv->rdreqs[i];
@@ -48,6 +48,7 @@
 #include <nuttx/semaphore.h>
 #include <nuttx/net/arp.h>
 #include <nuttx/net/netdev.h>
+#include <nuttx/mm/iob.h>
 #include <nuttx/usb/usbdev.h>
 #include <nuttx/usb/cdc.h>
 #include <nuttx/usb/usbdev_trace.h>
@@ -86,6 +87,33 @@
 #  define CONFIG_CDCECM_NINTERFACES 1
 #endif
 
+/* The number of read and write requests, each holding one frame */
+
+#ifndef CONFIG_CDCECM_NRDREQS
+#  define CONFIG_CDCECM_NRDREQS 2
+#endif
+
+#ifndef CONFIG_CDCECM_NWRREQS
+#  define CONFIG_CDCECM_NWRREQS 2
+#endif
+
+/* The size of the buffer of one request */
+
+#define CDCECM_PKTBUFSIZE (CONFIG_NET_ETH_PKTSIZE + CONFIG_NET_GUARDSIZE)
+
+/* A whole frame must fit into one I/O buffer to be received into it */
+
+#ifdef CONFIG_CDCECM_IOB_RECV
+#  if CONFIG_IOB_BUFSIZE >= CDCECM_PKTBUFSIZE
+#    define cdcecm_iob_tryalloc() iob_tryalloc(true, IOBUSER_NET_CDCECM)
+#  elif defined(CONFIG_IOB_LARGE) && \
+        CONFIG_IOB_LARGEBUFSIZE >= CDCECM_PKTBUFSIZE
+#    define cdcecm_iob_tryalloc() iob_large_tryalloc(IOBUSER_NET_CDCECM)
+#  else
+#    error I/O buffers are too small to hold an Ethernet frame
+#  endif
+#endif
+
 /* TX poll delay = 1 seconds.
  * CLK_TCK is the number of clock ticks per second
  */
@@ -104,6 +132,26 @@
  * Private Types
  ****************************************************************************/
 
+/* Container to support a list of read requests */
+
+struct cdcecm_rdreq_s
+{
+  FAR struct cdcecm_rdreq_s   *flink;       /* Supports a singly linked list */
+  FAR struct usbdev_req_s     *req;         /* The contained request */
+#ifdef CONFIG_CDCECM_IOB_RECV
+  FAR struct iob_s            *iob;         /* I/O buffer holding req->buf */
+  FAR uint8_t                 *buf;         /* The request's own buffer */
+#endif
+};
+
+/* Container to support a list of write requests */
+
+struct cdcecm_wrreq_s
+{
+  FAR struct cdcecm_wrreq_s   *flink;       /* Supports a singly linked list */
+  FAR struct usbdev_req_s     *req;         /* The contained request */
+};
+
 /* The cdcecm_driver_s encapsulates all state information for a single
  * hardware interface
  */
@@ -123,11 +171,12 @@ struct cdcecm_driver_s
   uint8_t                      pktbuf[CONFIG_NET_ETH_PKTSIZE +
                                       CONFIG_NET_GUARDSIZE];
 
-  struct usbdev_req_s         *rdreq;       /* Single read request */
-  bool                         rxpending;   /* Packet available in rdreq */
+  struct cdcecm_rdreq_s        rdreqs[CONFIG_CDCECM_NRDREQS];
+  struct sq_queue_s            rxpending;   /* Completed read requests */
 
-  struct usbdev_req_s         *wrreq;       /* Single write request */
-  sem_t                        wrreq_idle;  /* Is the wrreq available? */
+  struct cdcecm_wrreq_s        wrreqs[CONFIG_CDCECM_NWRREQS];
+  struct sq_queue_s            txfree;      /* Available write requests */
+  sem_t                        wrreq_idle;  /* Counts the entries in txfree */
   bool                         txdone;      /* Did a write request complete? */
 
   /* Network device */
@@ -160,7 +209,11 @@ static int  cdcecm_txpoll(FAR struct net_driver_s *dev);
 /* Interrupt handling */
 
 static void cdcecm_reply(struct cdcecm_driver_s *priv);
-static void cdcecm_receive(FAR struct cdcecm_driver_s *priv);
+#ifdef CONFIG_CDCECM_IOB_RECV
+static void cdcecm_rdbuffer(FAR struct cdcecm_rdreq_s *rdcontainer);
+#endif
+static void cdcecm_receive(FAR struct cdcecm_driver_s *priv,
+                           FAR struct cdcecm_rdreq_s *rdcontainer);
 static void cdcecm_txdone(FAR struct cdcecm_driver_s *priv);
 
 static void cdcecm_interrupt_work(FAR void *arg);
@@ -301,7 +354,11 @@ static const struct usb_devdesc_s g_devdesc =
 
 static int cdcecm_transmit(FAR struct cdcecm_driver_s *self)
 {
-  /* Wait until the USB device request for Ethernet frame transmissions
+  FAR struct cdcecm_wrreq_s *wrcontainer;
+  FAR struct usbdev_req_s *req;
+  irqstate_t flags;
+
+  /* Wait until a USB device request for Ethernet frame transmissions
    * becomes available.
    */
 
@@ -309,16 +366,23 @@ static int cdcecm_transmit(FAR struct cdcecm_driver_s *self)
     {
     }
 
+  flags = enter_critical_section();
+  wrcontainer = (FAR struct cdcecm_wrreq_s *)sq_remfirst(&self->txfree);
+  leave_critical_section(flags);
+
+  DEBUGASSERT(wrcontainer != NULL);
+  req = wrcontainer->req;
+
   /* Increment statistics */
 
   NETDEV_TXPACKETS(self->dev);
 
   /* Send the packet: address=priv->dev.d_buf, length=priv->dev.d_len */
 
-  memcpy(self->wrreq->buf, self->dev.d_buf, self->dev.d_len);
-  self->wrreq->len = self->dev.d_len;
+  memcpy(req->buf, self->dev.d_buf, self->dev.d_len);
+  req->len = self->dev.d_len;
 
-  return EP_SUBMIT(self->epbulkin, self->wrreq);
+  return EP_SUBMIT(self->epbulkin, req);
 }
 
 /****************************************************************************
@@ -388,7 +452,10 @@ static int cdcecm_txpoll(FAR struct net_driver_s *dev)
            * not, return a non-zero value to terminate the poll.
            */
 
-          return 1;
+          if (sq_empty(&priv->txfree))
+            {
+              return 1;
+            }
         }
     }
 
@@ -456,6 +523,32 @@ static void cdcecm_reply(struct cdcecm_driver_s *priv)
     }
 }
 
+/****************************************************************************
+ * Name: cdcecm_rdbuffer
+ *
+ * Description:
+ *   Provide the buffer for the next frame received by a read request.  An
+ *   I/O buffer is used if one is available, otherwise the request's own
+ *   buffer.
+ *
+ * Input Parameters:
+ *   rdcontainer - The read request container
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_CDCECM_IOB_RECV
+static void cdcecm_rdbuffer(FAR struct cdcecm_rdreq_s *rdcontainer)
+{
+  FAR struct iob_s *iob = cdcecm_iob_tryalloc();
+
+  rdcontainer->iob      = iob;
+  rdcontainer->req->buf = iob != NULL ? iob->io_data : rdcontainer->buf;
+}
+#endif
+
 /****************************************************************************
  * Name: cdcecm_receive
  *
@@ -473,20 +566,30 @@ static void cdcecm_reply(struct cdcecm_driver_s *priv)
  *
  ****************************************************************************/
 
-static void cdcecm_receive(FAR struct cdcecm_driver_s *self)
+static void cdcecm_receive(FAR struct cdcecm_driver_s *self,
+                           FAR struct cdcecm_rdreq_s *rdcontainer)
 {
+  FAR struct usbdev_req_s *req = rdcontainer->req;
+
   /* Check for errors and update statistics */
 
   /* Check if the packet is a valid size for the network buffer
    * configuration.
    */
 
-  /* Copy the data data from the hardware to self->dev.d_buf.  Set
-   * amount of data in self->dev.d_len
+  /* Let the network work on the frame where it was received rather than
+   * copying it to self->pktbuf.  Any response is built in the same buffer
+   * and copied to a write request before the read request is requeued.
    */
 
-  memcpy(self->dev.d_buf, self->rdreq->buf, self->rdreq->xfrd);
-  self->dev.d_len = self->rdreq->xfrd;
+  self->dev.d_buf = req->buf;
+  self->dev.d_len = req->xfrd;
+
+#ifdef CONFIG_CDCECM_IOB_RECV
+  /* If the frame is in an I/O buffer, read-ahead may take it over */
+
+  self->dev.d_iob = rdcontainer->iob;
+#endif
 
 #ifdef CONFIG_NET_PKT
   /* When packet sockets are enabled, feed the frame into the tap */
@@ -553,6 +656,21 @@ static void cdcecm_receive(FAR struct cdcecm_driver_s *self)
     {
       NETDEV_RXDROPPED(&self->dev);
     }
+
+#ifdef CONFIG_CDCECM_IOB_RECV
+  if (rdcontainer->iob != NULL && self->dev.d_iob == NULL)
+    {
+      /* The network kept the I/O buffer.  Get another one for the next
+       * frame.
+       */
+
+      cdcecm_rdbuffer(rdcontainer);
+    }
+
+  self->dev.d_iob = NULL;
+#endif
+
+  self->dev.d_buf = self->pktbuf;
 }
 
 /****************************************************************************
@@ -603,6 +721,7 @@ static void cdcecm_txdone(FAR struct cdcecm_driver_s *priv)
 static void cdcecm_interrupt_work(FAR void *arg)
 {
   FAR struct cdcecm_driver_s *self = (FAR struct cdcecm_driver_s *)arg;
+  FAR struct cdcecm_rdreq_s *rdcontainer;
   irqstate_t flags;
 
   /* Lock the network and serialize driver operations if necessary.
@@ -613,15 +732,26 @@ static void cdcecm_interrupt_work(FAR void *arg)
 
   net_lock();
 
-  /* Check if we received an incoming packet, if so, call cdcecm_receive() */
+  /* Pass each received packet to cdcecm_receive() and requeue its read
+   * request.
+   */
 
-  if (self->rxpending)
+  for (; ; )
     {
-      cdcecm_receive(self);
+      flags = enter_critical_section();
+      rdcontainer = (FAR struct cdcecm_rdreq_s *)
+        sq_remfirst(&self->rxpending);
+      leave_critical_section(flags);
+
+      if (rdcontainer == NULL)
+        {
+          break;
+        }
+
+      cdcecm_receive(self, rdcontainer);
 
       flags = enter_critical_section();
-      self->rxpending = false;
-      EP_SUBMIT(self->epbulkout, self->rdreq);
+      EP_SUBMIT(self->epbulkout, rdcontainer->req);
       leave_critical_section(flags);
     }
 
@@ -663,7 +793,8 @@ static void cdcecm_poll_work(FAR void *arg)
 {
   FAR struct cdcecm_driver_s *self = (FAR struct cdcecm_driver_s *)arg;
 
-  ninfo("rxpending: %d, txdone: %d\n", self->rxpending, self->txdone);
+  ninfo("rxpending: %d, txdone: %d\n",
+        !sq_empty(&self->rxpending), self->txdone);
 
   /* Lock the network and serialize driver operations if necessary.
    * NOTE: Serialization is only required in the case where the driver work
@@ -1102,8 +1233,7 @@ static void cdcecm_rdcomplete(FAR struct usbdev_ep_s *ep,
     {
       case 0:  /* Normal completion */
         {
-          DEBUGASSERT(!self->rxpending);
-          self->rxpending = true;
+          sq_addlast((FAR sq_entry_t *)req->priv, &self->rxpending);
           work_queue(ETHWORK, &self->irqwork,
                      cdcecm_interrupt_work, self, 0);
         }
@@ -1115,7 +1245,7 @@ static void cdcecm_rdcomplete(FAR struct usbdev_ep_s *ep,
       default: /* Some other error occurred */
         {
           uerr("req->result: %hd\n", req->result);
-          EP_SUBMIT(self->epbulkout, self->rdreq);
+          EP_SUBMIT(self->epbulkout, req);
         }
         break;
     }
@@ -1134,15 +1264,20 @@ static void cdcecm_wrcomplete(FAR struct usbdev_ep_s *ep,
                               FAR struct usbdev_req_s *req)
 {
   FAR struct cdcecm_driver_s *self = (FAR struct cdcecm_driver_s *)ep->priv;
+  irqstate_t flags;
   int rc;
 
   uinfo("buf: %p, flags 0x%hhx, len %hu, xfrd %hu, result %hd\n",
         req->buf, req->flags, req->len, req->xfrd, req->result);
 
-  /* The single USB device write request is available for upcoming
-   * transmissions again.
+  /* The USB device write request is available for upcoming transmissions
+   * again.
    */
 
+  flags = enter_critical_section();
+  sq_addlast((FAR sq_entry_t *)req->priv, &self->txfree);
+  leave_critical_section(flags);
+
   rc = nxsem_post(&self->wrreq_idle);
 
   if (rc != OK)
@@ -1253,6 +1388,7 @@ static int cdcecm_setconfig(FAR struct cdcecm_driver_s *self, uint8_t config)
 {
   struct usb_epdesc_s epdesc;
   int ret = OK;
+  int i;
 
   if (config == self->config)
     {
@@ -1306,14 +1442,16 @@ static int cdcecm_setconfig(FAR struct cdcecm_driver_s *self, uint8_t config)
 
   /* Queue read requests in the bulk OUT endpoint */
 
-  DEBUGASSERT(!self->rxpending);
+  DEBUGASSERT(sq_empty(&self->rxpending));
 
-  self->rdreq->callback = cdcecm_rdcomplete,
-  ret = EP_SUBMIT(self->epbulkout, self->rdreq);
-  if (ret != OK)
+  for (i = 0; i < CONFIG_CDCECM_NRDREQS; i++)
     {
-      uerr("EP_SUBMIT failed. ret %d\n", ret);
-      goto error;
+      ret = EP_SUBMIT(self->epbulkout, self->rdreqs[i].req);
+      if (ret != OK)
+        {
+          uerr("EP_SUBMIT failed. ret %d\n", ret);
+          goto error;
+        }
     }
 
   /* We are successfully configured */
@@ -1790,7 +1928,10 @@ static int cdcecm_bind(FAR struct usbdevclass_driver_s *driver,
                        FAR struct usbdev_s *dev)
 {
   FAR struct cdcecm_driver_s *self = (FAR struct cdcecm_driver_s *)driver;
+  FAR struct cdcecm_rdreq_s *rdcontainer;
+  FAR struct cdcecm_wrreq_s *wrcontainer;
   int ret = OK;
+  int i;
 
   uinfo("\n");
 
@@ -1834,33 +1975,50 @@ static int cdcecm_bind(FAR struct usbdevclass_driver_s *driver,
 
   /* Pre-allocate read requests.  The buffer size is one full packet. */
 
-  self->rdreq = cdcecm_allocreq(self->epbulkout,
-                  CONFIG_NET_ETH_PKTSIZE + CONFIG_NET_GUARDSIZE);
-  if (self->rdreq == NULL)
+  for (i = 0; i < CONFIG_CDCECM_NRDREQS; i++)
     {
-      uerr("Out of memory\n");
-      ret = -ENOMEM;
-      goto error;
-    }
+      rdcontainer      = &self->rdreqs[i];
+      rdcontainer->req = cdcecm_allocreq(self->epbulkout,
+                                         CDCECM_PKTBUFSIZE);
+      if (rdcontainer->req == NULL)
+        {
+          uerr("Out of memory\n");
+          ret = -ENOMEM;
+          goto error;
+        }
+
+      rdcontainer->req->priv     = rdcontainer;
+      rdcontainer->req->callback = cdcecm_rdcomplete;
 
-  self->rdreq->callback = cdcecm_rdcomplete;
+#ifdef CONFIG_CDCECM_IOB_RECV
+      rdcontainer->buf = rdcontainer->req->buf;
+      cdcecm_rdbuffer(rdcontainer);
+#endif
+    }
 
-  /* Pre-allocate a single write request.  Buffer size is one full packet. */
+  /* Pre-allocate write requests.  Buffer size is one full packet. */
 
-  self->wrreq = cdcecm_allocreq(self->epbulkin,
-                  CONFIG_NET_ETH_PKTSIZE + CONFIG_NET_GUARDSIZE);
-  if (self->wrreq == NULL)
+  sq_init(&self->txfree);
+  for (i = 0; i < CONFIG_CDCECM_NWRREQS; i++)
     {
-      uerr("Out of memory\n");
-      ret = -ENOMEM;
-      goto error;
-    }
+      wrcontainer      = &self->wrreqs[i];
+      wrcontainer->req = cdcecm_allocreq(self->epbulkin,
+                                         CDCECM_PKTBUFSIZE);
+      if (wrcontainer->req == NULL)
+        {
+          uerr("Out of memory\n");
+          ret = -ENOMEM;
+          goto error;
+        }
 
-  self->wrreq->callback = cdcecm_wrcomplete;
+      wrcontainer->req->priv     = wrcontainer;
+      wrcontainer->req->callback = cdcecm_wrcomplete;
+      sq_addlast((FAR sq_entry_t *)wrcontainer, &self->txfree);
+    }
 
-  /* The single write request just allocated is available now. */
+  /* The write requests just allocated are available now. */
 
-  ret = nxsem_init(&self->wrreq_idle, 0, 1);
+  ret = nxsem_init(&self->wrreq_idle, 0, CONFIG_CDCECM_NWRREQS);
 
   if (ret != OK)
     {
@@ -1894,6 +2052,9 @@ static void cdcecm_unbind(FAR struct usbdevclass_driver_s *driver,
                           FAR struct usbdev_s *dev)
 {
   FAR struct cdcecm_driver_s *self = (FAR struct cdcecm_driver_s *)driver;
+  FAR struct cdcecm_rdreq_s *rdcontainer;
+  FAR struct cdcecm_wrreq_s *wrcontainer;
+  int i;
 
 #ifdef CONFIG_DEBUG_FEATURES
   if (!driver || !dev)
@@ -1933,12 +2094,27 @@ static void cdcecm_unbind(FAR struct usbdevclass_driver_s *driver,
    * been returned to the free list at this time -- we don't check)
    */
 
-  if (self->rdreq != NULL)
+  for (i = 0; i < CONFIG_CDCECM_NRDREQS; i++)
     {
-      cdcecm_freereq(self->epbulkout, self->rdreq);
-      self->rdreq = NULL;
+      rdcontainer = &self->rdreqs[i];
+      if (rdcontainer->req != NULL)
+        {
+#ifdef CONFIG_CDCECM_IOB_RECV
+          if (rdcontainer->iob != NULL)
+            {
+              iob_free(rdcontainer->iob, IOBUSER_NET_CDCECM);
+              rdcontainer->iob      = NULL;
+              rdcontainer->req->buf = rdcontainer->buf;
+            }
+#endif
+
+          cdcecm_freereq(self->epbulkout, rdcontainer->req);
+          rdcontainer->req = NULL;
+        }
     }
 
+  sq_init(&self->rxpending);
+
   /* Free the bulk OUT endpoint */
 
   if (self->epbulkout)
@@ -1951,12 +2127,18 @@ static void cdcecm_unbind(FAR struct usbdevclass_driver_s *driver,
    * of them)
    */
 
-  if (self->wrreq != NULL)
+  for (i = 0; i < CONFIG_CDCECM_NWRREQS; i++)
     {
-      cdcecm_freereq(self->epbulkin, self->wrreq);
-      self->wrreq = NULL;
+      wrcontainer = &self->wrreqs[i];
+      if (wrcontainer->req != NULL)
+        {
+          cdcecm_freereq(self->epbulkin, wrcontainer->req);
+          wrcontainer->req = NULL;
+        }
     }
 
+  sq_init(&self->txfree);
+
   /* Free the bulk IN endpoint */
 
   if (self->epbulkin)
@@ -26,6 +26,8 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <stdbool.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include <nuttx/fs/dirent.h>
@@ -40,6 +42,20 @@
 #include "littlefs/lfs.h"
 #include "littlefs/lfs_util.h"
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_FS_LITTLEFS_READAHEAD
+#  define CONFIG_FS_LITTLEFS_READAHEAD 0
+#endif
+
+/* Mount options, as in "mount -t littlefs -o autoformat,cache_size=1024" */
+
+#define LITTLEFS_FORMAT_NONE   0  /* Only mount an existing filesystem */
+#define LITTLEFS_FORMAT_FORCE  1  /* -o forceformat */
+#define LITTLEFS_FORMAT_AUTO   2  /* -o autoformat */
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -62,6 +78,17 @@ struct littlefs_mountpt_s
   struct mtd_geometry_s geo;
   struct lfs_config     cfg;
   struct lfs            lfs;
+
+  /* Read-ahead cache, in units of device blocks.  rabuf holds racount
+   * blocks beginning at rastart.  ranext is the block following the last
+   * read and is used to detect sequential access.
+   */
+
+  FAR uint8_t          *rabuf;
+  size_t                rablocks;
+  off_t                 rastart;
+  size_t                racount;
+  off_t                 ranext;
 };
 
 /****************************************************************************
@@ -829,38 +856,108 @@ static int littlefs_rewinddir(FAR struct inode *mountpt,
 }
 
 /****************************************************************************
- * Name: littlefs_bind
+ * Name: littlefs_bread
  *
- * Description: This implements a portion of the mount operation. This
- *  function allocates and initializes the mountpoint private data and
- *  binds the driver inode to the filesystem private data. The final
- *  binding of the private data (containing the driver) to the
- *  mountpoint is performed by mount().
+ * Description: Read device blocks directly from the driver.
  *
  ****************************************************************************/
 
+static int littlefs_bread(FAR struct littlefs_mountpt_s *fs, off_t block,
+                          size_t nblocks, FAR uint8_t *buffer)
+{
+  FAR struct inode *drv = fs->drv;
+  int ret;
+
+  if (INODE_IS_MTD(drv))
+    {
+      ret = MTD_BREAD(drv->u.i_mtd, block, nblocks, buffer);
+    }
+  else
+    {
+      ret = drv->u.i_bops->read(drv, buffer, block, nblocks);
+    }
+
+  return ret >= 0 ? OK : ret;
+}
+
+/****************************************************************************
+ * Name: littlefs_rainvalidate
+ *
+ * Description: Drop the read-ahead cache if it overlaps the device blocks
+ *  that are about to be written or erased.
+ *
+ ****************************************************************************/
+
+static void littlefs_rainvalidate(FAR struct littlefs_mountpt_s *fs,
+                                  off_t block, size_t nblocks)
+{
+  if (fs->racount > 0 && block < fs->rastart + fs->racount &&
+      fs->rastart < block + nblocks)
+    {
+      fs->racount = 0;
+    }
+}
+
+/****************************************************************************
+ * Name: littlefs_read_block
+ ****************************************************************************/
+
 static int littlefs_read_block(FAR const struct lfs_config *c,
                                lfs_block_t block, lfs_off_t off,
                                FAR void *buffer, lfs_size_t size)
 {
   FAR struct littlefs_mountpt_s *fs = c->context;
   FAR struct mtd_geometry_s *geo = &fs->geo;
-  FAR struct inode *drv = fs->drv;
+  off_t start;
+  size_t nblocks;
+  size_t count;
   int ret;
 
-  block = (block * c->block_size + off) / geo->blocksize;
-  size  = size / geo->blocksize;
+  start   = ((off_t)block * c->block_size + off) / geo->blocksize;
+  nblocks = size / geo->blocksize;
 
-  if (INODE_IS_MTD(drv))
+  /* Serve the read from the read-ahead cache if it holds all of it */
+
+  if (fs->racount > 0 && start >= fs->rastart &&
+      start + nblocks <= fs->rastart + fs->racount)
     {
-      ret = MTD_BREAD(drv->u.i_mtd, block, size, buffer);
+      memcpy(buffer, fs->rabuf + (start - fs->rastart) * geo->blocksize,
+             size);
+      fs->ranext = start + nblocks;
+      return OK;
     }
-  else
+
+  /* Random and large reads go straight to the driver.  Only a read that
+   * continues where the previous one ended refills the cache.
+   */
+
+  if (fs->rabuf == NULL || nblocks >= fs->rablocks || start != fs->ranext)
     {
-      ret = drv->u.i_bops->read(drv, buffer, block, size);
+      fs->ranext = start + nblocks;
+      return littlefs_bread(fs, start, nblocks, buffer);
     }
 
-  return ret >= 0 ? OK : ret;
+  count = fs->rablocks;
+  if (start + count > (off_t)c->block_count * c->block_size /
+                      geo->blocksize)
+    {
+      count = (off_t)c->block_count * c->block_size / geo->blocksize -
+              start;
+    }
+
+  fs->racount = 0;
+  ret = littlefs_bread(fs, start, count, fs->rabuf);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  fs->rastart = start;
+  fs->racount = count;
+  fs->ranext  = start + nblocks;
+
+  memcpy(buffer, fs->rabuf, size);
+  return OK;
 }
 
 /****************************************************************************
@@ -879,6 +976,8 @@ static int littlefs_write_block(FAR const struct lfs_config *c,
   block = (block * c->block_size + off) / geo->blocksize;
   size  = size / geo->blocksize;
 
+  littlefs_rainvalidate(fs, block, size);
+
   if (INODE_IS_MTD(drv))
     {
       ret = MTD_BWRITE(drv->u.i_mtd, block, size, buffer);
@@ -902,6 +1001,10 @@ static int littlefs_erase_block(FAR const struct lfs_config *c,
   FAR struct inode *drv = fs->drv;
   int ret = OK;
 
+  littlefs_rainvalidate(fs, (off_t)block * c->block_size /
+                        fs->geo.blocksize,
+                        c->block_size / fs->geo.blocksize);
+
   if (INODE_IS_MTD(drv))
     {
       FAR struct mtd_geometry_s *geo = &fs->geo;
@@ -936,14 +1039,132 @@ static int littlefs_sync_block(FAR const struct lfs_config *c)
   return ret == -ENOTTY ? OK : ret;
 }
 
+/****************************************************************************
+ * Name: littlefs_optval
+ *
+ * Description: Check if the mount option of length len is "name=<value>"
+ *  and, if so, return the value.
+ *
+ ****************************************************************************/
+
+static bool littlefs_optval(FAR const char *opt, size_t len,
+                            FAR const char *name, FAR lfs_size_t *value)
+{
+  size_t namelen = strlen(name);
+  FAR char *end;
+
+  if (len <= namelen + 1 || strncmp(opt, name, namelen) != 0 ||
+      opt[namelen] != '=')
+    {
+      return false;
+    }
+
+  *value = strtoul(&opt[namelen + 1], &end, 0);
+  return end == opt + len;
+}
+
+/****************************************************************************
+ * Name: littlefs_parse_options
+ *
+ * Description: Parse the comma separated mount options, overriding the
+ *  default littlefs configuration, and validate the result.
+ *
+ ****************************************************************************/
+
+static int littlefs_parse_options(FAR struct littlefs_mountpt_s *fs,
+                                  FAR const char *data, FAR int *format)
+{
+  FAR struct lfs_config *cfg = &fs->cfg;
+  FAR const char *opt = data;
+  FAR const char *end;
+  lfs_size_t value;
+  size_t len;
+
+  *format = LITTLEFS_FORMAT_NONE;
+
+  while (opt != NULL && *opt != '\0')
+    {
+      end = strchr(opt, ',');
+      len = end != NULL ? end - opt : strlen(opt);
+
+      if (len == 11 && strncmp(opt, "forceformat", 11) == 0)
+        {
+          *format = LITTLEFS_FORMAT_FORCE;
+        }
+      else if (len == 10 && strncmp(opt, "autoformat", 10) == 0)
+        {
+          *format = LITTLEFS_FORMAT_AUTO;
+        }
+      else if (littlefs_optval(opt, len, "cache_size", &value))
+        {
+          cfg->cache_size = value;
+        }
+      else if (littlefs_optval(opt, len, "lookahead_size", &value))
+        {
+          cfg->lookahead_size = value;
+        }
+      else if (littlefs_optval(opt, len, "prog_size", &value))
+        {
+          cfg->prog_size = value;
+        }
+      else if (littlefs_optval(opt, len, "readahead", &value))
+        {
+          fs->rablocks = value;
+        }
+      else if (len > 0)
+        {
+          ferr("ERROR: Bad mount option: %.*s\n", (int)len, opt);
+          return -EINVAL;
+        }
+
+      opt = end != NULL ? end + 1 : NULL;
+    }
+
+  /* Reads and programs are issued in whole device blocks and littlefs
+   * requires the caches to hold whole reads and programs and to divide
+   * the erase block.
+   */
+
+  if (cfg->prog_size == 0 || cfg->prog_size % fs->geo.blocksize != 0 ||
+      cfg->block_size % cfg->prog_size != 0 ||
+      cfg->cache_size == 0 || cfg->cache_size % cfg->read_size != 0 ||
+      cfg->cache_size % cfg->prog_size != 0 ||
+      cfg->block_size % cfg->cache_size != 0 ||
+      cfg->lookahead_size == 0 || cfg->lookahead_size % 8 != 0)
+    {
+      ferr("ERROR: Bad prog_size %lu cache_size %lu lookahead_size %lu\n",
+           (unsigned long)cfg->prog_size, (unsigned long)cfg->cache_size,
+           (unsigned long)cfg->lookahead_size);
+      return -EINVAL;
+    }
+
+  return OK;
+}
+
 /****************************************************************************
  * Name: littlefs_bind
+ *
+ * Description: This implements a portion of the mount operation. This
+ *  function allocates and initializes the mountpoint private data and
+ *  binds the driver inode to the filesystem private data. The final
+ *  binding of the private data (containing the driver) to the
+ *  mountpoint is performed by mount().
+ *
+ *  The mount options are a comma separated list of:
+ *    forceformat          - Format the device before mounting it
+ *    autoformat           - Format the device if it cannot be mounted
+ *    cache_size=<bytes>   - Size of the littlefs read and program caches
+ *    lookahead_size=<n>   - Size of the block allocator lookahead buffer
+ *    prog_size=<bytes>    - Minimum size of a program operation
+ *    readahead=<blocks>   - Device blocks read ahead on sequential reads
+ *
  ****************************************************************************/
 
 static int littlefs_bind(FAR struct inode *driver, FAR const void *data,
                          FAR void **handle)
 {
   FAR struct littlefs_mountpt_s *fs;
+  int format;
   int ret;
 
   /* Open the block driver */
@@ -1025,6 +1246,27 @@ static int littlefs_bind(FAR struct inode *driver, FAR const void *data,
   fs->cfg.cache_size     = fs->geo.blocksize;
   fs->cfg.lookahead_size = lfs_min(lfs_alignup(fs->cfg.block_count, 64) / 8,
                                    fs->cfg.read_size);
+  fs->rablocks           = CONFIG_FS_LITTLEFS_READAHEAD;
+
+  /* Apply any overrides from the mount options */
+
+  ret = littlefs_parse_options(fs, data, &format);
+  if (ret < 0)
+    {
+      goto errout_with_fs;
+    }
+
+  /* Allocate the read-ahead cache shared by all files on this mountpoint */
+
+  if (fs->rablocks > 1)
+    {
+      fs->rabuf = kmm_malloc(fs->rablocks * fs->geo.blocksize);
+      if (fs->rabuf == NULL)
+        {
+          ret = -ENOMEM;
+          goto errout_with_fs;
+        }
+    }
 
   /* Then get information about the littlefs filesystem on the devices
    * managed by this driver.
@@ -1032,7 +1274,7 @@ static int littlefs_bind(FAR struct inode *driver, FAR const void *data,
 
   /* Force format the device if -o forceformat */
 
-  if (data && strcmp(data, "forceformat") == 0)
+  if (format == LITTLEFS_FORMAT_FORCE)
     {
       ret = lfs_format(&fs->lfs, &fs->cfg);
       if (ret < 0)
@@ -1046,8 +1288,7 @@ static int littlefs_bind(FAR struct inode *driver, FAR const void *data,
     {
       /* Auto format the device if -o autoformat */
 
-      if (ret != LFS_ERR_CORRUPT ||
-          !data || strcmp(data, "autoformat"))
+      if (ret != LFS_ERR_CORRUPT || format != LITTLEFS_FORMAT_AUTO)
         {
           goto errout_with_fs;
         }
@@ -1072,6 +1313,11 @@ static int littlefs_bind(FAR struct inode *driver, FAR const void *data,
   return OK;
 
 errout_with_fs:
+  if (fs->rabuf != NULL)
+    {
+      kmm_free(fs->rabuf);
+    }
+
   nxsem_destroy(&fs->sem);
   kmm_free(fs);
 errout_with_block:
@@ -1131,6 +1377,11 @@ static int littlefs_unbind(FAR void *handle, FAR struct inode **driver,
 
       /* Release the mountpoint private data */
 
+      if (fs->rabuf != NULL)
+        {
+          kmm_free(fs->rabuf);
+        }
+
       nxsem_destroy(&fs->sem);
       kmm_free(fs);
     }
@@ -241,6 +241,19 @@ struct nxffs_blkentry_s
   uint16_t                  foffset;  /* Offset to start of data */
 };
 
+/* One entry of the in-memory inode index.  The index holds one entry for
+ * each valid inode on the volume, ordered by the FLASH offset of the inode
+ * header.
+ */
+
+#ifdef CONFIG_NXFFS_INDEX
+struct nxffs_ixent_s
+{
+  off_t                     hoffset;  /* FLASH offset to the inode header */
+  uint32_t                  hash;     /* CRC32 of the inode name */
+};
+#endif
+
 /* This structure describes the state of one open file.  This structure
  * is protected by the volume semaphore.
  */
@@ -287,6 +300,12 @@ struct nxffs_volume_s
   FAR struct nxffs_ofile_s *ofiles;    /* A singly-linked list of open files */
   FAR uint8_t              *cache;     /* On cached erase block for general I/O */
   FAR uint8_t              *pack;      /* A full erase block to support packing */
+#ifdef CONFIG_NXFFS_INDEX
+  FAR struct nxffs_ixent_s *index;     /* Inode index ordered by FLASH offset */
+  unsigned int              nindex;    /* Number of entries in the index */
+  unsigned int              ixalloc;   /* Allocated size of the index */
+  bool                      ixvalid;   /* The index describes every inode */
+#endif
 };
 
 /* This structure describes the state of the blocks on the NXFFS volume */
@@ -1068,6 +1087,166 @@ int nxffs_rminode(FAR struct nxffs_volume_s *volume, FAR const char *name);
 
 int nxffs_pack(FAR struct nxffs_volume_s *volume);
 
+/****************************************************************************
+ * Name: nxffs_ixreset
+ *
+ * Description:
+ *   Empty the inode index and mark it valid.  Called before the inodes are
+ *   enumerated at mount time and when the volume is reformatted.
+ *
+ * Input Parameters:
+ *   volume - Describes the NXFFS volume
+ *
+ * Returned Value:
+ *   None
+ *
+ * Defined in nxffs_index.c
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXFFS_INDEX
+void nxffs_ixreset(FAR struct nxffs_volume_s *volume);
+#endif
+
+/****************************************************************************
+ * Name: nxffs_ixinvalidate
+ *
+ * Description:
+ *   Discard the inode index.  Lookups fall back to scanning the FLASH until
+ *   the volume is mounted again.
+ *
+ * Input Parameters:
+ *   volume - Describes the NXFFS volume
+ *
+ * Returned Value:
+ *   None
+ *
+ * Defined in nxffs_index.c
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXFFS_INDEX
+void nxffs_ixinvalidate(FAR struct nxffs_volume_s *volume);
+#endif
+
+/****************************************************************************
+ * Name: nxffs_ixinsert
+ *
+ * Description:
+ *   Add a newly written inode to the inode index.  If the index cannot be
+ *   grown, it is invalidated.
+ *
+ * Input Parameters:
+ *   volume  - Describes the NXFFS volume
+ *   name    - The name of the inode
+ *   hoffset - FLASH offset to the inode header
+ *
+ * Returned Value:
+ *   None
+ *
+ * Defined in nxffs_index.c
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXFFS_INDEX
+void nxffs_ixinsert(FAR struct nxffs_volume_s *volume, FAR const char *name,
+                    off_t hoffset);
+#endif
+
+/****************************************************************************
+ * Name: nxffs_ixremove
+ *
+ * Description:
+ *   Remove a deleted inode from the inode index.
+ *
+ * Input Parameters:
+ *   volume  - Describes the NXFFS volume
+ *   hoffset - FLASH offset to the inode header
+ *
+ * Returned Value:
+ *   None
+ *
+ * Defined in nxffs_index.c
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXFFS_INDEX
+void nxffs_ixremove(FAR struct nxffs_volume_s *volume, off_t hoffset);
+#endif
+
+/****************************************************************************
+ * Name: nxffs_ixmove
+ *
+ * Description:
+ *   Record that packing moved an inode header.  Packing only moves inodes
+ *   toward the beginning of FLASH and in order, so the index stays sorted.
+ *
+ * Input Parameters:
+ *   volume    - Describes the NXFFS volume
+ *   oldoffset - Previous FLASH offset to the inode header
+ *   newoffset - New FLASH offset to the inode header
+ *
+ * Returned Value:
+ *   None
+ *
+ * Defined in nxffs_index.c
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXFFS_INDEX
+void nxffs_ixmove(FAR struct nxffs_volume_s *volume, off_t oldoffset,
+                  off_t newoffset);
+#endif
+
+/****************************************************************************
+ * Name: nxffs_ixfind
+ *
+ * Description:
+ *   Use the inode index to find the inode with the provided name.  Only
+ *   the inodes whose name hash matches are read from FLASH.
+ *
+ * Input Parameters:
+ *   volume - Describes the NXFFS volume
+ *   name   - The name of the inode to find
+ *   entry  - The location to return information about the inode.
+ *
+ * Returned Value:
+ *   Zero is returned on success.  -ENOENT is returned if there is no such
+ *   inode.  -ENOSYS is returned if the index is not valid and the caller
+ *   must scan the FLASH instead.
+ *
+ * Defined in nxffs_index.c
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXFFS_INDEX
+int nxffs_ixfind(FAR struct nxffs_volume_s *volume, FAR const char *name,
+                 FAR struct nxffs_entry_s *entry);
+#endif
+
+/****************************************************************************
+ * Name: nxffs_ixnext
+ *
+ * Description:
+ *   Return the FLASH offset of the first valid inode header at or after
+ *   the provided offset.
+ *
+ * Input Parameters:
+ *   volume - Describes the NXFFS volume
+ *   offset - The FLASH offset to begin searching.
+ *
+ * Returned Value:
+ *   The offset of the inode header.  -ENOENT is returned if there are no
+ *   more inodes and -ENOSYS if the index is not valid.
+ *
+ * Defined in nxffs_index.c
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXFFS_INDEX
+off_t nxffs_ixnext(FAR struct nxffs_volume_s *volume, off_t offset);
+#endif
+
 /****************************************************************************
  * Standard mountpoint operation methods
  *
@@ -102,6 +102,9 @@ int nxffs_readdir(FAR struct inode *mountpt, FAR struct fs_dirent_s *dir)
   FAR struct nxffs_volume_s *volume;
   FAR struct nxffs_entry_s entry;
   off_t offset;
+#ifdef CONFIG_NXFFS_INDEX
+  off_t next;
+#endif
   int ret;
 
   /* Sanity checks */
@@ -120,6 +123,24 @@ int nxffs_readdir(FAR struct inode *mountpt, FAR struct fs_dirent_s *dir)
   /* Read the next inode header from the offset */
 
   offset = dir->u.nxffs.nx_offset;
+
+#ifdef CONFIG_NXFFS_INDEX
+  /* The inode index knows where the next inode header is, so there is no
+   * need to search through the file data for it.
+   */
+
+  next = nxffs_ixnext(volume, offset);
+  if (next == -ENOENT)
+    {
+      ret = -ENOENT;
+      goto errout_with_lock;
+    }
+  else if (next >= 0)
+    {
+      offset = next;
+    }
+#endif
+
   ret = nxffs_nextentry(volume, offset, &entry);
 
   /* If the read was successful, then handle the reported inode.  Note
@@ -142,6 +163,9 @@ int nxffs_readdir(FAR struct inode *mountpt, FAR struct fs_dirent_s *dir)
       ret = OK;
     }
 
+#ifdef CONFIG_NXFFS_INDEX
+errout_with_lock:
+#endif
   nxsem_post(&volume->exclsem);
 
 errout:
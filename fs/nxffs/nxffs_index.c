@@ -0,0 +1,390 @@
+/****************************************************************************
+ * fs/nxffs/nxffs_index.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <string.h>
+#include <crc32.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/kmalloc.h>
+
+#include "nxffs.h"
+
+#ifdef CONFIG_NXFFS_INDEX
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The index grows by this many entries at a time */
+
+#define NXFFS_IXINCR 16
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxffs_ixhash
+ *
+ * Description:
+ *   Return the hash of an inode name.
+ *
+ ****************************************************************************/
+
+static uint32_t nxffs_ixhash(FAR const char *name)
+{
+  return crc32((FAR const uint8_t *)name, strlen(name));
+}
+
+/****************************************************************************
+ * Name: nxffs_ixsearch
+ *
+ * Description:
+ *   Return the position of the first index entry whose inode header lies
+ *   at or after the provided FLASH offset.
+ *
+ ****************************************************************************/
+
+static unsigned int nxffs_ixsearch(FAR struct nxffs_volume_s *volume,
+                                   off_t offset)
+{
+  unsigned int low = 0;
+  unsigned int high = volume->nindex;
+  unsigned int mid;
+
+  while (low < high)
+    {
+      mid = (low + high) >> 1;
+      if (volume->index[mid].hoffset < offset)
+        {
+          low = mid + 1;
+        }
+      else
+        {
+          high = mid;
+        }
+    }
+
+  return low;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxffs_ixreset
+ *
+ * Description:
+ *   Empty the inode index and mark it valid.  Called before the inodes are
+ *   enumerated at mount time and when the volume is reformatted.
+ *
+ * Input Parameters:
+ *   volume - Describes the NXFFS volume
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void nxffs_ixreset(FAR struct nxffs_volume_s *volume)
+{
+  volume->nindex  = 0;
+  volume->ixvalid = true;
+}
+
+/****************************************************************************
+ * Name: nxffs_ixinvalidate
+ *
+ * Description:
+ *   Discard the inode index.  Lookups fall back to scanning the FLASH until
+ *   the volume is mounted again.
+ *
+ * Input Parameters:
+ *   volume - Describes the NXFFS volume
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void nxffs_ixinvalidate(FAR struct nxffs_volume_s *volume)
+{
+  if (volume->index != NULL)
+    {
+      kmm_free(volume->index);
+      volume->index = NULL;
+    }
+
+  volume->nindex  = 0;
+  volume->ixalloc = 0;
+  volume->ixvalid = false;
+}
+
+/****************************************************************************
+ * Name: nxffs_ixinsert
+ *
+ * Description:
+ *   Add a newly written inode to the inode index.  If the index cannot be
+ *   grown, it is invalidated.
+ *
+ * Input Parameters:
+ *   volume  - Describes the NXFFS volume
+ *   name    - The name of the inode
+ *   hoffset - FLASH offset to the inode header
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void nxffs_ixinsert(FAR struct nxffs_volume_s *volume, FAR const char *name,
+                    off_t hoffset)
+{
+  FAR struct nxffs_ixent_s *index;
+  unsigned int pos;
+
+  if (!volume->ixvalid)
+    {
+      return;
+    }
+
+  /* Make room for one more entry */
+
+  if (volume->nindex >= volume->ixalloc)
+    {
+      index = (FAR struct nxffs_ixent_s *)
+        kmm_realloc(volume->index, (volume->ixalloc + NXFFS_IXINCR) *
+                    sizeof(struct nxffs_ixent_s));
+      if (index == NULL)
+        {
+          fwarn("WARNING: No memory for the inode index\n");
+          nxffs_ixinvalidate(volume);
+          return;
+        }
+
+      volume->index    = index;
+      volume->ixalloc += NXFFS_IXINCR;
+    }
+
+  /* New inodes are normally written at the end of FLASH, so this is
+   * usually an append.
+   */
+
+  pos = nxffs_ixsearch(volume, hoffset);
+  memmove(&volume->index[pos + 1], &volume->index[pos],
+          (volume->nindex - pos) * sizeof(struct nxffs_ixent_s));
+
+  volume->index[pos].hoffset = hoffset;
+  volume->index[pos].hash    = nxffs_ixhash(name);
+  volume->nindex++;
+}
+
+/****************************************************************************
+ * Name: nxffs_ixremove
+ *
+ * Description:
+ *   Remove a deleted inode from the inode index.
+ *
+ * Input Parameters:
+ *   volume  - Describes the NXFFS volume
+ *   hoffset - FLASH offset to the inode header
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void nxffs_ixremove(FAR struct nxffs_volume_s *volume, off_t hoffset)
+{
+  unsigned int pos;
+
+  if (!volume->ixvalid)
+    {
+      return;
+    }
+
+  pos = nxffs_ixsearch(volume, hoffset);
+  if (pos < volume->nindex && volume->index[pos].hoffset == hoffset)
+    {
+      volume->nindex--;
+      memmove(&volume->index[pos], &volume->index[pos + 1],
+              (volume->nindex - pos) * sizeof(struct nxffs_ixent_s));
+    }
+}
+
+/****************************************************************************
+ * Name: nxffs_ixmove
+ *
+ * Description:
+ *   Record that packing moved an inode header.  Packing only moves inodes
+ *   toward the beginning of FLASH and in order, so the index stays sorted.
+ *
+ * Input Parameters:
+ *   volume    - Describes the NXFFS volume
+ *   oldoffset - Previous FLASH offset to the inode header
+ *   newoffset - New FLASH offset to the inode header
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void nxffs_ixmove(FAR struct nxffs_volume_s *volume, off_t oldoffset,
+                  off_t newoffset)
+{
+  unsigned int pos;
+
+  if (!volume->ixvalid)
+    {
+      return;
+    }
+
+  pos = nxffs_ixsearch(volume, oldoffset);
+  if (pos < volume->nindex && volume->index[pos].hoffset == oldoffset)
+    {
+      DEBUGASSERT(pos == 0 || volume->index[pos - 1].hoffset < newoffset);
+      volume->index[pos].hoffset = newoffset;
+    }
+  else
+    {
+      /* Every inode that is packed should have been indexed */
+
+      ferr("ERROR: Inode at %jd is not indexed\n", (intmax_t)oldoffset);
+      nxffs_ixinvalidate(volume);
+    }
+}
+
+/****************************************************************************
+ * Name: nxffs_ixfind
+ *
+ * Description:
+ *   Use the inode index to find the inode with the provided name.  Only
+ *   the inodes whose name hash matches are read from FLASH.
+ *
+ * Input Parameters:
+ *   volume - Describes the NXFFS volume
+ *   name   - The name of the inode to find
+ *   entry  - The location to return information about the inode.
+ *
+ * Returned Value:
+ *   Zero is returned on success.  -ENOENT is returned if there is no such
+ *   inode.  -ENOSYS is returned if the index is not valid and the caller
+ *   must scan the FLASH instead.
+ *
+ ****************************************************************************/
+
+int nxffs_ixfind(FAR struct nxffs_volume_s *volume, FAR const char *name,
+                 FAR struct nxffs_entry_s *entry)
+{
+  uint32_t hash;
+  unsigned int i;
+  int ret;
+
+  if (!volume->ixvalid)
+    {
+      return -ENOSYS;
+    }
+
+  hash = nxffs_ixhash(name);
+  for (i = 0; i < volume->nindex; i++)
+    {
+      if (volume->index[i].hash != hash)
+        {
+          continue;
+        }
+
+      /* The hash matches, read the inode to compare the names */
+
+      ret = nxffs_nextentry(volume, volume->index[i].hoffset, entry);
+      if (ret == OK && entry->hoffset == volume->index[i].hoffset)
+        {
+          if (strcmp(name, entry->name) == 0)
+            {
+              return OK;
+            }
+
+          nxffs_freeentry(entry);
+          continue;
+        }
+
+      /* There is no valid inode where the index says there should be one.
+       * Stop trusting the index.
+       */
+
+      if (ret == OK)
+        {
+          nxffs_freeentry(entry);
+        }
+
+      ferr("ERROR: Stale inode index entry at %jd\n",
+           (intmax_t)volume->index[i].hoffset);
+      nxffs_ixinvalidate(volume);
+      return -ENOSYS;
+    }
+
+  return -ENOENT;
+}
+
+/****************************************************************************
+ * Name: nxffs_ixnext
+ *
+ * Description:
+ *   Return the FLASH offset of the first valid inode header at or after
+ *   the provided offset.
+ *
+ * Input Parameters:
+ *   volume - Describes the NXFFS volume
+ *   offset - The FLASH offset to begin searching.
+ *
+ * Returned Value:
+ *   The offset of the inode header.  -ENOENT is returned if there are no
+ *   more inodes and -ENOSYS if the index is not valid.
+ *
+ ****************************************************************************/
+
+off_t nxffs_ixnext(FAR struct nxffs_volume_s *volume, off_t offset)
+{
+  unsigned int pos;
+
+  if (!volume->ixvalid)
+    {
+      return -ENOSYS;
+    }
+
+  pos = nxffs_ixsearch(volume, offset);
+  if (pos >= volume->nindex)
+    {
+      return -ENOENT;
+    }
+
+  return volume->index[pos].hoffset;
+}
+
+#endif /* CONFIG_NXFFS_INDEX */
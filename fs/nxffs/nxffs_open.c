@@ -894,6 +894,13 @@ static inline int nxffs_wrclose(FAR struct nxffs_volume_s *volume,
   /* Write the inode header to FLASH */
 
   ret = nxffs_wrinode(volume, &wrfile->ofile.entry);
+#ifdef CONFIG_NXFFS_INDEX
+  if (ret >= 0)
+    {
+      nxffs_ixinsert(volume, wrfile->ofile.entry.name,
+                     wrfile->ofile.entry.hoffset);
+    }
+#endif
 
   /* The volume is now available for other writers */
 
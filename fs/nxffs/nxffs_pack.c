@@ -697,6 +697,12 @@ static int nxffs_wrinodehdr(FAR struct nxffs_volume_s *volume,
         }
     }
 
+#ifdef CONFIG_NXFFS_INDEX
+  /* The inode now lives at its packed position */
+
+  nxffs_ixmove(volume, pack->src.entry.hoffset, pack->dest.entry.hoffset);
+#endif
+
   /* Reset the dest inode information */
 
   nxffs_freeentry(&pack->dest.entry);
@@ -1266,6 +1272,7 @@ int nxffs_pack(FAR struct nxffs_volume_s *volume)
   struct nxffs_pack_s pack;
   FAR struct nxffs_wrfile_s *wrfile;
   off_t iooffset;
+  off_t endoffset;
   off_t eblock;
   off_t block;
   bool packed;
@@ -1274,8 +1281,9 @@ int nxffs_pack(FAR struct nxffs_volume_s *volume)
 
   /* Get the offset to the first valid inode entry */
 
-  wrfile = NULL;
-  packed = false;
+  wrfile    = NULL;
+  packed    = false;
+  endoffset = volume->froffset;
 
   iooffset = nxffs_mediacheck(volume, &pack);
   if (iooffset == 0)
@@ -1408,6 +1416,17 @@ start_pack:
 
       pack.block0 = eblock * volume->blkper;
 
+      /* Once everything has been packed, the erase blocks beyond the old
+       * end of the data still hold nothing but block headers.  There is no
+       * need to erase and rewrite the rest of the volume.
+       */
+
+      if (packed && wrfile == NULL &&
+          (off_t)pack.block0 * volume->geo.blocksize >= endoffset)
+        {
+          break;
+        }
+
 #ifndef CONFIG_NXFFS_NAND
       /* Read the erase block into the pack buffer.  We need to do this even
        * if we are overwriting the entire block so that we skip over
@@ -1605,6 +1624,15 @@ start_pack:
     }
 
 errout_with_pack:
+#ifdef CONFIG_NXFFS_INDEX
+  if (ret < 0)
+    {
+      /* Some inodes may have moved without the index knowing */
+
+      nxffs_ixinvalidate(volume);
+    }
+#endif
+
   nxffs_freeentry(&pack.src.entry);
   nxffs_freeentry(&pack.dest.entry);
   return ret;
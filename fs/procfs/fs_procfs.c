@@ -65,9 +65,12 @@ extern const struct procfs_operations proc_operations;
 extern const struct procfs_operations irq_operations;
 extern const struct procfs_operations cpuload_operations;
 extern const struct procfs_operations critmon_operations;
+extern const struct procfs_operations latency_operations;
 extern const struct procfs_operations meminfo_operations;
 extern const struct procfs_operations iobinfo_operations;
 extern const struct procfs_operations module_operations;
+extern const struct procfs_operations runqueue_operations;
+extern const struct procfs_operations spinlock_operations;
 extern const struct procfs_operations uptime_operations;
 extern const struct procfs_operations version_operations;
 
@@ -112,6 +115,10 @@ static const struct procfs_entry_s g_procfs_entries[] =
   { "irqs",          &irq_operations,             PROCFS_FILE_TYPE   },
 #endif
 
+#ifdef CONFIG_SCHED_LATENCY_HIST
+  { "latency",       &latency_operations,         PROCFS_FILE_TYPE   },
+#endif
+
 #ifndef CONFIG_FS_PROCFS_EXCLUDE_MEMINFO
   { "meminfo",       &meminfo_operations,         PROCFS_FILE_TYPE   },
 #endif
@@ -153,6 +160,14 @@ static const struct procfs_entry_s g_procfs_entries[] =
   { "partitions",    &part_procfsoperations,      PROCFS_FILE_TYPE   },
 #endif
 
+#ifdef CONFIG_SCHED_LOADBALANCE
+  { "runqueue",      &runqueue_operations,        PROCFS_FILE_TYPE   },
+#endif
+
+#ifdef CONFIG_SPINLOCK_STATS
+  { "spinlocks",     &spinlock_operations,        PROCFS_FILE_TYPE   },
+#endif
+
 #ifndef CONFIG_FS_PROCFS_EXCLUDE_PROCESS
   { "self",          &proc_operations,            PROCFS_DIR_TYPE    },
   { "self/**",       &proc_operations,            PROCFS_UNKOWN_TYPE },
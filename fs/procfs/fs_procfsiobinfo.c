@@ -55,6 +55,10 @@
 
 #define IOBINFO_LINELEN 80
 
+/* The number of lines describing the buffer pools */
+
+#define IOBINFO_NPOOLINFO 7
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -68,6 +72,14 @@ struct iobinfo_file_s
   char line[IOBINFO_LINELEN];     /* Pre-allocated buffer for formatted lines */
 };
 
+/* One line of buffer pool information */
+
+struct iobinfo_pool_s
+{
+  FAR const char *name;
+  unsigned long value;
+};
+
 /****************************************************************************
  * Private Function Prototypes
  ****************************************************************************/
@@ -135,6 +147,12 @@ static FAR const char *g_iob_user_names[] =
 #ifdef CONFIG_NET_IPFORWARD
   "ipforward",
 #endif
+#ifdef CONFIG_NET_ARP_PENDING
+  "arp_pending",
+#endif
+#ifdef CONFIG_NET_IPv6_NCONF_PENDING
+  "neighbor_pending",
+#endif
 #ifdef CONFIG_WIRELESS_IEEE802154
   "rad802154",
 #endif
@@ -155,6 +173,9 @@ static FAR const char *g_iob_user_names[] =
 #endif
 #ifdef CONFIG_NET_CAN
   "can",
+#endif
+#ifdef CONFIG_CDCECM_IOB_RECV
+  "cdcecm",
 #endif
   "global",
 };
@@ -262,6 +283,9 @@ static ssize_t iobinfo_read(FAR struct file *filep, FAR char *buffer,
 {
   FAR struct iobinfo_file_s *iobfile;
   FAR struct iob_userstats_s *userstats;
+  FAR struct iob_poolstats_s *poolstats;
+  struct iobinfo_pool_s poolinfo[IOBINFO_NPOOLINFO];
+  int npoolinfo;
   size_t linesize;
   size_t copysize;
   size_t totalsize;
@@ -340,6 +364,50 @@ static ssize_t iobinfo_read(FAR struct file *filep, FAR char *buffer,
       totalsize += copysize;
     }
 
+  /* Then the state of the buffer pools */
+
+  poolstats = iob_getpoolstats();
+  i         = 0;
+
+  poolinfo[i].name    = "free";
+  poolinfo[i++].value = iob_navail(false);
+#ifdef CONFIG_IOB_LARGE
+  poolinfo[i].name    = "large_free";
+  poolinfo[i++].value = iob_large_navail();
+  poolinfo[i].name    = "large_alloc";
+  poolinfo[i++].value = poolstats->largealloc;
+  poolinfo[i].name    = "large_missed";
+  poolinfo[i++].value = poolstats->largemissed;
+#endif
+#ifdef CONFIG_IOB_PERCPU_CACHE
+  poolinfo[i].name    = "cache_hits";
+  poolinfo[i++].value = poolstats->cachehits;
+  poolinfo[i].name    = "cache_refills";
+  poolinfo[i++].value = poolstats->cacherefills;
+  poolinfo[i].name    = "cache_drains";
+  poolinfo[i++].value = poolstats->cachedrains;
+#endif
+
+  UNUSED(poolstats);
+  npoolinfo = i;
+
+  for (i = 0; i < npoolinfo; i++)
+    {
+      if (totalsize < buflen)
+        {
+          buffer    += copysize;
+          buflen    -= copysize;
+
+          linesize   = snprintf(iobfile->line, IOBINFO_LINELEN,
+                                "%s%-16s%16lu\n", i == 0 ? "\n" : "",
+                                poolinfo[i].name, poolinfo[i].value);
+
+          copysize   = procfs_memcpy(iobfile->line, linesize, buffer, buflen,
+                                     &offset);
+          totalsize += copysize;
+        }
+    }
+
   /* Update the file offset */
 
   filep->f_pos += totalsize;
@@ -0,0 +1,415 @@
+/****************************************************************************
+ * fs/procfs/fs_procfslatency.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/* The "latency" file shows the per-CPU latency histograms collected by
+ * sched/sched/sched_latency.c.  The first line holds the column names.
+ * After the type, the CPU and the maximum, each column is a bucket labeled
+ * with its exclusive upper bound in seconds.  There is one line for each
+ * histogram type and CPU.  Writing anything to the file clears all of the
+ * histograms.
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <string.h>
+#include <fcntl.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/sched.h>
+#include <nuttx/kmalloc.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/procfs.h>
+
+#if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS) && \
+     defined(CONFIG_SCHED_LATENCY_HIST)
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Determines the size of an intermediate buffer that must be large enough
+ * to handle the longest field generated by this logic.
+ */
+
+#define LATENCY_LINELEN 32
+
+#ifdef CONFIG_SMP
+#  define LATENCY_NCPUS CONFIG_SMP_NCPUS
+#else
+#  define LATENCY_NCPUS 1
+#endif
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* This structure describes one open "file" */
+
+struct latency_file_s
+{
+  struct procfs_file_s  base;   /* Base open file structure */
+  char line[LATENCY_LINELEN];   /* Pre-allocated buffer for formatted fields */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+/* File system methods */
+
+static int     latency_open(FAR struct file *filep, FAR const char *relpath,
+                 int oflags, mode_t mode);
+static int     latency_close(FAR struct file *filep);
+static ssize_t latency_read(FAR struct file *filep, FAR char *buffer,
+                 size_t buflen);
+static ssize_t latency_write(FAR struct file *filep, FAR const char *buffer,
+                 size_t buflen);
+static int     latency_dup(FAR const struct file *oldp,
+                 FAR struct file *newp);
+static int     latency_stat(FAR const char *relpath, FAR struct stat *buf);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static FAR const char *g_latency_name[LATENCY_NTYPES] =
+{
+  "irq",        /* LATENCY_IRQ */
+  "csection",   /* LATENCY_CSECTION */
+  "schedlock",  /* LATENCY_SCHEDLOCK */
+  "wakeup",     /* LATENCY_WAKEUP */
+  "semwait"     /* LATENCY_SEMWAIT */
+};
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+/* See fs_mount.c -- this structure is explicitly externed there.
+ * We use the old-fashioned kind of initializers so that this will compile
+ * with any compiler.
+ */
+
+const struct procfs_operations latency_operations =
+{
+  latency_open,       /* open */
+  latency_close,      /* close */
+  latency_read,       /* read */
+  latency_write,      /* write */
+
+  latency_dup,        /* dup */
+
+  NULL,               /* opendir */
+  NULL,               /* closedir */
+  NULL,               /* readdir */
+  NULL,               /* rewinddir */
+
+  latency_stat        /* stat */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: latency_open
+ ****************************************************************************/
+
+static int latency_open(FAR struct file *filep, FAR const char *relpath,
+                        int oflags, mode_t mode)
+{
+  FAR struct latency_file_s *attr;
+
+  finfo("Open '%s'\n", relpath);
+
+  /* "latency" is the only acceptable value for the relpath */
+
+  if (strcmp(relpath, "latency") != 0)
+    {
+      ferr("ERROR: relpath is '%s'\n", relpath);
+      return -ENOENT;
+    }
+
+  /* Allocate a container to hold the file attributes */
+
+  attr = kmm_zalloc(sizeof(struct latency_file_s));
+  if (!attr)
+    {
+      ferr("ERROR: Failed to allocate file attributes\n");
+      return -ENOMEM;
+    }
+
+  /* Save the attributes as the open-specific state in filep->f_priv */
+
+  filep->f_priv = (FAR void *)attr;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: latency_close
+ ****************************************************************************/
+
+static int latency_close(FAR struct file *filep)
+{
+  FAR struct latency_file_s *attr;
+
+  /* Recover our private data from the struct file instance */
+
+  attr = (FAR struct latency_file_s *)filep->f_priv;
+  DEBUGASSERT(attr);
+
+  /* Release the file attributes structure */
+
+  kmm_free(attr);
+  filep->f_priv = NULL;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: latency_copy
+ *
+ * Description:
+ *   Copy the 'linesize' characters in attr->line to the user buffer,
+ *   accounting for the file offset and the space that remains.
+ *
+ ****************************************************************************/
+
+static void latency_copy(FAR struct latency_file_s *attr, size_t linesize,
+                         FAR char *buffer, size_t buflen,
+                         FAR size_t *totalsize, FAR off_t *offset)
+{
+  if (*totalsize < buflen)
+    {
+      *totalsize += procfs_memcpy(attr->line, linesize,
+                                  buffer + *totalsize,
+                                  buflen - *totalsize, offset);
+    }
+}
+
+/****************************************************************************
+ * Name: latency_time
+ *
+ * Description:
+ *   Format an elapsed time in up_critmon_gettime() units as seconds.
+ *
+ ****************************************************************************/
+
+static size_t latency_time(FAR struct latency_file_s *attr,
+                           FAR const char *prefix, uint32_t elapsed)
+{
+  struct timespec ts;
+
+  if (elapsed > 0)
+    {
+      up_critmon_convert(elapsed, &ts);
+    }
+  else
+    {
+      ts.tv_sec  = 0;
+      ts.tv_nsec = 0;
+    }
+
+  return snprintf(attr->line, LATENCY_LINELEN, "%s%lu.%09lu", prefix,
+                  (unsigned long)ts.tv_sec, (unsigned long)ts.tv_nsec);
+}
+
+/****************************************************************************
+ * Name: latency_read
+ ****************************************************************************/
+
+static ssize_t latency_read(FAR struct file *filep, FAR char *buffer,
+                            size_t buflen)
+{
+  FAR struct latency_file_s *attr;
+  FAR struct latency_hist_s *hist;
+  size_t totalsize;
+  size_t linesize;
+  off_t offset;
+  int bucket;
+  int type;
+  int cpu;
+
+  finfo("buffer=%p buflen=%d\n", buffer, (int)buflen);
+
+  /* Recover our private data from the struct file instance */
+
+  attr = (FAR struct latency_file_s *)filep->f_priv;
+  DEBUGASSERT(attr);
+
+  totalsize = 0;
+  offset    = filep->f_pos;
+
+  /* The header line names the columns.  The buckets are labeled with their
+   * exclusive upper bounds; the last bucket is unbounded.
+   */
+
+  linesize = snprintf(attr->line, LATENCY_LINELEN, "type,cpu,max");
+  latency_copy(attr, linesize, buffer, buflen, &totalsize, &offset);
+
+  for (bucket = 0; bucket < CONFIG_SCHED_LATENCY_NBUCKETS - 1; bucket++)
+    {
+      linesize = latency_time(attr, ",", (uint32_t)1 << bucket);
+      latency_copy(attr, linesize, buffer, buflen, &totalsize, &offset);
+    }
+
+  linesize = snprintf(attr->line, LATENCY_LINELEN, ",inf\n");
+  latency_copy(attr, linesize, buffer, buflen, &totalsize, &offset);
+
+  /* Then one line for each histogram */
+
+  for (type = 0; type < LATENCY_NTYPES; type++)
+    {
+      for (cpu = 0; cpu < LATENCY_NCPUS; cpu++)
+        {
+          hist = &g_latency_hist[cpu][type];
+
+          linesize = snprintf(attr->line, LATENCY_LINELEN, "%s,%d",
+                              g_latency_name[type], cpu);
+          latency_copy(attr, linesize, buffer, buflen, &totalsize, &offset);
+
+          linesize = latency_time(attr, ",", hist->max);
+          latency_copy(attr, linesize, buffer, buflen, &totalsize, &offset);
+
+          for (bucket = 0; bucket < CONFIG_SCHED_LATENCY_NBUCKETS; bucket++)
+            {
+              linesize = snprintf(attr->line, LATENCY_LINELEN, ",%lu",
+                                  (unsigned long)hist->count[bucket]);
+              latency_copy(attr, linesize, buffer, buflen, &totalsize,
+                           &offset);
+            }
+
+          linesize = snprintf(attr->line, LATENCY_LINELEN, "\n");
+          latency_copy(attr, linesize, buffer, buflen, &totalsize, &offset);
+
+          if (totalsize >= buflen)
+            {
+              break;
+            }
+        }
+    }
+
+  /* Update the file offset */
+
+  if (totalsize > 0)
+    {
+      filep->f_pos += totalsize;
+    }
+
+  return totalsize;
+}
+
+/****************************************************************************
+ * Name: latency_write
+ *
+ * Description:
+ *   Any write to the file clears all of the histograms.
+ *
+ ****************************************************************************/
+
+static ssize_t latency_write(FAR struct file *filep, FAR const char *buffer,
+                             size_t buflen)
+{
+  nxsched_latency_reset();
+  return buflen;
+}
+
+/****************************************************************************
+ * Name: latency_dup
+ *
+ * Description:
+ *   Duplicate open file data in the new file structure.
+ *
+ ****************************************************************************/
+
+static int latency_dup(FAR const struct file *oldp, FAR struct file *newp)
+{
+  FAR struct latency_file_s *oldattr;
+  FAR struct latency_file_s *newattr;
+
+  finfo("Dup %p->%p\n", oldp, newp);
+
+  /* Recover our private data from the old struct file instance */
+
+  oldattr = (FAR struct latency_file_s *)oldp->f_priv;
+  DEBUGASSERT(oldattr);
+
+  /* Allocate a new container to hold the task and attribute selection */
+
+  newattr = kmm_malloc(sizeof(struct latency_file_s));
+  if (!newattr)
+    {
+      ferr("ERROR: Failed to allocate file attributes\n");
+      return -ENOMEM;
+    }
+
+  /* The copy the file attributes from the old attributes to the new */
+
+  memcpy(newattr, oldattr, sizeof(struct latency_file_s));
+
+  /* Save the new attributes in the new file structure */
+
+  newp->f_priv = (FAR void *)newattr;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: latency_stat
+ *
+ * Description: Return information about a file or directory
+ *
+ ****************************************************************************/
+
+static int latency_stat(FAR const char *relpath, FAR struct stat *buf)
+{
+  /* "latency" is the only acceptable value for the relpath */
+
+  if (strcmp(relpath, "latency") != 0)
+    {
+      ferr("ERROR: relpath is '%s'\n", relpath);
+      return -ENOENT;
+    }
+
+  /* "latency" is the name for a read/write file */
+
+  memset(buf, 0, sizeof(struct stat));
+  buf->st_mode = S_IFREG | S_IROTH | S_IRGRP | S_IRUSR | S_IWUSR;
+  return OK;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+#endif /* !CONFIG_DISABLE_MOUNTPOINT && CONFIG_FS_PROCFS && CONFIG_SCHED_LATENCY_HIST */
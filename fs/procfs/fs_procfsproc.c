@@ -86,6 +86,9 @@ enum proc_node_e
 #endif
 #ifdef CONFIG_SCHED_CRITMONITOR
   PROC_CRITMON,                       /* Critical section monitor */
+#endif
+#ifdef CONFIG_SCHED_LATENCY_HIST_PERTASK
+  PROC_LATENCY,                       /* Latency histograms */
 #endif
   PROC_STACK,                         /* Task stack info */
   PROC_GROUP,                         /* Group directory */
@@ -143,9 +146,10 @@ struct proc_envinfo_s
  * Private Data
  ****************************************************************************/
 
-static FAR const char *g_policy[4] =
+static FAR const char *g_policy[5] =
 {
-  "SCHED_FIFO", "SCHED_RR", "SCHED_SPORADIC", "SCHED_OTHER"
+  "SCHED_FIFO", "SCHED_RR", "SCHED_SPORADIC", "SCHED_OTHER",
+  "SCHED_DEADLINE"
 };
 
 /****************************************************************************
@@ -172,6 +176,11 @@ static ssize_t proc_critmon(FAR struct proc_file_s *procfile,
                  FAR struct tcb_s *tcb, FAR char *buffer, size_t buflen,
                  off_t offset);
 #endif
+#ifdef CONFIG_SCHED_LATENCY_HIST_PERTASK
+static ssize_t proc_latency(FAR struct proc_file_s *procfile,
+                 FAR struct tcb_s *tcb, FAR char *buffer, size_t buflen,
+                 off_t offset);
+#endif
 static ssize_t proc_stack(FAR struct proc_file_s *procfile,
                  FAR struct tcb_s *tcb, FAR char *buffer, size_t buflen,
                  off_t offset);
@@ -268,6 +277,22 @@ static const struct proc_node_s g_critmon =
 };
 #endif
 
+#ifdef CONFIG_SCHED_LATENCY_HIST_PERTASK
+static const struct proc_node_s g_latency =
+{
+  "latency",       "latency", (uint8_t)PROC_LATENCY,     DTYPE_FILE        /* Latency histograms */
+};
+
+static FAR const char *g_latency_name[LATENCY_NTYPES] =
+{
+  "irq",        /* LATENCY_IRQ */
+  "csection",   /* LATENCY_CSECTION */
+  "schedlock",  /* LATENCY_SCHEDLOCK */
+  "wakeup",     /* LATENCY_WAKEUP */
+  "semwait"     /* LATENCY_SEMWAIT */
+};
+#endif
+
 static const struct proc_node_s g_stack =
 {
   "stack",        "stack",   (uint8_t)PROC_STACK,        DTYPE_FILE        /* Task stack info */
@@ -307,6 +332,9 @@ static FAR const struct proc_node_s * const g_nodeinfo[] =
 #endif
 #ifdef CONFIG_SCHED_CRITMONITOR
   &g_critmon,      /* Critical section Monitor */
+#endif
+#ifdef CONFIG_SCHED_LATENCY_HIST_PERTASK
+  &g_latency,      /* Latency histograms */
 #endif
   &g_stack,        /* Task stack info */
   &g_group,        /* Group directory */
@@ -330,6 +358,9 @@ static const struct proc_node_s * const g_level0info[] =
 #endif
 #ifdef CONFIG_SCHED_CRITMONITOR
   &g_critmon,      /* Critical section monitor */
+#endif
+#ifdef CONFIG_SCHED_LATENCY_HIST_PERTASK
+  &g_latency,      /* Latency histograms */
 #endif
   &g_stack,        /* Task stack info */
   &g_group,        /* Group directory */
@@ -369,6 +400,9 @@ static FAR const char * const g_statenames[] =
 #ifdef CONFIG_SIG_SIGSTOP_ACTION
   , "Stopped"
 #endif
+#ifdef CONFIG_SCHED_DEADLINE
+  , "Waiting,Deadline"
+#endif
 };
 
 static FAR const char * const g_ttypenames[4] =
@@ -838,6 +872,77 @@ static ssize_t proc_critmon(FAR struct proc_file_s *procfile,
 }
 #endif
 
+/****************************************************************************
+ * Name: proc_latency
+ *
+ * Description:
+ *   Show the latency histograms of the thread, one line per type.  The
+ *   columns are the type, the maximum and the buckets.  The buckets are
+ *   those of the top-level "latency" file.  Interrupt handler time is not
+ *   charged to threads and is not shown.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_LATENCY_HIST_PERTASK
+static ssize_t proc_latency(FAR struct proc_file_s *procfile,
+                            FAR struct tcb_s *tcb, FAR char *buffer,
+                            size_t buflen, off_t offset)
+{
+  FAR struct latency_hist_s *hist;
+  struct timespec maxtime;
+  size_t linesize;
+  size_t totalsize;
+  int bucket;
+  int type;
+
+  totalsize = 0;
+
+  for (type = LATENCY_IRQ + 1; type < LATENCY_NTYPES; type++)
+    {
+      hist = &tcb->latency[type];
+
+      if (hist->max > 0)
+        {
+          up_critmon_convert(hist->max, &maxtime);
+        }
+      else
+        {
+          maxtime.tv_sec = 0;
+          maxtime.tv_nsec = 0;
+        }
+
+      linesize = snprintf(procfile->line, STATUS_LINELEN, "%s,%lu.%09lu",
+                          g_latency_name[type],
+                          (unsigned long)maxtime.tv_sec,
+                          (unsigned long)maxtime.tv_nsec);
+      totalsize += procfs_memcpy(procfile->line, linesize,
+                                 buffer + totalsize, buflen - totalsize,
+                                 &offset);
+
+      for (bucket = 0; bucket < CONFIG_SCHED_LATENCY_NBUCKETS; bucket++)
+        {
+          linesize = snprintf(procfile->line, STATUS_LINELEN, ",%lu",
+                              (unsigned long)hist->count[bucket]);
+          totalsize += procfs_memcpy(procfile->line, linesize,
+                                     buffer + totalsize, buflen - totalsize,
+                                     &offset);
+        }
+
+      linesize = snprintf(procfile->line, STATUS_LINELEN, "\n");
+      totalsize += procfs_memcpy(procfile->line, linesize,
+                                 buffer + totalsize, buflen - totalsize,
+                                 &offset);
+
+      if (totalsize >= buflen)
+        {
+          break;
+        }
+    }
+
+  return totalsize;
+}
+#endif
+
 /****************************************************************************
  * Name: proc_stack
  ****************************************************************************/
@@ -1411,6 +1516,11 @@ static ssize_t proc_read(FAR struct file *filep, FAR char *buffer,
     case PROC_CRITMON: /* Critical section monitor */
       ret = proc_critmon(procfile, tcb, buffer, buflen, filep->f_pos);
       break;
+#endif
+#ifdef CONFIG_SCHED_LATENCY_HIST_PERTASK
+    case PROC_LATENCY: /* Latency histograms */
+      ret = proc_latency(procfile, tcb, buffer, buflen, filep->f_pos);
+      break;
 #endif
     case PROC_STACK: /* Task stack info */
       ret = proc_stack(procfile, tcb, buffer, buflen, filep->f_pos);
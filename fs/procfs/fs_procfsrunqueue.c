@@ -0,0 +1,310 @@
+/****************************************************************************
+ * fs/procfs/fs_procfsrunqueue.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/* The "runqueue" file shows the run queue statistics collected by
+ * sched/sched/sched_balance.c.  The first line holds the column names,
+ * followed by one line for each CPU:  The priority of the running task,
+ * the number of other tasks assigned to the CPU, the number of unassigned
+ * tasks that may run on it, the CPU load, the number of tasks that
+ * migrated to it, and the number of balance passes it ran and the
+ * stranded tasks that those passes started.
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/sched.h>
+#include <nuttx/kmalloc.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/procfs.h>
+
+#if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS) && \
+     defined(CONFIG_SCHED_LOADBALANCE)
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Determines the size of an intermediate buffer that must be large enough
+ * to handle the longest line generated by this logic.
+ */
+
+#define RUNQUEUE_LINELEN 80
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* This structure describes one open "file" */
+
+struct runqueue_file_s
+{
+  struct procfs_file_s  base;    /* Base open file structure */
+  char line[RUNQUEUE_LINELEN];   /* Pre-allocated buffer for formatted lines */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+/* File system methods */
+
+static int     runqueue_open(FAR struct file *filep, FAR const char *relpath,
+                 int oflags, mode_t mode);
+static int     runqueue_close(FAR struct file *filep);
+static ssize_t runqueue_read(FAR struct file *filep, FAR char *buffer,
+                 size_t buflen);
+static int     runqueue_dup(FAR const struct file *oldp,
+                 FAR struct file *newp);
+static int     runqueue_stat(FAR const char *relpath, FAR struct stat *buf);
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+/* See fs_mount.c -- this structure is explicitly externed there.
+ * We use the old-fashioned kind of initializers so that this will compile
+ * with any compiler.
+ */
+
+const struct procfs_operations runqueue_operations =
+{
+  runqueue_open,      /* open */
+  runqueue_close,     /* close */
+  runqueue_read,      /* read */
+  NULL,               /* write */
+
+  runqueue_dup,       /* dup */
+
+  NULL,               /* opendir */
+  NULL,               /* closedir */
+  NULL,               /* readdir */
+  NULL,               /* rewinddir */
+
+  runqueue_stat       /* stat */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: runqueue_open
+ ****************************************************************************/
+
+static int runqueue_open(FAR struct file *filep, FAR const char *relpath,
+                         int oflags, mode_t mode)
+{
+  FAR struct runqueue_file_s *attr;
+
+  finfo("Open '%s'\n", relpath);
+
+  /* PROCFS is read-only.  Any attempt to open with any kind of write
+   * access is not permitted.
+   *
+   * REVISIT:  Write-able proc files could be quite useful.
+   */
+
+  if ((oflags & O_WRONLY) != 0 || (oflags & O_RDONLY) == 0)
+    {
+      ferr("ERROR: Only O_RDONLY supported\n");
+      return -EACCES;
+    }
+
+  /* "runqueue" is the only acceptable value for the relpath */
+
+  if (strcmp(relpath, "runqueue") != 0)
+    {
+      ferr("ERROR: relpath is '%s'\n", relpath);
+      return -ENOENT;
+    }
+
+  /* Allocate a container to hold the file attributes */
+
+  attr = kmm_zalloc(sizeof(struct runqueue_file_s));
+  if (!attr)
+    {
+      ferr("ERROR: Failed to allocate file attributes\n");
+      return -ENOMEM;
+    }
+
+  /* Save the attributes as the open-specific state in filep->f_priv */
+
+  filep->f_priv = (FAR void *)attr;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: runqueue_close
+ ****************************************************************************/
+
+static int runqueue_close(FAR struct file *filep)
+{
+  FAR struct runqueue_file_s *attr;
+
+  /* Recover our private data from the struct file instance */
+
+  attr = (FAR struct runqueue_file_s *)filep->f_priv;
+  DEBUGASSERT(attr);
+
+  /* Release the file attributes structure */
+
+  kmm_free(attr);
+  filep->f_priv = NULL;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: runqueue_read
+ ****************************************************************************/
+
+static ssize_t runqueue_read(FAR struct file *filep, FAR char *buffer,
+                             size_t buflen)
+{
+  FAR struct runqueue_file_s *attr;
+  struct sched_rqstats_s stats;
+  size_t totalsize;
+  size_t linesize;
+  off_t offset;
+  int cpu;
+
+  finfo("buffer=%p buflen=%d\n", buffer, (int)buflen);
+
+  /* Recover our private data from the struct file instance */
+
+  attr = (FAR struct runqueue_file_s *)filep->f_priv;
+  DEBUGASSERT(attr);
+
+  offset    = filep->f_pos;
+  linesize  = snprintf(attr->line, RUNQUEUE_LINELEN,
+                       "cpu,prio,assigned,waiting,load,migrations,"
+                       "balances,pulls\n");
+  totalsize = procfs_memcpy(attr->line, linesize, buffer, buflen, &offset);
+
+  /* Then one line for each CPU */
+
+  for (cpu = 0; cpu < CONFIG_SMP_NCPUS && totalsize < buflen; cpu++)
+    {
+      nxsched_get_rqstats(cpu, &stats);
+
+      linesize = snprintf(attr->line, RUNQUEUE_LINELEN,
+                          "%d,%u,%u,%u,%u%%,%lu,%lu,%lu\n", cpu,
+                          stats.runprio, stats.nassigned, stats.nwaiting,
+                          stats.load, (unsigned long)stats.migrations,
+                          (unsigned long)stats.balances,
+                          (unsigned long)stats.pulls);
+      totalsize += procfs_memcpy(attr->line, linesize, buffer + totalsize,
+                                 buflen - totalsize, &offset);
+    }
+
+  /* Update the file offset */
+
+  if (totalsize > 0)
+    {
+      filep->f_pos += totalsize;
+    }
+
+  return totalsize;
+}
+
+/****************************************************************************
+ * Name: runqueue_dup
+ *
+ * Description:
+ *   Duplicate open file data in the new file structure.
+ *
+ ****************************************************************************/
+
+static int runqueue_dup(FAR const struct file *oldp, FAR struct file *newp)
+{
+  FAR struct runqueue_file_s *oldattr;
+  FAR struct runqueue_file_s *newattr;
+
+  finfo("Dup %p->%p\n", oldp, newp);
+
+  /* Recover our private data from the old struct file instance */
+
+  oldattr = (FAR struct runqueue_file_s *)oldp->f_priv;
+  DEBUGASSERT(oldattr);
+
+  /* Allocate a new container to hold the task and attribute selection */
+
+  newattr = kmm_malloc(sizeof(struct runqueue_file_s));
+  if (!newattr)
+    {
+      ferr("ERROR: Failed to allocate file attributes\n");
+      return -ENOMEM;
+    }
+
+  /* The copy the file attributes from the old attributes to the new */
+
+  memcpy(newattr, oldattr, sizeof(struct runqueue_file_s));
+
+  /* Save the new attributes in the new file structure */
+
+  newp->f_priv = (FAR void *)newattr;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: runqueue_stat
+ *
+ * Description: Return information about a file or directory
+ *
+ ****************************************************************************/
+
+static int runqueue_stat(FAR const char *relpath, FAR struct stat *buf)
+{
+  /* "runqueue" is the only acceptable value for the relpath */
+
+  if (strcmp(relpath, "runqueue") != 0)
+    {
+      ferr("ERROR: relpath is '%s'\n", relpath);
+      return -ENOENT;
+    }
+
+  /* "runqueue" is the name for a read-only file */
+
+  memset(buf, 0, sizeof(struct stat));
+  buf->st_mode = S_IFREG | S_IROTH | S_IRGRP | S_IRUSR;
+  return OK;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+#endif /* !CONFIG_DISABLE_MOUNTPOINT && CONFIG_FS_PROCFS && CONFIG_SCHED_LOADBALANCE */
@@ -0,0 +1,346 @@
+/****************************************************************************
+ * fs/procfs/fs_procfsspinlock.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/* The "spinlocks" file shows the contention statistics of the named
+ * spinlocks registered with spin_stats_register().  The first line holds
+ * the column names, then there is one line per lock.  Writing anything to
+ * the file clears the counters.
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/kmalloc.h>
+#include <nuttx/spinlock.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/procfs.h>
+
+#if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS) && \
+     defined(CONFIG_SPINLOCK_STATS)
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Determines the size of an intermediate buffer that must be large enough
+ * to handle the longest line generated by this logic.
+ */
+
+#define SPINLOCK_LINELEN 96
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* This structure describes one open "file" */
+
+struct spinlock_file_s
+{
+  struct procfs_file_s  base;   /* Base open file structure */
+  char line[SPINLOCK_LINELEN];  /* Pre-allocated buffer for formatted lines */
+};
+
+/* The state of one read() while walking the registered locks */
+
+struct spinlock_read_s
+{
+  FAR struct spinlock_file_s *attr;
+  FAR char *buffer;
+  size_t buflen;
+  size_t totalsize;
+  off_t offset;
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+/* File system methods */
+
+static int     spinlock_open(FAR struct file *filep, FAR const char *relpath,
+                 int oflags, mode_t mode);
+static int     spinlock_close(FAR struct file *filep);
+static ssize_t spinlock_read(FAR struct file *filep, FAR char *buffer,
+                 size_t buflen);
+static ssize_t spinlock_write(FAR struct file *filep, FAR const char *buffer,
+                 size_t buflen);
+static int     spinlock_dup(FAR const struct file *oldp,
+                 FAR struct file *newp);
+static int     spinlock_stat(FAR const char *relpath, FAR struct stat *buf);
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+/* See fs_mount.c -- this structure is explicitly externed there.
+ * We use the old-fashioned kind of initializers so that this will compile
+ * with any compiler.
+ */
+
+const struct procfs_operations spinlock_operations =
+{
+  spinlock_open,      /* open */
+  spinlock_close,     /* close */
+  spinlock_read,      /* read */
+  spinlock_write,     /* write */
+
+  spinlock_dup,       /* dup */
+
+  NULL,               /* opendir */
+  NULL,               /* closedir */
+  NULL,               /* readdir */
+  NULL,               /* rewinddir */
+
+  spinlock_stat       /* stat */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: spinlock_open
+ ****************************************************************************/
+
+static int spinlock_open(FAR struct file *filep, FAR const char *relpath,
+                         int oflags, mode_t mode)
+{
+  FAR struct spinlock_file_s *attr;
+
+  finfo("Open '%s'\n", relpath);
+
+  /* "spinlocks" is the only acceptable value for the relpath */
+
+  if (strcmp(relpath, "spinlocks") != 0)
+    {
+      ferr("ERROR: relpath is '%s'\n", relpath);
+      return -ENOENT;
+    }
+
+  /* Allocate a container to hold the file attributes */
+
+  attr = kmm_zalloc(sizeof(struct spinlock_file_s));
+  if (!attr)
+    {
+      ferr("ERROR: Failed to allocate file attributes\n");
+      return -ENOMEM;
+    }
+
+  /* Save the attributes as the open-specific state in filep->f_priv */
+
+  filep->f_priv = (FAR void *)attr;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: spinlock_close
+ ****************************************************************************/
+
+static int spinlock_close(FAR struct file *filep)
+{
+  FAR struct spinlock_file_s *attr;
+
+  /* Recover our private data from the struct file instance */
+
+  attr = (FAR struct spinlock_file_s *)filep->f_priv;
+  DEBUGASSERT(attr);
+
+  /* Release the file attributes structure */
+
+  kmm_free(attr);
+  filep->f_priv = NULL;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: spinlock_copy
+ *
+ * Description:
+ *   Copy the 'linesize' characters in attr->line to the user buffer,
+ *   accounting for the file offset and the space that remains.
+ *
+ ****************************************************************************/
+
+static void spinlock_copy(FAR struct spinlock_read_s *rd, size_t linesize)
+{
+  if (rd->totalsize < rd->buflen)
+    {
+      rd->totalsize += procfs_memcpy(rd->attr->line, linesize,
+                                     rd->buffer + rd->totalsize,
+                                     rd->buflen - rd->totalsize,
+                                     &rd->offset);
+    }
+}
+
+/****************************************************************************
+ * Name: spinlock_line
+ *
+ * Description:
+ *   spin_stats_foreach() callback:  Format the line of one lock.
+ *
+ ****************************************************************************/
+
+static void spinlock_line(FAR const struct spinlock_stats_s *stats,
+                          FAR void *arg)
+{
+  FAR struct spinlock_read_s *rd = (FAR struct spinlock_read_s *)arg;
+  size_t linesize;
+
+  linesize = snprintf(rd->attr->line, SPINLOCK_LINELEN,
+                      "%s,%lu,%lu,%lu,%lu\n", stats->name,
+                      (unsigned long)stats->acquired,
+                      (unsigned long)stats->contended,
+                      (unsigned long)stats->spins,
+                      (unsigned long)stats->maxspins);
+  spinlock_copy(rd, linesize);
+}
+
+/****************************************************************************
+ * Name: spinlock_read
+ ****************************************************************************/
+
+static ssize_t spinlock_read(FAR struct file *filep, FAR char *buffer,
+                             size_t buflen)
+{
+  struct spinlock_read_s rd;
+  size_t linesize;
+
+  finfo("buffer=%p buflen=%d\n", buffer, (int)buflen);
+
+  /* Recover our private data from the struct file instance */
+
+  rd.attr      = (FAR struct spinlock_file_s *)filep->f_priv;
+  DEBUGASSERT(rd.attr);
+
+  rd.buffer    = buffer;
+  rd.buflen    = buflen;
+  rd.totalsize = 0;
+  rd.offset    = filep->f_pos;
+
+  linesize = snprintf(rd.attr->line, SPINLOCK_LINELEN,
+                      "name,acquired,contended,spins,maxspins\n");
+  spinlock_copy(&rd, linesize);
+
+  spin_stats_foreach(spinlock_line, &rd);
+
+  /* Update the file offset */
+
+  if (rd.totalsize > 0)
+    {
+      filep->f_pos += rd.totalsize;
+    }
+
+  return rd.totalsize;
+}
+
+/****************************************************************************
+ * Name: spinlock_write
+ *
+ * Description:
+ *   Any write to the file clears the counters of all locks.
+ *
+ ****************************************************************************/
+
+static ssize_t spinlock_write(FAR struct file *filep, FAR const char *buffer,
+                              size_t buflen)
+{
+  spin_stats_reset();
+  return buflen;
+}
+
+/****************************************************************************
+ * Name: spinlock_dup
+ *
+ * Description:
+ *   Duplicate open file data in the new file structure.
+ *
+ ****************************************************************************/
+
+static int spinlock_dup(FAR const struct file *oldp, FAR struct file *newp)
+{
+  FAR struct spinlock_file_s *oldattr;
+  FAR struct spinlock_file_s *newattr;
+
+  finfo("Dup %p->%p\n", oldp, newp);
+
+  /* Recover our private data from the old struct file instance */
+
+  oldattr = (FAR struct spinlock_file_s *)oldp->f_priv;
+  DEBUGASSERT(oldattr);
+
+  /* Allocate a new container to hold the task and attribute selection */
+
+  newattr = kmm_malloc(sizeof(struct spinlock_file_s));
+  if (!newattr)
+    {
+      ferr("ERROR: Failed to allocate file attributes\n");
+      return -ENOMEM;
+    }
+
+  /* The copy the file attributes from the old attributes to the new */
+
+  memcpy(newattr, oldattr, sizeof(struct spinlock_file_s));
+
+  /* Save the new attributes in the new file structure */
+
+  newp->f_priv = (FAR void *)newattr;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: spinlock_stat
+ *
+ * Description: Return information about a file or directory
+ *
+ ****************************************************************************/
+
+static int spinlock_stat(FAR const char *relpath, FAR struct stat *buf)
+{
+  /* "spinlocks" is the only acceptable value for the relpath */
+
+  if (strcmp(relpath, "spinlocks") != 0)
+    {
+      ferr("ERROR: relpath is '%s'\n", relpath);
+      return -ENOENT;
+    }
+
+  /* "spinlocks" is the name for a read/write file */
+
+  memset(buf, 0, sizeof(struct stat));
+  buf->st_mode = S_IFREG | S_IROTH | S_IRGRP | S_IRUSR | S_IWUSR;
+  return OK;
+}
+
+#endif /* !CONFIG_DISABLE_MOUNTPOINT && CONFIG_FS_PROCFS && CONFIG_SPINLOCK_STATS */
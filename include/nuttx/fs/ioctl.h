@@ -87,6 +87,7 @@
 #define _HIMEMBASE      (0x2f00) /* Himem device ioctl commands*/
 #define _EFUSEBASE      (0x3000) /* Efuse device ioctl commands*/
 #define _MTRIOBASE      (0x3100) /* Motor device ioctl commands*/
+#define _USRSOCKBASE    (0x3200) /* Usrsock daemon device ioctl commands */
 #define _WLIOCBASE      (0x8b00) /* Wireless modules ioctl network commands */
 
 /* boardctl() commands share the same number space */
@@ -547,6 +548,11 @@
 #define _MTRIOCVALID(c)     (_IOC_TYPE(c) == _MTRIOBASE)
 #define _MTRIOC(nr)         _IOC(_MTRIOBASE, nr)
 
+/* Usrsock daemon device ****************************************************/
+
+#define _USRSOCKIOCVALID(c) (_IOC_TYPE(c) == _USRSOCKBASE)
+#define _USRSOCKIOC(nr)     _IOC(_USRSOCKBASE, nr)
+
 /* Wireless driver network ioctl definitions ********************************/
 
 /* (see nuttx/include/wireless/wireless.h */
@@ -32,6 +32,10 @@
 
 #include <nuttx/fs/ioctl.h>
 
+#ifdef CONFIG_I2C_ASYNC
+#  include <nuttx/wqueue.h>
+#endif
+
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
@@ -234,6 +238,37 @@ struct i2c_transfer_s
   size_t msgc;                /* Number of messages in the array. */
 };
 
+#ifdef CONFIG_I2C_ASYNC
+/* This describes one transfer queued with i2c_transfer_async().  The
+ * structure, the messages and their buffers belong to the queue until the
+ * callback is called.  The callback runs on the work queue and receives
+ * the result of I2C_TRANSFER().
+ */
+
+struct i2c_async_s;
+typedef CODE void (*i2c_async_callback_t)(FAR struct i2c_async_s *req,
+                                          int result);
+
+struct i2c_async_s
+{
+  FAR struct i2c_async_s *flink;   /* Supports a singly linked list */
+  FAR struct i2c_msg_s *msgv;      /* Array of I2C messages to transfer */
+  size_t msgc;                     /* Number of messages in the array */
+  uint8_t priority;                /* Higher priorities are started first */
+  i2c_async_callback_t callback;   /* Called when the transfer completes */
+  FAR void *arg;                   /* Opaque argument for the callback */
+};
+
+/* One queue of pending transfers for an I2C bus */
+
+struct i2c_queue_s
+{
+  FAR struct i2c_master_s *i2c;    /* The I2C bus */
+  FAR struct i2c_async_s *head;    /* Pending transfers, by priority */
+  struct work_s work;              /* Runs the pending transfers */
+};
+#endif
+
 /****************************************************************************
  * Public Functions Definitions
  ****************************************************************************/
@@ -347,6 +382,71 @@ int i2c_read(FAR struct i2c_master_s *dev,
              FAR const struct i2c_config_s *config,
              FAR uint8_t *buffer, int buflen);
 
+/****************************************************************************
+ * Name: i2c_queue_initialize
+ *
+ * Description:
+ *   Initialize an empty queue of asynchronous transfers for an I2C bus.
+ *   All users of the bus that want asynchronous transfers should share
+ *   the same queue so that their transfers are ordered by priority.
+ *
+ * Input Parameters:
+ *   queue - The queue to initialize
+ *   i2c   - An instance of the lower half I2C driver
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_I2C_ASYNC
+void i2c_queue_initialize(FAR struct i2c_queue_s *queue,
+                          FAR struct i2c_master_s *i2c);
+
+/****************************************************************************
+ * Name: i2c_transfer_async
+ *
+ * Description:
+ *   Queue a transfer of one or more I2C messages and return without
+ *   waiting for it.  Queued transfers are passed to I2C_TRANSFER() one at
+ *   a time, highest priority first and in order of submission for equal
+ *   priorities.  All of the messages of a transfer are given to the lower
+ *   half in one call.  This function may be called from an interrupt
+ *   handler.
+ *
+ * Input Parameters:
+ *   queue - The queue of the I2C bus to use
+ *   req   - Describes the messages and the completion callback
+ *
+ * Returned Value:
+ *   0: success, <0: A negated errno
+ *
+ ****************************************************************************/
+
+int i2c_transfer_async(FAR struct i2c_queue_s *queue,
+                       FAR struct i2c_async_s *req);
+
+/****************************************************************************
+ * Name: i2c_cancel_async
+ *
+ * Description:
+ *   Remove a transfer from the queue before it is started.  The callback
+ *   of a cancelled transfer is not called.
+ *
+ * Input Parameters:
+ *   queue - The queue of the I2C bus
+ *   req   - The transfer to cancel
+ *
+ * Returned Value:
+ *   0: success, -ENOENT if the transfer is not pending, because it has
+ *   already been started or was never queued.
+ *
+ ****************************************************************************/
+
+int i2c_cancel_async(FAR struct i2c_queue_s *queue,
+                     FAR struct i2c_async_s *req);
+#endif
+
 #undef EXTERN
 #if defined(__cplusplus)
 }
@@ -70,10 +70,28 @@
 #  error CONFIG_IOB_NBUFFERS <= CONFIG_IOB_THROTTLE
 #endif
 
+#ifdef CONFIG_IOB_LARGE
+#  if CONFIG_IOB_LARGEBUFSIZE <= CONFIG_IOB_BUFSIZE
+#    error CONFIG_IOB_LARGEBUFSIZE must be larger than CONFIG_IOB_BUFSIZE
+#  endif
+#endif
+
+#ifdef CONFIG_IOB_PERCPU_CACHE
+#  if CONFIG_IOB_PERCPU_CACHE_BATCH > CONFIG_IOB_PERCPU_CACHE_SIZE
+#    error CONFIG_IOB_PERCPU_CACHE_BATCH > CONFIG_IOB_PERCPU_CACHE_SIZE
+#  endif
+#endif
+
 /* IOB helpers */
 
+#ifdef CONFIG_IOB_LARGE
+#  define IOB_BUFSIZE(p) ((p)->io_bufsize)
+#else
+#  define IOB_BUFSIZE(p) CONFIG_IOB_BUFSIZE
+#endif
+
 #define IOB_DATA(p)      (&(p)->io_data[(p)->io_offset])
-#define IOB_FREESPACE(p) (CONFIG_IOB_BUFSIZE - (p)->io_len - (p)->io_offset)
+#define IOB_FREESPACE(p) (IOB_BUFSIZE(p) - (p)->io_len - (p)->io_offset)
 
 #if CONFIG_IOB_NCHAINS > 0
 /* Queue helpers */
@@ -89,6 +107,10 @@
 /* Represents one I/O buffer.  A packet is contained by one or more I/O
  * buffers in a chain.  The io_pktlen is only valid for the I/O buffer at
  * the head of the chain.
+ *
+ * Buffers from the large pool have the same layout, but io_data[] extends
+ * to io_bufsize bytes.  Use IOB_BUFSIZE() rather than CONFIG_IOB_BUFSIZE
+ * for the capacity of a buffer that may be part of any chain.
  */
 
 struct iob_s
@@ -99,7 +121,7 @@ struct iob_s
 
   /* Payload */
 
-#if CONFIG_IOB_BUFSIZE < 256
+#if CONFIG_IOB_BUFSIZE < 256 && !defined(CONFIG_IOB_LARGE)
   uint8_t  io_len;      /* Length of the data in the entry */
   uint8_t  io_offset;   /* Data begins at this offset */
 #else
@@ -107,6 +129,9 @@ struct iob_s
   uint16_t io_offset;   /* Data begins at this offset */
 #endif
   uint16_t io_pktlen;   /* Total length of the packet */
+#ifdef CONFIG_IOB_LARGE
+  uint16_t io_bufsize;  /* Size of io_data[] */
+#endif
 
   uint8_t  io_data[CONFIG_IOB_BUFSIZE];
 };
@@ -188,6 +213,12 @@ enum iob_user_e
 #ifdef CONFIG_NET_IPFORWARD
   IOBUSER_NET_IPFORWARD,
 #endif
+#ifdef CONFIG_NET_ARP_PENDING
+  IOBUSER_NET_ARP_PENDING,
+#endif
+#ifdef CONFIG_NET_IPv6_NCONF_PENDING
+  IOBUSER_NET_NEIGHBOR_PENDING,
+#endif
 #ifdef CONFIG_WIRELESS_IEEE802154
   IOBUSER_WIRELESS_RAD802154,
 #endif
@@ -208,6 +239,9 @@ enum iob_user_e
 #endif
 #ifdef CONFIG_NET_CAN
   IOBUSER_NET_CAN_READAHEAD,
+#endif
+#ifdef CONFIG_CDCECM_IOB_RECV
+  IOBUSER_NET_CDCECM,
 #endif
   IOBUSER_GLOBAL,
   IOBUSER_NENTRIES /* MUST BE LAST ENTRY */
@@ -219,6 +253,17 @@ struct iob_userstats_s
   int totalproduced;
 };
 
+/* Statistics of the buffer pools themselves */
+
+struct iob_poolstats_s
+{
+  uint32_t cachehits;    /* Allocations served from a per-CPU cache */
+  uint32_t cacherefills; /* Batches moved from the free list to a cache */
+  uint32_t cachedrains;  /* Batches moved from a cache to the free list */
+  uint32_t largealloc;   /* Large I/O buffers allocated */
+  uint32_t largemissed;  /* Large I/O buffers wanted but none was free */
+};
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -275,6 +320,32 @@ int iob_navail(bool throttled);
 
 int iob_qentry_navail(void);
 
+/****************************************************************************
+ * Name: iob_large_navail
+ *
+ * Description:
+ *   Return the number of available large IOBs.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_IOB_LARGE
+int iob_large_navail(void);
+#endif
+
+/****************************************************************************
+ * Name: iob_large_tryalloc
+ *
+ * Description:
+ *   Try to allocate a large I/O buffer without waiting.  NULL is returned
+ *   if the large pool is empty; the caller should then fall back to a
+ *   normal I/O buffer.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_IOB_LARGE
+FAR struct iob_s *iob_large_tryalloc(enum iob_user_e consumerid);
+#endif
+
 /****************************************************************************
  * Name: iob_free
  *
@@ -606,5 +677,24 @@ void iob_dump(FAR const char *msg, FAR struct iob_s *iob, unsigned int len,
 FAR struct iob_userstats_s * iob_getuserstats(enum iob_user_e userid);
 #endif
 
+/****************************************************************************
+ * Name: iob_getpoolstats
+ *
+ * Description:
+ *   Return a reference to the statistics of the IOB pools
+ *
+ * Input Parameters:
+ *   None.
+ *
+ * Returned Value:
+ *   A reference to the pool statistics.
+ *
+ ****************************************************************************/
+
+#if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS) && \
+    !defined(CONFIG_FS_PROCFS_EXCLUDE_IOBINFO)
+FAR struct iob_poolstats_s *iob_getpoolstats(void);
+#endif
+
 #endif /* CONFIG_MM_IOB */
 #endif /* _INCLUDE_NUTTX_MM_IOB_H */
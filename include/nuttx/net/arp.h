@@ -174,7 +174,8 @@ void arp_arpin(FAR struct net_driver_s *dev);
  *   packet in the d_buf is replaced by an ARP request packet for the
  *   IPv4 address. The IPv4 packet is dropped and it is assumed that the
  *   higher level protocols (e.g., TCP) eventually will retransmit the
- *   dropped packet.
+ *   dropped packet.  If CONFIG_NET_ARP_PENDING is enabled, a copy of the
+ *   packet is kept instead and sent when the ARP response arrives.
  *
  *   Upon return in either the case, a packet to be sent is present in the
  *   d_buf buffer and the d_len field holds the length of the Ethernet
@@ -184,6 +185,26 @@ void arp_arpin(FAR struct net_driver_s *dev);
 
 void arp_out(FAR struct net_driver_s *dev);
 
+/****************************************************************************
+ * Name: arp_table_resize
+ *
+ * Description:
+ *   Replace the ARP table with an empty table of the given size.  All
+ *   existing entries, and any packets waiting for address resolution, are
+ *   discarded.  The table is otherwise allocated on first use with
+ *   CONFIG_NET_ARPTAB_SIZE entries.
+ *
+ * Input Parameters:
+ *   nentries - The new number of ARP table entries
+ *
+ * Returned Value:
+ *   Zero (OK) on success; a negated errno value on failure, in which case
+ *   the old table is kept.
+ *
+ ****************************************************************************/
+
+int arp_table_resize(unsigned int nentries);
+
 #else /* CONFIG_NET_ARP */
 
 /* If ARP is disabled, stub out all ARP interfaces */
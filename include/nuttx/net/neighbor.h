@@ -96,6 +96,26 @@ extern "C"
  * Public Function Prototypes
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: neighbor_table_resize
+ *
+ * Description:
+ *   Replace the Neighbor table with an empty table of the given size.  All
+ *   existing entries, and any packets waiting for address resolution, are
+ *   discarded.  The table is otherwise allocated on first use with
+ *   CONFIG_NET_IPv6_NCONF_ENTRIES entries.
+ *
+ * Input Parameters:
+ *   nentries - The new number of Neighbor table entries
+ *
+ * Returned Value:
+ *   Zero (OK) on success; a negated errno value on failure, in which case
+ *   the old table is kept.
+ *
+ ****************************************************************************/
+
+int neighbor_table_resize(unsigned int nentries);
+
 #undef EXTERN
 #ifdef __cplusplus
 }
@@ -305,6 +305,23 @@ struct net_driver_s
 
   FAR uint8_t *d_buf;
 
+#ifdef CONFIG_NETDEV_IOB_RECV
+  /* A driver that receives into an I/O buffer may set d_iob to that buffer
+   * before calling the network input function.  The whole packet must be
+   * in that single buffer and d_buf must point into its io_data[].
+   *
+   * The network may then take the buffer over and queue it as read-ahead
+   * data instead of copying the payload.  In that case, d_iob is NULL on
+   * return and the driver must provide a new buffer for the next packet.
+   * Any response that the network placed in d_buf (such as a TCP ACK) is
+   * still in the old buffer and must be sent, or copied, before the
+   * network is unlocked.  If d_iob is still set on return, it continues to
+   * belong to the driver.
+   */
+
+  FAR struct iob_s *d_iob;
+#endif
+
   /* d_appdata points to the location where application data can be read from
    * or written to in the packet buffer.
    */
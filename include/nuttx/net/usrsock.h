@@ -46,12 +46,39 @@
 #include <stdbool.h>
 
 #include <nuttx/net/netconfig.h>
+#include <nuttx/fs/ioctl.h>
 #include <nuttx/compiler.h>
 
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
 
+/* /dev/usrsock ioctl commands.
+ *
+ * USRSOCKIOC_BATCH - Select batched transfers.  By default, each read()
+ *   returns data from one request only and each write() handles one
+ *   message.  With a non-zero argument, read() returns as many queued
+ *   requests as fit in the buffer, back to back, and write() accepts any
+ *   number of complete messages.  The daemon finds the length of each
+ *   request from its header.  lseek() can only move within the first
+ *   request that has not been completely read.
+ *
+ * USRSOCKIOC_SHAREDBUF - Select shared buffer mode (CONFIG_BUILD_FLAT
+ *   only).  With a non-zero argument, the payload of a SENDTO request is
+ *   not copied in the request.  It is replaced with an array of
+ *   struct usrsock_iovec_s describing the sender's buffers, the lengths of
+ *   which add up to 'buflen'.  A RECVFROM request is followed by the
+ *   descriptors of the receive buffer, adding up to 'max_buflen', and the
+ *   daemon copies the received data there before sending the data
+ *   response.  That response is then followed by the value (address)
+ *   only.
+ *
+ * Both modes are reset when /dev/usrsock is closed.
+ */
+
+#define USRSOCKIOC_BATCH             _USRSOCKIOC(0x0001)
+#define USRSOCKIOC_SHAREDBUF         _USRSOCKIOC(0x0002)
+
 /* Event message flags */
 
 #define USRSOCK_EVENT_ABORT          (1 << 1)
@@ -228,6 +255,14 @@ begin_packed_struct struct usrsock_request_ioctl_s
   uint16_t arglen;
 } end_packed_struct;
 
+/* Buffer descriptor used in place of payload data in shared buffer mode */
+
+begin_packed_struct struct usrsock_iovec_s
+{
+  FAR void *base;
+  uint32_t len;
+} end_packed_struct;
+
 /* Response/event message structures (kernel <= /dev/usrsock <= daemon) */
 
 begin_packed_struct struct usrsock_message_common_s
@@ -50,6 +50,14 @@
  *                          noteram_get_taskname_s
  *                Result:   If -ESRCH, the corresponding task name doesn't
  *                          exist.
+ * NOTERAM_GETNRINGS
+ *              - Get the number of note rings (one per CPU if
+ *                CONFIG_DRIVER_NOTERAM_PERCPU is selected, else one)
+ *                Argument: A writable pointer to unsigned int
+ * NOTERAM_GETRING
+ *              - Snapshot the state of one note ring
+ *                Argument: A pointer to struct noteram_ring_s with
+ *                          nr_index set to the ring to query
  */
 
 #ifdef CONFIG_DRIVER_NOTERAM
@@ -59,6 +67,8 @@
 #if CONFIG_DRIVER_NOTERAM_TASKNAME_BUFSIZE > 0
 #define NOTERAM_GETTASKNAME     _NOTERAMIOC(0x04)
 #endif
+#define NOTERAM_GETNRINGS       _NOTERAMIOC(0x05)
+#define NOTERAM_GETRING         _NOTERAMIOC(0x06)
 #endif
 
 /* Overwrite mode definitions */
@@ -83,6 +93,25 @@ struct noteram_get_taskname_s
 };
 #endif
 
+/* This is the type of the argument passed to the NOTERAM_GETRING ioctl.
+ *
+ * nr_head and nr_tail are free-running byte counters; the notes currently
+ * held in the ring start at nr_buffer[nr_tail % nr_bufsize] and are packed
+ * back to back, each beginning with its nc_length byte.  nr_buffer is only
+ * directly accessible in a flat build.
+ */
+
+#ifdef CONFIG_DRIVER_NOTERAM
+struct noteram_ring_s
+{
+  unsigned int nr_index;      /* IN:  Ring (CPU) to query */
+  unsigned int nr_bufsize;    /* OUT: Size of the ring buffer in bytes */
+  unsigned int nr_head;       /* OUT: Index one past the newest note */
+  unsigned int nr_tail;       /* OUT: Index of the oldest note */
+  FAR uint8_t *nr_buffer;     /* OUT: Address of the ring buffer */
+};
+#endif
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -97,17 +97,18 @@
 #define TCB_FLAG_CANCEL_DEFERRED   (1 << 3)                      /* Bit 3: Deferred (vs asynch) cancellation type */
 #define TCB_FLAG_CANCEL_PENDING    (1 << 4)                      /* Bit 4: Pthread cancel is pending */
 #define TCB_FLAG_CANCEL_DOING      (1 << 5)                      /* Bit 4: Pthread cancel/exit is doing */
-#define TCB_FLAG_POLICY_SHIFT      (6)                           /* Bit 5-6: Scheduling policy */
-#define TCB_FLAG_POLICY_MASK       (3 << TCB_FLAG_POLICY_SHIFT)
+#define TCB_FLAG_POLICY_SHIFT      (6)                           /* Bit 6-8: Scheduling policy */
+#define TCB_FLAG_POLICY_MASK       (7 << TCB_FLAG_POLICY_SHIFT)
 #  define TCB_FLAG_SCHED_FIFO      (0 << TCB_FLAG_POLICY_SHIFT)  /* FIFO scheding policy */
 #  define TCB_FLAG_SCHED_RR        (1 << TCB_FLAG_POLICY_SHIFT)  /* Round robin scheding policy */
 #  define TCB_FLAG_SCHED_SPORADIC  (2 << TCB_FLAG_POLICY_SHIFT)  /* Sporadic scheding policy */
 #  define TCB_FLAG_SCHED_OTHER     (3 << TCB_FLAG_POLICY_SHIFT)  /* Other scheding policy */
-#define TCB_FLAG_CPU_LOCKED        (1 << 8)                      /* Bit 7: Locked to this CPU */
-#define TCB_FLAG_SIGNAL_ACTION     (1 << 9)                      /* Bit 8: In a signal handler */
-#define TCB_FLAG_SYSCALL           (1 << 10)                     /* Bit 9: In a system call */
-#define TCB_FLAG_EXIT_PROCESSING   (1 << 11)                     /* Bit 10: Exitting */
-                                                                 /* Bits 11-15: Available */
+#  define TCB_FLAG_SCHED_DEADLINE  (4 << TCB_FLAG_POLICY_SHIFT)  /* Deadline scheding policy */
+#define TCB_FLAG_CPU_LOCKED        (1 << 9)                      /* Bit 9: Locked to this CPU */
+#define TCB_FLAG_SIGNAL_ACTION     (1 << 10)                     /* Bit 10: In a signal handler */
+#define TCB_FLAG_SYSCALL           (1 << 11)                     /* Bit 11: In a system call */
+#define TCB_FLAG_EXIT_PROCESSING   (1 << 12)                     /* Bit 12: Exitting */
+                                                                 /* Bits 13-15: Available */
 
 /* Values for struct task_group tg_flags */
 
@@ -220,6 +221,9 @@ enum tstate_e
 #ifdef CONFIG_SIG_SIGSTOP_ACTION
   TSTATE_TASK_STOPPED,        /* BLOCKED      - Waiting for SIGCONT */
 #endif
+#ifdef CONFIG_SCHED_DEADLINE
+  TSTATE_WAIT_DEADLINE,       /* BLOCKED      - Waiting for budget replenishment */
+#endif
 
   NUM_TASK_STATES             /* Must be last */
 };
@@ -317,6 +321,27 @@ struct sporadic_s
 
 #endif /* CONFIG_SCHED_SPORADIC */
 
+/* struct deadline_s ********************************************************/
+
+#ifdef CONFIG_SCHED_DEADLINE
+/* This structure holds the SCHED_DEADLINE reservation of a thread and the
+ * state of its constant bandwidth server.  All times are in system clock
+ * ticks.
+ */
+
+struct deadline_s
+{
+  uint32_t  runtime;                /* Execution time reserved per period       */
+  uint32_t  deadline;               /* Relative deadline                        */
+  uint32_t  period;                 /* Reservation period                       */
+  uint32_t  bandwidth;              /* runtime/period, see sched_deadline.c     */
+  int32_t   budget;                 /* Execution time left in this period       */
+  clock_t   abstime;                /* Current absolute deadline                */
+  clock_t   eventtime;              /* Time the thread was last resumed         */
+  struct wdog_s timer;              /* Ends the throttling of the thread        */
+};
+#endif /* CONFIG_SCHED_DEADLINE */
+
 /* struct child_status_s ****************************************************/
 
 /* This structure is used to maintain information about child tasks.
@@ -411,6 +436,51 @@ struct stackinfo_s
                                          /* from the stack.                     */
 };
 
+/* struct latency_hist_s ****************************************************/
+
+#ifdef CONFIG_SCHED_LATENCY_HIST
+/* These are the hot paths whose latency is collected in histograms */
+
+enum latency_type_e
+{
+  LATENCY_IRQ = 0,                       /* Time spent in interrupt handlers    */
+  LATENCY_CSECTION,                      /* Critical section hold time          */
+  LATENCY_SCHEDLOCK,                     /* Pre-emption disabled time           */
+  LATENCY_WAKEUP,                        /* Ready-to-run until running          */
+  LATENCY_SEMWAIT,                       /* Time blocked on a semaphore         */
+  LATENCY_NTYPES
+};
+
+/* A log2 histogram of elapsed times in up_critmon_gettime() units.  Bucket
+ * 0 counts zero elapsed times, bucket n counts times in the range
+ * [2^(n-1), 2^n) and the last bucket counts everything beyond that.
+ */
+
+struct latency_hist_s
+{
+  uint32_t count[CONFIG_SCHED_LATENCY_NBUCKETS];
+  uint32_t max;                          /* Largest elapsed time recorded       */
+};
+#endif
+
+/* struct sched_rqstats_s ***************************************************/
+
+#ifdef CONFIG_SCHED_LOADBALANCE
+/* Run queue statistics of one CPU, see nxsched_get_rqstats() */
+
+struct sched_rqstats_s
+{
+  uint8_t  runprio;                      /* Priority of the running task        */
+  uint8_t  load;                         /* Busy percentage (with CPULOAD)      */
+  uint16_t nassigned;                    /* Tasks assigned, not counting IDLE   */
+  uint16_t nwaiting;                     /* Unassigned tasks that may run here  */
+  uint32_t migrations;                   /* Tasks started after running on      */
+                                         /* another CPU                         */
+  uint32_t balances;                     /* Balance passes run on this CPU      */
+  uint32_t pulls;                        /* Stranded tasks moved by the passes  */
+};
+#endif
+
 /* struct exitinfo_s ********************************************************/
 
 struct exitinfo_s
@@ -655,6 +725,9 @@ struct tcb_s
 #ifdef CONFIG_SCHED_SPORADIC
   FAR struct sporadic_s *sporadic;       /* Sporadic scheduling parameters  */
 #endif
+#ifdef CONFIG_SCHED_DEADLINE
+  struct deadline_s deadline;            /* Deadline scheduling parameters  */
+#endif
 
   struct wdog_s waitdog;                 /* All timed waits use this timer  */
 
@@ -678,6 +751,10 @@ struct tcb_s
   /* POSIX Semaphore Control Fields *****************************************/
 
   sem_t *waitsem;                        /* Semaphore ID waiting on         */
+#ifdef CONFIG_PRIORITY_INHERITANCE
+  FAR struct tcb_s *waitlink;            /* Next waiter on waitsem          */
+  FAR struct semholder_s *holdsem;       /* Semaphores held by the thread   */
+#endif
 
   /* POSIX Signal Control Fields ********************************************/
 
@@ -708,6 +785,17 @@ struct tcb_s
   uint32_t crit_max;                     /* Max time in critical section        */
 #endif
 
+#ifdef CONFIG_SCHED_LATENCY_HIST
+  uint32_t ready_start;                  /* Time when made ready-to-run         */
+#ifdef CONFIG_SCHED_LATENCY_HIST_PERTASK
+  struct latency_hist_s latency[LATENCY_NTYPES]; /* Per-thread histograms */
+#endif
+#endif
+
+#ifdef CONFIG_SCHED_LOADBALANCE
+  clock_t  last_run;                     /* Time when last suspended            */
+#endif
+
   /* State save areas *******************************************************/
 
   /* The form and content of these fields are platform-specific.            */
@@ -808,6 +896,17 @@ EXTERN uint32_t g_crit_max[1];
 #endif
 #endif /* CONFIG_SCHED_CRITMONITOR */
 
+#ifdef CONFIG_SCHED_LATENCY_HIST
+/* Per-CPU latency histograms, see sched/sched/sched_latency.c */
+
+#ifdef CONFIG_SMP_NCPUS
+EXTERN struct latency_hist_s
+  g_latency_hist[CONFIG_SMP_NCPUS][LATENCY_NTYPES];
+#else
+EXTERN struct latency_hist_s g_latency_hist[1][LATENCY_NTYPES];
+#endif
+#endif /* CONFIG_SCHED_LATENCY_HIST */
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -849,6 +948,44 @@ FAR struct tcb_s *nxsched_self(void);
 
 void nxsched_foreach(nxsched_foreach_t handler, FAR void *arg);
 
+/****************************************************************************
+ * Name: nxsched_latency_reset
+ *
+ * Description:
+ *   Clear the per-CPU latency histograms and, if enabled, the histograms
+ *   of every thread.
+ *
+ * Input Parameters:
+ *   None
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_LATENCY_HIST
+void nxsched_latency_reset(void);
+#endif
+
+/****************************************************************************
+ * Name: nxsched_get_rqstats
+ *
+ * Description:
+ *   Return a snapshot of the run queue statistics of one CPU.
+ *
+ * Input Parameters:
+ *   cpu   - The CPU of interest
+ *   stats - The location to return the statistics
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_LOADBALANCE
+void nxsched_get_rqstats(int cpu, FAR struct sched_rqstats_s *stats);
+#endif
+
 /****************************************************************************
  * Name: nxsched_get_tcb
  *
@@ -147,6 +147,11 @@ enum note_type_e
   NOTE_IRQ_ENTER       = 20,
   NOTE_IRQ_LEAVE       = 21
 #endif
+#ifdef CONFIG_SCHED_INSTRUMENTATION_PRIOINHERIT
+  ,
+  NOTE_PRIO_BOOST      = 22,
+  NOTE_PRIO_RESTORE    = 23
+#endif
 };
 
 /* This structure provides the common header of each note */
@@ -318,6 +323,20 @@ struct note_irqhandler_s
 };
 #endif /* CONFIG_SCHED_INSTRUMENTATION_IRQHANDLER */
 
+#ifdef CONFIG_SCHED_INSTRUMENTATION_PRIOINHERIT
+/* This is the specific form of the NOTE_PRIO_BOOST/RESTORE notes.  The
+ * common header carries the priority before the change.
+ */
+
+struct note_prioinherit_s
+{
+  struct note_common_s npi_cmn; /* Common note parameters */
+  uint8_t npi_priority;         /* New priority of the thread */
+  uint8_t npi_depth;            /* Position in the inheritance chain */
+  uint8_t npi_waiter[2];        /* ID of the waiter causing the boost */
+};
+#endif /* CONFIG_SCHED_INSTRUMENTATION_PRIOINHERIT */
+
 #ifdef CONFIG_SCHED_INSTRUMENTATION_FILTER
 
 /* This is the type of the argument passed to the NOTECTL_GETMODE and
@@ -439,6 +458,15 @@ void sched_note_irqhandler(int irq, FAR void *handler, bool enter);
 #  define sched_note_irqhandler(i,h,e)
 #endif
 
+#ifdef CONFIG_SCHED_INSTRUMENTATION_PRIOINHERIT
+void sched_note_prio_boost(FAR struct tcb_s *tcb, FAR struct tcb_s *wtcb,
+                           int priority, int depth);
+void sched_note_prio_restore(FAR struct tcb_s *tcb, int priority);
+#else
+#  define sched_note_prio_boost(t,w,p,d)
+#  define sched_note_prio_restore(t,p)
+#endif
+
 #if defined(__KERNEL__) || defined(CONFIG_BUILD_FLAT)
 
 /****************************************************************************
@@ -561,6 +589,8 @@ void sched_note_filter_irq(struct note_filter_irq_s *oldf,
 #  define sched_note_syscall_enter(n,a...)
 #  define sched_note_syscall_leave(n,r)
 #  define sched_note_irqhandler(i,h,e)
+#  define sched_note_prio_boost(t,w,p,d)
+#  define sched_note_prio_restore(t,p)
 
 #endif /* CONFIG_SCHED_INSTRUMENTATION */
 #endif /* __INCLUDE_NUTTX_SCHED_NOTE_H */
@@ -134,6 +134,10 @@ extern "C"
  *   of referring to copies of sem in calls to sem_wait(), sem_trywait(),
  *   sem_post(), and sem_destroy() is undefined.
  *
+ *   With priority inheritance, the holder records of a semaphore are also
+ *   linked into the lists of the holder threads.  Records left over from
+ *   an earlier use of the memory are dropped.
+ *
  * Input Parameters:
  *   sem - Semaphore to be initialized
  *   pshared - Process sharing (not used)
@@ -620,6 +624,28 @@ int nxsem_clockwait_uninterruptible(FAR sem_t *sem, clockid_t clockid,
 int nxsem_tickwait_uninterruptible(FAR sem_t *sem, clock_t start,
                                    uint32_t delay);
 
+/****************************************************************************
+ * Name: nxsem_drop_holders
+ *
+ * Description:
+ *   Release any priority inheritance holder records that still refer to
+ *   the memory of a semaphore.  Called by nxsem_init() so that a held
+ *   semaphore whose memory is reused without nxsem_destroy() does not
+ *   leave records behind in the lists of the holder threads.
+ *
+ * Input Parameters:
+ *   sem - The semaphore about to be initialized.  Its contents are not
+ *         examined.
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_PRIORITY_INHERITANCE
+void nxsem_drop_holders(FAR sem_t *sem);
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
@@ -284,4 +284,31 @@
 
 #define SNIOC_SET_BUFFER_NUMBER    _SNIOC(0x0084)
 
+/* Command:      SNIOC_SET_WATERMARK
+ * Description:  Set the number of events that must be pending for the
+ *               caller before a blocked read() returns or poll() reports
+ *               POLLIN.
+ * Argument:     This is the number of events, at least one.
+ * Note:         Each opened file has its own watermark and read position,
+ *               so several readers can consume the same events at
+ *               different rates.  Non-blocking reads return whatever is
+ *               pending regardless of the watermark.
+ */
+
+#define SNIOC_SET_WATERMARK        _SNIOC(0x0085)
+
+/* Command:      SNIOC_GET_RING
+ * Description:  Get the state of the event ring of the upper half.
+ * Argument:     A writable pointer to struct sensor_ring_s.
+ * Note:         In the flat build the ring can be mapped with mmap() (see
+ *               FIOC_MMAP) and the events read in place:  the event at
+ *               position pos is at base + pos % size and is valid while
+ *               head - pos <= size.  Read head again after copying an
+ *               event to detect that it was overwritten meanwhile.
+ *               SNIOC_BATCH and SNIOC_SET_BUFFER_NUMBER may reallocate the
+ *               ring; query it again afterwards.
+ */
+
+#define SNIOC_GET_RING             _SNIOC(0x0086)
+
 #endif /* __INCLUDE_NUTTX_SENSORS_IOCTL_H */
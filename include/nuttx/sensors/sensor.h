@@ -414,6 +414,16 @@ struct sensor_event_hbeat   /* Type: Heart Beat */
   float beat;               /* Units is times/minutes */
 };
 
+/* The state of the event ring of the upper half (see SNIOC_GET_RING) */
+
+struct sensor_ring_s
+{
+  FAR void *base;           /* The address of the ring */
+  size_t size;              /* The size of the ring in bytes */
+  size_t head;              /* Position of the next event to be written */
+  uint8_t esize;            /* The size of one event in bytes */
+};
+
 /* The sensor lower half driver interface */
 
 struct sensor_lowerhalf_s;
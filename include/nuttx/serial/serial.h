@@ -286,6 +286,15 @@ struct uart_dev_s
   tcflag_t             tc_iflag;     /* Input modes */
   tcflag_t             tc_oflag;     /* Output modes */
   tcflag_t             tc_lflag;     /* Local modes */
+  cc_t                 tc_vmin;      /* Minimum bytes returned by read */
+  cc_t                 tc_vtime;     /* Inter-byte read timeout (deciseconds) */
+
+  /* Receive wakeup coalescing */
+
+  volatile int16_t     recvwakeup;   /* Bytes buffered before waking reader */
+  volatile bool        recvidle;     /* true: RX line went idle */
+  volatile clock_t     recvtick;     /* Time the last data was received */
+
 #if defined(CONFIG_TTY_SIGINT) || defined(CONFIG_TTY_SIGTSTP)
   pid_t                pid;          /* Thread PID to receive signals (-1 if none) */
 #endif
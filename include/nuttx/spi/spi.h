@@ -433,6 +433,37 @@
 #  define SPI_TRIGGER(d) \
   (((d)->ops->trigger) ? ((d)->ops->trigger(d)) : -ENOSYS)
 
+/****************************************************************************
+ * Name: SPI_SEQUENCE
+ *
+ * Description:
+ *   Start a whole sequence of transfers (see struct spi_sequence_s) and
+ *   return without waiting for it, e.g. by chaining the transfers in DMA
+ *   descriptors.  The lower half selects the device, applies the sequence
+ *   properties and honors the delays and deselects between transfers just
+ *   as spi_transfer() would.  The bus belongs to the sequence until the
+ *   done callback is called, normally from the interrupt handler.  Used by
+ *   spi_transfer_async().  Optional.
+ *
+ * Input Parameters:
+ *   dev  - Device-specific state data
+ *   seq  - The sequence of transfers
+ *   done - Called once with the result when the sequence completes
+ *   arg  - A caller provided value to return with the callback
+ *
+ * Returned Value:
+ *   OK      - The sequence was started and done will be called
+ *   -ENOSYS - The sequence can not be started this way; the caller falls
+ *             back to spi_transfer().  done will not be called.
+ *   Other negated errno values on failure.  done will not be called.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SPI_ASYNC
+#  define SPI_SEQUENCE(d,s,c,a) \
+  (((d)->ops->sequence) ? ((d)->ops->sequence(d,s,c,a)) : -ENOSYS)
+#endif
+
 /* SPI Device Macros ********************************************************/
 
 /* This builds a SPI devid from its type and index */
@@ -533,9 +564,18 @@ enum spi_mode_e
 typedef uint8_t spi_hwfeatures_t;
 #endif
 
+#ifdef CONFIG_SPI_ASYNC
+/* Called by the lower half when a sequence started by SPI_SEQUENCE()
+ * completes.
+ */
+
+typedef CODE void (*spi_seqdone_t)(FAR void *arg, int result);
+#endif
+
 /* The SPI vtable */
 
 struct spi_dev_s;
+struct spi_sequence_s;
 struct spi_ops_s
 {
   CODE int      (*lock)(FAR struct spi_dev_s *dev, bool lock);
@@ -574,6 +614,11 @@ struct spi_ops_s
 #endif
   CODE int      (*registercallback)(FAR struct spi_dev_s *dev,
                   spi_mediachange_t callback, void *arg);
+#ifdef CONFIG_SPI_ASYNC
+  CODE int      (*sequence)(FAR struct spi_dev_s *dev,
+                  FAR struct spi_sequence_s *seq, spi_seqdone_t done,
+                  FAR void *arg);
+#endif
 };
 
 /* SPI private data.  This structure only defines the initial fields of the
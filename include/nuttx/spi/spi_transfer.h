@@ -34,6 +34,10 @@
 #include <nuttx/fs/ioctl.h>
 #include <nuttx/spi/spi.h>
 
+#ifdef CONFIG_SPI_ASYNC
+#  include <nuttx/wqueue.h>
+#endif
+
 #ifdef CONFIG_SPI_EXCHANGE
 
 /* SPI Character Driver IOCTL Commands **************************************/
@@ -111,6 +115,39 @@ struct spi_sequence_s
   FAR struct spi_trans_s *trans;
 };
 
+#ifdef CONFIG_SPI_ASYNC
+/* This describes one sequence queued with spi_transfer_async().  The
+ * structure, the sequence and its buffers belong to the queue until the
+ * callback is called.  The callback runs on the work queue and receives
+ * the result of the sequence.
+ */
+
+struct spi_async_s;
+typedef CODE void (*spi_async_callback_t)(FAR struct spi_async_s *req,
+                                          int result);
+
+struct spi_async_s
+{
+  FAR struct spi_async_s *flink;   /* Supports a singly linked list */
+  FAR struct spi_sequence_s *seq;  /* The sequence of transfers */
+  uint8_t priority;                /* Higher priorities are started first */
+  spi_async_callback_t callback;   /* Called when the sequence completes */
+  FAR void *arg;                   /* Opaque argument for the callback */
+};
+
+/* One queue of pending sequences for an SPI bus */
+
+struct spi_queue_s
+{
+  FAR struct spi_dev_s *spi;       /* The SPI bus */
+  FAR struct spi_async_s *head;    /* Pending sequences, by priority */
+  FAR struct spi_async_s *active;  /* Sequence being performed */
+  FAR struct spi_async_s *done;    /* Completed by the lower half */
+  int result;                      /* Result of the done sequence */
+  struct work_s work;              /* Runs the pending sequences */
+};
+#endif
+
 /****************************************************************************
  * Public Functions Definitions
  ****************************************************************************/
@@ -134,6 +171,75 @@ struct spi_sequence_s
 
 int spi_transfer(FAR struct spi_dev_s *spi, FAR struct spi_sequence_s *seq);
 
+/****************************************************************************
+ * Name: spi_queue_initialize
+ *
+ * Description:
+ *   Initialize an empty queue of asynchronous transfers for an SPI bus.
+ *   All users of the bus that want asynchronous transfers should share
+ *   the same queue so that their sequences are ordered by priority.
+ *
+ * Input Parameters:
+ *   queue - The queue to initialize
+ *   spi   - An instance of the SPI device to use for the transfers
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SPI_ASYNC
+void spi_queue_initialize(FAR struct spi_queue_s *queue,
+                          FAR struct spi_dev_s *spi);
+
+/****************************************************************************
+ * Name: spi_transfer_async
+ *
+ * Description:
+ *   Queue a sequence of SPI transfers and return without waiting for it.
+ *   Queued sequences are performed one at a time, highest priority first
+ *   and in order of submission for equal priorities.  This function may be
+ *   called from an interrupt handler.
+ *
+ *   If the lower half implements SPI_SEQUENCE(), the work queue only
+ *   starts each sequence.  Otherwise the work queue performs it with
+ *   spi_transfer(), which occupies the work queue thread (and delays the
+ *   queues of other buses served by that thread) until the sequence
+ *   completes.
+ *
+ * Input Parameters:
+ *   queue - The queue of the SPI bus to use
+ *   req   - Describes the sequence and the completion callback
+ *
+ * Returned Value:
+ *   Zero (OK) on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int spi_transfer_async(FAR struct spi_queue_s *queue,
+                       FAR struct spi_async_s *req);
+
+/****************************************************************************
+ * Name: spi_cancel_async
+ *
+ * Description:
+ *   Remove a sequence from the queue before it is started.  The callback
+ *   of a cancelled sequence is not called.
+ *
+ * Input Parameters:
+ *   queue - The queue of the SPI bus
+ *   req   - The sequence to cancel
+ *
+ * Returned Value:
+ *   Zero (OK) on success; -ENOENT if the sequence is not pending, because
+ *   it has already been started or was never queued.
+ *
+ ****************************************************************************/
+
+int spi_cancel_async(FAR struct spi_queue_s *queue,
+                     FAR struct spi_async_s *req);
+#endif
+
 /****************************************************************************
  * Name: spi_register
  *
@@ -29,6 +29,7 @@
 
 #include <sys/types.h>
 #include <stdint.h>
+#include <stdbool.h>
 
 #include <nuttx/irq.h>
 
@@ -83,6 +84,94 @@ typedef struct
 #  define __SP_UNLOCK_FUNCTION 1
 #endif
 
+/* Static initializers for the lock types below */
+
+#ifdef CONFIG_SPINLOCK_STATS
+#  define SPINLOCK_STATS_INITIALIZER , {NULL, NULL, 0, 0, 0, 0}
+#else
+#  define SPINLOCK_STATS_INITIALIZER
+#endif
+
+#define TICKETLOCK_INITIALIZER \
+  {0, 0, SP_UNLOCKED SPINLOCK_STATS_INITIALIZER}
+#define MCSLOCK_INITIALIZER \
+  {NULL, SP_UNLOCKED SPINLOCK_STATS_INITIALIZER}
+#define RWLOCK_INITIALIZER \
+  {0, 0, SP_UNLOCKED SPINLOCK_STATS_INITIALIZER}
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* Contention statistics of one named lock.  The counters are updated by
+ * the thread that just acquired the lock, so they are exact for ticket
+ * and queued locks and approximate for the read side of a rwlock_t.
+ */
+
+#ifdef CONFIG_SPINLOCK_STATS
+struct spinlock_stats_s
+{
+  FAR struct spinlock_stats_s *flink;  /* Next registered lock */
+  FAR const char *name;                /* Name of the lock */
+  uint32_t acquired;                   /* Number of acquisitions */
+  uint32_t contended;                  /* Acquisitions that had to wait */
+  uint32_t spins;                      /* Total wait loop iterations */
+  uint32_t maxspins;                   /* Longest single wait */
+};
+
+typedef CODE void (*spin_stats_handler_t)
+  (FAR const struct spinlock_stats_s *stats, FAR void *arg);
+#endif
+
+/* A ticket lock grants the lock in the order in which it was requested.
+ * While waiting, a CPU only reads 'owner' so the waiters do not keep
+ * stealing the cache line from each other.
+ */
+
+typedef struct
+{
+  volatile uint16_t next;        /* Next ticket to hand out */
+  volatile uint16_t owner;       /* Ticket that now holds the lock */
+  spinlock_t guard;              /* Makes taking a ticket atomic */
+#ifdef CONFIG_SPINLOCK_STATS
+  struct spinlock_stats_s stats;
+#endif
+} ticketlock_t;
+
+/* A queued (MCS) lock.  Each waiter spins on a flag in its own queue node,
+ * normally allocated on its stack, and the holder hands the lock directly
+ * to the next node on release.
+ */
+
+struct mcs_node_s
+{
+  FAR struct mcs_node_s *volatile next;  /* Next waiter in the queue */
+  volatile bool locked;                  /* True while this node waits */
+};
+
+typedef struct
+{
+  FAR struct mcs_node_s *volatile tail;  /* Last node in the queue */
+  spinlock_t guard;                      /* Makes queue updates atomic */
+#ifdef CONFIG_SPINLOCK_STATS
+  struct spinlock_stats_s stats;
+#endif
+} mcslock_t;
+
+/* A reader-writer spinlock.  Any number of readers or one writer may hold
+ * the lock.  A waiting writer holds off new readers.
+ */
+
+typedef struct
+{
+  volatile int16_t count;        /* >0: readers, -1: writer, 0: free */
+  volatile uint16_t wwait;       /* Number of waiting writers */
+  spinlock_t guard;              /* Makes count updates atomic */
+#ifdef CONFIG_SPINLOCK_STATS
+  struct spinlock_stats_s stats;
+#endif
+} rwlock_t;
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -351,6 +440,203 @@ void spin_clrbit(FAR volatile cpu_set_t *set, unsigned int cpu,
                  FAR volatile spinlock_t *orlock);
 #endif
 
+/****************************************************************************
+ * Name: ticket_initialize
+ *
+ * Description:
+ *   Initialize a ticket lock to its unlocked state.  If 'name' is not NULL
+ *   and CONFIG_SPINLOCK_STATS is enabled, the lock's contention statistics
+ *   are registered under that name.
+ *
+ ****************************************************************************/
+
+void ticket_initialize(FAR ticketlock_t *lock, FAR const char *name);
+
+/****************************************************************************
+ * Name: ticket_lock
+ *
+ * Description:
+ *   Take a ticket and spin until it is served.  Waiting CPUs acquire the
+ *   lock in FIFO order.  The lock is not reentrant and the caller must
+ *   disable local interrupts if the lock is also taken by interrupt
+ *   handlers.
+ *
+ ****************************************************************************/
+
+void ticket_lock(FAR ticketlock_t *lock);
+
+/****************************************************************************
+ * Name: ticket_trylock
+ *
+ * Description:
+ *   Take the ticket lock only if it is free and nobody is waiting.
+ *   Returns true if the lock was acquired.
+ *
+ ****************************************************************************/
+
+bool ticket_trylock(FAR ticketlock_t *lock);
+
+/****************************************************************************
+ * Name: ticket_unlock
+ *
+ * Description:
+ *   Release the ticket lock to the next waiter, if any.
+ *
+ ****************************************************************************/
+
+void ticket_unlock(FAR ticketlock_t *lock);
+
+/* bool ticket_islocked(FAR ticketlock_t *lock); */
+#define ticket_islocked(l) ((l)->next != (l)->owner)
+
+/****************************************************************************
+ * Name: mcs_initialize
+ *
+ * Description:
+ *   Initialize a queued lock to its unlocked state.  See
+ *   ticket_initialize() for the meaning of 'name'.
+ *
+ ****************************************************************************/
+
+void mcs_initialize(FAR mcslock_t *lock, FAR const char *name);
+
+/****************************************************************************
+ * Name: mcs_lock
+ *
+ * Description:
+ *   Queue 'node' on the lock and spin on it until the lock is handed over.
+ *   'node' must stay valid until the matching mcs_unlock(), which must be
+ *   passed the same node.
+ *
+ ****************************************************************************/
+
+void mcs_lock(FAR mcslock_t *lock, FAR struct mcs_node_s *node);
+
+/****************************************************************************
+ * Name: mcs_trylock
+ *
+ * Description:
+ *   Take the queued lock only if it is free.  Returns true if the lock was
+ *   acquired, in which case 'node' must be passed to mcs_unlock().
+ *
+ ****************************************************************************/
+
+bool mcs_trylock(FAR mcslock_t *lock, FAR struct mcs_node_s *node);
+
+/****************************************************************************
+ * Name: mcs_unlock
+ *
+ * Description:
+ *   Hand the queued lock to the next waiter or release it.
+ *
+ ****************************************************************************/
+
+void mcs_unlock(FAR mcslock_t *lock, FAR struct mcs_node_s *node);
+
+/****************************************************************************
+ * Name: rwlock_initialize
+ *
+ * Description:
+ *   Initialize a reader-writer spinlock to its unlocked state.  See
+ *   ticket_initialize() for the meaning of 'name'.
+ *
+ ****************************************************************************/
+
+void rwlock_initialize(FAR rwlock_t *lock, FAR const char *name);
+
+/****************************************************************************
+ * Name: read_lock, read_trylock, read_unlock
+ *
+ * Description:
+ *   Acquire and release a reader-writer spinlock for reading.  The read
+ *   lock is not recursive:  Taking it again while a writer waits would
+ *   deadlock.  read_trylock() returns true if the lock was acquired.
+ *
+ ****************************************************************************/
+
+void read_lock(FAR rwlock_t *lock);
+bool read_trylock(FAR rwlock_t *lock);
+void read_unlock(FAR rwlock_t *lock);
+
+/****************************************************************************
+ * Name: write_lock, write_trylock, write_unlock
+ *
+ * Description:
+ *   Acquire and release a reader-writer spinlock for writing.
+ *   write_trylock() returns true if the lock was acquired.
+ *
+ ****************************************************************************/
+
+void write_lock(FAR rwlock_t *lock);
+bool write_trylock(FAR rwlock_t *lock);
+void write_unlock(FAR rwlock_t *lock);
+
+/****************************************************************************
+ * Name: spin_stats_register
+ *
+ * Description:
+ *   Register the contention statistics of a lock under 'name' so that
+ *   they are reported by spin_stats_foreach().
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SPINLOCK_STATS
+void spin_stats_register(FAR struct spinlock_stats_s *stats,
+                         FAR const char *name);
+#endif
+
+/****************************************************************************
+ * Name: spin_stats_unregister
+ *
+ * Description:
+ *   Remove registered statistics.  This must be called before the memory
+ *   holding a named lock is released.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SPINLOCK_STATS
+void spin_stats_unregister(FAR struct spinlock_stats_s *stats);
+#endif
+
+/****************************************************************************
+ * Name: spin_stats_acquired
+ *
+ * Description:
+ *   Account for one acquisition of a lock after 'spins' iterations of its
+ *   wait loop.  Called by the lock implementations while holding the lock.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SPINLOCK_STATS
+void spin_stats_acquired(FAR struct spinlock_stats_s *stats,
+                         uint32_t spins);
+#endif
+
+/****************************************************************************
+ * Name: spin_stats_foreach
+ *
+ * Description:
+ *   Call 'handler' for each registered lock.  The handler runs with local
+ *   interrupts disabled and must not take any of the registered locks.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SPINLOCK_STATS
+void spin_stats_foreach(spin_stats_handler_t handler, FAR void *arg);
+#endif
+
+/****************************************************************************
+ * Name: spin_stats_reset
+ *
+ * Description:
+ *   Clear the counters of all registered locks.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SPINLOCK_STATS
+void spin_stats_reset(void);
+#endif
+
 #endif /* CONFIG_SPINLOCK */
 
 /****************************************************************************
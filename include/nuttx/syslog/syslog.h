@@ -31,6 +31,7 @@
 
 #include <sys/types.h>
 #include <stdarg.h>
+#include <stdint.h>
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -270,6 +271,25 @@ FAR struct syslog_channel_s *syslog_file_channel(FAR const char *devpath);
 
 int syslog_flush(void);
 
+/****************************************************************************
+ * Name: syslog_deferred_dropped
+ *
+ * Description:
+ *   Return the total number of SYSLOG messages that were dropped because a
+ *   deferred ring was full (CONFIG_SYSLOG_DEFERRED).
+ *
+ * Input Parameters:
+ *   None
+ *
+ * Returned Value:
+ *   The number of dropped messages since boot.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SYSLOG_DEFERRED
+uint32_t syslog_deferred_dropped(void);
+#endif
+
 /****************************************************************************
  * Name: nx_vsyslog
  *
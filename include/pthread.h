@@ -371,7 +371,12 @@ typedef struct pthread_barrierattr_s pthread_barrierattr_t;
 
 struct pthread_barrier_s
 {
+#ifdef CONFIG_FUTEX
+  volatile uint32_t seq;      /* Incremented each time the barrier opens */
+  volatile uint32_t arrived;  /* Number of threads waiting at the barrier */
+#else
   sem_t        sem;
+#endif
   unsigned int count;
 };
 
@@ -387,8 +392,13 @@ typedef bool pthread_once_t;
 
 struct pthread_rwlock_s
 {
+#ifdef CONFIG_FUTEX
+  volatile uint32_t lock;  /* Futex lock word protecting the fields below */
+  volatile uint32_t cv;    /* Futex condition word */
+#else
   pthread_mutex_t lock;
   pthread_cond_t  cv;
+#endif
   unsigned int num_readers;
   unsigned int num_writers;
   bool write_in_progress;
@@ -398,9 +408,13 @@ typedef struct pthread_rwlock_s pthread_rwlock_t;
 
 typedef int pthread_rwlockattr_t;
 
-#define PTHREAD_RWLOCK_INITIALIZER  {PTHREAD_MUTEX_INITIALIZER, \
-                                     PTHREAD_COND_INITIALIZER, \
-                                     0, 0, false}
+#ifdef CONFIG_FUTEX
+#  define PTHREAD_RWLOCK_INITIALIZER  {0, 0, 0, 0, false}
+#else
+#  define PTHREAD_RWLOCK_INITIALIZER  {PTHREAD_MUTEX_INITIALIZER, \
+                                       PTHREAD_COND_INITIALIZER, \
+                                       0, 0, false}
+#endif
 
 #ifdef CONFIG_PTHREAD_SPINLOCKS
 /* This (non-standard) structure represents a pthread spinlock */
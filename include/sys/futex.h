@@ -0,0 +1,104 @@
+/****************************************************************************
+ * include/sys/futex.h
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_SYS_FUTEX_H
+#define __INCLUDE_SYS_FUTEX_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <time.h>
+
+#ifdef CONFIG_FUTEX
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifdef __cplusplus
+#define EXTERN extern "C"
+extern "C"
+{
+#else
+#define EXTERN extern
+#endif
+
+/****************************************************************************
+ * Name: futex_wait
+ *
+ * Description:
+ *   Block the calling thread until futex_wake() is called on the same
+ *   address, provided that the 32-bit word at addr still contains val.
+ *   The comparison and the blocking are atomic with respect to
+ *   futex_wake():  A thread that changes the word and then calls
+ *   futex_wake() will never miss a waiter that saw the old value.
+ *
+ *   Like all futex waits, the wakeup may be spurious.  The caller must
+ *   re-examine the word after the return.
+ *
+ * Input Parameters:
+ *   addr    - The address of the futex word
+ *   val     - The value that the caller expects to find in the word
+ *   clockid - The clock that abstime refers to
+ *   abstime - The absolute time of the timeout.  NULL waits forever.
+ *
+ * Returned Value:
+ *   Zero (OK) is returned when woken.  Otherwise, -1 (ERROR) is returned
+ *   and the errno value is set appropriately:
+ *
+ *   EAGAIN    The word did not contain val
+ *   ETIMEDOUT The timeout expired
+ *   EINTR     The wait was interrupted by a signal
+ *   EINVAL    addr is NULL or not aligned
+ *
+ ****************************************************************************/
+
+int futex_wait(FAR volatile uint32_t *addr, uint32_t val,
+               clockid_t clockid, FAR const struct timespec *abstime);
+
+/****************************************************************************
+ * Name: futex_wake
+ *
+ * Description:
+ *   Wake up to nwake threads waiting on the futex word at addr.  The
+ *   highest priority waiters are woken first.
+ *
+ * Input Parameters:
+ *   addr  - The address of the futex word
+ *   nwake - The maximum number of threads to wake
+ *
+ * Returned Value:
+ *   The number of threads woken.
+ *
+ ****************************************************************************/
+
+int futex_wake(FAR volatile uint32_t *addr, int nwake);
+
+#undef EXTERN
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONFIG_FUTEX */
+#endif /* __INCLUDE_SYS_FUTEX_H */
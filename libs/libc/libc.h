@@ -204,6 +204,18 @@ ssize_t lib_parse_hostfile(FAR FILE *stream, FAR struct hostent *host,
 int lib_restoredir(void);
 #endif
 
+/* Defined in pthread/pthread_futex.c */
+
+#ifdef CONFIG_FUTEX
+void lib_futex_lock(FAR volatile uint32_t *lock);
+int  lib_futex_trylock(FAR volatile uint32_t *lock);
+void lib_futex_unlock(FAR volatile uint32_t *lock);
+int  lib_futex_condwait(FAR volatile uint32_t *cv,
+                        FAR volatile uint32_t *lock, clockid_t clockid,
+                        FAR const struct timespec *abstime);
+int  lib_futex_broadcast(FAR volatile uint32_t *cv);
+#endif
+
 #undef EXTERN
 #if defined(__cplusplus)
 }
@@ -69,7 +69,9 @@ int pthread_barrier_destroy(FAR pthread_barrier_t *barrier)
     }
   else
     {
+#ifndef CONFIG_FUTEX
       sem_destroy(&barrier->sem);
+#endif
       barrier->count = 0;
     }
 
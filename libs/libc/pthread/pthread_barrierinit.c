@@ -81,7 +81,12 @@ int pthread_barrier_init(FAR pthread_barrier_t *barrier,
     }
   else
     {
+#ifdef CONFIG_FUTEX
+      barrier->seq     = 0;
+      barrier->arrived = 0;
+#else
       sem_init(&barrier->sem, 0, 0);
+#endif
       barrier->count = count;
     }
 
@@ -27,6 +27,8 @@
 #include <pthread.h>
 #include <semaphore.h>
 #include <sched.h>
+#include <limits.h>
+#include <sys/futex.h>
 #include <errno.h>
 #include <debug.h>
 
@@ -78,6 +80,47 @@
  *
  ****************************************************************************/
 
+#ifdef CONFIG_FUTEX
+int pthread_barrier_wait(FAR pthread_barrier_t *barrier)
+{
+  uint32_t seq;
+
+  if (!barrier)
+    {
+      return EINVAL;
+    }
+
+  /* Sample the generation before arriving so that the final thread's
+   * update cannot be missed.
+   */
+
+  seq = __atomic_load_n(&barrier->seq, __ATOMIC_ACQUIRE);
+
+  if (__atomic_add_fetch(&barrier->arrived, 1, __ATOMIC_ACQ_REL) >=
+      barrier->count)
+    {
+      /* This is the final thread:  Reset the barrier, open the next
+       * generation, and free all of the waiting threads.
+       */
+
+      __atomic_store_n(&barrier->arrived, 0, __ATOMIC_RELAXED);
+      __atomic_add_fetch(&barrier->seq, 1, __ATOMIC_RELEASE);
+      futex_wake(&barrier->seq, INT_MAX);
+      return PTHREAD_BARRIER_SERIAL_THREAD;
+    }
+
+  /* Otherwise, wait until the generation changes.  Signals and spurious
+   * wakeups just resume the wait.
+   */
+
+  while (__atomic_load_n(&barrier->seq, __ATOMIC_ACQUIRE) == seq)
+    {
+      futex_wait(&barrier->seq, seq, CLOCK_REALTIME, NULL);
+    }
+
+  return 0;
+}
+#else
 int pthread_barrier_wait(FAR pthread_barrier_t *barrier)
 {
   int semcount;
@@ -147,3 +190,4 @@ int pthread_barrier_wait(FAR pthread_barrier_t *barrier)
       return 0;
     }
 }
+#endif /* CONFIG_FUTEX */
@@ -0,0 +1,187 @@
+/****************************************************************************
+ * libs/libc/pthread/pthread_futex.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <limits.h>
+#include <errno.h>
+#include <sys/futex.h>
+
+#include "libc.h"
+
+#ifdef CONFIG_FUTEX
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Lock word states */
+
+#define FUTEX_UNLOCKED   0  /* Not held */
+#define FUTEX_LOCKED     1  /* Held, no waiters */
+#define FUTEX_CONTENDED  2  /* Held, there may be waiters */
+
+/* The low bit of a condition word is set while there may be waiters */
+
+#define FUTEX_CV_WAITERS 1
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: lib_futex_lock
+ *
+ * Description:
+ *   Acquire a futex lock word.  An uncontended lock is taken with a single
+ *   atomic compare-and-swap and never enters the kernel.
+ *
+ ****************************************************************************/
+
+void lib_futex_lock(FAR volatile uint32_t *lock)
+{
+  uint32_t expected = FUTEX_UNLOCKED;
+
+  if (__atomic_compare_exchange_n(lock, &expected, FUTEX_LOCKED, false,
+                                  __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+    {
+      return;
+    }
+
+  /* Mark the lock contended so that the holder wakes us when it unlocks */
+
+  while (__atomic_exchange_n(lock, FUTEX_CONTENDED, __ATOMIC_ACQUIRE) !=
+         FUTEX_UNLOCKED)
+    {
+      futex_wait(lock, FUTEX_CONTENDED, CLOCK_REALTIME, NULL);
+    }
+}
+
+/****************************************************************************
+ * Name: lib_futex_trylock
+ *
+ * Description:
+ *   Acquire a futex lock word without waiting.  Returns zero on success or
+ *   EBUSY if the lock is held.
+ *
+ ****************************************************************************/
+
+int lib_futex_trylock(FAR volatile uint32_t *lock)
+{
+  uint32_t expected = FUTEX_UNLOCKED;
+
+  if (__atomic_compare_exchange_n(lock, &expected, FUTEX_LOCKED, false,
+                                  __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+    {
+      return OK;
+    }
+
+  return EBUSY;
+}
+
+/****************************************************************************
+ * Name: lib_futex_unlock
+ *
+ * Description:
+ *   Release a futex lock word.  The kernel is entered only if another
+ *   thread may be waiting for the lock.
+ *
+ ****************************************************************************/
+
+void lib_futex_unlock(FAR volatile uint32_t *lock)
+{
+  if (__atomic_exchange_n(lock, FUTEX_UNLOCKED, __ATOMIC_RELEASE) ==
+      FUTEX_CONTENDED)
+    {
+      futex_wake(lock, 1);
+    }
+}
+
+/****************************************************************************
+ * Name: lib_futex_condwait
+ *
+ * Description:
+ *   Atomically release the futex lock word 'lock' and wait for a broadcast
+ *   on the condition word 'cv'.  The lock is held again on return.
+ *
+ * Returned Value:
+ *   Zero is returned when woken, possibly spuriously.  ETIMEDOUT is
+ *   returned if abstime expired first.
+ *
+ ****************************************************************************/
+
+int lib_futex_condwait(FAR volatile uint32_t *cv,
+                       FAR volatile uint32_t *lock, clockid_t clockid,
+                       FAR const struct timespec *abstime)
+{
+  uint32_t seq;
+  int ret = OK;
+
+  /* Announce the waiter while still holding the lock.  A broadcast that
+   * happens after the lock is released changes the word, so the futex
+   * wait below will not sleep through it.
+   */
+
+  seq = __atomic_load_n(cv, __ATOMIC_RELAXED) | FUTEX_CV_WAITERS;
+  __atomic_store_n(cv, seq, __ATOMIC_RELAXED);
+
+  lib_futex_unlock(lock);
+
+  if (futex_wait(cv, seq, clockid, abstime) < 0 &&
+      get_errno() == ETIMEDOUT)
+    {
+      ret = ETIMEDOUT;
+    }
+
+  lib_futex_lock(lock);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: lib_futex_broadcast
+ *
+ * Description:
+ *   Wake all threads waiting on the condition word 'cv'.  The caller must
+ *   hold the futex lock word associated with the condition.  Nothing is
+ *   done if there are no waiters.  Always returns zero.
+ *
+ ****************************************************************************/
+
+int lib_futex_broadcast(FAR volatile uint32_t *cv)
+{
+  uint32_t seq = __atomic_load_n(cv, __ATOMIC_RELAXED);
+
+  if ((seq & FUTEX_CV_WAITERS) != 0)
+    {
+      /* Advance to the next sequence and clear the waiter bit */
+
+      __atomic_store_n(cv, seq + 1, __ATOMIC_RELEASE);
+      futex_wake(cv, INT_MAX);
+    }
+
+  return OK;
+}
+
+#endif /* CONFIG_FUTEX */
@@ -29,6 +29,8 @@
 #include <errno.h>
 #include <debug.h>
 
+#include "pthread_rwlock.h"
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -47,6 +49,11 @@ int pthread_rwlock_init(FAR pthread_rwlock_t *lock,
   lock->num_writers       = 0;
   lock->write_in_progress = false;
 
+#ifdef CONFIG_FUTEX
+  lock->lock              = 0;
+  lock->cv                = 0;
+  err                     = OK;
+#else
   err = pthread_cond_init(&lock->cv, NULL);
   if (err != 0)
     {
@@ -59,12 +66,19 @@ int pthread_rwlock_init(FAR pthread_rwlock_t *lock,
       pthread_cond_destroy(&lock->cv);
       return err;
     }
+#endif
 
   return err;
 }
 
 int pthread_rwlock_destroy(FAR pthread_rwlock_t *lock)
 {
+#ifdef CONFIG_FUTEX
+  /* Futex words hold no resources */
+
+  UNUSED(lock);
+  return OK;
+#else
   int cond_err  = pthread_cond_destroy(&lock->cv);
   int mutex_err = pthread_mutex_destroy(&lock->lock);
 
@@ -74,13 +88,14 @@ int pthread_rwlock_destroy(FAR pthread_rwlock_t *lock)
     }
 
   return cond_err;
+#endif
 }
 
 int pthread_rwlock_unlock(FAR pthread_rwlock_t *rw_lock)
 {
   int err;
 
-  err = pthread_mutex_lock(&rw_lock->lock);
+  err = rwlock_lock(rw_lock);
   if (err != 0)
     {
       return err;
@@ -92,20 +107,20 @@ int pthread_rwlock_unlock(FAR pthread_rwlock_t *rw_lock)
 
       if (rw_lock->num_readers == 0)
         {
-          err = pthread_cond_broadcast(&rw_lock->cv);
+          err = rwlock_broadcast(rw_lock);
         }
     }
   else if (rw_lock->write_in_progress)
     {
       rw_lock->write_in_progress = false;
 
-      err = pthread_cond_broadcast(&rw_lock->cv);
+      err = rwlock_broadcast(rw_lock);
     }
   else
     {
       err = EINVAL;
     }
 
-  pthread_mutex_unlock(&rw_lock->lock);
+  rwlock_unlock(rw_lock);
   return err;
 }
@@ -0,0 +1,62 @@
+/****************************************************************************
+ * libs/libc/pthread/pthread_rwlock.h
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __LIBS_LIBC_PTHREAD_PTHREAD_RWLOCK_H
+#define __LIBS_LIBC_PTHREAD_PTHREAD_RWLOCK_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <pthread.h>
+
+#include "libc.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The fields of a read/write lock are protected by an internal lock and
+ * condition.  With CONFIG_FUTEX these are futex words so that uncontended
+ * operations complete without a system call; otherwise they are a pthread
+ * mutex and condition variable.
+ */
+
+#ifdef CONFIG_FUTEX
+#  define rwlock_lock(rw)        (lib_futex_lock(&(rw)->lock), OK)
+#  define rwlock_trylock(rw)     lib_futex_trylock(&(rw)->lock)
+#  define rwlock_unlock(rw)      lib_futex_unlock(&(rw)->lock)
+#  define rwlock_wait(rw, c, ts) \
+     lib_futex_condwait(&(rw)->cv, &(rw)->lock, (c), (ts))
+#  define rwlock_broadcast(rw)   lib_futex_broadcast(&(rw)->cv)
+#else
+#  define rwlock_lock(rw)        pthread_mutex_lock(&(rw)->lock)
+#  define rwlock_trylock(rw)     pthread_mutex_trylock(&(rw)->lock)
+#  define rwlock_unlock(rw)      pthread_mutex_unlock(&(rw)->lock)
+#  define rwlock_wait(rw, c, ts) \
+     ((ts) != NULL ? \
+      pthread_cond_clockwait(&(rw)->cv, &(rw)->lock, (c), (ts)) : \
+      pthread_cond_wait(&(rw)->cv, &(rw)->lock))
+#  define rwlock_broadcast(rw)   pthread_cond_broadcast(&(rw)->cv)
+#endif
+
+#endif /* __LIBS_LIBC_PTHREAD_PTHREAD_RWLOCK_H */
@@ -29,6 +29,8 @@
 #include <errno.h>
 #include <debug.h>
 
+#include "pthread_rwlock.h"
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -38,7 +40,7 @@ static void rdlock_cleanup(FAR void *arg)
 {
   FAR pthread_rwlock_t *rw_lock = (FAR pthread_rwlock_t *)arg;
 
-  pthread_mutex_unlock(&rw_lock->lock);
+  rwlock_unlock(rw_lock);
 }
 #endif
 
@@ -85,7 +87,7 @@ static int tryrdlock(FAR pthread_rwlock_t *rw_lock)
 
 int pthread_rwlock_tryrdlock(FAR pthread_rwlock_t *rw_lock)
 {
-  int err = pthread_mutex_trylock(&rw_lock->lock);
+  int err = rwlock_trylock(rw_lock);
 
   if (err != 0)
     {
@@ -94,7 +96,7 @@ int pthread_rwlock_tryrdlock(FAR pthread_rwlock_t *rw_lock)
 
   err = tryrdlock(rw_lock);
 
-  pthread_mutex_unlock(&rw_lock->lock);
+  rwlock_unlock(rw_lock);
   return err;
 }
 
@@ -102,7 +104,7 @@ int pthread_rwlock_clockrdlock(FAR pthread_rwlock_t *rw_lock,
                                clockid_t clockid,
                                FAR const struct timespec *ts)
 {
-  int err = pthread_mutex_lock(&rw_lock->lock);
+  int err = rwlock_lock(rw_lock);
 
   if (err != 0)
     {
@@ -114,15 +116,7 @@ int pthread_rwlock_clockrdlock(FAR pthread_rwlock_t *rw_lock,
 #endif
   while ((err = tryrdlock(rw_lock)) == EBUSY)
     {
-      if (ts != NULL)
-        {
-          err = pthread_cond_clockwait(&rw_lock->cv, &rw_lock->lock,
-                                       clockid, ts);
-        }
-      else
-        {
-          err = pthread_cond_wait(&rw_lock->cv, &rw_lock->lock);
-        }
+      err = rwlock_wait(rw_lock, clockid, ts);
 
       if (err != 0)
         {
@@ -134,7 +128,7 @@ int pthread_rwlock_clockrdlock(FAR pthread_rwlock_t *rw_lock,
   pthread_cleanup_pop(0);
 #endif
 
-  pthread_mutex_unlock(&rw_lock->lock);
+  rwlock_unlock(rw_lock);
   return err;
 }
 
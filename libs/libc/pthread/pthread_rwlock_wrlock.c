@@ -29,6 +29,8 @@
 #include <errno.h>
 #include <debug.h>
 
+#include "pthread_rwlock.h"
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -39,7 +41,7 @@ static void wrlock_cleanup(FAR void *arg)
   FAR pthread_rwlock_t *rw_lock = (FAR pthread_rwlock_t *)arg;
 
   rw_lock->num_writers--;
-  pthread_mutex_unlock(&rw_lock->lock);
+  rwlock_unlock(rw_lock);
 }
 #endif
 
@@ -65,7 +67,7 @@ static void wrlock_cleanup(FAR void *arg)
 
 int pthread_rwlock_trywrlock(FAR pthread_rwlock_t *rw_lock)
 {
-  int err = pthread_mutex_trylock(&rw_lock->lock);
+  int err = rwlock_trylock(rw_lock);
 
   if (err != 0)
     {
@@ -81,7 +83,7 @@ int pthread_rwlock_trywrlock(FAR pthread_rwlock_t *rw_lock)
       rw_lock->write_in_progress = true;
     }
 
-  pthread_mutex_unlock(&rw_lock->lock);
+  rwlock_unlock(rw_lock);
   return err;
 }
 
@@ -89,7 +91,7 @@ int pthread_rwlock_clockwrlock(FAR pthread_rwlock_t *rw_lock,
                                clockid_t clockid,
                                FAR const struct timespec *ts)
 {
-  int err = pthread_mutex_lock(&rw_lock->lock);
+  int err = rwlock_lock(rw_lock);
 
   if (err != 0)
     {
@@ -109,15 +111,7 @@ int pthread_rwlock_clockwrlock(FAR pthread_rwlock_t *rw_lock,
 #endif
   while (rw_lock->write_in_progress || rw_lock->num_readers > 0)
     {
-      if (ts != NULL)
-        {
-          err = pthread_cond_clockwait(&rw_lock->cv, &rw_lock->lock,
-                                       clockid, ts);
-        }
-      else
-        {
-          err = pthread_cond_wait(&rw_lock->cv, &rw_lock->lock);
-        }
+      err = rwlock_wait(rw_lock, clockid, ts);
 
       if (err != 0)
         {
@@ -137,13 +131,13 @@ int pthread_rwlock_clockwrlock(FAR pthread_rwlock_t *rw_lock,
     {
       /* In case of error, notify any blocked readers. */
 
-      pthread_cond_broadcast(&rw_lock->cv);
+      rwlock_broadcast(rw_lock);
     }
 
   rw_lock->num_writers--;
 
 exit_with_mutex:
-  pthread_mutex_unlock(&rw_lock->lock);
+  rwlock_unlock(rw_lock);
   return err;
 }
 
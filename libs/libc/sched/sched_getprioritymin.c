@@ -52,6 +52,18 @@
 
 int sched_get_priority_min(int policy)
 {
+#ifdef CONFIG_SCHED_DEADLINE
+  DEBUGASSERT(policy >= SCHED_FIFO && policy <= SCHED_DEADLINE);
+
+  /* All deadline threads run at the same priority */
+
+  if (policy == SCHED_DEADLINE)
+    {
+      return CONFIG_SCHED_DEADLINE_PRIORITY;
+    }
+#else
   DEBUGASSERT(policy >= SCHED_FIFO && policy <= SCHED_OTHER);
+#endif
+
   return SCHED_PRIORITY_MIN;
 }
@@ -47,6 +47,10 @@
  *   of referring to copies of sem in calls to nxsem_wait(), nxsem_trywait(),
  *   nxsem_post(), and nxsem_destroy() is undefined.
  *
+ *   With priority inheritance, the holder records of a semaphore are also
+ *   linked into the lists of the holder threads.  Records left over from
+ *   an earlier use of the memory are dropped.
+ *
  * Input Parameters:
  *   sem - Semaphore to be initialized
  *   pshared - Process sharing (not used)
@@ -74,7 +78,12 @@ int nxsem_init(FAR sem_t *sem, int pshared, unsigned int value)
       /* Initialize to support priority inheritance */
 
 #ifdef CONFIG_PRIORITY_INHERITANCE
+#  if defined(CONFIG_BUILD_FLAT) || defined(__KERNEL__)
+      nxsem_drop_holders(sem);
+#  endif
+
       sem->flags            = 0;
+      sem->waitlist         = NULL;
 #  if CONFIG_SEM_PREALLOCHOLDERS > 0
       sem->hhead            = NULL;
 #  else
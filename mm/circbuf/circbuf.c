@@ -306,6 +306,64 @@ ssize_t circbuf_peek(FAR struct circbuf_s *circ,
   return bytes;
 }
 
+/****************************************************************************
+ * Name: circbuf_peekat
+ *
+ * Description:
+ *   Get data from a specified position in the circular buffer without
+ *   removing it.  The position is an absolute byte count in the same space
+ *   as head and tail, so several readers can each keep their own position.
+ *
+ * Input Parameters:
+ *   circ  - Address of the circular buffer to be used.
+ *   pos   - Position to read from.
+ *   dst   - Address where to store the data.
+ *   bytes - Number of bytes to get.
+ *
+ * Returned Value:
+ *   The bytes of get data is returned if the peek data is successful;
+ *   -EINVAL is returned if the position is no longer, or not yet, held in
+ *   the buffer.
+ ****************************************************************************/
+
+ssize_t circbuf_peekat(FAR struct circbuf_s *circ, size_t pos,
+                       FAR void *dst, size_t bytes)
+{
+  size_t len;
+  size_t off;
+
+  DEBUGASSERT(circ);
+
+  if (!circ->size)
+    {
+      return 0;
+    }
+
+  if (pos - circ->tail > circ->head - circ->tail)
+    {
+      return -EINVAL;
+    }
+
+  len = circ->head - pos;
+  off = pos % circ->size;
+
+  if (bytes > len)
+    {
+      bytes = len;
+    }
+
+  len = circ->size - off;
+  if (bytes < len)
+    {
+      len = bytes;
+    }
+
+  memcpy(dst, circ->base + off, len);
+  memcpy(dst + len, circ->base, bytes - len);
+
+  return bytes;
+}
+
 /****************************************************************************
  * Name: circbuf_read
  *
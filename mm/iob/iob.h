@@ -48,6 +48,15 @@
 #  define iobinfo                _none
 #endif /* CONFIG_DEBUG_FEATURES && CONFIG_IOB_DEBUG */
 
+/* IOB_POOLSTATS - Count an event in the IOB pool statistics */
+
+#if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS) && \
+    !defined(CONFIG_FS_PROCFS_EXCLUDE_IOBINFO)
+#  define IOB_POOLSTATS(f)       (g_iob_poolstats.f++)
+#else
+#  define IOB_POOLSTATS(f)
+#endif
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -80,6 +89,13 @@ extern sem_t g_throttle_sem;  /* Counts available I/O buffers when throttled */
 extern sem_t g_qentry_sem;    /* Counts free I/O buffer queue containers */
 #endif
 
+#if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS) && \
+    !defined(CONFIG_FS_PROCFS_EXCLUDE_IOBINFO)
+/* Statistics of the IOB pools */
+
+extern struct iob_poolstats_s g_iob_poolstats;
+#endif
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -119,6 +135,73 @@ FAR struct iob_qentry_s *iob_tryalloc_qentry(void);
 
 FAR struct iob_qentry_s *iob_free_qentry(FAR struct iob_qentry_s *iobq);
 
+/****************************************************************************
+ * Name: iob_large_initialize
+ *
+ * Description:
+ *   Set up the pool of large I/O buffers.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_IOB_LARGE
+void iob_large_initialize(void);
+#endif
+
+/****************************************************************************
+ * Name: iob_large_free
+ *
+ * Description:
+ *   Return a large I/O buffer to the large pool.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_IOB_LARGE
+void iob_large_free(FAR struct iob_s *iob, enum iob_user_e producerid);
+#endif
+
+/****************************************************************************
+ * Name: iob_cache_alloc
+ *
+ * Description:
+ *   Try to take an I/O buffer from the cache of the current CPU, refilling
+ *   the cache from the free list in a batch if it is empty.  NULL is
+ *   returned if the cache cannot serve the request; the caller should then
+ *   use the free list.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_IOB_PERCPU_CACHE
+FAR struct iob_s *iob_cache_alloc(bool throttled);
+#endif
+
+/****************************************************************************
+ * Name: iob_cache_free
+ *
+ * Description:
+ *   Try to put a free I/O buffer in the cache of the current CPU, draining
+ *   a batch to the free list if the cache is full.  false is returned if
+ *   the buffer was not taken; the caller must then return it to the free
+ *   list.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_IOB_PERCPU_CACHE
+bool iob_cache_free(FAR struct iob_s *iob);
+#endif
+
+/****************************************************************************
+ * Name: iob_cache_flush
+ *
+ * Description:
+ *   Return the buffers in the caches of all CPUs to the free list.  The
+ *   number of buffers returned is provided.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_IOB_PERCPU_CACHE
+int iob_cache_flush(void);
+#endif
+
 /****************************************************************************
  * Name: iob_notifier_signal
  *
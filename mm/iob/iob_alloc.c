@@ -124,6 +124,18 @@ static FAR struct iob_s *iob_allocwait(bool throttled,
   iob = iob_tryalloc(throttled, consumerid);
   while (ret == OK && iob == NULL)
     {
+#ifdef CONFIG_IOB_PERCPU_CACHE
+      /* Buffers held in the per-CPU caches are not counted as free.  Return
+       * them to the free list and try again before waiting.
+       */
+
+      if (iob_cache_flush() > 0)
+        {
+          iob = iob_tryalloc(throttled, consumerid);
+          continue;
+        }
+#endif
+
       /* If not successful, then the semaphore count was less than or equal
        * to zero (meaning that there are no free buffers).  We need to wait
        * for an I/O buffer to be released and placed in the committed
@@ -228,6 +240,27 @@ FAR struct iob_s *iob_tryalloc(bool throttled, enum iob_user_e consumerid)
   sem = (throttled ? &g_throttle_sem : &g_iob_sem);
 #endif
 
+#ifdef CONFIG_IOB_PERCPU_CACHE
+  /* Try the cache of this CPU first.  That only needs the local interrupts
+   * disabled.
+   */
+
+  iob = iob_cache_alloc(throttled);
+  if (iob != NULL)
+    {
+#if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS) && \
+    defined(CONFIG_MM_IOB) && !defined(CONFIG_FS_PROCFS_EXCLUDE_IOBINFO)
+      iob_stats_onalloc(consumerid);
+#endif
+
+      iob->io_flink  = NULL; /* Not in a chain */
+      iob->io_len    = 0;    /* Length of the data in the entry */
+      iob->io_offset = 0;    /* Offset to the beginning of data */
+      iob->io_pktlen = 0;    /* Total length of the packet */
+      return iob;
+    }
+#endif
+
   /* We don't know what context we are called from so we use extreme measures
    * to protect the free list:  We disable interrupts very briefly.
    */
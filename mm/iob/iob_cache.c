@@ -0,0 +1,364 @@
+/****************************************************************************
+ * mm/iob/iob_cache.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <assert.h>
+
+#include <nuttx/irq.h>
+#include <nuttx/arch.h>
+#include <nuttx/spinlock.h>
+#include <nuttx/mm/iob.h>
+
+#include "iob.h"
+
+#ifdef CONFIG_IOB_PERCPU_CACHE
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The cache is only refilled, and frees only go to the cache, while the
+ * free list has more buffers than this.  This keeps the last free buffers
+ * in the shared pool where they are available to every CPU and to threads
+ * waiting for a buffer.
+ */
+
+#define IOB_CACHE_RESERVE (CONFIG_IOB_THROTTLE + CONFIG_IOB_PERCPU_CACHE_BATCH)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* The free I/O buffers held by one CPU.  Cached buffers are accounted for
+ * as allocated: they are not counted in g_iob_sem or g_throttle_sem.
+ *
+ * The cache is normally only accessed by its own CPU, but the lock allows
+ * iob_cache_flush() to empty it from any CPU.  The lock is never held
+ * while entering the critical section.
+ */
+
+struct iob_cache_s
+{
+  spinlock_t ic_lock;           /* Protects the list */
+  FAR struct iob_s *ic_head;    /* List of cached buffers */
+  int ic_count;                 /* Number of buffers in the list */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct iob_cache_s g_iob_cache[CONFIG_SMP_NCPUS];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: iob_cache_refill
+ *
+ * Description:
+ *   Take up to a batch of buffers from the free list.  The first one is
+ *   returned and the others are added to the cache.  The buffers are
+ *   accounted for as allocated from the free list.
+ *
+ ****************************************************************************/
+
+static FAR struct iob_s *iob_cache_refill(FAR struct iob_cache_s *cache)
+{
+  FAR struct iob_s *head = NULL;
+  FAR struct iob_s *tail = NULL;
+  FAR struct iob_s *iob;
+  irqstate_t flags;
+  int nmoved = 0;
+
+  flags = enter_critical_section();
+
+  while (nmoved < CONFIG_IOB_PERCPU_CACHE_BATCH &&
+         g_iob_sem.semcount > IOB_CACHE_RESERVE &&
+         g_iob_freelist != NULL)
+    {
+      iob            = g_iob_freelist;
+      g_iob_freelist = iob->io_flink;
+
+      /* Take the semaphore count(s) just as iob_tryalloc() does */
+
+      g_iob_sem.semcount--;
+#if CONFIG_IOB_THROTTLE > 0
+      g_throttle_sem.semcount--;
+#endif
+
+      iob->io_flink = head;
+      head          = iob;
+      if (tail == NULL)
+        {
+          tail = iob;
+        }
+
+      nmoved++;
+    }
+
+  leave_critical_section(flags);
+
+  if (head == NULL)
+    {
+      return NULL;
+    }
+
+  IOB_POOLSTATS(cacherefills);
+
+  /* Keep the first buffer for the caller and cache the rest */
+
+  iob = head;
+  if (nmoved > 1)
+    {
+      spin_lock(&cache->ic_lock);
+      tail->io_flink  = cache->ic_head;
+      cache->ic_head  = iob->io_flink;
+      cache->ic_count += nmoved - 1;
+      spin_unlock(&cache->ic_lock);
+    }
+
+  iob->io_flink = NULL;
+  return iob;
+}
+
+/****************************************************************************
+ * Name: iob_cache_release
+ *
+ * Description:
+ *   Return a list of buffers taken from a cache to the free list and
+ *   signal that they are available.
+ *
+ ****************************************************************************/
+
+static void iob_cache_release(FAR struct iob_s *list)
+{
+  FAR struct iob_s *iob;
+  irqstate_t flags;
+
+  if (list == NULL)
+    {
+      return;
+    }
+
+  flags = enter_critical_section();
+
+  while (list != NULL)
+    {
+      iob  = list;
+      list = iob->io_flink;
+
+      /* Reserve the buffer for a waiter, if there is one, just as
+       * iob_free() does.
+       */
+
+      if (g_iob_sem.semcount < 0)
+        {
+          iob->io_flink   = g_iob_committed;
+          g_iob_committed = iob;
+        }
+      else
+        {
+          iob->io_flink   = g_iob_freelist;
+          g_iob_freelist  = iob;
+        }
+
+      nxsem_post(&g_iob_sem);
+#if CONFIG_IOB_THROTTLE > 0
+      nxsem_post(&g_throttle_sem);
+#endif
+    }
+
+#ifdef CONFIG_IOB_NOTIFIER
+  /* Tell the threads that wait for a notification that buffers are free */
+
+  iob_notifier_signal();
+#endif
+
+  leave_critical_section(flags);
+  IOB_POOLSTATS(cachedrains);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: iob_cache_alloc
+ *
+ * Description:
+ *   Try to take an I/O buffer from the cache of the current CPU, refilling
+ *   the cache from the free list in a batch if it is empty.  NULL is
+ *   returned if the cache cannot serve the request; the caller should then
+ *   use the free list.
+ *
+ ****************************************************************************/
+
+FAR struct iob_s *iob_cache_alloc(bool throttled)
+{
+  FAR struct iob_cache_s *cache;
+  FAR struct iob_s *iob;
+  irqstate_t flags;
+
+#if CONFIG_IOB_THROTTLE > 0
+  /* Throttled allocations may not dip into the buffers reserved for
+   * unthrottled ones.  The cached buffers are not counted as free, so
+   * they are only used while the free list is above the throttle.
+   */
+
+  if (throttled && g_throttle_sem.semcount <= 0)
+    {
+      return NULL;
+    }
+#else
+  UNUSED(throttled);
+#endif
+
+  flags = up_irq_save();
+  cache = &g_iob_cache[up_cpu_index()];
+
+  spin_lock(&cache->ic_lock);
+  iob = cache->ic_head;
+  if (iob != NULL)
+    {
+      cache->ic_head = iob->io_flink;
+      cache->ic_count--;
+      IOB_POOLSTATS(cachehits);
+    }
+
+  spin_unlock(&cache->ic_lock);
+
+  if (iob == NULL)
+    {
+      iob = iob_cache_refill(cache);
+    }
+
+  up_irq_restore(flags);
+  return iob;
+}
+
+/****************************************************************************
+ * Name: iob_cache_free
+ *
+ * Description:
+ *   Try to put a free I/O buffer in the cache of the current CPU, draining
+ *   a batch to the free list if the cache is full.  false is returned if
+ *   the buffer was not taken; the caller must then return it to the free
+ *   list.
+ *
+ ****************************************************************************/
+
+bool iob_cache_free(FAR struct iob_s *iob)
+{
+  FAR struct iob_cache_s *cache;
+  FAR struct iob_s *drain = NULL;
+  FAR struct iob_s *next;
+  irqstate_t flags;
+  int i;
+
+  /* Buffers go straight back to the free list while anybody is waiting for
+   * one or the free list is running low.
+   */
+
+  if (g_iob_sem.semcount <= IOB_CACHE_RESERVE)
+    {
+      return false;
+    }
+
+  flags = up_irq_save();
+  cache = &g_iob_cache[up_cpu_index()];
+
+  spin_lock(&cache->ic_lock);
+
+  /* If the cache is full, take a batch out of it to be drained */
+
+  if (cache->ic_count >= CONFIG_IOB_PERCPU_CACHE_SIZE)
+    {
+      drain = cache->ic_head;
+      next  = drain;
+      for (i = 1;
+           i < CONFIG_IOB_PERCPU_CACHE_BATCH && next->io_flink != NULL;
+           i++)
+        {
+          next = next->io_flink;
+        }
+
+      cache->ic_head  = next->io_flink;
+      cache->ic_count -= i;
+      next->io_flink  = NULL;
+    }
+
+  iob->io_flink  = cache->ic_head;
+  cache->ic_head = iob;
+  cache->ic_count++;
+
+  spin_unlock(&cache->ic_lock);
+
+  iob_cache_release(drain);
+  up_irq_restore(flags);
+  return true;
+}
+
+/****************************************************************************
+ * Name: iob_cache_flush
+ *
+ * Description:
+ *   Return the buffers in the caches of all CPUs to the free list.  This is
+ *   done before a thread waits for a free buffer so that buffers are not
+ *   held back in the cache of another CPU.
+ *
+ * Returned Value:
+ *   The number of buffers that were returned to the free list.
+ *
+ ****************************************************************************/
+
+int iob_cache_flush(void)
+{
+  FAR struct iob_cache_s *cache;
+  FAR struct iob_s *list;
+  irqstate_t flags;
+  int nflushed = 0;
+  int cpu;
+
+  for (cpu = 0; cpu < CONFIG_SMP_NCPUS; cpu++)
+    {
+      cache = &g_iob_cache[cpu];
+
+      flags = spin_lock_irqsave(&cache->ic_lock);
+      list            = cache->ic_head;
+      nflushed       += cache->ic_count;
+      cache->ic_head  = NULL;
+      cache->ic_count = 0;
+      spin_unlock_irqrestore(&cache->ic_lock, flags);
+
+      iob_cache_release(list);
+    }
+
+  return nflushed;
+}
+
+#endif /* CONFIG_IOB_PERCPU_CACHE */
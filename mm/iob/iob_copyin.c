@@ -35,9 +35,45 @@
 #include "iob.h"
 
 /****************************************************************************
- * Public Functions
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: iob_copyin_alloc
+ *
+ * Description:
+ *  Allocate the next I/O buffer of a chain that 'len' more bytes will be
+ *  copied into.  A large I/O buffer is preferred if the data would not fit
+ *  into a normal one.
+ *
  ****************************************************************************/
 
+static FAR struct iob_s *iob_copyin_alloc(unsigned int len, bool throttled,
+                                          bool can_block,
+                                          enum iob_user_e consumerid)
+{
+#ifdef CONFIG_IOB_LARGE
+  if (len > CONFIG_IOB_BUFSIZE)
+    {
+      FAR struct iob_s *iob = iob_large_tryalloc(consumerid);
+
+      if (iob != NULL)
+        {
+          return iob;
+        }
+    }
+#endif
+
+  if (can_block)
+    {
+      return iob_alloc(throttled, consumerid);
+    }
+  else
+    {
+      return iob_tryalloc(throttled, consumerid);
+    }
+}
+
 /****************************************************************************
  * Name: iob_copyin_internal
  *
@@ -122,7 +158,7 @@ static int iob_copyin_internal(FAR struct iob_s *iob, FAR const uint8_t *src,
 
               /* Yes.. We can extend this buffer to the up to the very end. */
 
-              maxlen = CONFIG_IOB_BUFSIZE - iob->io_offset;
+              maxlen = IOB_BUFSIZE(iob) - iob->io_offset;
 
               /* This is the new buffer length that we need.  Of course,
                * clipped to the maximum possible size in this buffer.
@@ -175,15 +211,7 @@ static int iob_copyin_internal(FAR struct iob_s *iob, FAR const uint8_t *src,
            * Copy as many bytes as possible. Block if we're allowed.
            */
 
-          if (can_block)
-            {
-              next = iob_alloc(throttled, consumerid);
-            }
-          else
-            {
-              next = iob_tryalloc(throttled, consumerid);
-            }
-
+          next = iob_copyin_alloc(len, throttled, can_block, consumerid);
           if (next == NULL)
             {
               ioberr("ERROR: Failed to allocate I/O buffer\n");
@@ -113,6 +113,32 @@ FAR struct iob_s *iob_free(FAR struct iob_s *iob,
               next, next->io_pktlen, next->io_len);
     }
 
+#ifdef CONFIG_IOB_LARGE
+  /* Large I/O buffers go back to their own pool */
+
+  if (IOB_BUFSIZE(iob) != CONFIG_IOB_BUFSIZE)
+    {
+      iob_large_free(iob, producerid);
+      return next;
+    }
+#endif
+
+#ifdef CONFIG_IOB_PERCPU_CACHE
+  /* Keep the I/O buffer in the cache of this CPU if possible.  A cached
+   * buffer still counts as allocated, so there is nothing to signal here;
+   * the notifier is signalled when the cache is drained to the free list.
+   */
+
+  if (iob_cache_free(iob))
+    {
+#if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS) && \
+    defined(CONFIG_MM_IOB) && !defined(CONFIG_FS_PROCFS_EXCLUDE_IOBINFO)
+      iob_stats_onfree(producerid);
+#endif
+      return next;
+    }
+#endif
+
   /* Free the I/O buffer by adding it to the head of the free or the
    * committed list. We don't know what context we are called from so
    * we use extreme measures to protect the free list:  We disable
@@ -108,6 +108,10 @@ void iob_initialize(void)
         {
           FAR struct iob_s *iob = &g_iob_pool[i];
 
+#ifdef CONFIG_IOB_LARGE
+          iob->io_bufsize = CONFIG_IOB_BUFSIZE;
+#endif
+
           /* Add the pre-allocate I/O buffer to the head of the free list */
 
           iob->io_flink  = g_iob_freelist;
@@ -143,6 +147,10 @@ void iob_initialize(void)
       nxsem_init(&g_qentry_sem, 0, CONFIG_IOB_NCHAINS);
 #endif
 
+#ifdef CONFIG_IOB_LARGE
+      iob_large_initialize();
+#endif
+
       initialized = true;
     }
 }
@@ -0,0 +1,189 @@
+/****************************************************************************
+ * mm/iob/iob_large.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <assert.h>
+
+#include <nuttx/irq.h>
+#include <nuttx/mm/iob.h>
+
+#include "iob.h"
+
+#ifdef CONFIG_IOB_LARGE
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* A large I/O buffer is a normal struct iob_s whose io_data[] continues
+ * into the storage that follows it.  io_data[] is the last member of
+ * struct iob_s, so the payload is contiguous.
+ */
+
+struct iob_large_s
+{
+  struct iob_s iob;
+  uint8_t      extra[CONFIG_IOB_LARGEBUFSIZE - CONFIG_IOB_BUFSIZE];
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* This is the pool of pre-allocated large I/O buffers */
+
+static struct iob_large_s g_iob_largepool[CONFIG_IOB_NLARGEBUFFERS];
+
+/* A list of all free, unallocated large I/O buffers */
+
+static FAR struct iob_s *g_iob_largefreelist;
+
+/* The number of buffers in g_iob_largefreelist */
+
+static int g_iob_nlargefree;
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: iob_large_initialize
+ *
+ * Description:
+ *   Set up the pool of large I/O buffers.
+ *
+ ****************************************************************************/
+
+void iob_large_initialize(void)
+{
+  int i;
+
+  for (i = 0; i < CONFIG_IOB_NLARGEBUFFERS; i++)
+    {
+      FAR struct iob_s *iob = &g_iob_largepool[i].iob;
+
+      /* The size never changes, so set it once here */
+
+      iob->io_bufsize     = CONFIG_IOB_LARGEBUFSIZE;
+      iob->io_flink       = g_iob_largefreelist;
+      g_iob_largefreelist = iob;
+    }
+
+  g_iob_nlargefree = CONFIG_IOB_NLARGEBUFFERS;
+}
+
+/****************************************************************************
+ * Name: iob_large_tryalloc
+ *
+ * Description:
+ *   Try to allocate a large I/O buffer without waiting.  NULL is returned
+ *   if the large pool is empty; the caller should then fall back to a
+ *   normal I/O buffer.
+ *
+ ****************************************************************************/
+
+FAR struct iob_s *iob_large_tryalloc(enum iob_user_e consumerid)
+{
+  FAR struct iob_s *iob;
+  irqstate_t flags;
+
+  flags = enter_critical_section();
+
+  iob = g_iob_largefreelist;
+  if (iob != NULL)
+    {
+      g_iob_largefreelist = iob->io_flink;
+      g_iob_nlargefree--;
+      IOB_POOLSTATS(largealloc);
+
+#if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS) && \
+    defined(CONFIG_MM_IOB) && !defined(CONFIG_FS_PROCFS_EXCLUDE_IOBINFO)
+      iob_stats_onalloc(consumerid);
+#endif
+    }
+  else
+    {
+      IOB_POOLSTATS(largemissed);
+    }
+
+  leave_critical_section(flags);
+
+  if (iob != NULL)
+    {
+      /* Put the I/O buffer in a known state */
+
+      iob->io_flink  = NULL; /* Not in a chain */
+      iob->io_len    = 0;    /* Length of the data in the entry */
+      iob->io_offset = 0;    /* Offset to the beginning of data */
+      iob->io_pktlen = 0;    /* Total length of the packet */
+    }
+
+  return iob;
+}
+
+/****************************************************************************
+ * Name: iob_large_free
+ *
+ * Description:
+ *   Return a large I/O buffer to the large pool.
+ *
+ ****************************************************************************/
+
+void iob_large_free(FAR struct iob_s *iob, enum iob_user_e producerid)
+{
+  irqstate_t flags;
+
+  DEBUGASSERT(iob->io_bufsize == CONFIG_IOB_LARGEBUFSIZE);
+
+  flags = enter_critical_section();
+
+  iob->io_flink       = g_iob_largefreelist;
+  g_iob_largefreelist = iob;
+  g_iob_nlargefree++;
+  DEBUGASSERT(g_iob_nlargefree <= CONFIG_IOB_NLARGEBUFFERS);
+
+#if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS) && \
+    defined(CONFIG_MM_IOB) && !defined(CONFIG_FS_PROCFS_EXCLUDE_IOBINFO)
+  iob_stats_onfree(producerid);
+#endif
+
+  leave_critical_section(flags);
+}
+
+/****************************************************************************
+ * Name: iob_large_navail
+ *
+ * Description:
+ *   Return the number of available large IOBs.
+ *
+ ****************************************************************************/
+
+int iob_large_navail(void)
+{
+  return g_iob_nlargefree;
+}
+
+#endif /* CONFIG_IOB_LARGE */
@@ -53,6 +53,10 @@ int iob_navail(bool throttled)
   ret = nxsem_get_value(&g_iob_sem, &navail);
   if (ret >= 0)
     {
+      /* Buffers in the per-CPU caches count as allocated, just as they
+       * do for the semaphores.
+       */
+
       ret = navail;
 
 #if CONFIG_IOB_THROTTLE > 0
@@ -32,6 +32,8 @@
 
 #include <nuttx/mm/iob.h>
 
+#include "iob.h"
+
 #if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS) && \
     !defined(CONFIG_FS_PROCFS_EXCLUDE_IOBINFO)
 
@@ -41,6 +43,12 @@
 
 struct iob_userstats_s g_iobuserstats[IOBUSER_NENTRIES];
 
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+struct iob_poolstats_s g_iob_poolstats;
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -116,5 +124,24 @@ FAR struct iob_userstats_s * iob_getuserstats(enum iob_user_e userid)
   return &g_iobuserstats[userid];
 }
 
+/****************************************************************************
+ * Name: iob_getpoolstats
+ *
+ * Description:
+ *   Return a reference to the statistics of the IOB pools
+ *
+ * Input Parameters:
+ *   None.
+ *
+ * Returned Value:
+ *   A reference to the pool statistics.
+ *
+ ****************************************************************************/
+
+FAR struct iob_poolstats_s *iob_getpoolstats(void)
+{
+  return &g_iob_poolstats;
+}
+
 #endif /* !CONFIG_DISABLE_MOUNTPOINT && CONFIG_FS_PROCFS &&
         * !CONFIG_FS_PROCFS_EXCLUDE_IOBINFO */
@@ -147,6 +147,14 @@ struct arp_notify_s
  * Public Data
  ****************************************************************************/
 
+#ifdef CONFIG_NET_ARP
+/* The number of entries in the ARP table.  This is zero until the table is
+ * first used.  The network must be locked when accessing it.
+ */
+
+extern unsigned int g_arpsize;
+#endif
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -427,6 +435,49 @@ unsigned int arp_snapshot(FAR struct arp_entry_s *snapshot,
 #  define arp_snapshot(s,n) (0)
 #endif
 
+/****************************************************************************
+ * Name: arp_pending_add
+ *
+ * Description:
+ *   Keep a copy of the IPv4 packet in d_buf, which is about to be replaced
+ *   by an ARP request for 'ipaddr'.  The packet is sent when the ARP
+ *   response arrives.
+ *
+ * Input Parameters:
+ *   dev    - The device that will send the packet
+ *   ipaddr - The IPv4 address whose hardware address is needed
+ *
+ * Assumptions
+ *   The network is locked to assure exclusive access to the ARP table.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_ARP_PENDING
+void arp_pending_add(FAR struct net_driver_s *dev, in_addr_t ipaddr);
+#else
+#  define arp_pending_add(d,i)
+#endif
+
+/****************************************************************************
+ * Name: arp_pending_poll
+ *
+ * Description:
+ *   Send the packets of the device whose hardware address has been
+ *   resolved, and discard those that have waited too long.
+ *
+ * Assumptions:
+ *   This function is called from the MAC device driver indirectly through
+ *   devif_poll() with the network locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_ARP_PENDING
+int arp_pending_poll(FAR struct net_driver_s *dev,
+                     devif_poll_callback_t callback);
+#else
+#  define arp_pending_poll(d,c) (0)
+#endif
+
 /****************************************************************************
  * Name: arp_dump
  *
@@ -128,7 +128,8 @@ static const uint8_t g_multicast_ethaddr[3] =
  *   packet in the d_buf is replaced by an ARP request packet for the
  *   IP address. The IP packet is dropped and it is assumed that the
  *   higher level protocols (e.g., TCP) eventually will retransmit the
- *   dropped packet.
+ *   dropped packet.  If CONFIG_NET_ARP_PENDING is enabled, a copy of the
+ *   packet is kept instead and sent when the ARP response arrives.
  *
  *   Upon return in either the case, a packet to be sent is present in the
  *   d_buf buffer and the d_len field holds the length of the Ethernet
@@ -263,9 +264,11 @@ void arp_out(FAR struct net_driver_s *dev)
       ninfo("ARP request for IP %08lx\n", (unsigned long)ipaddr);
 
       /* The destination address was not in our ARP table, so we overwrite
-       * the IP packet with an ARP request.
+       * the IP packet with an ARP request.  Keep a copy of the IP packet,
+       * if so configured, to send when the response arrives.
        */
 
+      arp_pending_add(dev, ipaddr);
       arp_format(dev, ipaddr);
       arp_dump(ARPBUF);
       return;
@@ -55,6 +55,8 @@
 #include <net/ethernet.h>
 
 #include <nuttx/clock.h>
+#include <nuttx/kmalloc.h>
+#include <nuttx/mm/iob.h>
 #include <nuttx/net/netconfig.h>
 #include <nuttx/net/net.h>
 #include <nuttx/net/netdev.h>
@@ -72,6 +74,13 @@
 
 #define ARP_MAXAGE_TICK SEC2TICK(10 * CONFIG_NET_ARP_MAXAGE)
 
+#ifdef CONFIG_NET_ARP_PENDING
+#  define ARP_PENDING_TICK MSEC2TICK(CONFIG_NET_ARP_PENDING_TIMEOUT)
+#  define ARP_RESOLVED(t)  (!(t)->at_unresolved)
+#else
+#  define ARP_RESOLVED(t)  true
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -82,13 +91,49 @@ struct arp_table_info_s
   FAR struct ether_addr *ai_ethaddr;  /* Location to return the MAC address */
 };
 
+/* One entry of the ARP table.  Entries with the same hash value are linked
+ * together.
+ */
+
+struct arp_tabentry_s
+{
+  struct arp_entry_s at_entry;          /* Must be first */
+  FAR struct arp_tabentry_s *at_hnext;  /* Next entry in the hash chain */
+#ifdef CONFIG_NET_ARP_PENDING
+  FAR struct net_driver_s *at_dev;      /* Device of the pending packets */
+  struct iob_queue_s at_pending;        /* IPv4 packets waiting for the
+                                         * hardware address */
+  uint8_t at_npending;                  /* Number of pending packets */
+  bool at_unresolved;                   /* Waiting for an ARP response */
+#endif
+};
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
 
-/* The table of known address mappings */
+/* The table of known address mappings and its hash index.  Both are
+ * allocated on first use, with CONFIG_NET_ARPTAB_SIZE entries, or when
+ * the table is resized.
+ */
+
+static FAR struct arp_tabentry_s *g_arptable;
+static FAR struct arp_tabentry_s **g_arphash;
+static unsigned int g_arphashmask;
+
+#ifdef CONFIG_NET_ARP_PENDING
+/* The total number of packets waiting for address resolution */
+
+static unsigned int g_arp_npending;
+#endif
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+/* The number of entries in g_arptable */
 
-static struct arp_entry_s g_arptable[CONFIG_NET_ARPTAB_SIZE];
+unsigned int g_arpsize;
 
 /****************************************************************************
  * Private Functions
@@ -141,32 +186,128 @@ static int arp_match(FAR struct net_driver_s *dev, FAR void *arg)
 }
 
 /****************************************************************************
- * Name: arp_return_old_entry
+ * Name: arp_hash
  *
  * Description:
- *   Compare and return the old ARP table entry.
+ *   Return the hash chain for an IPv4 address.
  *
  ****************************************************************************/
 
-static FAR struct arp_entry_s *
-arp_return_old_entry(FAR struct arp_entry_s *e1, FAR struct arp_entry_s *e2)
+static inline unsigned int arp_hash(in_addr_t ipaddr)
 {
-  if (e1->at_ipaddr == 0)
+  uint32_t hash = (uint32_t)ipaddr * 2654435761u;
+
+  return (hash ^ (hash >> 16)) & g_arphashmask;
+}
+
+/****************************************************************************
+ * Name: arp_tabfind
+ *
+ * Description:
+ *   Find the table entry of an IPv4 address, whether it is resolved or
+ *   not.
+ *
+ ****************************************************************************/
+
+static FAR struct arp_tabentry_s *arp_tabfind(in_addr_t ipaddr)
+{
+  FAR struct arp_tabentry_s *tab;
+
+  if (g_arptable == NULL || ipaddr == 0)
     {
-      return e1;
+      return NULL;
     }
-  else if (e2->at_ipaddr == 0)
+
+  for (tab = g_arphash[arp_hash(ipaddr)]; tab != NULL; tab = tab->at_hnext)
     {
-      return e2;
+      if (net_ipv4addr_cmp(ipaddr, tab->at_entry.at_ipaddr))
+        {
+          return tab;
+        }
     }
-  else if ((int)(e1->at_time - e2->at_time) <= 0)
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: arp_tabfree
+ *
+ * Description:
+ *   Remove an entry from its hash chain and discard its pending packets.
+ *
+ ****************************************************************************/
+
+static void arp_tabfree(FAR struct arp_tabentry_s *tab)
+{
+  FAR struct arp_tabentry_s **pnext;
+
+  if (tab->at_entry.at_ipaddr == 0)
     {
-      return e1;
+      return;
     }
-  else
+
+  pnext = &g_arphash[arp_hash(tab->at_entry.at_ipaddr)];
+  while (*pnext != tab)
     {
-      return e2;
+      pnext = &(*pnext)->at_hnext;
     }
+
+  *pnext                  = tab->at_hnext;
+  tab->at_hnext           = NULL;
+  tab->at_entry.at_ipaddr = 0;
+
+#ifdef CONFIG_NET_ARP_PENDING
+  iob_free_queue(&tab->at_pending, IOBUSER_NET_ARP_PENDING);
+  g_arp_npending    -= tab->at_npending;
+  tab->at_npending   = 0;
+  tab->at_unresolved = false;
+#endif
+}
+
+/****************************************************************************
+ * Name: arp_taballoc
+ *
+ * Description:
+ *   Get an unused table entry, or else the oldest entry, for the IPv4
+ *   address and add it to its hash chain.
+ *
+ ****************************************************************************/
+
+static FAR struct arp_tabentry_s *arp_taballoc(in_addr_t ipaddr)
+{
+  FAR struct arp_tabentry_s *oldest = NULL;
+  FAR struct arp_tabentry_s *tab;
+  unsigned int hash;
+  unsigned int i;
+
+  if (g_arptable == NULL && arp_table_resize(CONFIG_NET_ARPTAB_SIZE) < 0)
+    {
+      return NULL;
+    }
+
+  for (i = 0; i < g_arpsize; i++)
+    {
+      tab = &g_arptable[i];
+      if (tab->at_entry.at_ipaddr == 0)
+        {
+          oldest = tab;
+          break;
+        }
+
+      if (oldest == NULL ||
+          (int)(tab->at_entry.at_time - oldest->at_entry.at_time) < 0)
+        {
+          oldest = tab;
+        }
+    }
+
+  arp_tabfree(oldest);
+
+  hash                       = arp_hash(ipaddr);
+  oldest->at_entry.at_ipaddr = ipaddr;
+  oldest->at_hnext           = g_arphash[hash];
+  g_arphash[hash]            = oldest;
+  return oldest;
 }
 
 /****************************************************************************
@@ -195,43 +336,48 @@ arp_return_old_entry(FAR struct arp_entry_s *e1, FAR struct arp_entry_s *e2)
 
 int arp_update(in_addr_t ipaddr, FAR uint8_t *ethaddr)
 {
-  FAR struct arp_entry_s *tabptr = &g_arptable[0];
-  int i;
+  FAR struct arp_tabentry_s *tab;
 
-  /* Walk through the ARP mapping table and try to find an entry to
-   * update. If none is found, the IP -> MAC address mapping is
-   * inserted in the ARP table.
-   */
-
-  for (i = 0; i < CONFIG_NET_ARPTAB_SIZE; ++i)
+  if (ipaddr == 0)
     {
-      /* Check if the source IP address of the incoming packet matches
-       * the IP address in this ARP table entry.
-       */
+      return -EINVAL;
+    }
 
-      if (g_arptable[i].at_ipaddr != 0 &&
-          net_ipv4addr_cmp(ipaddr, g_arptable[i].at_ipaddr))
-        {
-          /* An old entry found, break. */
+  /* Find the hash table entry for the IP address.  If there is none, the
+   * IP -> MAC address mapping is inserted in the ARP table, replacing the
+   * oldest entry if the table is full.
+   */
 
-          tabptr = &g_arptable[i];
-          break;
-        }
-      else
+  tab = arp_tabfind(ipaddr);
+  if (tab == NULL)
+    {
+      tab = arp_taballoc(ipaddr);
+      if (tab == NULL)
         {
-          /* Record the oldest entry. */
-
-          tabptr = arp_return_old_entry(tabptr, &g_arptable[i]);
+          return -ENOMEM;
         }
     }
 
-  /* Now, tabptr is the ARP table entry which we will fill with the new
+  /* Now, tab is the ARP table entry which we will fill with the new
    * information.
    */
 
-  tabptr->at_ipaddr = ipaddr;
-  memcpy(tabptr->at_ethaddr.ether_addr_octet, ethaddr, ETHER_ADDR_LEN);
-  tabptr->at_time = clock_systime_ticks();
+  memcpy(tab->at_entry.at_ethaddr.ether_addr_octet, ethaddr,
+         ETHER_ADDR_LEN);
+  tab->at_entry.at_time = clock_systime_ticks();
+
+#ifdef CONFIG_NET_ARP_PENDING
+  /* If packets were waiting for this address, let the device poll for
+   * them.
+   */
+
+  tab->at_unresolved = false;
+  if (tab->at_npending > 0)
+    {
+      netdev_txnotify_dev(tab->at_dev);
+    }
+#endif
+
   return OK;
 }
 
@@ -281,19 +427,15 @@ void arp_hdr_update(FAR uint16_t *pipaddr, FAR uint8_t *ethaddr)
 
 FAR struct arp_entry_s *arp_lookup(in_addr_t ipaddr)
 {
-  FAR struct arp_entry_s *tabptr;
-  int i;
+  FAR struct arp_tabentry_s *tab;
 
   /* Check if the IPv4 address is already in the ARP table. */
 
-  for (i = 0; i < CONFIG_NET_ARPTAB_SIZE; ++i)
+  tab = arp_tabfind(ipaddr);
+  if (tab != NULL && ARP_RESOLVED(tab) &&
+      clock_systime_ticks() - tab->at_entry.at_time <= ARP_MAXAGE_TICK)
     {
-      tabptr = &g_arptable[i];
-      if (net_ipv4addr_cmp(ipaddr, tabptr->at_ipaddr) &&
-          clock_systime_ticks() - tabptr->at_time <= ARP_MAXAGE_TICK)
-        {
-          return tabptr;
-        }
+      return &tab->at_entry;
     }
 
   /* Not found */
@@ -380,16 +522,16 @@ int arp_find(in_addr_t ipaddr, FAR struct ether_addr *ethaddr)
 
 void arp_delete(in_addr_t ipaddr)
 {
-  FAR struct arp_entry_s *tabptr;
+  FAR struct arp_tabentry_s *tab;
 
   /* Check if the IPv4 address is in the ARP table. */
 
-  tabptr = arp_lookup(ipaddr);
-  if (tabptr != NULL)
+  tab = arp_tabfind(ipaddr);
+  if (tab != NULL)
     {
-      /* Yes.. Set the IP address to zero to "delete" it */
+      /* Yes.. Remove it from the hash table and mark it unused */
 
-      tabptr->at_ipaddr = 0;
+      arp_tabfree(tab);
     }
 }
 
@@ -417,22 +559,23 @@ void arp_delete(in_addr_t ipaddr)
 unsigned int arp_snapshot(FAR struct arp_entry_s *snapshot,
                           unsigned int nentries)
 {
-  FAR struct arp_entry_s *tabptr;
+  FAR struct arp_tabentry_s *tab;
   clock_t now;
   unsigned int ncopied;
-  int i;
+  unsigned int i;
 
   /* Copy all non-empty, non-expired entries in the ARP table. */
 
   for (i = 0, now = clock_systime_ticks(), ncopied = 0;
-       nentries > ncopied && i < CONFIG_NET_ARPTAB_SIZE;
+       nentries > ncopied && i < g_arpsize;
        i++)
     {
-      tabptr = &g_arptable[i];
-      if (tabptr->at_ipaddr != 0 &&
-          now - tabptr->at_time <= ARP_MAXAGE_TICK)
+      tab = &g_arptable[i];
+      if (tab->at_entry.at_ipaddr != 0 && ARP_RESOLVED(tab) &&
+          now - tab->at_entry.at_time <= ARP_MAXAGE_TICK)
         {
-          memcpy(&snapshot[ncopied], tabptr, sizeof(struct arp_entry_s));
+          memcpy(&snapshot[ncopied], &tab->at_entry,
+                 sizeof(struct arp_entry_s));
           ncopied++;
         }
     }
@@ -443,5 +586,250 @@ unsigned int arp_snapshot(FAR struct arp_entry_s *snapshot,
 }
 #endif
 
+/****************************************************************************
+ * Name: arp_table_resize
+ *
+ * Description:
+ *   Replace the ARP table with an empty table of the given size.  All
+ *   existing entries, and any packets waiting for address resolution, are
+ *   discarded.
+ *
+ * Input Parameters:
+ *   nentries - The new number of ARP table entries
+ *
+ * Returned Value:
+ *   Zero (OK) on success; a negated errno value on failure, in which case
+ *   the old table is kept.
+ *
+ ****************************************************************************/
+
+int arp_table_resize(unsigned int nentries)
+{
+  FAR struct arp_tabentry_s *table;
+  unsigned int nbuckets;
+  unsigned int i;
+
+  if (nentries == 0 || nentries > UINT16_MAX)
+    {
+      return -EINVAL;
+    }
+
+  /* Use a power of two number of hash chains, at least one per entry */
+
+  nbuckets = 1;
+  while (nbuckets < nentries)
+    {
+      nbuckets <<= 1;
+    }
+
+  table = kmm_zalloc(nentries * sizeof(struct arp_tabentry_s) +
+                     nbuckets * sizeof(FAR struct arp_tabentry_s *));
+  if (table == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  net_lock();
+
+  if (g_arptable != NULL)
+    {
+      for (i = 0; i < g_arpsize; i++)
+        {
+          arp_tabfree(&g_arptable[i]);
+        }
+
+      kmm_free(g_arptable);
+    }
+
+  g_arptable    = table;
+  g_arphash     = (FAR struct arp_tabentry_s **)&table[nentries];
+  g_arpsize     = nentries;
+  g_arphashmask = nbuckets - 1;
+
+  net_unlock();
+  return OK;
+}
+
+/****************************************************************************
+ * Name: arp_pending_add
+ *
+ * Description:
+ *   Keep a copy of the IPv4 packet in d_buf, which is about to be replaced
+ *   by an ARP request for 'ipaddr'.  The packet is sent when the ARP
+ *   response arrives.
+ *
+ * Input Parameters:
+ *   dev    - The device that will send the packet
+ *   ipaddr - The IPv4 address whose hardware address is needed
+ *
+ * Assumptions
+ *   The network is locked to assure exclusive access to the ARP table.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_ARP_PENDING
+void arp_pending_add(FAR struct net_driver_s *dev, in_addr_t ipaddr)
+{
+  FAR struct arp_tabentry_s *tab;
+  FAR struct iob_s *iob;
+  int ret;
+
+  tab = arp_tabfind(ipaddr);
+  if (tab == NULL)
+    {
+      tab = arp_taballoc(ipaddr);
+      if (tab == NULL)
+        {
+          return;
+        }
+
+      tab->at_entry.at_time = clock_systime_ticks();
+    }
+
+  /* The packets of an entry are all sent through the same device.  Drop
+   * the packets queued for another one.
+   */
+
+  if (tab->at_npending > 0 && tab->at_dev != dev)
+    {
+      iob_free_queue(&tab->at_pending, IOBUSER_NET_ARP_PENDING);
+      g_arp_npending  -= tab->at_npending;
+      tab->at_npending = 0;
+    }
+
+  /* Only an entry that is not resolved (or has expired) can wait for an
+   * ARP response.  The wait starts again with the first packet queued
+   * after earlier ones have timed out.
+   */
+
+  if (!tab->at_unresolved || tab->at_npending == 0)
+    {
+      tab->at_unresolved    = true;
+      tab->at_entry.at_time = clock_systime_ticks();
+    }
+
+  /* Make room for the new packet by dropping the oldest one */
+
+  if (tab->at_npending >= CONFIG_NET_ARP_MAXPENDING)
+    {
+      iob = iob_remove_queue(&tab->at_pending);
+      if (iob != NULL)
+        {
+          iob_free_chain(iob, IOBUSER_NET_ARP_PENDING);
+          tab->at_npending--;
+          g_arp_npending--;
+        }
+    }
+
+  /* Copy the IPv4 packet without waiting for I/O buffers */
+
+  iob = iob_tryalloc(true, IOBUSER_NET_ARP_PENDING);
+  if (iob == NULL)
+    {
+      return;
+    }
+
+  ret = iob_trycopyin(iob, &dev->d_buf[ETH_HDRLEN], dev->d_len, 0, true,
+                      IOBUSER_NET_ARP_PENDING);
+  if (ret >= 0)
+    {
+      ret = iob_tryadd_queue(iob, &tab->at_pending);
+    }
+
+  if (ret < 0)
+    {
+      iob_free_chain(iob, IOBUSER_NET_ARP_PENDING);
+      return;
+    }
+
+  tab->at_dev = dev;
+  tab->at_npending++;
+  g_arp_npending++;
+}
+
+/****************************************************************************
+ * Name: arp_pending_poll
+ *
+ * Description:
+ *   Send the packets of the device whose hardware address has been
+ *   resolved, and discard those that have waited too long.
+ *
+ * Assumptions:
+ *   This function is called from the MAC device driver indirectly through
+ *   devif_poll() with the network locked.
+ *
+ ****************************************************************************/
+
+int arp_pending_poll(FAR struct net_driver_s *dev,
+                     devif_poll_callback_t callback)
+{
+  FAR struct arp_tabentry_s *tab;
+  FAR struct iob_s *iob;
+  clock_t now;
+  unsigned int i;
+  int bstop = 0;
+
+  if (g_arp_npending == 0)
+    {
+      return 0;
+    }
+
+  now = clock_systime_ticks();
+  for (i = 0; i < g_arpsize && bstop == 0; i++)
+    {
+      tab = &g_arptable[i];
+      if (tab->at_npending == 0 || tab->at_dev != dev)
+        {
+          continue;
+        }
+
+      if (tab->at_unresolved)
+        {
+          /* Still waiting.  Drop the packets if the address could not be
+           * resolved in time.
+           */
+
+          if (now - tab->at_entry.at_time > ARP_PENDING_TICK)
+            {
+              iob_free_queue(&tab->at_pending, IOBUSER_NET_ARP_PENDING);
+              g_arp_npending  -= tab->at_npending;
+              tab->at_npending = 0;
+            }
+
+          continue;
+        }
+
+      /* Resolved.  Send the packets one at a time through the driver,
+       * which adds the Ethernet header with arp_out().
+       */
+
+      while (tab->at_npending > 0 && bstop == 0)
+        {
+          iob = iob_remove_queue(&tab->at_pending);
+          tab->at_npending--;
+          g_arp_npending--;
+
+          if (iob == NULL)
+            {
+              continue;
+            }
+
+          if (iob->io_pktlen <= dev->d_pktsize - ETH_HDRLEN)
+            {
+              iob_copyout(&dev->d_buf[ETH_HDRLEN], iob, iob->io_pktlen, 0);
+              dev->d_len = iob->io_pktlen;
+              IFF_SET_IPv4(dev->d_flags);
+
+              bstop = callback(dev);
+            }
+
+          iob_free_chain(iob, IOBUSER_NET_ARP_PENDING);
+        }
+    }
+
+  return bstop;
+}
+#endif /* CONFIG_NET_ARP_PENDING */
+
 #endif /* CONFIG_NET_ARP */
 #endif /* CONFIG_NET */
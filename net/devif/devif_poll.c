@@ -34,6 +34,7 @@
 
 #include "devif/devif.h"
 #include "arp/arp.h"
+#include "neighbor/neighbor.h"
 #include "can/can.h"
 #include "tcp/tcp.h"
 #include "udp/udp.h"
@@ -675,10 +676,28 @@ int devif_poll(FAR struct net_driver_s *dev, devif_poll_callback_t callback)
    * action.
    */
 
+#ifdef CONFIG_NET_ARP_PENDING
+  /* Check for packets whose ARP request has been answered */
+
+  bstop = arp_pending_poll(dev, callback);
+  if (!bstop)
+#endif
 #ifdef CONFIG_NET_ARP_SEND
-  /* Check for pending ARP requests */
+    {
+      /* Check for pending ARP requests */
+
+      bstop = arp_poll(dev, callback);
+    }
+
+  if (!bstop)
+#endif
+#ifdef CONFIG_NET_IPv6_NCONF_PENDING
+    {
+      /* Check for packets whose Neighbor Solicitation has been answered */
+
+      bstop = neighbor_pending_poll(dev, callback);
+    }
 
-  bstop = arp_poll(dev, callback);
   if (!bstop)
 #endif
 #ifdef CONFIG_NET_PKT
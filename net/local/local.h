@@ -59,6 +59,20 @@
 #define LOCAL_SYNC_BYTE   0x42     /* Byte in sync sequence */
 #define LOCAL_END_BYTE    0xbd     /* End of sync sequence */
 
+/* Connection-oriented socket types.  SOCK_SEQPACKET is only available with
+ * the ring buffer transport.
+ */
+
+#ifdef CONFIG_NET_LOCAL_RING
+#  define LOCAL_ISCONNTYPE(t) ((t) == SOCK_STREAM || (t) == SOCK_SEQPACKET)
+#else
+#  define LOCAL_ISCONNTYPE(t) ((t) == SOCK_STREAM)
+#endif
+
+#ifndef CONFIG_NET_LOCAL_SCM_MAXFD
+#  define CONFIG_NET_LOCAL_SCM_MAXFD 0
+#endif
+
 /****************************************************************************
  * Public Type Definitions
  ****************************************************************************/
@@ -93,6 +107,38 @@ enum local_state_s
   LOCAL_STATE_DISCONNECTED     /* Peer disconnected */
 };
 
+#ifdef CONFIG_NET_LOCAL_RING
+/* File descriptors passed with SCM_RIGHTS.  They are held as open struct
+ * file references while in flight and are attached to the first byte of
+ * the data that was sent with them.
+ */
+
+#if CONFIG_NET_LOCAL_SCM_MAXFD > 0
+struct local_scm_s
+{
+  sq_entry_t ls_node;          /* Supports a singly linked list */
+  size_t ls_offset;            /* Ring offset of the first data byte */
+  uint8_t ls_nfds;             /* Number of valid entries in ls_files */
+  struct file ls_files[CONFIG_NET_LOCAL_SCM_MAXFD];
+};
+#endif
+
+/* The receive ring of a connected peer.  lr_head and lr_tail are free-
+ * running byte offsets; the ring size is a power of two.
+ */
+
+struct local_ring_s
+{
+  FAR uint8_t *lr_buffer;      /* CONFIG_NET_LOCAL_RING_SIZE bytes */
+  size_t lr_head;              /* Offset of the next byte written */
+  size_t lr_tail;              /* Offset of the next byte read */
+  sem_t lr_waitsem;            /* Waits for data or for space in the peer */
+#if CONFIG_NET_LOCAL_SCM_MAXFD > 0
+  sq_queue_t lr_scm;           /* Queue of struct local_scm_s in flight */
+#endif
+};
+#endif /* CONFIG_NET_LOCAL_RING */
+
 /* Representation of a local connection.  There are four types of
  * connection structures:
  *
@@ -137,7 +183,7 @@ struct local_conn_s
   /* Fields common to SOCK_STREAM and SOCK_DGRAM */
 
   uint8_t lc_crefs;            /* Reference counts on this instance */
-  uint8_t lc_proto;            /* SOCK_STREAM or SOCK_DGRAM */
+  uint8_t lc_proto;            /* SOCK_STREAM, SOCK_DGRAM, ... */
   uint8_t lc_type;             /* See enum local_type_e */
   uint8_t lc_state;            /* See enum local_state_e */
   struct file lc_infile;       /* File for read-only FIFO (peers) */
@@ -160,6 +206,18 @@ struct local_conn_s
   struct pollfd lc_inout_fds[2*LOCAL_NPOLLWAITERS];
 #endif
 
+#ifdef CONFIG_NET_LOCAL_RING
+  /* Connected peers are linked directly to each other.  Each peer sends
+   * into the receive ring of the other.
+   */
+
+  FAR struct local_conn_s *lc_peer; /* Connected peer, NULL once closed */
+  struct local_ring_s lc_rxring;    /* Data sent to us by lc_peer */
+#ifdef HAVE_LOCAL_POLL
+  struct pollfd *lc_ring_fds[LOCAL_NPOLLWAITERS];
+#endif
+#endif
+
   /* Union of fields unique to SOCK_STREAM client, server, and connected
    * peers.
    */
@@ -624,6 +682,116 @@ int local_open_sender(FAR struct local_conn_s *conn, FAR const char *path,
                       bool nonblock);
 #endif
 
+/****************************************************************************
+ * Name: local_ring_alloc
+ *
+ * Description:
+ *   Allocate the receive ring of a connection that is about to be linked
+ *   to its peer.
+ *
+ * Returned Value:
+ *   Zero (OK) on success; -ENOMEM if the ring could not be allocated.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_LOCAL_RING
+int local_ring_alloc(FAR struct local_conn_s *conn);
+#endif
+
+/****************************************************************************
+ * Name: local_ring_free
+ *
+ * Description:
+ *   Free the receive ring of a connection, closing any file descriptors
+ *   that were passed to it but never received.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_LOCAL_RING
+void local_ring_free(FAR struct local_conn_s *conn);
+#endif
+
+/****************************************************************************
+ * Name: local_ring_disconnect
+ *
+ * Description:
+ *   Unlink a connection from its peer.  The peer sees end-of-file once it
+ *   has drained its receive ring and further sends to it fail with EPIPE.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_LOCAL_RING
+void local_ring_disconnect(FAR struct local_conn_s *conn);
+#endif
+
+/****************************************************************************
+ * Name: local_ring_sendmsg
+ *
+ * Description:
+ *   Send data on a connected SOCK_STREAM or SOCK_SEQPACKET socket by
+ *   copying it into the receive ring of the peer.  SCM_RIGHTS control
+ *   messages are honored.
+ *
+ * Input Parameters:
+ *   psock    A pointer to a NuttX-specific, internal socket structure
+ *   msg      msg to send
+ *   flags    Send flags
+ *
+ * Returned Value:
+ *   On success, returns the number of characters sent.  On error, a
+ *   negated errno value is returned.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_LOCAL_RING
+ssize_t local_ring_sendmsg(FAR struct socket *psock, FAR struct msghdr *msg,
+                           int flags);
+#endif
+
+/****************************************************************************
+ * Name: local_ring_recvmsg
+ *
+ * Description:
+ *   Receive data from the receive ring of a connected SOCK_STREAM or
+ *   SOCK_SEQPACKET socket.  File descriptors passed with the data are
+ *   installed in the caller's descriptor table and returned as an
+ *   SCM_RIGHTS control message.
+ *
+ * Input Parameters:
+ *   psock    A pointer to a NuttX-specific, internal socket structure
+ *   msg      Buffer to receive the message
+ *   flags    Receive flags
+ *
+ * Returned Value:
+ *   On success, returns the number of characters received, or zero if the
+ *   peer has closed the connection.  On error, a negated errno value is
+ *   returned.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_LOCAL_RING
+ssize_t local_ring_recvmsg(FAR struct socket *psock, FAR struct msghdr *msg,
+                           int flags);
+#endif
+
+/****************************************************************************
+ * Name: local_ring_events
+ *
+ * Description:
+ *   Return the poll events currently pending on a ring-connected socket.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_LOCAL_RING
+pollevent_t local_ring_events(FAR struct local_conn_s *conn);
+#endif
+
 /****************************************************************************
  * Name: local_accept_pollnotify
  ****************************************************************************/
@@ -635,6 +803,19 @@ void local_accept_pollnotify(FAR struct local_conn_s *conn,
 #define local_accept_pollnotify(conn, eventset) ((void)(conn))
 #endif
 
+/****************************************************************************
+ * Name: local_ring_pollnotify
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_LOCAL_RING
+#ifdef HAVE_LOCAL_POLL
+void local_ring_pollnotify(FAR struct local_conn_s *conn,
+                           pollevent_t eventset);
+#else
+#define local_ring_pollnotify(conn, eventset) ((void)(conn))
+#endif
+#endif
+
 /****************************************************************************
  * Name: local_pollsetup
  *
@@ -109,7 +109,7 @@ int local_accept(FAR struct socket *psock, FAR struct sockaddr *addr,
 
   /* Is the socket a stream? */
 
-  if (psock->s_domain != PF_LOCAL || psock->s_type != SOCK_STREAM)
+  if (psock->s_domain != PF_LOCAL || !LOCAL_ISCONNTYPE(psock->s_type))
     {
       return -EOPNOTSUPP;
     }
@@ -120,7 +120,7 @@ int local_accept(FAR struct socket *psock, FAR struct sockaddr *addr,
 
   server = (FAR struct local_conn_s *)psock->s_conn;
 
-  if (server->lc_proto != SOCK_STREAM ||
+  if (server->lc_proto != psock->s_type ||
       server->lc_state != LOCAL_STATE_LISTENING ||
       server->lc_type  != LOCAL_TYPE_PATHNAME)
     {
@@ -160,7 +160,7 @@ int local_accept(FAR struct socket *psock, FAR struct sockaddr *addr,
               /* Initialize the new connection structure */
 
               conn->lc_crefs  = 1;
-              conn->lc_proto  = SOCK_STREAM;
+              conn->lc_proto  = server->lc_proto;
               conn->lc_type   = LOCAL_TYPE_PATHNAME;
               conn->lc_state  = LOCAL_STATE_CONNECTED;
 
@@ -168,6 +168,18 @@ int local_accept(FAR struct socket *psock, FAR struct sockaddr *addr,
               conn->lc_path[UNIX_PATH_MAX - 1] = '\0';
               conn->lc_instance_id = client->lc_instance_id;
 
+#ifdef CONFIG_NET_LOCAL_RING
+              /* Link the two peers directly.  Each sends into the receive
+               * ring of the other.
+               */
+
+              ret = local_ring_alloc(conn);
+              if (ret == OK)
+                {
+                  conn->lc_peer   = client;
+                  client->lc_peer = conn;
+                }
+#else
               /* Open the server-side write-only FIFO.  This should not
                * block.
                */
@@ -179,8 +191,10 @@ int local_accept(FAR struct socket *psock, FAR struct sockaddr *addr,
                   nerr("ERROR: Failed to open write-only FIFOs for %s: %d\n",
                      conn->lc_path, ret);
                 }
+#endif
             }
 
+#ifndef CONFIG_NET_LOCAL_RING
           /* Do we have a connection?  Is the write-side FIFO opened? */
 
           if (ret == OK)
@@ -200,12 +214,15 @@ int local_accept(FAR struct socket *psock, FAR struct sockaddr *addr,
                         conn->lc_path, ret);
                 }
             }
+#endif
 
           /* Do we have a connection?  Are the FIFOs opened? */
 
           if (ret == OK)
             {
+#ifndef CONFIG_NET_LOCAL_RING
               DEBUGASSERT(conn->lc_infile.f_inode != NULL);
+#endif
 
               /* Return the address family */
 
@@ -220,11 +237,21 @@ int local_accept(FAR struct socket *psock, FAR struct sockaddr *addr,
               /* Setup the client socket structure */
 
               newsock->s_domain = psock->s_domain;
-              newsock->s_type   = SOCK_STREAM;
+              newsock->s_type   = psock->s_type;
               newsock->s_sockif = psock->s_sockif;
               newsock->s_conn   = (FAR void *)conn;
             }
 
+#ifdef CONFIG_NET_LOCAL_RING
+          else if (conn != NULL)
+            {
+              /* Undo the link to the client */
+
+              client->lc_peer = NULL;
+              local_free(conn);
+            }
+#endif
+
           /* Signal the client with the result of the connection */
 
           client->u.client.lc_result = ret;
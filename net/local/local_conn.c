@@ -112,6 +112,11 @@ FAR struct local_conn_s *local_alloc(void)
       nxsem_init(&conn->lc_waitsem, 0, 0);
       nxsem_set_protocol(&conn->lc_waitsem, SEM_PRIO_NONE);
 #endif
+
+#ifdef CONFIG_NET_LOCAL_RING
+      nxsem_init(&conn->lc_rxring.lr_waitsem, 0, 0);
+      nxsem_set_protocol(&conn->lc_rxring.lr_waitsem, SEM_PRIO_NONE);
+#endif
     }
 
   return conn;
@@ -146,10 +151,18 @@ void local_free(FAR struct local_conn_s *conn)
       conn->lc_outfile.f_inode = NULL;
     }
 
-#ifdef CONFIG_NET_LOCAL_STREAM
+#ifdef CONFIG_NET_LOCAL_RING
+  /* Free the receive ring and anything still queued in it */
+
+  local_ring_free(conn);
+  nxsem_destroy(&conn->lc_rxring.lr_waitsem);
+#elif defined(CONFIG_NET_LOCAL_STREAM)
   /* Destroy all FIFOs associted with the connection */
 
   local_release_fifos(conn);
+#endif
+
+#ifdef CONFIG_NET_LOCAL_STREAM
   nxsem_destroy(&conn->lc_waitsem);
 #endif
 
@@ -126,6 +126,19 @@ static int inline local_stream_connect(FAR struct local_conn_s *client,
   server->u.server.lc_pending++;
   DEBUGASSERT(server->u.server.lc_pending != 0);
 
+#ifdef CONFIG_NET_LOCAL_RING
+  /* Allocate our receive ring.  The server links the two peers directly
+   * when it accepts the connection; no FIFOs are needed.
+   */
+
+  ret = local_ring_alloc(client);
+  if (ret < 0)
+    {
+      server->u.server.lc_pending--;
+      net_unlock();
+      return ret;
+    }
+#else
   /* Create the FIFOs needed for the connection */
 
   ret = local_create_fifos(client);
@@ -153,6 +166,7 @@ static int inline local_stream_connect(FAR struct local_conn_s *client,
     }
 
   DEBUGASSERT(client->lc_outfile.f_inode != NULL);
+#endif
 
   /* Set the busy "result" before giving the semaphore. */
 
@@ -188,6 +202,7 @@ static int inline local_stream_connect(FAR struct local_conn_s *client,
       goto errout_with_outfd;
     }
 
+#ifndef CONFIG_NET_LOCAL_RING
   /* Yes.. open the read-only FIFO */
 
   ret = local_open_client_rx(client, nonblock);
@@ -199,15 +214,22 @@ static int inline local_stream_connect(FAR struct local_conn_s *client,
     }
 
   DEBUGASSERT(client->lc_infile.f_inode != NULL);
+#endif
+
   client->lc_state = LOCAL_STATE_CONNECTED;
   return OK;
 
 errout_with_outfd:
+#ifdef CONFIG_NET_LOCAL_RING
+  local_ring_free(client);
+#else
   file_close(&client->lc_outfile);
   client->lc_outfile.f_inode = NULL;
 
 errout_with_fifos:
   local_release_fifos(client);
+#endif
+
   client->lc_state = LOCAL_STATE_BOUND;
   return ret;
 }
@@ -263,7 +285,7 @@ int psock_local_connect(FAR struct socket *psock,
        */
 
       DEBUGASSERT(conn->lc_state == LOCAL_STATE_LISTENING &&
-                  conn->lc_proto == SOCK_STREAM);
+                  LOCAL_ISCONNTYPE(conn->lc_proto));
 
       /* Handle according to the server connection type */
 
@@ -285,6 +307,14 @@ int psock_local_connect(FAR struct socket *psock,
               {
                 int ret = OK;
 
+                /* The server must be of the same socket type */
+
+                if (conn->lc_proto != psock->s_type)
+                  {
+                    net_unlock();
+                    return -EPROTOTYPE;
+                  }
+
                 /* Bind the address and protocol */
 
                 client->lc_proto = conn->lc_proto;
@@ -297,9 +327,9 @@ int psock_local_connect(FAR struct socket *psock,
 
                 client->lc_state = LOCAL_STATE_BOUND;
 
-                /* We have to do more for the SOCK_STREAM family */
+                /* We have to do more for the connection-oriented types */
 
-                if (conn->lc_proto == SOCK_STREAM)
+                if (LOCAL_ISCONNTYPE(conn->lc_proto))
                   {
                     ret =
                       local_stream_connect(client, conn,
@@ -81,7 +81,7 @@ int local_listen(FAR struct socket *psock, int backlog)
    * address family.
    */
 
-  if (psock->s_domain != PF_LOCAL || psock->s_type != SOCK_STREAM)
+  if (psock->s_domain != PF_LOCAL || !LOCAL_ISCONNTYPE(psock->s_type))
     {
       nerr("ERROR: Unsupported socket family=%d or socket type=%d\n",
            psock->s_domain, psock->s_type);
@@ -92,7 +92,7 @@ int local_listen(FAR struct socket *psock, int backlog)
 
   /* Some sanity checks */
 
-  if (server->lc_proto != SOCK_STREAM ||
+  if (server->lc_proto != psock->s_type ||
       server->lc_state == LOCAL_STATE_UNBOUND ||
       server->lc_type != LOCAL_TYPE_PATHNAME)
     {
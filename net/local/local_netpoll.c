@@ -114,6 +114,79 @@ errout:
 }
 #endif
 
+/****************************************************************************
+ * Name: local_ring_pollsetup
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_LOCAL_RING
+static int local_ring_pollsetup(FAR struct local_conn_s *conn,
+                                FAR struct pollfd *fds,
+                                bool setup)
+{
+  pollevent_t eventset;
+  int ret = OK;
+  int i;
+
+  net_lock();
+  if (setup)
+    {
+      /* This is a request to set up the poll.  Find an available
+       * slot for the poll structure reference
+       */
+
+      for (i = 0; i < LOCAL_NPOLLWAITERS; i++)
+        {
+          /* Find an available slot */
+
+          if (!conn->lc_ring_fds[i])
+            {
+              /* Bind the poll structure and this slot */
+
+              conn->lc_ring_fds[i] = fds;
+              fds->priv = &conn->lc_ring_fds[i];
+              break;
+            }
+        }
+
+      if (i >= LOCAL_NPOLLWAITERS)
+        {
+          fds->priv = NULL;
+          ret = -EBUSY;
+          goto errout;
+        }
+
+      /* Report the events that are already pending */
+
+      eventset = local_ring_events(conn);
+      if (eventset)
+        {
+          local_ring_pollnotify(conn, eventset);
+        }
+    }
+  else
+    {
+      /* This is a request to tear down the poll. */
+
+      struct pollfd **slot = (struct pollfd **)fds->priv;
+
+      if (!slot)
+        {
+          ret = -EIO;
+          goto errout;
+        }
+
+      /* Remove all memory of the poll setup */
+
+      *slot = NULL;
+      fds->priv = NULL;
+    }
+
+errout:
+  net_unlock();
+  return ret;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -144,6 +217,34 @@ void local_accept_pollnotify(FAR struct local_conn_s *conn,
 #endif
 }
 
+/****************************************************************************
+ * Name: local_ring_pollnotify
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_LOCAL_RING
+void local_ring_pollnotify(FAR struct local_conn_s *conn,
+                           pollevent_t eventset)
+{
+  int i;
+
+  for (i = 0; i < LOCAL_NPOLLWAITERS; i++)
+    {
+      struct pollfd *fds = conn->lc_ring_fds[i];
+      if (fds)
+        {
+          /* POLLHUP is reported whether it was requested or not */
+
+          fds->revents |= eventset & (fds->events | POLLHUP);
+          if (fds->revents != 0)
+            {
+              ninfo("Report events: %02x\n", fds->revents);
+              nxsem_post(fds->sem);
+            }
+        }
+    }
+}
+#endif
+
 /****************************************************************************
  * Name: local_pollsetup
  *
@@ -179,6 +280,13 @@ int local_pollsetup(FAR struct socket *psock, FAR struct pollfd *fds)
       return local_accept_pollsetup(conn, fds, true);
     }
 
+#ifdef CONFIG_NET_LOCAL_RING
+  if (conn->lc_state == LOCAL_STATE_CONNECTED)
+    {
+      return local_ring_pollsetup(conn, fds, true);
+    }
+#endif
+
   if (conn->lc_state == LOCAL_STATE_DISCONNECTED)
     {
       fds->priv = NULL;
@@ -329,6 +437,13 @@ int local_pollteardown(FAR struct socket *psock, FAR struct pollfd *fds)
       return local_accept_pollsetup(conn, fds, false);
     }
 
+#ifdef CONFIG_NET_LOCAL_RING
+  if (conn->lc_state == LOCAL_STATE_CONNECTED)
+    {
+      return local_ring_pollsetup(conn, fds, false);
+    }
+#endif
+
   if (conn->lc_state == LOCAL_STATE_DISCONNECTED)
     {
       return OK;
@@ -412,6 +412,15 @@ ssize_t local_recvmsg(FAR struct socket *psock, FAR struct msghdr *msg,
 
   DEBUGASSERT(psock && psock->s_conn && buf);
 
+#ifdef CONFIG_NET_LOCAL_RING
+  /* Connected peers receive from their own receive ring */
+
+  if (LOCAL_ISCONNTYPE(psock->s_type))
+    {
+      return local_ring_recvmsg(psock, msg, flags);
+    }
+#endif
+
   /* Check for a stream socket */
 
 #ifdef CONFIG_NET_LOCAL_STREAM
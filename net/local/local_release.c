@@ -70,7 +70,13 @@ int local_release(FAR struct local_conn_s *conn)
   if (conn->lc_state == LOCAL_STATE_CONNECTED ||
       conn->lc_state == LOCAL_STATE_DISCONNECTED)
     {
-      DEBUGASSERT(conn->lc_proto == SOCK_STREAM);
+      DEBUGASSERT(LOCAL_ISCONNTYPE(conn->lc_proto));
+
+#ifdef CONFIG_NET_LOCAL_RING
+      /* Tell the peer that no more data will arrive */
+
+      local_ring_disconnect(conn);
+#endif
 
       /* Just free the connection structure */
     }
@@ -81,7 +87,7 @@ int local_release(FAR struct local_conn_s *conn)
     {
       FAR struct local_conn_s *client;
 
-      DEBUGASSERT(conn->lc_proto == SOCK_STREAM);
+      DEBUGASSERT(LOCAL_ISCONNTYPE(conn->lc_proto));
 
       /* Are there still clients waiting for a connection to the server? */
 
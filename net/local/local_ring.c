@@ -0,0 +1,827 @@
+/****************************************************************************
+ * net/local/local_ring.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+#include <debug.h>
+
+#include <nuttx/kmalloc.h>
+#include <nuttx/net/net.h>
+
+#include "socket/socket.h"
+#include "local/local.h"
+
+#ifdef CONFIG_NET_LOCAL_RING
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define LOCAL_RING_SIZE    CONFIG_NET_LOCAL_RING_SIZE
+#define LOCAL_RING_MASK    (LOCAL_RING_SIZE - 1)
+
+#if (LOCAL_RING_SIZE & LOCAL_RING_MASK) != 0
+#  error CONFIG_NET_LOCAL_RING_SIZE must be a power of two
+#endif
+
+/* Each SOCK_SEQPACKET message is preceded by its 16-bit length */
+
+#define LOCAL_RING_HDRLEN  sizeof(uint16_t)
+
+#ifndef MIN
+#  define MIN(a,b) ((a) < (b) ? (a) : (b))
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: local_ring_used and local_ring_space
+ *
+ * Description:
+ *   Return the number of bytes queued in the ring and the number of bytes
+ *   that may still be written to it.
+ *
+ ****************************************************************************/
+
+static inline size_t local_ring_used(FAR struct local_ring_s *ring)
+{
+  return ring->lr_head - ring->lr_tail;
+}
+
+static inline size_t local_ring_space(FAR struct local_ring_s *ring)
+{
+  return LOCAL_RING_SIZE - local_ring_used(ring);
+}
+
+/****************************************************************************
+ * Name: local_ring_copyin
+ *
+ * Description:
+ *   Append 'len' bytes to the ring.  The caller has verified that there is
+ *   space for them.
+ *
+ ****************************************************************************/
+
+static void local_ring_copyin(FAR struct local_ring_s *ring,
+                              FAR const void *buf, size_t len)
+{
+  size_t offset = ring->lr_head & LOCAL_RING_MASK;
+  size_t chunk  = MIN(len, LOCAL_RING_SIZE - offset);
+
+  memcpy(&ring->lr_buffer[offset], buf, chunk);
+  memcpy(ring->lr_buffer, (FAR const uint8_t *)buf + chunk, len - chunk);
+  ring->lr_head += len;
+}
+
+/****************************************************************************
+ * Name: local_ring_copyout
+ *
+ * Description:
+ *   Remove 'len' bytes from the ring, copying them to 'buf' unless 'buf' is
+ *   NULL.  The caller has verified that the bytes are present.
+ *
+ ****************************************************************************/
+
+static void local_ring_copyout(FAR struct local_ring_s *ring,
+                               FAR void *buf, size_t len)
+{
+  size_t offset = ring->lr_tail & LOCAL_RING_MASK;
+  size_t chunk  = MIN(len, LOCAL_RING_SIZE - offset);
+
+  if (buf != NULL)
+    {
+      memcpy(buf, &ring->lr_buffer[offset], chunk);
+      memcpy((FAR uint8_t *)buf + chunk, ring->lr_buffer, len - chunk);
+    }
+
+  ring->lr_tail += len;
+}
+
+/****************************************************************************
+ * Name: local_ring_writeiov
+ *
+ * Description:
+ *   Append 'len' bytes taken from the I/O vector, starting 'offset' bytes
+ *   into it, to the ring.
+ *
+ ****************************************************************************/
+
+static void local_ring_writeiov(FAR struct local_ring_s *ring,
+                                FAR const struct iovec *iov, int iovcnt,
+                                size_t offset, size_t len)
+{
+  for (; iovcnt > 0 && len > 0; iov++, iovcnt--)
+    {
+      size_t chunk;
+
+      if (offset >= iov->iov_len)
+        {
+          offset -= iov->iov_len;
+          continue;
+        }
+
+      chunk = MIN(iov->iov_len - offset, len);
+      local_ring_copyin(ring, (FAR const uint8_t *)iov->iov_base + offset,
+                        chunk);
+      offset = 0;
+      len   -= chunk;
+    }
+}
+
+/****************************************************************************
+ * Name: local_ring_readiov
+ *
+ * Description:
+ *   Remove 'len' bytes from the ring, scattering them over the I/O vector.
+ *   The vector has room for at least 'len' bytes.
+ *
+ ****************************************************************************/
+
+static void local_ring_readiov(FAR struct local_ring_s *ring,
+                               FAR const struct iovec *iov, int iovcnt,
+                               size_t len)
+{
+  for (; iovcnt > 0 && len > 0; iov++, iovcnt--)
+    {
+      size_t chunk = MIN(iov->iov_len, len);
+
+      local_ring_copyout(ring, iov->iov_base, chunk);
+      len -= chunk;
+    }
+}
+
+/****************************************************************************
+ * Name: local_ring_iovlen
+ ****************************************************************************/
+
+static size_t local_ring_iovlen(FAR const struct iovec *iov, int iovcnt)
+{
+  size_t len = 0;
+
+  while (iovcnt-- > 0)
+    {
+      len += iov++->iov_len;
+    }
+
+  return len;
+}
+
+/****************************************************************************
+ * Name: local_ring_wait
+ *
+ * Description:
+ *   Wait for activity on the connection: data arriving in its receive
+ *   ring, space being released in the ring of its peer, or the peer
+ *   closing.  The network lock is released while waiting.
+ *
+ ****************************************************************************/
+
+static int local_ring_wait(FAR struct local_conn_s *conn)
+{
+  return net_lockedwait(&conn->lc_rxring.lr_waitsem);
+}
+
+/****************************************************************************
+ * Name: local_ring_notify
+ *
+ * Description:
+ *   Wake up every thread waiting on the connection and report the events
+ *   to any poll() waiters.
+ *
+ ****************************************************************************/
+
+static void local_ring_notify(FAR struct local_conn_s *conn,
+                              pollevent_t eventset)
+{
+  int sval;
+
+  while (nxsem_get_value(&conn->lc_rxring.lr_waitsem, &sval) == 0 &&
+         sval < 0)
+    {
+      nxsem_post(&conn->lc_rxring.lr_waitsem);
+    }
+
+  local_ring_pollnotify(conn, eventset);
+}
+
+#if CONFIG_NET_LOCAL_SCM_MAXFD > 0
+/****************************************************************************
+ * Name: local_scm_free
+ *
+ * Description:
+ *   Close the file references held by an in-flight SCM_RIGHTS message and
+ *   free it.
+ *
+ ****************************************************************************/
+
+static void local_scm_free(FAR struct local_scm_s *scm)
+{
+  int i;
+
+  for (i = 0; i < scm->ls_nfds; i++)
+    {
+      file_close(&scm->ls_files[i]);
+    }
+
+  kmm_free(scm);
+}
+
+/****************************************************************************
+ * Name: local_scm_alloc
+ *
+ * Description:
+ *   Take a reference on every file descriptor named by the SCM_RIGHTS
+ *   control messages of 'msg'.  *scmp is set to NULL if there are none.
+ *
+ ****************************************************************************/
+
+static int local_scm_alloc(FAR struct msghdr *msg,
+                           FAR struct local_scm_s **scmp)
+{
+  FAR struct local_scm_s *scm;
+  FAR struct cmsghdr *cmsg;
+  int ret = OK;
+
+  *scmp = NULL;
+
+  scm = (FAR struct local_scm_s *)kmm_zalloc(sizeof(struct local_scm_s));
+  if (scm == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  for (cmsg = CMSG_FIRSTHDR(msg); cmsg != NULL;
+       cmsg = CMSG_NXTHDR(msg, cmsg))
+    {
+      FAR int *fds = (FAR int *)CMSG_DATA(cmsg);
+      int nfds;
+      int i;
+
+      if (cmsg->cmsg_len < CMSG_LEN(0))
+        {
+          ret = -EINVAL;
+          goto errout;
+        }
+
+      if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS)
+        {
+          continue;
+        }
+
+      nfds = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+      for (i = 0; i < nfds; i++)
+        {
+          FAR struct file *filep;
+
+          if (scm->ls_nfds >= CONFIG_NET_LOCAL_SCM_MAXFD)
+            {
+              ret = -ETOOMANYREFS;
+              goto errout;
+            }
+
+          ret = fs_getfilep(fds[i], &filep);
+          if (ret >= 0)
+            {
+              ret = file_dup2(filep, &scm->ls_files[scm->ls_nfds]);
+            }
+
+          if (ret < 0)
+            {
+              goto errout;
+            }
+
+          scm->ls_nfds++;
+        }
+    }
+
+  if (scm->ls_nfds == 0)
+    {
+      kmm_free(scm);
+      return OK;
+    }
+
+  *scmp = scm;
+  return OK;
+
+errout:
+  local_scm_free(scm);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: local_scm_deliver
+ *
+ * Description:
+ *   Install the files of a received SCM_RIGHTS message in the descriptor
+ *   table of the caller and describe them in the control buffer of 'msg'.
+ *   Descriptors that do not fit are closed and MSG_CTRUNC is reported.
+ *
+ ****************************************************************************/
+
+static void local_scm_deliver(FAR struct msghdr *msg,
+                              FAR struct local_scm_s *scm)
+{
+  FAR struct cmsghdr *cmsg = CMSG_FIRSTHDR(msg);
+  int fds[CONFIG_NET_LOCAL_SCM_MAXFD];
+  size_t maxfds = 0;
+  size_t nfds = 0;
+  int i;
+
+  if (cmsg != NULL && msg->msg_controllen >= CMSG_LEN(0))
+    {
+      maxfds = (msg->msg_controllen - CMSG_LEN(0)) / sizeof(int);
+    }
+
+  for (i = 0; i < scm->ls_nfds; i++)
+    {
+      int fd = -EMFILE;
+
+      if (nfds < maxfds)
+        {
+          fd = file_dup(&scm->ls_files[i], 0);
+        }
+
+      if (fd >= 0)
+        {
+          fds[nfds++] = fd;
+        }
+      else
+        {
+          msg->msg_flags |= MSG_CTRUNC;
+        }
+    }
+
+  if (nfds > 0)
+    {
+      cmsg->cmsg_level = SOL_SOCKET;
+      cmsg->cmsg_type  = SCM_RIGHTS;
+      cmsg->cmsg_len   = CMSG_LEN(nfds * sizeof(int));
+      memcpy(CMSG_DATA(cmsg), fds, nfds * sizeof(int));
+      msg->msg_controllen = CMSG_SPACE(nfds * sizeof(int));
+    }
+  else
+    {
+      msg->msg_controllen = 0;
+    }
+
+  local_scm_free(scm);
+}
+#endif /* CONFIG_NET_LOCAL_SCM_MAXFD > 0 */
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: local_ring_alloc
+ *
+ * Description:
+ *   Allocate the receive ring of a connection that is about to be linked
+ *   to its peer.
+ *
+ * Returned Value:
+ *   Zero (OK) on success; -ENOMEM if the ring could not be allocated.
+ *
+ ****************************************************************************/
+
+int local_ring_alloc(FAR struct local_conn_s *conn)
+{
+  FAR struct local_ring_s *ring = &conn->lc_rxring;
+
+  DEBUGASSERT(ring->lr_buffer == NULL);
+
+  ring->lr_buffer = (FAR uint8_t *)kmm_malloc(LOCAL_RING_SIZE);
+  if (ring->lr_buffer == NULL)
+    {
+      nerr("ERROR: Failed to allocate the receive ring\n");
+      return -ENOMEM;
+    }
+
+  ring->lr_head = 0;
+  ring->lr_tail = 0;
+#if CONFIG_NET_LOCAL_SCM_MAXFD > 0
+  sq_init(&ring->lr_scm);
+#endif
+  return OK;
+}
+
+/****************************************************************************
+ * Name: local_ring_free
+ *
+ * Description:
+ *   Free the receive ring of a connection, closing any file descriptors
+ *   that were passed to it but never received.
+ *
+ ****************************************************************************/
+
+void local_ring_free(FAR struct local_conn_s *conn)
+{
+  FAR struct local_ring_s *ring = &conn->lc_rxring;
+
+  if (ring->lr_buffer != NULL)
+    {
+#if CONFIG_NET_LOCAL_SCM_MAXFD > 0
+      FAR struct local_scm_s *scm;
+
+      while ((scm = (FAR struct local_scm_s *)sq_remfirst(&ring->lr_scm))
+             != NULL)
+        {
+          local_scm_free(scm);
+        }
+#endif
+
+      kmm_free(ring->lr_buffer);
+      ring->lr_buffer = NULL;
+    }
+}
+
+/****************************************************************************
+ * Name: local_ring_disconnect
+ *
+ * Description:
+ *   Unlink a connection from its peer.  The peer sees end-of-file once it
+ *   has drained its receive ring and further sends to it fail with EPIPE.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+void local_ring_disconnect(FAR struct local_conn_s *conn)
+{
+  FAR struct local_conn_s *peer = conn->lc_peer;
+
+  if (peer != NULL)
+    {
+      DEBUGASSERT(peer->lc_peer == conn);
+
+      peer->lc_peer = NULL;
+      conn->lc_peer = NULL;
+      local_ring_notify(peer, POLLIN | POLLHUP);
+    }
+}
+
+/****************************************************************************
+ * Name: local_ring_events
+ *
+ * Description:
+ *   Return the poll events currently pending on a ring-connected socket.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+pollevent_t local_ring_events(FAR struct local_conn_s *conn)
+{
+  FAR struct local_conn_s *peer = conn->lc_peer;
+  pollevent_t eventset = 0;
+
+  if (local_ring_used(&conn->lc_rxring) > 0)
+    {
+      eventset |= POLLIN;
+    }
+
+  if (peer == NULL)
+    {
+      /* Report POLLIN as well so that a reader picks up end-of-file */
+
+      eventset |= POLLIN | POLLHUP;
+    }
+  else if (local_ring_space(&peer->lc_rxring) >
+           (conn->lc_proto == SOCK_SEQPACKET ? LOCAL_RING_HDRLEN : 0))
+    {
+      eventset |= POLLOUT;
+    }
+
+  return eventset;
+}
+
+/****************************************************************************
+ * Name: local_ring_sendmsg
+ *
+ * Description:
+ *   Send data on a connected SOCK_STREAM or SOCK_SEQPACKET socket by
+ *   copying it into the receive ring of the peer.  SCM_RIGHTS control
+ *   messages are honored.
+ *
+ * Input Parameters:
+ *   psock    A pointer to a NuttX-specific, internal socket structure
+ *   msg      msg to send
+ *   flags    Send flags
+ *
+ * Returned Value:
+ *   On success, returns the number of characters sent.  On error, a
+ *   negated errno value is returned.
+ *
+ ****************************************************************************/
+
+ssize_t local_ring_sendmsg(FAR struct socket *psock, FAR struct msghdr *msg,
+                           int flags)
+{
+  FAR struct local_conn_s *conn = (FAR struct local_conn_s *)psock->s_conn;
+  FAR const struct iovec *iov = msg->msg_iov;
+  int iovcnt = msg->msg_iovlen;
+#if CONFIG_NET_LOCAL_SCM_MAXFD > 0
+  FAR struct local_scm_s *scm = NULL;
+#endif
+  bool seqpacket = psock->s_type == SOCK_SEQPACKET;
+  bool nonblock;
+  size_t sent = 0;
+  size_t len;
+  int ret = OK;
+
+  if (conn->lc_state != LOCAL_STATE_CONNECTED)
+    {
+      nerr("ERROR: not connected\n");
+      return -ENOTCONN;
+    }
+
+  len = local_ring_iovlen(iov, iovcnt);
+  if (seqpacket &&
+      (len > UINT16_MAX || len + LOCAL_RING_HDRLEN > LOCAL_RING_SIZE))
+    {
+      return -EMSGSIZE;
+    }
+
+  if (len == 0 && !seqpacket)
+    {
+      return 0;
+    }
+
+#if CONFIG_NET_LOCAL_SCM_MAXFD > 0
+  if (msg->msg_control != NULL && msg->msg_controllen > 0)
+    {
+      ret = local_scm_alloc(msg, &scm);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      /* The descriptors travel with the first byte of the data */
+
+      if (scm != NULL && len == 0)
+        {
+          local_scm_free(scm);
+          return -EINVAL;
+        }
+    }
+#endif
+
+  nonblock = _SS_ISNONBLOCK(psock->s_flags) || (flags & MSG_DONTWAIT) != 0;
+
+  net_lock();
+  for (; ; )
+    {
+      FAR struct local_conn_s *peer = conn->lc_peer;
+      FAR struct local_ring_s *ring;
+      size_t space;
+      size_t chunk;
+
+      if (peer == NULL)
+        {
+          ret = -EPIPE;
+          break;
+        }
+
+      ring  = &peer->lc_rxring;
+      space = local_ring_space(ring);
+
+      /* A SOCK_SEQPACKET message is written in one piece; a stream is
+       * written in as many pieces as the space in the ring allows.
+       */
+
+      chunk = seqpacket ? len + LOCAL_RING_HDRLEN : len - sent;
+      if (seqpacket ? space >= chunk : space > 0)
+        {
+#if CONFIG_NET_LOCAL_SCM_MAXFD > 0
+          if (scm != NULL)
+            {
+              scm->ls_offset = ring->lr_head;
+              sq_addlast(&scm->ls_node, &ring->lr_scm);
+              scm = NULL;
+            }
+#endif
+
+          if (seqpacket)
+            {
+              uint16_t pktlen = len;
+
+              local_ring_copyin(ring, &pktlen, LOCAL_RING_HDRLEN);
+              local_ring_writeiov(ring, iov, iovcnt, 0, len);
+              sent = len;
+            }
+          else
+            {
+              chunk = MIN(chunk, space);
+              local_ring_writeiov(ring, iov, iovcnt, sent, chunk);
+              sent += chunk;
+            }
+
+          local_ring_notify(peer, POLLIN);
+          if (sent >= len)
+            {
+              break;
+            }
+        }
+      else if (nonblock)
+        {
+          ret = -EAGAIN;
+          break;
+        }
+      else
+        {
+          /* Wait for the peer to drain its ring */
+
+          ret = local_ring_wait(conn);
+          if (ret < 0)
+            {
+              break;
+            }
+        }
+    }
+
+  net_unlock();
+
+#if CONFIG_NET_LOCAL_SCM_MAXFD > 0
+  if (scm != NULL)
+    {
+      local_scm_free(scm);
+    }
+#endif
+
+  return sent > 0 || ret >= 0 ? (ssize_t)sent : ret;
+}
+
+/****************************************************************************
+ * Name: local_ring_recvmsg
+ *
+ * Description:
+ *   Receive data from the receive ring of a connected SOCK_STREAM or
+ *   SOCK_SEQPACKET socket.  File descriptors passed with the data are
+ *   installed in the caller's descriptor table and returned as an
+ *   SCM_RIGHTS control message.
+ *
+ * Input Parameters:
+ *   psock    A pointer to a NuttX-specific, internal socket structure
+ *   msg      Buffer to receive the message
+ *   flags    Receive flags
+ *
+ * Returned Value:
+ *   On success, returns the number of characters received, or zero if the
+ *   peer has closed the connection.  On error, a negated errno value is
+ *   returned.
+ *
+ ****************************************************************************/
+
+ssize_t local_ring_recvmsg(FAR struct socket *psock, FAR struct msghdr *msg,
+                           int flags)
+{
+  FAR struct local_conn_s *conn = (FAR struct local_conn_s *)psock->s_conn;
+  FAR struct local_ring_s *ring = &conn->lc_rxring;
+  FAR const struct iovec *iov = msg->msg_iov;
+  int iovcnt = msg->msg_iovlen;
+#if CONFIG_NET_LOCAL_SCM_MAXFD > 0
+  FAR struct local_scm_s *scm = NULL;
+#endif
+  bool nonblock;
+  size_t avail;
+  size_t len;
+  ssize_t ret;
+
+  if (conn->lc_state != LOCAL_STATE_CONNECTED)
+    {
+      return -ENOTCONN;
+    }
+
+  len      = local_ring_iovlen(iov, iovcnt);
+  nonblock = _SS_ISNONBLOCK(psock->s_flags) || (flags & MSG_DONTWAIT) != 0;
+
+  net_lock();
+  while ((avail = local_ring_used(ring)) == 0)
+    {
+      if (conn->lc_peer == NULL)
+        {
+          /* The peer has closed and everything it sent has been read */
+
+          ret = 0;
+          goto out;
+        }
+
+      if (nonblock)
+        {
+          ret = -EAGAIN;
+          goto out;
+        }
+
+      ret = local_ring_wait(conn);
+      if (ret < 0)
+        {
+          goto out;
+        }
+    }
+
+#if CONFIG_NET_LOCAL_SCM_MAXFD > 0
+  /* Descriptors are delivered with the read that starts at the byte they
+   * were sent with.  A stream read stops short of the next such byte.
+   */
+
+  scm = (FAR struct local_scm_s *)sq_peek(&ring->lr_scm);
+  if (scm != NULL && scm->ls_offset != ring->lr_tail)
+    {
+      avail = MIN(avail, scm->ls_offset - ring->lr_tail);
+      scm   = NULL;
+    }
+  else if (scm != NULL)
+    {
+      FAR struct local_scm_s *next;
+
+      /* Nor may it run into the descriptors sent with a later write */
+
+      sq_remfirst(&ring->lr_scm);
+      next = (FAR struct local_scm_s *)sq_peek(&ring->lr_scm);
+      if (next != NULL && next->ls_offset != ring->lr_tail)
+        {
+          avail = MIN(avail, next->ls_offset - ring->lr_tail);
+        }
+    }
+#endif
+
+  if (psock->s_type == SOCK_SEQPACKET)
+    {
+      uint16_t pktlen;
+      size_t copied;
+
+      local_ring_copyout(ring, &pktlen, LOCAL_RING_HDRLEN);
+      copied = MIN(pktlen, len);
+      local_ring_readiov(ring, iov, iovcnt, copied);
+
+      /* Discard whatever did not fit in the caller's buffer */
+
+      if (copied < pktlen)
+        {
+          local_ring_copyout(ring, NULL, pktlen - copied);
+          msg->msg_flags |= MSG_TRUNC;
+        }
+
+      ret = (flags & MSG_TRUNC) != 0 ? pktlen : copied;
+    }
+  else
+    {
+      ret = MIN(avail, len);
+      local_ring_readiov(ring, iov, iovcnt, ret);
+    }
+
+  /* Space was released; let a blocked sender continue */
+
+  if (conn->lc_peer != NULL)
+    {
+      local_ring_notify(conn->lc_peer, POLLOUT);
+    }
+
+out:
+  net_unlock();
+
+#if CONFIG_NET_LOCAL_SCM_MAXFD > 0
+  if (scm != NULL)
+    {
+      local_scm_deliver(msg, scm);
+    }
+  else
+#endif
+    {
+      msg->msg_controllen = 0;
+    }
+
+  return ret;
+}
+
+#endif /* CONFIG_NET_LOCAL_RING */
@@ -284,6 +284,15 @@ ssize_t local_sendmsg(FAR struct socket *psock, FAR struct msghdr *msg,
   FAR const struct sockaddr *to = msg->msg_name;
   socklen_t tolen = msg->msg_namelen;
 
+#ifdef CONFIG_NET_LOCAL_RING
+  /* Connected peers send straight into the receive ring of the other */
+
+  if (LOCAL_ISCONNTYPE(psock->s_type))
+    {
+      return local_ring_sendmsg(psock, msg, flags);
+    }
+#endif
+
   return to ? local_sendto(psock, buf, len, flags, to, tolen) :
               local_send(psock, buf, len, flags);
 }
@@ -153,8 +153,8 @@ static int local_setup(FAR struct socket *psock, int protocol)
    * connection structure, it is unallocated at this point.  It will not
    * actually be initialized until the socket is connected.
    *
-   * REVIST:  Only SOCK_STREAM and SOCK_DGRAM are supported.  Should also
-   * support SOCK_RAW.
+   * REVIST:  Only SOCK_STREAM, SOCK_SEQPACKET (with the ring transport)
+   * and SOCK_DGRAM are supported.  Should also support SOCK_RAW.
    */
 
   switch (psock->s_type)
@@ -171,6 +171,18 @@ static int local_setup(FAR struct socket *psock, int protocol)
         return local_sockif_alloc(psock);
 #endif /* CONFIG_NET_LOCAL_STREAM */
 
+#ifdef CONFIG_NET_LOCAL_RING
+      case SOCK_SEQPACKET:
+        if (protocol != 0)
+          {
+            return -EPROTONOSUPPORT;
+          }
+
+        /* Allocate and attach the local connection structure */
+
+        return local_sockif_alloc(psock);
+#endif /* CONFIG_NET_LOCAL_RING */
+
 #ifdef CONFIG_NET_LOCAL_DGRAM
       case SOCK_DGRAM:
         if (protocol != 0 && protocol != IPPROTO_UDP)
@@ -279,6 +291,9 @@ static int local_bind(FAR struct socket *psock,
 #ifdef CONFIG_NET_LOCAL_STREAM
       case SOCK_STREAM:
 #endif
+#ifdef CONFIG_NET_LOCAL_RING
+      case SOCK_SEQPACKET:
+#endif
 #ifdef CONFIG_NET_LOCAL_DGRAM
       case SOCK_DGRAM:
 #endif
@@ -503,6 +518,9 @@ static int local_connect(FAR struct socket *psock,
   switch (psock->s_type)
     {
 #ifdef CONFIG_NET_LOCAL_STREAM
+#ifdef CONFIG_NET_LOCAL_RING
+      case SOCK_SEQPACKET:
+#endif
       case SOCK_STREAM:
         {
           /* Verify that the socket is not already connected */
@@ -655,6 +673,9 @@ static int local_close(FAR struct socket *psock)
 #ifdef CONFIG_NET_LOCAL_STREAM
       case SOCK_STREAM:
 #endif
+#ifdef CONFIG_NET_LOCAL_RING
+      case SOCK_SEQPACKET:
+#endif
 #ifdef CONFIG_NET_LOCAL_DGRAM
       case SOCK_DGRAM:
 #endif
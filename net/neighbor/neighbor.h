@@ -46,9 +46,12 @@
  ****************************************************************************/
 
 #include <stdint.h>
+#include <stdbool.h>
 
 #include <net/ethernet.h>
 
+#include <nuttx/mm/iob.h>
+
 #include <nuttx/net/ip.h>
 #include <nuttx/net/netdev.h>
 #include <nuttx/net/sixlowpan.h>
@@ -56,15 +59,44 @@
 
 #ifdef CONFIG_NET_IPv6
 
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* One entry of the Neighbor table.  Entries with the same hash value are
+ * linked together.
+ */
+
+struct neighbor_tabentry_s
+{
+  struct neighbor_entry_s ne_entry;          /* Must be first */
+  FAR struct neighbor_tabentry_s *ne_hnext;  /* Next entry in the hash
+                                              * chain */
+#ifdef CONFIG_NET_IPv6_NCONF_PENDING
+  FAR struct net_driver_s *ne_dev;           /* Device of the pending
+                                              * packets */
+  struct iob_queue_s ne_pending;             /* IPv6 packets waiting for
+                                              * the link layer address */
+  uint8_t ne_npending;                       /* Number of pending
+                                              * packets */
+  bool ne_unresolved;                        /* Waiting for a Neighbor
+                                              * Advertisement */
+#endif
+};
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
 
-/* This is the Neighbor table.  The network should be locked when accessing
- * this table.
+/* This is the Neighbor table and its hash index.  Both are allocated on
+ * first use, with CONFIG_NET_IPv6_NCONF_ENTRIES entries, or when the table
+ * is resized.  The network should be locked when accessing this table.
  */
 
-extern struct neighbor_entry_s g_neighbors[CONFIG_NET_IPv6_NCONF_ENTRIES];
+extern FAR struct neighbor_tabentry_s *g_neighbors;
+extern FAR struct neighbor_tabentry_s **g_neighbor_hash;
+extern unsigned int g_nneighbors;
+extern unsigned int g_neighbor_hashmask;
 
 /****************************************************************************
  * Public Function Prototypes
@@ -90,6 +122,45 @@ struct net_driver_s; /* Forward reference */
 
 FAR struct neighbor_entry_s *neighbor_findentry(const net_ipv6addr_t ipaddr);
 
+/****************************************************************************
+ * Name: neighbor_tabfind
+ *
+ * Description:
+ *   Find the table entry of an IPv6 address, whether its link layer address
+ *   is known or not.
+ *
+ * Input Parameters:
+ *   ipaddr - The IPv6 address to use in the lookup;
+ *
+ * Returned Value:
+ *   The Neighbor table entry of the IPv6 address;  NULL is returned if
+ *   there is no matching entry in the Neighbor Table.
+ *
+ ****************************************************************************/
+
+FAR struct neighbor_tabentry_s *
+neighbor_tabfind(FAR const net_ipv6addr_t ipaddr);
+
+/****************************************************************************
+ * Name: neighbor_taballoc
+ *
+ * Description:
+ *   Get an unused table entry, or else the oldest entry, for the IPv6
+ *   address and add it to its hash chain.  The table is allocated if this
+ *   is the first use.
+ *
+ * Input Parameters:
+ *   ipaddr - The IPv6 address of the new entry
+ *
+ * Returned Value:
+ *   The new Neighbor table entry;  NULL is returned if the table could not
+ *   be allocated.
+ *
+ ****************************************************************************/
+
+FAR struct neighbor_tabentry_s *
+neighbor_taballoc(FAR const net_ipv6addr_t ipaddr);
+
 /****************************************************************************
  * Name: neighbor_add
  *
@@ -206,6 +277,50 @@ unsigned int neighbor_snapshot(FAR struct neighbor_entry_s *snapshot,
                                unsigned int nentries);
 #endif
 
+/****************************************************************************
+ * Name: neighbor_pending_add
+ *
+ * Description:
+ *   Keep a copy of the IPv6 packet in d_buf, which is about to be replaced
+ *   by a Neighbor Solicitation for 'ipaddr'.  The packet is sent when the
+ *   Neighbor Advertisement arrives.
+ *
+ * Input Parameters:
+ *   dev    - The device that will send the packet
+ *   ipaddr - The IPv6 address whose link layer address is needed
+ *
+ * Assumptions
+ *   The network is locked to assure exclusive access to the Neighbor table.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_IPv6_NCONF_PENDING
+void neighbor_pending_add(FAR struct net_driver_s *dev,
+                          FAR const net_ipv6addr_t ipaddr);
+#else
+#  define neighbor_pending_add(d,i)
+#endif
+
+/****************************************************************************
+ * Name: neighbor_pending_poll
+ *
+ * Description:
+ *   Send the packets of the device whose link layer address has been
+ *   resolved, and discard those that have waited too long.
+ *
+ * Assumptions:
+ *   This function is called from the MAC device driver indirectly through
+ *   devif_poll() with the network locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_IPv6_NCONF_PENDING
+int neighbor_pending_poll(FAR struct net_driver_s *dev,
+                          devif_poll_callback_t callback);
+#else
+#  define neighbor_pending_poll(d,c) (0)
+#endif
+
 /****************************************************************************
  * Name: neighbor_dumpentry
  *
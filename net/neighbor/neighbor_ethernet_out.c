@@ -90,7 +90,8 @@
  *   the packet in the d_buf is replaced by an ICMPv6 Neighbor Solicit
  *   request packet for the IPv6 address. The IPv6 packet is dropped and
  *   it is assumed that the higher level protocols (e.g., TCP) eventually
- *   will retransmit the dropped packet.
+ *   will retransmit the dropped packet, unless CONFIG_NET_IPv6_NCONF_PENDING
+ *   is selected to queue it until the address is resolved.
  *
  *   Upon return in either the case, a packet to be sent is present in the
  *   d_buf buffer and the d_len field holds the length of the Ethernet
@@ -171,9 +172,11 @@ void neighbor_ethernet_out(FAR struct net_driver_s *dev)
 
           /* The destination address was not in our Neighbor Table, so we
            * overwrite the IPv6 packet with an ICMPv6 Neighbor Solicitation
-           * message.
+           * message.  With CONFIG_NET_IPv6_NCONF_PENDING, a copy of the
+           * packet is kept and sent when the address is resolved.
            */
 
+          neighbor_pending_add(dev, ipaddr);
           icmpv6_solicit(dev, ipaddr);
 #else
           /* What to do here? We need the laddr, but no way to get it. */
@@ -70,17 +70,21 @@
 
 FAR struct neighbor_entry_s *neighbor_findentry(const net_ipv6addr_t ipaddr)
 {
-  int i;
+  FAR struct neighbor_tabentry_s *tab;
 
-  for (i = 0; i < CONFIG_NET_IPv6_NCONF_ENTRIES; ++i)
-    {
-      FAR struct neighbor_entry_s *neighbor = &g_neighbors[i];
+  /* Entries that are still waiting for a Neighbor Advertisement have no
+   * link layer address yet.
+   */
 
-      if (net_ipv6addr_cmp(neighbor->ne_ipaddr, ipaddr))
-        {
-          neighbor_dumpentry("Entry found", neighbor);
-          return neighbor;
-        }
+  tab = neighbor_tabfind(ipaddr);
+#ifdef CONFIG_NET_IPv6_NCONF_PENDING
+  if (tab != NULL && !tab->ne_unresolved)
+#else
+  if (tab != NULL)
+#endif
+    {
+      neighbor_dumpentry("Entry found", &tab->ne_entry);
+      return &tab->ne_entry;
     }
 
   neighbor_dumpipaddr("Not found", ipaddr);
@@ -50,11 +50,15 @@
  * Public Data
  ****************************************************************************/
 
-/* This is the Neighbor table.  The network should be locked when accessing
- * this table.
+/* This is the Neighbor table and its hash index.  Both are allocated on
+ * first use, with CONFIG_NET_IPv6_NCONF_ENTRIES entries, or when the table
+ * is resized.  The network should be locked when accessing this table.
  */
 
-struct neighbor_entry_s g_neighbors[CONFIG_NET_IPv6_NCONF_ENTRIES];
+FAR struct neighbor_tabentry_s *g_neighbors;
+FAR struct neighbor_tabentry_s **g_neighbor_hash;
+unsigned int g_nneighbors;
+unsigned int g_neighbor_hashmask;
 
 /****************************************************************************
  * Public Functions
@@ -62,21 +62,27 @@ unsigned int neighbor_snapshot(FAR struct neighbor_entry_s *snapshot,
                                unsigned int nentries)
 {
   unsigned int ncopied;
-  int i;
+  unsigned int i;
 
   /* Copy all non-empty entries in the Neighbor table. */
 
-  for (i = 0, ncopied = 0;
-       nentries > ncopied && i < CONFIG_NET_IPv6_NCONF_ENTRIES;
-       i++)
+  for (i = 0, ncopied = 0; nentries > ncopied && i < g_nneighbors; i++)
     {
-      FAR struct neighbor_entry_s *neighbor = &g_neighbors[i];
+      FAR struct neighbor_entry_s *neighbor = &g_neighbors[i].ne_entry;
 
       /* An unused entry table entry will be nullified.  In particularly,
        * the Neighbor IP address will be all zero (i.e., the unspecified
-       * IPv6 address).
+       * IPv6 address).  Entries still waiting for address resolution are
+       * not reported either.
        */
 
+#ifdef CONFIG_NET_IPv6_NCONF_PENDING
+      if (g_neighbors[i].ne_unresolved)
+        {
+          continue;
+        }
+#endif
+
       if (!net_ipv6addr_cmp(neighbor->ne_ipaddr, g_ipv6_unspecaddr))
         {
           memcpy(&snapshot[ncopied], neighbor,
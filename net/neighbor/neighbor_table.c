@@ -0,0 +1,467 @@
+/****************************************************************************
+ * net/neighbor/neighbor_table.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/clock.h>
+#include <nuttx/kmalloc.h>
+#include <nuttx/mm/iob.h>
+#include <nuttx/net/net.h>
+#include <nuttx/net/ip.h>
+#include <nuttx/net/netdev.h>
+#include <nuttx/net/neighbor.h>
+
+#include "inet/inet.h"
+#include "neighbor/neighbor.h"
+
+#ifdef CONFIG_NET_IPv6
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_IPv6_NCONF_PENDING
+#  define NEIGHBOR_PENDING_TICK \
+     MSEC2TICK(CONFIG_NET_IPv6_NCONF_PENDING_TIMEOUT)
+#endif
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_IPv6_NCONF_PENDING
+/* The total number of packets waiting for address resolution */
+
+static unsigned int g_neighbor_npending;
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: neighbor_hash
+ *
+ * Description:
+ *   Return the hash chain for an IPv6 address.
+ *
+ ****************************************************************************/
+
+static unsigned int neighbor_hash(FAR const net_ipv6addr_t ipaddr)
+{
+  uint32_t hash = 0;
+  int i;
+
+  for (i = 0; i < 8; i++)
+    {
+      hash = (hash ^ ipaddr[i]) * 16777619u;
+    }
+
+  return (hash ^ (hash >> 16)) & g_neighbor_hashmask;
+}
+
+/****************************************************************************
+ * Name: neighbor_tabfree
+ *
+ * Description:
+ *   Remove an entry from its hash chain and discard its pending packets.
+ *
+ ****************************************************************************/
+
+static void neighbor_tabfree(FAR struct neighbor_tabentry_s *tab)
+{
+  FAR struct neighbor_tabentry_s **pnext;
+
+  if (net_ipv6addr_cmp(tab->ne_entry.ne_ipaddr, g_ipv6_unspecaddr))
+    {
+      return;
+    }
+
+  pnext = &g_neighbor_hash[neighbor_hash(tab->ne_entry.ne_ipaddr)];
+  while (*pnext != tab)
+    {
+      pnext = &(*pnext)->ne_hnext;
+    }
+
+  *pnext = tab->ne_hnext;
+
+#ifdef CONFIG_NET_IPv6_NCONF_PENDING
+  iob_free_queue(&tab->ne_pending, IOBUSER_NET_NEIGHBOR_PENDING);
+  g_neighbor_npending -= tab->ne_npending;
+#endif
+
+  memset(tab, 0, sizeof(struct neighbor_tabentry_s));
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: neighbor_tabfind
+ *
+ * Description:
+ *   Find the table entry of an IPv6 address, whether its link layer address
+ *   is known or not.
+ *
+ * Input Parameters:
+ *   ipaddr - The IPv6 address to use in the lookup;
+ *
+ * Returned Value:
+ *   The Neighbor table entry of the IPv6 address;  NULL is returned if
+ *   there is no matching entry in the Neighbor Table.
+ *
+ ****************************************************************************/
+
+FAR struct neighbor_tabentry_s *
+neighbor_tabfind(FAR const net_ipv6addr_t ipaddr)
+{
+  FAR struct neighbor_tabentry_s *tab;
+
+  if (g_neighbors == NULL ||
+      net_ipv6addr_cmp(ipaddr, g_ipv6_unspecaddr))
+    {
+      return NULL;
+    }
+
+  for (tab = g_neighbor_hash[neighbor_hash(ipaddr)];
+       tab != NULL;
+       tab = tab->ne_hnext)
+    {
+      if (net_ipv6addr_cmp(ipaddr, tab->ne_entry.ne_ipaddr))
+        {
+          return tab;
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: neighbor_taballoc
+ *
+ * Description:
+ *   Get an unused table entry, or else the oldest entry, for the IPv6
+ *   address and add it to its hash chain.  The table is allocated if this
+ *   is the first use.
+ *
+ * Input Parameters:
+ *   ipaddr - The IPv6 address of the new entry
+ *
+ * Returned Value:
+ *   The new Neighbor table entry;  NULL is returned if the table could not
+ *   be allocated.
+ *
+ ****************************************************************************/
+
+FAR struct neighbor_tabentry_s *
+neighbor_taballoc(FAR const net_ipv6addr_t ipaddr)
+{
+  FAR struct neighbor_tabentry_s *oldest = NULL;
+  FAR struct neighbor_tabentry_s *tab;
+  unsigned int hash;
+  unsigned int i;
+
+  if (g_neighbors == NULL &&
+      neighbor_table_resize(CONFIG_NET_IPv6_NCONF_ENTRIES) < 0)
+    {
+      return NULL;
+    }
+
+  for (i = 0; i < g_nneighbors; i++)
+    {
+      tab = &g_neighbors[i];
+      if (net_ipv6addr_cmp(tab->ne_entry.ne_ipaddr, g_ipv6_unspecaddr))
+        {
+          oldest = tab;
+          break;
+        }
+
+      if (oldest == NULL ||
+          (int)(tab->ne_entry.ne_time - oldest->ne_entry.ne_time) < 0)
+        {
+          oldest = tab;
+        }
+    }
+
+  neighbor_tabfree(oldest);
+
+  hash = neighbor_hash(ipaddr);
+  net_ipv6addr_copy(oldest->ne_entry.ne_ipaddr, ipaddr);
+  oldest->ne_hnext      = g_neighbor_hash[hash];
+  g_neighbor_hash[hash] = oldest;
+  return oldest;
+}
+
+/****************************************************************************
+ * Name: neighbor_table_resize
+ *
+ * Description:
+ *   Replace the Neighbor table with an empty table of the given size.  All
+ *   existing entries, and any packets waiting for address resolution, are
+ *   discarded.
+ *
+ * Input Parameters:
+ *   nentries - The new number of Neighbor table entries
+ *
+ * Returned Value:
+ *   Zero (OK) on success; a negated errno value on failure, in which case
+ *   the old table is kept.
+ *
+ ****************************************************************************/
+
+int neighbor_table_resize(unsigned int nentries)
+{
+  FAR struct neighbor_tabentry_s *table;
+  unsigned int nbuckets;
+  unsigned int i;
+
+  if (nentries == 0 || nentries > UINT16_MAX)
+    {
+      return -EINVAL;
+    }
+
+  /* Use a power of two number of hash chains, at least one per entry */
+
+  nbuckets = 1;
+  while (nbuckets < nentries)
+    {
+      nbuckets <<= 1;
+    }
+
+  table = kmm_zalloc(nentries * sizeof(struct neighbor_tabentry_s) +
+                     nbuckets * sizeof(FAR struct neighbor_tabentry_s *));
+  if (table == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  net_lock();
+
+  if (g_neighbors != NULL)
+    {
+      for (i = 0; i < g_nneighbors; i++)
+        {
+          neighbor_tabfree(&g_neighbors[i]);
+        }
+
+      kmm_free(g_neighbors);
+    }
+
+  g_neighbors         = table;
+  g_neighbor_hash     = (FAR struct neighbor_tabentry_s **)&table[nentries];
+  g_nneighbors        = nentries;
+  g_neighbor_hashmask = nbuckets - 1;
+
+  net_unlock();
+  return OK;
+}
+
+/****************************************************************************
+ * Name: neighbor_pending_add
+ *
+ * Description:
+ *   Keep a copy of the IPv6 packet in d_buf, which is about to be replaced
+ *   by a Neighbor Solicitation for 'ipaddr'.  The packet is sent when the
+ *   Neighbor Advertisement arrives.
+ *
+ * Input Parameters:
+ *   dev    - The device that will send the packet
+ *   ipaddr - The IPv6 address whose link layer address is needed
+ *
+ * Assumptions
+ *   The network is locked to assure exclusive access to the Neighbor table.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_IPv6_NCONF_PENDING
+void neighbor_pending_add(FAR struct net_driver_s *dev,
+                          FAR const net_ipv6addr_t ipaddr)
+{
+  FAR struct neighbor_tabentry_s *tab;
+  FAR struct iob_s *iob;
+  int ret;
+
+  tab = neighbor_tabfind(ipaddr);
+  if (tab == NULL)
+    {
+      tab = neighbor_taballoc(ipaddr);
+      if (tab == NULL)
+        {
+          return;
+        }
+    }
+
+  /* The packets of an entry are all sent through the same device.  Drop
+   * the packets queued for another one.
+   */
+
+  if (tab->ne_npending > 0 && tab->ne_dev != dev)
+    {
+      iob_free_queue(&tab->ne_pending, IOBUSER_NET_NEIGHBOR_PENDING);
+      g_neighbor_npending -= tab->ne_npending;
+      tab->ne_npending     = 0;
+    }
+
+  /* The timeout starts with the first solicitation.  The wait starts
+   * again with the first packet queued after earlier ones have timed out.
+   */
+
+  if (!tab->ne_unresolved || tab->ne_npending == 0)
+    {
+      tab->ne_unresolved    = true;
+      tab->ne_entry.ne_time = clock_systime_ticks();
+    }
+
+  /* Make room for the new packet by dropping the oldest one */
+
+  if (tab->ne_npending >= CONFIG_NET_IPv6_NCONF_MAXPENDING)
+    {
+      iob = iob_remove_queue(&tab->ne_pending);
+      if (iob != NULL)
+        {
+          iob_free_chain(iob, IOBUSER_NET_NEIGHBOR_PENDING);
+          tab->ne_npending--;
+          g_neighbor_npending--;
+        }
+    }
+
+  /* Copy the IPv6 packet without waiting for I/O buffers */
+
+  iob = iob_tryalloc(true, IOBUSER_NET_NEIGHBOR_PENDING);
+  if (iob == NULL)
+    {
+      return;
+    }
+
+  ret = iob_trycopyin(iob, &dev->d_buf[NET_LL_HDRLEN(dev)], dev->d_len, 0,
+                      true, IOBUSER_NET_NEIGHBOR_PENDING);
+  if (ret >= 0)
+    {
+      ret = iob_tryadd_queue(iob, &tab->ne_pending);
+    }
+
+  if (ret < 0)
+    {
+      iob_free_chain(iob, IOBUSER_NET_NEIGHBOR_PENDING);
+      return;
+    }
+
+  tab->ne_dev = dev;
+  tab->ne_npending++;
+  g_neighbor_npending++;
+}
+
+/****************************************************************************
+ * Name: neighbor_pending_poll
+ *
+ * Description:
+ *   Send the packets of the device whose link layer address has been
+ *   resolved, and discard those that have waited too long.
+ *
+ * Assumptions:
+ *   This function is called from the MAC device driver indirectly through
+ *   devif_poll() with the network locked.
+ *
+ ****************************************************************************/
+
+int neighbor_pending_poll(FAR struct net_driver_s *dev,
+                          devif_poll_callback_t callback)
+{
+  FAR struct neighbor_tabentry_s *tab;
+  FAR struct iob_s *iob;
+  clock_t now;
+  unsigned int i;
+  int bstop = 0;
+
+  if (g_neighbor_npending == 0)
+    {
+      return 0;
+    }
+
+  now = clock_systime_ticks();
+  for (i = 0; i < g_nneighbors && bstop == 0; i++)
+    {
+      tab = &g_neighbors[i];
+      if (tab->ne_npending == 0 || tab->ne_dev != dev)
+        {
+          continue;
+        }
+
+      if (tab->ne_unresolved)
+        {
+          /* Still waiting.  Drop the packets if the address could not be
+           * resolved in time.
+           */
+
+          if (now - tab->ne_entry.ne_time > NEIGHBOR_PENDING_TICK)
+            {
+              iob_free_queue(&tab->ne_pending,
+                             IOBUSER_NET_NEIGHBOR_PENDING);
+              g_neighbor_npending -= tab->ne_npending;
+              tab->ne_npending     = 0;
+            }
+
+          continue;
+        }
+
+      /* Resolved.  Send the packets one at a time through the driver,
+       * which adds the link layer header with neighbor_out().
+       */
+
+      while (tab->ne_npending > 0 && bstop == 0)
+        {
+          iob = iob_remove_queue(&tab->ne_pending);
+          tab->ne_npending--;
+          g_neighbor_npending--;
+
+          if (iob == NULL)
+            {
+              continue;
+            }
+
+          if (iob->io_pktlen <= dev->d_pktsize - NET_LL_HDRLEN(dev))
+            {
+              iob_copyout(&dev->d_buf[NET_LL_HDRLEN(dev)], iob,
+                          iob->io_pktlen, 0);
+              dev->d_len = iob->io_pktlen;
+              IFF_SET_IPv6(dev->d_flags);
+
+              bstop = callback(dev);
+            }
+
+          iob_free_chain(iob, IOBUSER_NET_NEIGHBOR_PENDING);
+        }
+    }
+
+  return bstop;
+}
+#endif /* CONFIG_NET_IPv6_NCONF_PENDING */
+
+#endif /* CONFIG_NET_IPv6 */
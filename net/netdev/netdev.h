@@ -558,6 +558,39 @@ int netdown_notifier_teardown(int key);
 void netdown_notifier_signal(FAR struct net_driver_s *dev);
 #endif
 
+/****************************************************************************
+ * Name: netdev_iob_claim
+ *
+ * Description:
+ *   Take over the I/O buffer that holds the packet being received, if the
+ *   driver provided one in dev->d_iob.  The buffer is trimmed so that its
+ *   data is the 'buflen' bytes at 'buffer', preceded by 'headroom' bytes
+ *   that the caller may fill in.  The headroom is taken from the packet
+ *   headers, which must no longer be needed.
+ *
+ * Input Parameters:
+ *   dev       - The device that received the packet
+ *   buffer    - The start of the data to keep, within dev->d_buf
+ *   buflen    - The length of the data to keep
+ *   headroom  - The number of bytes needed in front of the data
+ *   throttled - True if the buffer is for throttled read-ahead data
+ *
+ * Returned Value:
+ *   The I/O buffer, now owned by the caller, or NULL if the driver did not
+ *   provide a suitable buffer.  The caller must then copy the data.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NETDEV_IOB_RECV
+FAR struct iob_s *netdev_iob_claim(FAR struct net_driver_s *dev,
+                                   FAR const uint8_t *buffer,
+                                   unsigned int buflen,
+                                   unsigned int headroom, bool throttled);
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
@@ -0,0 +1,122 @@
+/****************************************************************************
+ * net/netdev/netdev_iob.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <debug.h>
+
+#include <nuttx/mm/iob.h>
+#include <nuttx/net/netdev.h>
+
+#include "netdev/netdev.h"
+
+#ifdef CONFIG_NETDEV_IOB_RECV
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: netdev_iob_claim
+ *
+ * Description:
+ *   Take over the I/O buffer that holds the packet being received, if the
+ *   driver provided one in dev->d_iob.  The buffer is trimmed so that its
+ *   data is the 'buflen' bytes at 'buffer', preceded by 'headroom' bytes
+ *   that the caller may fill in.  The headroom is taken from the packet
+ *   headers, which must no longer be needed.
+ *
+ * Input Parameters:
+ *   dev       - The device that received the packet
+ *   buffer    - The start of the data to keep, within dev->d_buf
+ *   buflen    - The length of the data to keep
+ *   headroom  - The number of bytes needed in front of the data
+ *   throttled - True if the buffer is for throttled read-ahead data
+ *
+ * Returned Value:
+ *   The I/O buffer, now owned by the caller, or NULL if the driver did not
+ *   provide a suitable buffer.  The caller must then copy the data.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+FAR struct iob_s *netdev_iob_claim(FAR struct net_driver_s *dev,
+                                   FAR const uint8_t *buffer,
+                                   unsigned int buflen,
+                                   unsigned int headroom, bool throttled)
+{
+  FAR struct iob_s *iob = dev->d_iob;
+  uintptr_t start;
+  uintptr_t data;
+
+  /* Only a packet held in one I/O buffer can be taken over */
+
+  if (iob == NULL || iob->io_flink != NULL)
+    {
+      return NULL;
+    }
+
+  /* The data to keep, and the headroom in front of it, must be within the
+   * payload of the buffer.
+   */
+
+  start = (uintptr_t)iob->io_data;
+  data  = (uintptr_t)buffer;
+
+  if (data < start + headroom ||
+      data + buflen > start + IOB_BUFSIZE(iob))
+    {
+      return NULL;
+    }
+
+#if CONFIG_IOB_THROTTLE > 0
+  /* Throttled read-ahead data may not hold on to the buffers that are
+   * reserved for unthrottled users.
+   */
+
+  if (throttled && iob_navail(true) <= 0)
+    {
+      return NULL;
+    }
+#else
+  UNUSED(throttled);
+#endif
+
+  /* Take the buffer from the driver and trim it to the data */
+
+  dev->d_iob     = NULL;
+  iob->io_offset = data - start - headroom;
+  iob->io_len    = headroom + buflen;
+  iob->io_pktlen = headroom + buflen;
+
+  ninfo("Claimed iob=%p offset=%u len=%u\n",
+        iob, iob->io_offset, iob->io_len);
+  return iob;
+}
+
+#endif /* CONFIG_NETDEV_IOB_RECV */
@@ -1286,11 +1286,9 @@ static int netdev_arp_ioctl(FAR struct socket *psock, int cmd,
                 arp_lookup(addr->sin_addr.s_addr);
               if (entry != NULL)
                 {
-                  /* The ARP table is fixed size; an entry is deleted
-                   * by nullifying its protocol address.
-                   */
+                  /* Remove the entry from the ARP table */
 
-                  entry->at_ipaddr = 0;
+                  arp_delete(addr->sin_addr.s_addr);
                   ret = OK;
                 }
               else
@@ -345,18 +345,24 @@ static int netlink_get_arptable(NETLINK_HANDLE handle,
                               FAR const struct nlroute_sendto_request_s *req)
 {
   FAR struct getneigh_recvfrom_rsplist_s *entry;
+  unsigned int nentries;
   unsigned int ncopied;
   size_t allocsize;
   size_t tabsize;
   size_t rspsize;
 
-  /* Preallocate memory to hold the maximum sized ARP table
+  /* Preallocate memory to hold the maximum sized ARP table.  The table may
+   * have been resized, so use its current size.
    * REVISIT:  This is probably excessively large and could cause false
    * memory out conditions.  A better approach would be to actually count
    * the number of valid entries in the ARP table.
    */
 
-  tabsize   = CONFIG_NET_ARPTAB_SIZE * sizeof(struct arp_entry_s);
+  net_lock();
+  nentries  = g_arpsize;
+  net_unlock();
+
+  tabsize   = nentries * sizeof(struct arp_entry_s);
   rspsize   = SIZEOF_NLROUTE_RECVFROM_RESPONSE_S(tabsize);
   allocsize = SIZEOF_NLROUTE_RECVFROM_RSPLIST_S(tabsize);
 
@@ -380,14 +386,14 @@ static int netlink_get_arptable(NETLINK_HANDLE handle,
 
   net_lock();
   ncopied = arp_snapshot((FAR struct arp_entry_s *)entry->payload.data,
-                         CONFIG_NET_ARPTAB_SIZE);
+                         nentries);
   net_unlock();
 
   /* Now we have the real number of valid entries in the ARP table and
    * we can trim the allocation.
    */
 
-  if (ncopied < CONFIG_NET_ARPTAB_SIZE)
+  if (ncopied < nentries)
     {
       FAR struct getneigh_recvfrom_rsplist_s *newentry;
 
@@ -427,19 +433,24 @@ static int netlink_get_nbtable(NETLINK_HANDLE handle,
                               FAR const struct nlroute_sendto_request_s *req)
 {
   FAR struct getneigh_recvfrom_rsplist_s *entry;
+  unsigned int nentries;
   unsigned int ncopied;
   size_t allocsize;
   size_t tabsize;
   size_t rspsize;
 
-  /* Preallocate memory to hold the maximum sized Neighbor table
+  /* Preallocate memory to hold the maximum sized Neighbor table.  The
+   * table may have been resized, so use its current size.
    * REVISIT:  This is probably excessively large and could cause false
    * memory out conditions.  A better approach would be to actually count
    * the number of valid entries in the Neighbor table.
    */
 
-  tabsize   = CONFIG_NET_IPv6_NCONF_ENTRIES *
-              sizeof(struct neighbor_entry_s);
+  net_lock();
+  nentries  = g_nneighbors;
+  net_unlock();
+
+  tabsize   = nentries * sizeof(struct neighbor_entry_s);
   rspsize   = SIZEOF_NLROUTE_RECVFROM_RESPONSE_S(tabsize);
   allocsize = SIZEOF_NLROUTE_RECVFROM_RSPLIST_S(tabsize);
 
@@ -463,15 +474,14 @@ static int netlink_get_nbtable(NETLINK_HANDLE handle,
 
   net_lock();
   ncopied = neighbor_snapshot(
-    (FAR struct neighbor_entry_s *)entry->payload.data,
-    CONFIG_NET_IPv6_NCONF_ENTRIES);
+    (FAR struct neighbor_entry_s *)entry->payload.data, nentries);
   net_unlock();
 
   /* Now we have the real number of valid entries in the Neighbor table
    * and we can trim the allocation.
    */
 
-  if (ncopied < CONFIG_NET_IPv6_NCONF_ENTRIES)
+  if (ncopied < nentries)
     {
       FAR struct getneigh_recvfrom_rsplist_s *newentry;
 
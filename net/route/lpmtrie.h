@@ -0,0 +1,94 @@
+/****************************************************************************
+ * net/route/lpmtrie.h
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __NET_ROUTE_LPMTRIE_H
+#define __NET_ROUTE_LPMTRIE_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include "route/route.h"
+
+#ifdef CONFIG_ROUTE_LPMTRIE
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: net_lpmroute_ipv4 and net_lpmroute_ipv6
+ *
+ * Description:
+ *   Find the route with the longest prefix matching the target address in
+ *   the in-memory lookup trie.  The trie is built from the routing table on
+ *   first use after it was flushed.
+ *
+ * Input Parameters:
+ *   target - An IP address on a remote network to use in the lookup.
+ *   dev    - If not NULL, only routes whose router lies on the network of
+ *            this device are considered.
+ *   router - The location to return the router address.
+ *
+ * Returned Value:
+ *   OK if a route was found; -ENOENT if there is no matching route.
+ *   -ENOSYS is returned if the trie could not be built (for example, if
+ *   memory is exhausted or a route uses a non-contiguous netmask).  The
+ *   caller must then search the routing table itself.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_IPv4
+int net_lpmroute_ipv4(in_addr_t target, FAR struct net_driver_s *dev,
+                      FAR in_addr_t *router);
+#endif
+
+#ifdef CONFIG_NET_IPv6
+int net_lpmroute_ipv6(FAR const net_ipv6addr_t target,
+                      FAR struct net_driver_s *dev, net_ipv6addr_t router);
+#endif
+
+/****************************************************************************
+ * Name: net_flushlpm_ipv4 and net_flushlpm_ipv6
+ *
+ * Description:
+ *   Discard the lookup trie.  This must be called whenever the routing
+ *   table is modified.  The trie is rebuilt on the next lookup.
+ *
+ * Input Parameters:
+ *   None
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_IPv4
+void net_flushlpm_ipv4(void);
+#endif
+
+#ifdef CONFIG_NET_IPv6
+void net_flushlpm_ipv6(void);
+#endif
+
+#endif /* CONFIG_ROUTE_LPMTRIE */
+#endif /* __NET_ROUTE_LPMTRIE_H */
@@ -34,6 +34,7 @@
 #include <nuttx/net/ip.h>
 
 #include "route/fileroute.h"
+#include "route/lpmtrie.h"
 #include "route/route.h"
 
 #if defined(CONFIG_ROUTE_IPv4_FILEROUTE) || defined(CONFIG_ROUTE_IPv6_FILEROUTE)
@@ -84,6 +85,13 @@ int net_addroute_ipv4(in_addr_t target, in_addr_t netmask, in_addr_t router)
   nwritten = net_writeroute_ipv4(&fshandle, &route);
 
   net_closeroute_ipv4(&fshandle);
+
+#ifdef CONFIG_ROUTE_LPMTRIE
+  /* The lookup trie must be rebuilt to include the new entry */
+
+  net_flushlpm_ipv4();
+#endif
+
   return nwritten >= 0 ? 0 : (int)nwritten;
 }
 #endif
@@ -118,6 +126,13 @@ int net_addroute_ipv6(net_ipv6addr_t target, net_ipv6addr_t netmask,
   nwritten = net_writeroute_ipv6(&fshandle, &route);
 
   net_closeroute_ipv6(&fshandle);
+
+#ifdef CONFIG_ROUTE_LPMTRIE
+  /* The lookup trie must be rebuilt to include the new entry */
+
+  net_flushlpm_ipv6();
+#endif
+
   return nwritten >= 0 ? 0 : (int)nwritten;
 }
 #endif
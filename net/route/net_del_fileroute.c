@@ -38,6 +38,7 @@
 
 #include "route/fileroute.h"
 #include "route/cacheroute.h"
+#include "route/lpmtrie.h"
 #include "route/route.h"
 
 #if defined(CONFIG_ROUTE_IPv4_FILEROUTE) || defined(CONFIG_ROUTE_IPv6_FILEROUTE)
@@ -318,6 +319,15 @@ errout_with_fshandle:
 
 errout_with_lock:
   net_unlockroute_ipv4();
+
+#ifdef CONFIG_ROUTE_LPMTRIE
+  /* The lookup trie must be rebuilt.  This is done after releasing the
+   * routing table, because the trie is built with the network locked.
+   */
+
+  net_flushlpm_ipv4();
+#endif
+
   return ret;
 }
 #endif
@@ -469,6 +479,15 @@ errout_with_fshandle:
 
 errout_with_lock:
   net_unlockroute_ipv6();
+
+#ifdef CONFIG_ROUTE_LPMTRIE
+  /* The lookup trie must be rebuilt.  This is done after releasing the
+   * routing table, because the trie is built with the network locked.
+   */
+
+  net_flushlpm_ipv6();
+#endif
+
   return ret;
 }
 #endif
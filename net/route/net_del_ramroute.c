@@ -32,6 +32,7 @@
 #include <arpa/inet.h>
 #include <nuttx/net/ip.h>
 
+#include "route/lpmtrie.h"
 #include "route/ramroute.h"
 #include "route/route.h"
 
@@ -202,6 +203,7 @@ static int net_match_ipv6(
 int net_delroute_ipv4(in_addr_t target, in_addr_t netmask)
 {
   struct route_match_ipv4_s match;
+  int ret;
 
   /* Set up the comparison structure */
 
@@ -211,7 +213,18 @@ int net_delroute_ipv4(in_addr_t target, in_addr_t netmask)
 
   /* Then remove the entry from the routing table */
 
-  return net_foreachroute_ipv4(net_match_ipv4, &match) ? OK : -ENOENT;
+  ret = net_foreachroute_ipv4(net_match_ipv4, &match) ? OK : -ENOENT;
+
+#ifdef CONFIG_ROUTE_LPMTRIE
+  /* The lookup trie must be rebuilt without the removed entry */
+
+  if (ret == OK)
+    {
+      net_flushlpm_ipv4();
+    }
+#endif
+
+  return ret;
 }
 #endif
 
@@ -219,6 +232,7 @@ int net_delroute_ipv4(in_addr_t target, in_addr_t netmask)
 int net_delroute_ipv6(net_ipv6addr_t target, net_ipv6addr_t netmask)
 {
   struct route_match_ipv6_s match;
+  int ret;
 
   /* Set up the comparison structure */
 
@@ -228,7 +242,18 @@ int net_delroute_ipv6(net_ipv6addr_t target, net_ipv6addr_t netmask)
 
   /* Then remove the entry from the routing table */
 
-  return net_foreachroute_ipv6(net_match_ipv6, &match) ? OK : -ENOENT;
+  ret = net_foreachroute_ipv6(net_match_ipv6, &match) ? OK : -ENOENT;
+
+#ifdef CONFIG_ROUTE_LPMTRIE
+  /* The lookup trie must be rebuilt without the removed entry */
+
+  if (ret == OK)
+    {
+      net_flushlpm_ipv6();
+    }
+#endif
+
+  return ret;
 }
 #endif
 
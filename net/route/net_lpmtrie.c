@@ -0,0 +1,649 @@
+/****************************************************************************
+ * net/route/net_lpmtrie.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/kmalloc.h>
+#include <nuttx/net/net.h>
+#include <nuttx/net/netdev.h>
+#include <nuttx/net/ip.h>
+
+#include "route/lpmtrie.h"
+#include "route/route.h"
+
+#if defined(CONFIG_NET) && defined(CONFIG_ROUTE_LPMTRIE)
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Trie states */
+
+#define LPM_STALE    0  /* The trie must be (re-)built before use */
+#define LPM_VALID    1  /* The trie reflects the routing table */
+#define LPM_FAILED   2  /* The trie could not be built */
+
+/* Return bit 'n' of a key, counting from the most significant bit */
+
+#define LPM_BIT(k,n) (((k)[(n) >> 3] >> (7 - ((n) & 7))) & 1)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* One route held by the trie.  This is a copy of the routing table entry */
+
+struct lpm_route_s
+{
+  FAR struct lpm_route_s *flink;  /* Next route with the same prefix */
+  union
+  {
+#ifdef CONFIG_NET_IPv4
+    struct net_route_ipv4_s ipv4;
+#endif
+#ifdef CONFIG_NET_IPv6
+    struct net_route_ipv6_s ipv6;
+#endif
+  } u;
+};
+
+/* One node of the path-compressed binary trie.  A node exists for every
+ * prefix in the routing table and for every bit position at which the
+ * prefixes below it diverge.  The child is selected by the first address
+ * bit after the node prefix.  The key is allocated with the address size.
+ */
+
+struct lpm_node_s
+{
+  FAR struct lpm_node_s *child[2]; /* Sub-tries */
+  FAR struct lpm_route_s *routes;  /* Routes for exactly this prefix */
+  uint8_t plen;                    /* Prefix length in bits */
+  uint8_t key[1];                  /* Prefix, masked to plen bits */
+};
+
+struct lpm_trie_s
+{
+  FAR struct lpm_node_s *root;     /* Root of the trie */
+  uint8_t addrlen;                 /* Size of an address in bytes */
+  uint8_t state;                   /* See LPM_* definitions */
+};
+
+/* Type of the function used to restrict the routes that may be selected */
+
+typedef bool (*lpm_filter_t)(FAR const struct lpm_route_s *route,
+                             FAR struct net_driver_s *dev);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_IPv4
+static struct lpm_trie_s g_ipv4_trie =
+{
+  NULL, sizeof(in_addr_t), LPM_STALE
+};
+#endif
+
+#ifdef CONFIG_NET_IPv6
+static struct lpm_trie_s g_ipv6_trie =
+{
+  NULL, sizeof(net_ipv6addr_t), LPM_STALE
+};
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: lpm_common
+ *
+ * Description:
+ *   Return the number of leading bits, up to 'maxbits', that are the same
+ *   in the two keys.
+ *
+ ****************************************************************************/
+
+static unsigned int lpm_common(FAR const uint8_t *key1,
+                               FAR const uint8_t *key2,
+                               unsigned int maxbits)
+{
+  unsigned int nbits = 0;
+  uint8_t diff;
+
+  while (nbits < maxbits)
+    {
+      diff = key1[nbits >> 3] ^ key2[nbits >> 3];
+      if (diff != 0)
+        {
+          while ((diff & 0x80) == 0)
+            {
+              diff <<= 1;
+              nbits++;
+            }
+
+          break;
+        }
+
+      nbits += 8;
+    }
+
+  return nbits < maxbits ? nbits : maxbits;
+}
+
+/****************************************************************************
+ * Name: lpm_prefixlen
+ *
+ * Description:
+ *   Convert a netmask to a prefix length.  A negated errno value is
+ *   returned if the netmask is not contiguous.
+ *
+ ****************************************************************************/
+
+static int lpm_prefixlen(FAR const uint8_t *netmask, unsigned int addrlen)
+{
+  unsigned int nbits = 0;
+  unsigned int i;
+
+  while (nbits < 8 * addrlen && LPM_BIT(netmask, nbits) != 0)
+    {
+      nbits++;
+    }
+
+  for (i = nbits; i < 8 * addrlen; i++)
+    {
+      if (LPM_BIT(netmask, i) != 0)
+        {
+          return -EINVAL;
+        }
+    }
+
+  return nbits;
+}
+
+/****************************************************************************
+ * Name: lpm_newnode
+ *
+ * Description:
+ *   Allocate a trie node for the first 'plen' bits of the key.
+ *
+ ****************************************************************************/
+
+static FAR struct lpm_node_s *lpm_newnode(FAR struct lpm_trie_s *trie,
+                                          FAR const uint8_t *key,
+                                          unsigned int plen)
+{
+  FAR struct lpm_node_s *node;
+  unsigned int i;
+
+  node = kmm_malloc(offsetof(struct lpm_node_s, key) + trie->addrlen);
+  if (node != NULL)
+    {
+      node->child[0] = NULL;
+      node->child[1] = NULL;
+      node->routes   = NULL;
+      node->plen     = plen;
+
+      for (i = 0; i < trie->addrlen; i++)
+        {
+          if (8 * (i + 1) <= plen)
+            {
+              node->key[i] = key[i];
+            }
+          else if (8 * i < plen)
+            {
+              node->key[i] = key[i] & (0xff << (8 - (plen & 7)));
+            }
+          else
+            {
+              node->key[i] = 0;
+            }
+        }
+    }
+
+  return node;
+}
+
+/****************************************************************************
+ * Name: lpm_freenode
+ *
+ * Description:
+ *   Free a trie node together with its routes and sub-tries.
+ *
+ ****************************************************************************/
+
+static void lpm_freenode(FAR struct lpm_node_s *node)
+{
+  FAR struct lpm_route_s *route;
+
+  if (node != NULL)
+    {
+      lpm_freenode(node->child[0]);
+      lpm_freenode(node->child[1]);
+
+      while ((route = node->routes) != NULL)
+        {
+          node->routes = route->flink;
+          kmm_free(route);
+        }
+
+      kmm_free(node);
+    }
+}
+
+/****************************************************************************
+ * Name: lpm_insert
+ *
+ * Description:
+ *   Add a copy of a routing table entry to the trie.
+ *
+ * Input Parameters:
+ *   trie      - The trie to add the route to
+ *   key       - The target address of the route
+ *   plen      - The prefix length of the route
+ *   route     - The routing table entry
+ *   routesize - The size of the routing table entry
+ *
+ * Returned Value:
+ *   OK on success; -ENOMEM if memory is exhausted.
+ *
+ ****************************************************************************/
+
+static int lpm_insert(FAR struct lpm_trie_s *trie, FAR const uint8_t *key,
+                      unsigned int plen, FAR const void *route,
+                      size_t routesize)
+{
+  FAR struct lpm_node_s **pnode = &trie->root;
+  FAR struct lpm_node_s *node;
+  FAR struct lpm_node_s *split;
+  FAR struct lpm_route_s **pentry;
+  FAR struct lpm_route_s *entry;
+  unsigned int common;
+
+  entry = kmm_malloc(sizeof(struct lpm_route_s));
+  if (entry == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  entry->flink = NULL;
+  memcpy(&entry->u, route, routesize);
+
+  while ((node = *pnode) != NULL)
+    {
+      common = lpm_common(node->key, key,
+                          node->plen < plen ? node->plen : plen);
+      if (common == node->plen)
+        {
+          if (common == plen)
+            {
+              /* Same prefix.  Keep the order of the routing table, so that
+               * the first of several routes for the same network wins.
+               */
+
+              pentry = &node->routes;
+              while (*pentry != NULL)
+                {
+                  pentry = &(*pentry)->flink;
+                }
+
+              *pentry = entry;
+              return OK;
+            }
+
+          /* The node prefix is a prefix of the new one.  Descend. */
+
+          pnode = &node->child[LPM_BIT(key, node->plen)];
+          continue;
+        }
+
+      /* The new prefix diverges from the node prefix, or is a prefix of it.
+       * Insert a node for the common part above the existing node.
+       */
+
+      split = lpm_newnode(trie, key, common);
+      if (split == NULL)
+        {
+          kmm_free(entry);
+          return -ENOMEM;
+        }
+
+      split->child[LPM_BIT(node->key, common)] = node;
+      *pnode = split;
+
+      if (common == plen)
+        {
+          split->routes = entry;
+          return OK;
+        }
+
+      pnode = &split->child[LPM_BIT(key, common)];
+    }
+
+  node = lpm_newnode(trie, key, plen);
+  if (node == NULL)
+    {
+      kmm_free(entry);
+      return -ENOMEM;
+    }
+
+  node->routes = entry;
+  *pnode = node;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: lpm_lookup
+ *
+ * Description:
+ *   Find the route with the longest prefix that matches the key and is
+ *   accepted by the filter.  The trie is walked from the root, so each
+ *   match found replaces a shorter one.
+ *
+ ****************************************************************************/
+
+static FAR struct lpm_route_s *lpm_lookup(FAR struct lpm_trie_s *trie,
+                                          FAR const uint8_t *key,
+                                          lpm_filter_t filter,
+                                          FAR struct net_driver_s *dev)
+{
+  FAR struct lpm_node_s *node = trie->root;
+  FAR struct lpm_route_s *best = NULL;
+  FAR struct lpm_route_s *route;
+
+  while (node != NULL &&
+         lpm_common(node->key, key, node->plen) == node->plen)
+    {
+      for (route = node->routes; route != NULL; route = route->flink)
+        {
+          if (filter == NULL || filter(route, dev))
+            {
+              best = route;
+              break;
+            }
+        }
+
+      if (node->plen >= 8 * trie->addrlen)
+        {
+          break;
+        }
+
+      node = node->child[LPM_BIT(key, node->plen)];
+    }
+
+  return best;
+}
+
+/****************************************************************************
+ * Name: lpm_flush
+ *
+ * Description:
+ *   Discard the content of a trie and mark it for rebuilding.
+ *
+ ****************************************************************************/
+
+static void lpm_flush(FAR struct lpm_trie_s *trie)
+{
+  net_lock();
+  lpm_freenode(trie->root);
+  trie->root  = NULL;
+  trie->state = LPM_STALE;
+  net_unlock();
+}
+
+/****************************************************************************
+ * Name: lpm_built
+ *
+ * Description:
+ *   Record the result of building a trie from the routing table.
+ *
+ ****************************************************************************/
+
+static void lpm_built(FAR struct lpm_trie_s *trie, int ret)
+{
+  if (ret < 0)
+    {
+      nwarn("WARNING: Failed to build the route trie: %d\n", ret);
+
+      lpm_freenode(trie->root);
+      trie->root  = NULL;
+      trie->state = LPM_FAILED;
+    }
+  else
+    {
+      trie->state = LPM_VALID;
+    }
+}
+
+/****************************************************************************
+ * Name: lpm_add_ipv4
+ *
+ * Description:
+ *   net_foreachroute_ipv4() callback that adds one route to the trie.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_IPv4
+static int lpm_add_ipv4(FAR struct net_route_ipv4_s *route, FAR void *arg)
+{
+  int plen;
+
+  plen = lpm_prefixlen((FAR const uint8_t *)&route->netmask,
+                       sizeof(in_addr_t));
+  if (plen < 0)
+    {
+      return plen;
+    }
+
+  return lpm_insert(&g_ipv4_trie, (FAR const uint8_t *)&route->target,
+                    plen, route, sizeof(struct net_route_ipv4_s));
+}
+
+/****************************************************************************
+ * Name: lpm_devmatch_ipv4
+ *
+ * Description:
+ *   Return true if the router of the IPv4 route is on the device network.
+ *
+ ****************************************************************************/
+
+static bool lpm_devmatch_ipv4(FAR const struct lpm_route_s *route,
+                              FAR struct net_driver_s *dev)
+{
+  return net_ipv4addr_maskcmp(route->u.ipv4.router, dev->d_ipaddr,
+                              dev->d_netmask);
+}
+#endif /* CONFIG_NET_IPv4 */
+
+/****************************************************************************
+ * Name: lpm_add_ipv6
+ *
+ * Description:
+ *   net_foreachroute_ipv6() callback that adds one route to the trie.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_IPv6
+static int lpm_add_ipv6(FAR struct net_route_ipv6_s *route, FAR void *arg)
+{
+  int plen;
+
+  plen = lpm_prefixlen((FAR const uint8_t *)route->netmask,
+                       sizeof(net_ipv6addr_t));
+  if (plen < 0)
+    {
+      return plen;
+    }
+
+  return lpm_insert(&g_ipv6_trie, (FAR const uint8_t *)route->target,
+                    plen, route, sizeof(struct net_route_ipv6_s));
+}
+
+/****************************************************************************
+ * Name: lpm_devmatch_ipv6
+ *
+ * Description:
+ *   Return true if the router of the IPv6 route is on the device network.
+ *
+ ****************************************************************************/
+
+static bool lpm_devmatch_ipv6(FAR const struct lpm_route_s *route,
+                              FAR struct net_driver_s *dev)
+{
+  return net_ipv6addr_maskcmp(route->u.ipv6.router, dev->d_ipv6addr,
+                              dev->d_ipv6netmask);
+}
+#endif /* CONFIG_NET_IPv6 */
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: net_lpmroute_ipv4 and net_lpmroute_ipv6
+ *
+ * Description:
+ *   Find the route with the longest prefix matching the target address in
+ *   the in-memory lookup trie.  The trie is built from the routing table on
+ *   first use after it was flushed.
+ *
+ * Input Parameters:
+ *   target - An IP address on a remote network to use in the lookup.
+ *   dev    - If not NULL, only routes whose router lies on the network of
+ *            this device are considered.
+ *   router - The location to return the router address.
+ *
+ * Returned Value:
+ *   OK if a route was found; -ENOENT if there is no matching route.
+ *   -ENOSYS is returned if the trie could not be built (for example, if
+ *   memory is exhausted or a route uses a non-contiguous netmask).  The
+ *   caller must then search the routing table itself.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_IPv4
+int net_lpmroute_ipv4(in_addr_t target, FAR struct net_driver_s *dev,
+                      FAR in_addr_t *router)
+{
+  FAR struct lpm_route_s *route;
+  int ret = -ENOSYS;
+
+  net_lock();
+
+  if (g_ipv4_trie.state == LPM_STALE)
+    {
+      lpm_built(&g_ipv4_trie, net_foreachroute_ipv4(lpm_add_ipv4, NULL));
+    }
+
+  if (g_ipv4_trie.state == LPM_VALID)
+    {
+      route = lpm_lookup(&g_ipv4_trie, (FAR const uint8_t *)&target,
+                         dev != NULL ? lpm_devmatch_ipv4 : NULL, dev);
+      if (route != NULL)
+        {
+          net_ipv4addr_copy(*router, route->u.ipv4.router);
+          ret = OK;
+        }
+      else
+        {
+          ret = -ENOENT;
+        }
+    }
+
+  net_unlock();
+  return ret;
+}
+#endif /* CONFIG_NET_IPv4 */
+
+#ifdef CONFIG_NET_IPv6
+int net_lpmroute_ipv6(FAR const net_ipv6addr_t target,
+                      FAR struct net_driver_s *dev, net_ipv6addr_t router)
+{
+  FAR struct lpm_route_s *route;
+  int ret = -ENOSYS;
+
+  net_lock();
+
+  if (g_ipv6_trie.state == LPM_STALE)
+    {
+      lpm_built(&g_ipv6_trie, net_foreachroute_ipv6(lpm_add_ipv6, NULL));
+    }
+
+  if (g_ipv6_trie.state == LPM_VALID)
+    {
+      route = lpm_lookup(&g_ipv6_trie, (FAR const uint8_t *)target,
+                         dev != NULL ? lpm_devmatch_ipv6 : NULL, dev);
+      if (route != NULL)
+        {
+          net_ipv6addr_copy(router, route->u.ipv6.router);
+          ret = OK;
+        }
+      else
+        {
+          ret = -ENOENT;
+        }
+    }
+
+  net_unlock();
+  return ret;
+}
+#endif /* CONFIG_NET_IPv6 */
+
+/****************************************************************************
+ * Name: net_flushlpm_ipv4 and net_flushlpm_ipv6
+ *
+ * Description:
+ *   Discard the lookup trie.  This must be called whenever the routing
+ *   table is modified.  The trie is rebuilt on the next lookup.
+ *
+ * Input Parameters:
+ *   None
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_IPv4
+void net_flushlpm_ipv4(void)
+{
+  lpm_flush(&g_ipv4_trie);
+}
+#endif
+
+#ifdef CONFIG_NET_IPv6
+void net_flushlpm_ipv6(void)
+{
+  lpm_flush(&g_ipv6_trie);
+}
+#endif
+
+#endif /* CONFIG_NET && CONFIG_ROUTE_LPMTRIE */
@@ -33,6 +33,7 @@
 
 #include "netdev/netdev.h"
 #include "route/cacheroute.h"
+#include "route/lpmtrie.h"
 #include "route/route.h"
 
 #if defined(CONFIG_NET) && defined(CONFIG_NET_ROUTE)
@@ -218,6 +219,23 @@ void netdev_ipv4_router(FAR struct net_driver_s *dev, in_addr_t target,
   struct route_ipv4_devmatch_s match;
   int ret;
 
+#ifdef CONFIG_ROUTE_LPMTRIE
+  /* Find the longest matching prefix in the in-memory trie.  Search the
+   * routing table only if the trie could not be built.
+   */
+
+  ret = net_lpmroute_ipv4(target, dev, router);
+  if (ret == -ENOENT)
+    {
+      net_ipv4addr_copy(*router, dev->d_draddr);
+    }
+
+  if (ret != -ENOSYS)
+    {
+      return;
+    }
+#endif
+
   /* Set up the comparison structure */
 
   memset(&match, 0, sizeof(struct route_ipv4_devmatch_s));
@@ -297,6 +315,23 @@ void netdev_ipv6_router(FAR struct net_driver_s *dev,
   struct route_ipv6_devmatch_s match;
   int ret;
 
+#ifdef CONFIG_ROUTE_LPMTRIE
+  /* Find the longest matching prefix in the in-memory trie.  Search the
+   * routing table only if the trie could not be built.
+   */
+
+  ret = net_lpmroute_ipv6(target, dev, router);
+  if (ret == -ENOENT)
+    {
+      net_ipv6addr_copy(router, dev->d_ipv6draddr);
+    }
+
+  if (ret != -ENOSYS)
+    {
+      return;
+    }
+#endif
+
   /* Set up the comparison structure */
 
   memset(&match, 0, sizeof(struct route_ipv6_devmatch_s));
@@ -0,0 +1,186 @@
+/****************************************************************************
+ * net/socket/recvmmsg.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/socket.h>
+#include <assert.h>
+#include <errno.h>
+#include <time.h>
+
+#include <nuttx/cancelpt.h>
+#include <nuttx/clock.h>
+#include <nuttx/net/net.h>
+
+#include "socket/socket.h"
+
+#ifdef CONFIG_NET
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: psock_recvmmsg
+ *
+ * Description:
+ *   psock_recvmmsg() receives up to 'vlen' messages from a socket with a
+ *   single call.  This is an internal OS interface.  It is functionally
+ *   equivalent to recvmmsg() except that:
+ *
+ *   - It is not a cancellation point,
+ *   - It does not modify the errno variable, and
+ *   - It accepts the internal socket structure as an input rather than an
+ *     task-specific socket descriptor.
+ *
+ * Input Parameters:
+ *   psock     A pointer to a NuttX-specific, internal socket structure
+ *   msgvec    Array of buffers to receive the messages
+ *   vlen      The number of entries in msgvec
+ *   flags     Receive flags
+ *   timeout   Optional time limit for the whole operation
+ *
+ * Returned Value:
+ *   On success, returns the number of messages received.  The length of
+ *   each message is returned in the msg_len field of its msgvec entry.  If
+ *   no message could be received, a negated errno value is returned (see
+ *   comments with recvmsg() for a list of appropriate errno values).
+ *
+ ****************************************************************************/
+
+int psock_recvmmsg(FAR struct socket *psock, FAR struct mmsghdr *msgvec,
+                   unsigned int vlen, int flags,
+                   FAR struct timespec *timeout)
+{
+  clock_t start = 0;
+  clock_t ticks = 0;
+  unsigned int i;
+  int rflags;
+  ssize_t ret;
+
+  if (msgvec == NULL)
+    {
+      return -EINVAL;
+    }
+
+  if (timeout != NULL)
+    {
+      if (timeout->tv_sec < 0 || timeout->tv_nsec < 0 ||
+          timeout->tv_nsec >= NSEC_PER_SEC)
+        {
+          return -EINVAL;
+        }
+
+      ticks = SEC2TICK(timeout->tv_sec) + NSEC2TICK(timeout->tv_nsec);
+      start = clock_systime_ticks();
+    }
+
+  rflags = flags & ~MSG_WAITFORONE;
+  for (i = 0; i < vlen; i++)
+    {
+      ret = psock_recvmsg(psock, &msgvec[i].msg_hdr, rflags);
+      if (ret < 0)
+        {
+          /* Report the error only if nothing has been received yet.  The
+           * messages already received must be returned first.
+           */
+
+          return i > 0 ? i : ret;
+        }
+
+      msgvec[i].msg_len = ret;
+
+      /* With MSG_WAITFORONE, only wait for the first message */
+
+      if ((flags & MSG_WAITFORONE) != 0)
+        {
+          rflags |= MSG_DONTWAIT;
+        }
+
+      /* As on other systems, the timeout is only checked after each
+       * message and cannot interrupt a blocked receive.
+       */
+
+      if (timeout != NULL &&
+          (clock_t)(clock_systime_ticks() - start) >= ticks)
+        {
+          return i + 1;
+        }
+    }
+
+  return i;
+}
+
+/****************************************************************************
+ * Function: recvmmsg
+ *
+ * Description:
+ *   recvmmsg() receives multiple messages from a socket with a single
+ *   call.  Each message is received as with recvmsg() into the msg_hdr
+ *   field of an entry of msgvec.
+ *
+ * Parameters:
+ *   sockfd   Socket descriptor of socket
+ *   msgvec   Array of buffers to receive the messages
+ *   vlen     The number of entries in msgvec
+ *   flags    Receive flags.  In addition to the recvmsg() flags,
+ *            MSG_WAITFORONE makes the receive non-blocking after the first
+ *            message has been received.
+ *   timeout  If not NULL, recvmmsg() returns when this time has elapsed
+ *            after receiving a message.
+ *
+ * Returned Value:
+ *   On success, returns the number of messages received.  On error, -1 is
+ *   returned, and errno is set appropriately (see recvmsg()).  An error is
+ *   only reported if no message was received.
+ *
+ ****************************************************************************/
+
+int recvmmsg(int sockfd, FAR struct mmsghdr *msgvec, unsigned int vlen,
+             int flags, FAR struct timespec *timeout)
+{
+  FAR struct socket *psock;
+  int ret;
+
+  /* recvmmsg() is a cancellation point */
+
+  enter_cancellation_point();
+
+  /* Get the underlying socket structure and let psock_recvmmsg() do all
+   * of the work.
+   */
+
+  psock = sockfd_socket(sockfd);
+  ret   = psock_recvmmsg(psock, msgvec, vlen, flags, timeout);
+  if (ret < 0)
+    {
+      _SO_SETERRNO(psock, -ret);
+      ret = ERROR;
+    }
+
+  leave_cancellation_point();
+  return ret;
+}
+
+#endif /* CONFIG_NET */
@@ -35,6 +35,7 @@
 #include <nuttx/net/udp.h>
 
 #include "devif/devif.h"
+#include "netdev/netdev.h"
 #include "udp/udp.h"
 
 /****************************************************************************
@@ -51,6 +52,87 @@
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: udp_copyin
+ *
+ * Description:
+ *   Allocate a new I/O buffer chain and copy the source address and the
+ *   newly received packet into it.
+ *
+ ****************************************************************************/
+
+static FAR struct iob_s *udp_copyin(FAR uint8_t *buffer, uint16_t buflen,
+                                    FAR void *src_addr,
+                                    uint8_t src_addr_size)
+{
+  FAR struct iob_s *iob;
+  int ret;
+
+  /* Allocate on I/O buffer to start the chain (throttling as necessary).
+   * We will not wait for an I/O buffer to become available in this context.
+   */
+
+  iob = iob_tryalloc(true, IOBUSER_NET_UDP_READAHEAD);
+  if (iob == NULL)
+    {
+      nerr("ERROR: Failed to create new I/O buffer chain\n");
+      return NULL;
+    }
+
+  /* Copy the src address info into the I/O buffer chain.  We will not wait
+   * for an I/O buffer to become available in this context.  It there is
+   * any failure to allocated, the entire I/O buffer chain will be discarded.
+   */
+
+  ret = iob_trycopyin(iob, (FAR const uint8_t *)&src_addr_size,
+                      sizeof(uint8_t), 0, true, IOBUSER_NET_UDP_READAHEAD);
+  if (ret < 0)
+    {
+      /* On a failure, iob_trycopyin return a negated error value but does
+       * not free any I/O buffers.
+       */
+
+      nerr("ERROR: Failed to add data to the I/O buffer chain: %d\n", ret);
+      iob_free_chain(iob, IOBUSER_NET_UDP_READAHEAD);
+      return NULL;
+    }
+
+  ret = iob_trycopyin(iob, (FAR const uint8_t *)src_addr, src_addr_size,
+                      sizeof(uint8_t), true, IOBUSER_NET_UDP_READAHEAD);
+  if (ret < 0)
+    {
+      /* On a failure, iob_trycopyin return a negated error value but does
+       * not free any I/O buffers.
+       */
+
+      nerr("ERROR: Failed to add data to the I/O buffer chain: %d\n", ret);
+      iob_free_chain(iob, IOBUSER_NET_UDP_READAHEAD);
+      return NULL;
+    }
+
+  if (buflen > 0)
+    {
+      /* Copy the new appdata into the I/O buffer chain */
+
+      ret = iob_trycopyin(iob, buffer, buflen,
+                          src_addr_size + sizeof(uint8_t), true,
+                          IOBUSER_NET_UDP_READAHEAD);
+      if (ret < 0)
+        {
+          /* On a failure, iob_trycopyin return a negated error value but
+           * does not free any I/O buffers.
+           */
+
+          nerr("ERROR: Failed to add data to the I/O buffer chain: %d\n",
+               ret);
+          iob_free_chain(iob, IOBUSER_NET_UDP_READAHEAD);
+          return NULL;
+        }
+    }
+
+  return iob;
+}
+
 /****************************************************************************
  * Name: udp_datahandler
  *
@@ -83,17 +165,6 @@ static uint16_t udp_datahandler(FAR struct net_driver_s *dev,
   FAR void  *src_addr;
   uint8_t src_addr_size;
 
-  /* Allocate on I/O buffer to start the chain (throttling as necessary).
-   * We will not wait for an I/O buffer to become available in this context.
-   */
-
-  iob = iob_tryalloc(true, IOBUSER_NET_UDP_READAHEAD);
-  if (iob == NULL)
-    {
-      nerr("ERROR: Failed to create new I/O buffer chain\n");
-      return 0;
-    }
-
 #ifdef CONFIG_NET_IPv6
 #ifdef CONFIG_NET_IPv4
   if (IFF_IS_IPv6(dev->d_flags))
@@ -158,53 +229,27 @@ static uint16_t udp_datahandler(FAR struct net_driver_s *dev,
     }
 #endif /* CONFIG_NET_IPv4 */
 
-  /* Copy the src address info into the I/O buffer chain.  We will not wait
-   * for an I/O buffer to become available in this context.  It there is
-   * any failure to allocated, the entire I/O buffer chain will be discarded.
+#ifdef CONFIG_NETDEV_IOB_RECV
+  /* If the driver received the packet into an I/O buffer, queue that buffer
+   * itself.  The source address info is written over the packet headers in
+   * front of the payload, which have already been consumed.
    */
 
-  ret = iob_trycopyin(iob, (FAR const uint8_t *)&src_addr_size,
-                      sizeof(uint8_t), 0, true, IOBUSER_NET_UDP_READAHEAD);
-  if (ret < 0)
+  iob = netdev_iob_claim(dev, buffer, buflen,
+                         src_addr_size + sizeof(uint8_t), true);
+  if (iob != NULL)
     {
-      /* On a failure, iob_trycopyin return a negated error value but does
-       * not free any I/O buffers.
-       */
+      FAR uint8_t *hdr = IOB_DATA(iob);
 
-      nerr("ERROR: Failed to add data to the I/O buffer chain: %d\n", ret);
-      iob_free_chain(iob, IOBUSER_NET_UDP_READAHEAD);
-      return 0;
+      hdr[0] = src_addr_size;
+      memcpy(&hdr[1], src_addr, src_addr_size);
     }
-
-  ret = iob_trycopyin(iob, (FAR const uint8_t *)src_addr, src_addr_size,
-                      sizeof(uint8_t), true, IOBUSER_NET_UDP_READAHEAD);
-  if (ret < 0)
-    {
-      /* On a failure, iob_trycopyin return a negated error value but does
-       * not free any I/O buffers.
-       */
-
-      nerr("ERROR: Failed to add data to the I/O buffer chain: %d\n", ret);
-      iob_free_chain(iob, IOBUSER_NET_UDP_READAHEAD);
-      return 0;
-    }
-
-  if (buflen > 0)
+  else
+#endif
     {
-      /* Copy the new appdata into the I/O buffer chain */
-
-      ret = iob_trycopyin(iob, buffer, buflen,
-                          src_addr_size + sizeof(uint8_t), true,
-                          IOBUSER_NET_UDP_READAHEAD);
-      if (ret < 0)
+      iob = udp_copyin(buffer, buflen, src_addr, src_addr_size);
+      if (iob == NULL)
         {
-          /* On a failure, iob_trycopyin return a negated error value but
-           * does not free any I/O buffers.
-           */
-
-          nerr("ERROR: Failed to add data to the I/O buffer chain: %d\n",
-               ret);
-          iob_free_chain(iob, IOBUSER_NET_UDP_READAHEAD);
           return 0;
         }
     }
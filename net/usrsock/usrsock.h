@@ -117,11 +117,24 @@ struct usrsock_conn_s
   uint16_t      flags;               /* Socket state flags */
   struct usrsockdev_s *dev;          /* Device node used for this conn */
 
+  struct
+  {
+    sq_entry_t node;            /* Supports a singly linked list */
+    FAR struct iovec *iov;      /* Request buffers not yet read by daemon */
+    int      iovcnt;            /* Number of request buffers */
+    size_t   pos;               /* Reader position on request buffers */
+    sem_t    acksem;            /* Request acknowledgment notification */
+    bool     ackwait;           /* Waiting for acknowledgment of request */
+  } req;
+
   struct
   {
     sem_t    sem;               /* Request semaphore (only one outstanding request) */
     uint8_t  xid;               /* Expected message exchange id */
     bool     inprogress;        /* Request was received but daemon is still processing */
+#ifdef CONFIG_NET_USRSOCK_SHAREDBUF
+    bool     sharedbuf;         /* Daemon writes received data directly */
+#endif
     uint16_t valuelen;          /* Length of value from daemon */
     uint16_t valuelen_nontrunc; /* Actual length of value at daemon */
     int      result;            /* Result for request */
@@ -229,6 +242,17 @@ FAR struct usrsock_conn_s *usrsock_nextconn(FAR struct usrsock_conn_s *conn);
 
 int usrsock_connidx(FAR struct usrsock_conn_s *conn);
 
+/****************************************************************************
+ * Name: usrsock_connfromidx()
+ *
+ * Description:
+ *   Return the connection structure with the given index, as returned by
+ *   usrsock_connidx(), or NULL if the index is out of range.
+ *
+ ****************************************************************************/
+
+FAR struct usrsock_conn_s *usrsock_connfromidx(int idx);
+
 /****************************************************************************
  * Name: usrsock_active()
  *
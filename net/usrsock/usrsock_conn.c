@@ -121,6 +121,8 @@ FAR struct usrsock_conn_s *usrsock_alloc(void)
 
       memset(conn, 0, sizeof(*conn));
       nxsem_init(&conn->resp.sem, 0, 1);
+      nxsem_init(&conn->req.acksem, 0, 0);
+      nxsem_set_protocol(&conn->req.acksem, SEM_PRIO_NONE);
       conn->dev = NULL;
       conn->usockid = -1;
       conn->state = USRSOCK_CONN_STATE_UNINITIALIZED;
@@ -160,6 +162,7 @@ void usrsock_free(FAR struct usrsock_conn_s *conn)
   /* Reset structure */
 
   nxsem_destroy(&conn->resp.sem);
+  nxsem_destroy(&conn->req.acksem);
   memset(conn, 0, sizeof(*conn));
   conn->dev = NULL;
   conn->usockid = -1;
@@ -209,6 +212,25 @@ int usrsock_connidx(FAR struct usrsock_conn_s *conn)
   return idx;
 }
 
+/****************************************************************************
+ * Name: usrsock_connfromidx()
+ *
+ * Description:
+ *   Return the connection structure with the given index, as returned by
+ *   usrsock_connidx(), or NULL if the index is out of range.
+ *
+ ****************************************************************************/
+
+FAR struct usrsock_conn_s *usrsock_connfromidx(int idx)
+{
+  if (idx < 0 || idx >= ARRAY_SIZE(g_usrsock_connections))
+    {
+      return NULL;
+    }
+
+  return &g_usrsock_connections[idx];
+}
+
 /****************************************************************************
  * Name: usrsock_active()
  *
@@ -53,6 +53,7 @@
 
 #include <arch/irq.h>
 
+#include <nuttx/nuttx.h>
 #include <nuttx/random.h>
 #include <nuttx/fs/fs.h>
 #include <nuttx/semaphore.h>
@@ -79,18 +80,12 @@ struct usrsockdev_s
   sem_t   devsem;     /* Lock for device node */
   uint8_t ocount;     /* The number of times the device has been opened */
 
-  struct
-  {
-    FAR const struct iovec *iov; /* Pending request buffers */
-    int     iovcnt;              /* Number of request buffers */
-    size_t  pos;                 /* Reader position on request buffer */
-    sem_t   sem;                 /* Request semaphore (only one outstanding
-                                  * request) */
-    sem_t   acksem;              /* Request acknowledgment notification */
-    uint8_t ack_xid;             /* Exchange id for which waiting ack */
-    uint16_t nbusy;              /* Number of requests blocked from different
-                                  * threads */
-  } req;
+  sq_queue_t reqs;    /* Connections with requests not completely read by
+                       * the daemon, in order of submission */
+  bool    batch;      /* read()/write() handle several requests/messages */
+#ifdef CONFIG_NET_USRSOCK_SHAREDBUF
+  bool    sharedbuf;  /* Payloads are passed by reference */
+#endif
 
   FAR struct usrsock_conn_s *datain_conn; /* Connection instance to receive
                                            * data buffers. */
@@ -112,6 +107,9 @@ static ssize_t usrsockdev_write(FAR struct file *filep,
 static off_t usrsockdev_seek(FAR struct file *filep, off_t offset,
                              int whence);
 
+static int usrsockdev_ioctl(FAR struct file *filep, int cmd,
+                            unsigned long arg);
+
 static int usrsockdev_open(FAR struct file *filep);
 
 static int usrsockdev_close(FAR struct file *filep);
@@ -130,7 +128,7 @@ static const struct file_operations g_usrsockdevops =
   usrsockdev_read,    /* read */
   usrsockdev_write,   /* write */
   usrsockdev_seek,    /* seek */
-  NULL,               /* ioctl */
+  usrsockdev_ioctl,   /* ioctl */
   usrsockdev_poll     /* poll */
 #ifndef CONFIG_DISABLE_PSEUDOFS_OPERATIONS
   , NULL              /* unlink */
@@ -273,7 +271,8 @@ static uint8_t usrsockdev_get_xid(FAR struct usrsock_conn_s *conn)
 #endif
 
   /* Each connection can one only one request/response pending. So map
-   * connection structure index to xid value.
+   * connection structure index to xid value.  Responses are matched back
+   * to their connection with usrsock_connfromidx().
    */
 
   conn_idx = usrsock_connidx(conn);
@@ -318,6 +317,47 @@ static bool usrsockdev_is_opened(FAR struct usrsockdev_s *dev)
   return ret;
 }
 
+/****************************************************************************
+ * Name: usrsockdev_nextreq
+ *
+ * Description:
+ *   Return the connection of the oldest request that has not been
+ *   completely read by the daemon.
+ *
+ ****************************************************************************/
+
+static FAR struct usrsock_conn_s *
+usrsockdev_nextreq(FAR struct usrsockdev_s *dev)
+{
+  FAR sq_entry_t *node = sq_peek(&dev->reqs);
+
+  if (node == NULL)
+    {
+      return NULL;
+    }
+
+  return container_of(node, struct usrsock_conn_s, req.node);
+}
+
+/****************************************************************************
+ * Name: usrsockdev_reqdone
+ *
+ * Description:
+ *   The request of the connection will not be read anymore, either because
+ *   it has been read completely or because it has been acknowledged.
+ *
+ ****************************************************************************/
+
+static void usrsockdev_reqdone(FAR struct usrsockdev_s *dev,
+                               FAR struct usrsock_conn_s *conn)
+{
+  if (conn->req.iov != NULL)
+    {
+      sq_rem(&conn->req.node, &dev->reqs);
+      conn->req.iov = NULL;
+    }
+}
+
 /****************************************************************************
  * Name: usrsockdev_pollnotify
  ****************************************************************************/
@@ -348,9 +388,11 @@ static void usrsockdev_pollnotify(FAR struct usrsockdev_s *dev,
 static ssize_t usrsockdev_read(FAR struct file *filep, FAR char *buffer,
                                size_t len)
 {
-  FAR struct inode        *inode = filep->f_inode;
-  FAR struct usrsockdev_s *dev;
-  int                      ret;
+  FAR struct inode          *inode = filep->f_inode;
+  FAR struct usrsock_conn_s *conn;
+  FAR struct usrsockdev_s   *dev;
+  size_t                     nread;
+  int                        ret;
 
   if (len == 0)
     {
@@ -376,37 +418,44 @@ static ssize_t usrsockdev_read(FAR struct file *filep, FAR char *buffer,
 
   net_lock();
 
-  /* Is request available? */
+  /* Copy the pending requests to user-space, in order.  Unless batched
+   * transfers were selected, only data from the first request is returned.
+   */
 
-  if (dev->req.iov)
+  nread = 0;
+  while (nread < len && (conn = usrsockdev_nextreq(dev)) != NULL)
     {
       ssize_t rlen;
 
-      /* Copy request to user-space. */
-
-      rlen = iovec_get(buffer, len, dev->req.iov, dev->req.iovcnt,
-                       dev->req.pos);
-      if (rlen < 0)
+      rlen = iovec_get(buffer + nread, len - nread, conn->req.iov,
+                       conn->req.iovcnt, conn->req.pos);
+      if (rlen > 0)
         {
-          /* Tried reading beyond buffer. */
+          conn->req.pos += rlen;
+          nread += rlen;
+        }
+
+      /* The request stays available until read completely.  The daemon
+       * may also skip the rest of the request by acknowledging it.
+       */
 
-          len = 0;
+      if (iovec_get(NULL, 0, conn->req.iov, conn->req.iovcnt,
+                    conn->req.pos) < 0 ||
+          rlen <= 0)
+        {
+          usrsockdev_reqdone(dev, conn);
         }
-      else
+
+      if (!dev->batch && nread > 0)
         {
-          dev->req.pos += rlen;
-          len = rlen;
+          break;
         }
     }
-  else
-    {
-      len = 0;
-    }
 
   net_unlock();
   usrsockdev_semgive(&dev->devsem);
 
-  return len;
+  return nread;
 }
 
 /****************************************************************************
@@ -417,6 +466,7 @@ static off_t usrsockdev_seek(FAR struct file *filep, off_t offset,
                              int whence)
 {
   FAR struct inode        *inode = filep->f_inode;
+  FAR struct usrsock_conn_s *conn;
   FAR struct usrsockdev_s *dev;
   off_t pos;
   int ret;
@@ -440,24 +490,27 @@ static off_t usrsockdev_seek(FAR struct file *filep, off_t offset,
 
   net_lock();
 
-  /* Is request available? */
+  /* Is request available?  Seeking is relative to the first request that
+   * has not been completely read.
+   */
 
-  if (dev->req.iov)
+  conn = usrsockdev_nextreq(dev);
+  if (conn != NULL)
     {
       ssize_t rlen;
 
       if (whence == SEEK_CUR)
         {
-          pos = dev->req.pos + offset;
+          pos = conn->req.pos + offset;
         }
       else
         {
           pos = offset;
         }
 
-      /* Copy request to user-space. */
+      /* Check the new position. */
 
-      rlen = iovec_get(NULL, 0, dev->req.iov, dev->req.iovcnt, pos);
+      rlen = iovec_get(NULL, 0, conn->req.iov, conn->req.iovcnt, pos);
       if (rlen < 0)
         {
           /* Tried seek beyond buffer. */
@@ -466,7 +519,7 @@ static off_t usrsockdev_seek(FAR struct file *filep, off_t offset,
         }
       else
         {
-          dev->req.pos = pos;
+          conn->req.pos = pos;
         }
     }
   else
@@ -711,6 +764,18 @@ usrsockdev_handle_datareq_response(FAR struct usrsockdev_s *dev,
 
   conn->resp.datain.iovcnt = num_inbufs;
 
+#ifdef CONFIG_NET_USRSOCK_SHAREDBUF
+  if (conn->resp.sharedbuf && hdr->result > 0)
+    {
+      /* The daemon has already copied the data to the receive buffer.
+       * Only the value follows the message.
+       */
+
+      conn->resp.datain.iovcnt = 1;
+      conn->resp.datain.total -= hdr->result;
+    }
+#endif
+
   /* Next written buffers are redirected to data buffers. */
 
   dev->datain_conn = conn;
@@ -764,18 +829,12 @@ static ssize_t usrsockdev_handle_req_response(FAR struct usrsockdev_s *dev,
 
   net_lock();
 
-  /* Get corresponding usrsock connection for this transfer */
-
-  conn = usrsock_nextconn(NULL);
-  while (conn)
-    {
-      if (conn->resp.xid == hdr->xid)
-        break;
-
-      conn = usrsock_nextconn(conn);
-    }
+  /* Get corresponding usrsock connection for this transfer.  The xid is
+   * derived from the connection index.
+   */
 
-  if (!conn)
+  conn = usrsock_connfromidx(hdr->xid - 1);
+  if (conn == NULL || hdr->xid == 0 || conn->resp.xid != hdr->xid)
     {
       /* No connection waiting for this message. */
 
@@ -786,15 +845,16 @@ static ssize_t usrsockdev_handle_req_response(FAR struct usrsockdev_s *dev,
       goto unlock_out;
     }
 
-  if (dev->req.ack_xid == hdr->xid && dev->req.iov)
+  if (conn->req.ackwait)
     {
       /* Signal that request was received and read by daemon and
        * acknowledgment response was received.
        */
 
-      dev->req.iov = NULL;
+      usrsockdev_reqdone(dev, conn);
+      conn->req.ackwait = false;
 
-      nxsem_post(&dev->req.acksem);
+      nxsem_post(&conn->req.acksem);
     }
 
   ret = handle_response(dev, conn, buffer);
@@ -862,70 +922,138 @@ static ssize_t usrsockdev_write(FAR struct file *filep,
       return ret;
     }
 
-  if (!dev->datain_conn)
-    {
-      /* Start of message, buffer length should be at least size of common
-       * message header.
-       */
+  /* With batched transfers, handle messages until the buffer is consumed
+   * or an invalid message is found.
+   */
 
-      if (len < sizeof(struct usrsock_message_common_s))
+  do
+    {
+      if (!dev->datain_conn)
         {
-          nwarn("message too short, %d < %d.\n", len,
-                sizeof(struct usrsock_message_common_s));
+          /* Start of message, buffer length should be at least size of
+           * common message header.
+           */
 
-          ret = -EINVAL;
-          goto errout;
-        }
+          if (len < sizeof(struct usrsock_message_common_s))
+            {
+              nwarn("message too short, %d < %d.\n", len,
+                    sizeof(struct usrsock_message_common_s));
 
-      /* Handle message. */
+              ret = -EINVAL;
+              break;
+            }
+
+          /* Handle message. */
+
+          ret = usrsockdev_handle_message(dev, buffer, len);
+          if (ret < 0)
+            {
+              break;
+            }
 
-      ret = usrsockdev_handle_message(dev, buffer, len);
-      if (ret >= 0)
-        {
           buffer += ret;
           len -= ret;
           ret = origlen - len;
         }
+
+      /* Data input handling. */
+
+      if (dev->datain_conn)
+        {
+          conn = dev->datain_conn;
+
+          /* Copy data from user-space. */
+
+          ret = iovec_put(conn->resp.datain.iov, conn->resp.datain.iovcnt,
+                          conn->resp.datain.pos, buffer, len);
+          if (ret < 0)
+            {
+              /* Tried writing beyond buffer. */
+
+              ret = -EINVAL;
+              conn->resp.result = -EINVAL;
+              conn->resp.datain.pos =
+                  conn->resp.datain.total;
+            }
+          else
+            {
+              conn->resp.datain.pos += ret;
+              buffer += ret;
+              len -= ret;
+              ret = origlen - len;
+            }
+
+          if (conn->resp.datain.pos == conn->resp.datain.total)
+            {
+              dev->datain_conn = NULL;
+
+              /* Done with data response. */
+
+              usrsock_event(conn, USRSOCK_EVENT_REQ_COMPLETE);
+            }
+
+          if (ret < 0)
+            {
+              break;
+            }
+        }
     }
+  while (dev->batch && len > 0);
 
-  /* Data input handling. */
+  /* Report the messages handled before an error in a batch */
 
-  if (dev->datain_conn)
+  if (ret < 0 && len < origlen && dev->batch)
     {
-      conn = dev->datain_conn;
+      ret = origlen - len;
+    }
 
-      /* Copy data from user-space. */
+  usrsockdev_semgive(&dev->devsem);
+  return ret;
+}
 
-      ret = iovec_put(conn->resp.datain.iov, conn->resp.datain.iovcnt,
-                      conn->resp.datain.pos, buffer, len);
-      if (ret < 0)
-        {
-          /* Tried writing beyond buffer. */
+/****************************************************************************
+ * Name: usrsockdev_ioctl
+ ****************************************************************************/
 
-          ret = -EINVAL;
-          conn->resp.result = -EINVAL;
-          conn->resp.datain.pos =
-              conn->resp.datain.total;
-        }
-      else
-        {
-          conn->resp.datain.pos += ret;
-          buffer += ret;
-          len -= ret;
-          ret = origlen - len;
-        }
+static int usrsockdev_ioctl(FAR struct file *filep, int cmd,
+                            unsigned long arg)
+{
+  FAR struct inode *inode = filep->f_inode;
+  FAR struct usrsockdev_s *dev;
+  int ret;
 
-      if (conn->resp.datain.pos == conn->resp.datain.total)
-        {
-          dev->datain_conn = NULL;
+  DEBUGASSERT(inode);
 
-          /* Done with data response. */
+  dev = inode->i_private;
 
-          usrsock_event(conn, USRSOCK_EVENT_REQ_COMPLETE);
-        }
+  DEBUGASSERT(dev);
+
+  ret = usrsockdev_semtake(&dev->devsem);
+  if (ret < 0)
+    {
+      return ret;
     }
 
-errout:
+  net_lock();
+
+  switch (cmd)
+    {
+    case USRSOCKIOC_BATCH:
+      dev->batch = (arg != 0);
+      break;
+
+#ifdef CONFIG_NET_USRSOCK_SHAREDBUF
+    case USRSOCKIOC_SHAREDBUF:
+      dev->sharedbuf = (arg != 0);
+      break;
+#endif
+
+    default:
+      ret = -ENOTTY;
+      break;
+    }
+
+  net_unlock();
   usrsockdev_semgive(&dev->devsem);
   return ret;
 }
@@ -1026,46 +1154,32 @@ static int usrsockdev_close(FAR struct file *filep)
   DEBUGASSERT(dev->ocount == 0);
   ret = OK;
 
-  do
-    {
-      /* Give other threads short time window to complete recently completed
-       * requests.
-       */
-
-      ret = net_timedwait(&dev->req.sem, 10);
-      if (ret < 0)
-        {
-          if (ret != -ETIMEDOUT && ret != -EINTR)
-            {
-              ninfo("net_timedwait errno: %d\n", ret);
-              DEBUGASSERT(false);
-            }
-        }
-      else
-        {
-          usrsockdev_semgive(&dev->req.sem);
-        }
-
-      /* Wake-up pending requests. */
+  /* Wake-up pending requests.  The daemon will not read or acknowledge
+   * them anymore.
+   */
 
-      if (dev->req.nbusy == 0)
+  conn = usrsock_nextconn(NULL);
+  while (conn)
+    {
+      usrsockdev_reqdone(dev, conn);
+      if (conn->req.ackwait)
         {
-          break;
+          conn->req.ackwait = false;
+          nxsem_post(&conn->req.acksem);
         }
 
-      dev->req.iov = NULL;
-      nxsem_post(&dev->req.acksem);
+      conn = usrsock_nextconn(conn);
     }
-  while (true);
 
-  net_unlock();
+  DEBUGASSERT(sq_empty(&dev->reqs));
 
-  /* Check if request line is active */
+  dev->datain_conn = NULL;
+  dev->batch       = false;
+#ifdef CONFIG_NET_USRSOCK_SHAREDBUF
+  dev->sharedbuf   = false;
+#endif
 
-  if (dev->req.iov != NULL)
-    {
-      dev->req.iov = NULL;
-    }
+  net_unlock();
 
   usrsockdev_semgive(&dev->devsem);
 
@@ -1140,9 +1254,7 @@ static int usrsockdev_poll(FAR struct file *filep, FAR struct pollfd *fds,
 
       /* Notify the POLLIN event if pending request. */
 
-      if (dev->req.iov != NULL &&
-          !(iovec_get(NULL, 0, dev->req.iov,
-                      dev->req.iovcnt, dev->req.pos) < 0))
+      if (!sq_empty(&dev->reqs))
         {
           eventset |= POLLIN;
         }
@@ -1176,12 +1288,102 @@ errout:
   return ret;
 }
 
+/****************************************************************************
+ * Name: usrsockdev_sharedbuf
+ *
+ * Description:
+ *   Replace the payload of a SENDTO request by descriptors of the sender's
+ *   buffers, or add the descriptor of the receive buffer to a RECVFROM
+ *   request.  'sbufs' must have room for three buffers and 'desc' for one
+ *   descriptor per request buffer.
+ *
+ * Returned Value:
+ *   The number of request buffers in 'sbufs', or zero if the request is
+ *   not affected.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_USRSOCK_SHAREDBUF
+static unsigned int
+usrsockdev_sharedbuf(FAR struct usrsock_conn_s *conn,
+                     FAR struct iovec *iov, unsigned int iovcnt,
+                     FAR struct iovec *sbufs,
+                     FAR struct usrsock_iovec_s *desc)
+{
+  FAR struct usrsock_request_common_s *req_head = iov[0].iov_base;
+  unsigned int ndesc = 0;
+  unsigned int nhdr;
+  unsigned int i;
+
+  switch (req_head->reqid)
+    {
+    case USRSOCK_REQUEST_SENDTO:
+      {
+        FAR struct usrsock_request_sendto_s *req = iov[0].iov_base;
+        size_t remaining = req->buflen;
+
+        /* The request and the address are followed by the payload */
+
+        nhdr = 2;
+        for (i = nhdr; i < iovcnt && remaining > 0; i++)
+          {
+            if (iov[i].iov_len > 0)
+              {
+                desc[ndesc].base = iov[i].iov_base;
+                desc[ndesc].len  = MIN(iov[i].iov_len, remaining);
+                remaining       -= desc[ndesc].len;
+                ndesc++;
+              }
+          }
+      }
+      break;
+
+    case USRSOCK_REQUEST_RECVFROM:
+
+      /* The receive buffer follows the address buffer set up with
+       * usrsock_setup_datain().
+       */
+
+      if (conn->resp.datain.iovcnt < 2)
+        {
+          return 0;
+        }
+
+      nhdr = 1;
+      if (conn->resp.datain.iov[1].iov_len > 0)
+        {
+          desc[0].base = conn->resp.datain.iov[1].iov_base;
+          desc[0].len  = conn->resp.datain.iov[1].iov_len;
+          ndesc        = 1;
+        }
+
+      conn->resp.sharedbuf = true;
+      break;
+
+    default:
+      return 0;
+    }
+
+  memcpy(sbufs, iov, nhdr * sizeof(struct iovec));
+  sbufs[nhdr].iov_base = desc;
+  sbufs[nhdr].iov_len  = ndesc * sizeof(struct usrsock_iovec_s);
+
+  return nhdr + 1;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
 
 /****************************************************************************
  * Name: usrsockdev_do_request
+ *
+ * Description:
+ *   Queue a request for the daemon and wait until the daemon acknowledges
+ *   it.  Requests of different connections are queued independently, so
+ *   that a slow request does not hold up the others.
+ *
  ****************************************************************************/
 
 int usrsockdev_do_request(FAR struct usrsock_conn_s *conn,
@@ -1189,6 +1391,11 @@ int usrsockdev_do_request(FAR struct usrsock_conn_s *conn,
 {
   FAR struct usrsockdev_s *dev = conn->dev;
   FAR struct usrsock_request_common_s *req_head = iov[0].iov_base;
+#ifdef CONFIG_NET_USRSOCK_SHAREDBUF
+  struct usrsock_iovec_s desc[iovcnt];
+  struct iovec sbufs[3];
+  unsigned int nsbufs;
+#endif
 
   if (!dev)
     {
@@ -1214,40 +1421,48 @@ int usrsockdev_do_request(FAR struct usrsock_conn_s *conn,
   conn->resp.xid = req_head->xid;
   conn->resp.result = -EACCES;
 
-  ++dev->req.nbusy; /* net_lock held. */
+#ifdef CONFIG_NET_USRSOCK_SHAREDBUF
+  conn->resp.sharedbuf = false;
+  if (dev->sharedbuf)
+    {
+      nsbufs = usrsockdev_sharedbuf(conn, iov, iovcnt, sbufs, desc);
+      if (nsbufs > 0)
+        {
+          iov    = sbufs;
+          iovcnt = nsbufs;
+        }
+    }
+#endif
 
-  /* Set outstanding request for daemon to handle. */
+  /* Queue the request for the daemon to handle (net_lock held).  Only one
+   * request per connection can be outstanding.
+   */
 
-  net_lockedwait_uninterruptible(&dev->req.sem);
+  DEBUGASSERT(!conn->req.ackwait && conn->req.iov == NULL);
 
-  if (usrsockdev_is_opened(dev))
-    {
-      DEBUGASSERT(dev->req.iov == NULL);
-      dev->req.ack_xid = req_head->xid;
-      dev->req.iov = iov;
-      dev->req.pos = 0;
-      dev->req.iovcnt = iovcnt;
+  conn->req.iov     = iov;
+  conn->req.iovcnt  = iovcnt;
+  conn->req.pos     = 0;
+  conn->req.ackwait = true;
+  sq_addlast(&conn->req.node, &dev->reqs);
 
-      /* Notify daemon of new request. */
+  /* Notify daemon of new request. */
 
-      usrsockdev_pollnotify(dev, POLLIN);
+  usrsockdev_pollnotify(dev, POLLIN);
 
-      /* Wait ack for request. */
+  /* Wait ack for request.  The buffers must stay valid until then. */
 
-      net_lockedwait_uninterruptible(&dev->req.acksem);
+  while (conn->req.ackwait)
+    {
+      net_lockedwait_uninterruptible(&conn->req.acksem);
     }
-  else
+
+  if (!usrsockdev_is_opened(dev))
     {
       ninfo("usockid=%d; daemon abruptly closed /dev/usrsock.\n",
             conn->usockid);
     }
 
-  /* Free request line for next command. */
-
-  usrsockdev_semgive(&dev->req.sem);
-
-  --dev->req.nbusy; /* net_lock held. */
-
   return OK;
 }
 
@@ -1264,11 +1479,8 @@ void usrsockdev_register(void)
   /* Initialize device private structure. */
 
   g_usrsockdev.ocount = 0;
-  g_usrsockdev.req.nbusy = 0;
+  sq_init(&g_usrsockdev.reqs);
   nxsem_init(&g_usrsockdev.devsem, 0, 1);
-  nxsem_init(&g_usrsockdev.req.sem, 0, 1);
-  nxsem_init(&g_usrsockdev.req.acksem, 0, 0);
-  nxsem_set_protocol(&g_usrsockdev.req.acksem, SEM_PRIO_NONE);
 
   register_driver("/dev/usrsock", &g_usrsockdevops, 0666,
                   &g_usrsockdev);
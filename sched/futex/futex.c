@@ -0,0 +1,351 @@
+/****************************************************************************
+ * sched/futex/futex.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <limits.h>
+#include <errno.h>
+
+#include <nuttx/irq.h>
+#include <nuttx/futex.h>
+#include <nuttx/sched.h>
+#include <nuttx/semaphore.h>
+
+#include "sched/sched.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_FUTEX_HASH_SIZE
+#  define CONFIG_FUTEX_HASH_SIZE 16
+#endif
+
+/* Futex words are 32-bit aligned, so the low two address bits carry no
+ * information.
+ */
+
+#define FUTEX_HASH(a) \
+  ((((uintptr_t)(a)) >> 2) % CONFIG_FUTEX_HASH_SIZE)
+
+/* In the kernel build each process has its own address space, so the same
+ * address in two processes names two different futexes.
+ */
+
+#ifdef CONFIG_BUILD_KERNEL
+#  define FUTEX_KEY(t) ((t)->group)
+#else
+#  define FUTEX_KEY(t) NULL
+#endif
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* One of these lives on the stack of each waiting thread */
+
+struct futex_waiter_s
+{
+  FAR struct futex_waiter_s *flink;  /* Next waiter in the hash bucket */
+  FAR volatile uint32_t *addr;       /* The futex word waited on */
+  FAR void *key;                     /* The address space of addr */
+  uint8_t priority;                  /* Priority of the waiting thread */
+  bool woken;                        /* Removed by futex_wake() */
+  sem_t sem;                         /* The waiting thread sleeps here */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* Each bucket is kept in priority order so that futex_wake() wakes the
+ * highest priority waiters of a word first.
+ */
+
+static FAR struct futex_waiter_s *g_futex_hash[CONFIG_FUTEX_HASH_SIZE];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: futex_insert
+ *
+ * Assumptions:
+ *   Interrupts are disabled.
+ *
+ ****************************************************************************/
+
+static void futex_insert(FAR struct futex_waiter_s *waiter)
+{
+  FAR struct futex_waiter_s **pprev;
+
+  pprev = &g_futex_hash[FUTEX_HASH(waiter->addr)];
+
+  while (*pprev != NULL && (*pprev)->priority >= waiter->priority)
+    {
+      pprev = &(*pprev)->flink;
+    }
+
+  waiter->flink = *pprev;
+  *pprev        = waiter;
+}
+
+/****************************************************************************
+ * Name: futex_remove
+ *
+ * Assumptions:
+ *   Interrupts are disabled.
+ *
+ ****************************************************************************/
+
+static void futex_remove(FAR struct futex_waiter_s *waiter)
+{
+  FAR struct futex_waiter_s **pprev;
+
+  pprev = &g_futex_hash[FUTEX_HASH(waiter->addr)];
+
+  while (*pprev != NULL)
+    {
+      if (*pprev == waiter)
+        {
+          *pprev = waiter->flink;
+          break;
+        }
+
+      pprev = &(*pprev)->flink;
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxfutex_wait
+ *
+ * Description:
+ *   This is the internal OS version of futex_wait().  It does not modify
+ *   the errno value.
+ *
+ * Input Parameters:
+ *   addr    - The address of the futex word
+ *   val     - The value that the caller expects to find in the word
+ *   clockid - The clock that abstime refers to
+ *   abstime - The absolute time of the timeout.  NULL waits forever.
+ *
+ * Returned Value:
+ *   Zero (OK) is returned when woken.  A negated errno value is returned
+ *   on failure.
+ *
+ ****************************************************************************/
+
+int nxfutex_wait(FAR volatile uint32_t *addr, uint32_t val,
+                 clockid_t clockid, FAR const struct timespec *abstime)
+{
+  FAR struct tcb_s *rtcb = this_task();
+  struct futex_waiter_s waiter;
+  irqstate_t flags;
+  int ret;
+
+  if (addr == NULL || ((uintptr_t)addr & 3) != 0)
+    {
+      return -EINVAL;
+    }
+
+  waiter.addr     = addr;
+  waiter.key      = FUTEX_KEY(rtcb);
+  waiter.priority = rtcb->sched_priority;
+  waiter.woken    = false;
+
+  /* The waiter semaphore is used for signaling and must not have priority
+   * inheritance enabled.
+   */
+
+  nxsem_init(&waiter.sem, 0, 0);
+  nxsem_set_protocol(&waiter.sem, SEM_PRIO_NONE);
+
+  /* The comparison and the queueing must be atomic with respect to
+   * futex_wake():  A thread that changes the word before calling
+   * futex_wake() will either find this waiter queued or the comparison
+   * will see the new value.
+   */
+
+  flags = enter_critical_section();
+  if (*addr != val)
+    {
+      ret = -EAGAIN;
+    }
+  else
+    {
+      futex_insert(&waiter);
+
+      if (abstime != NULL)
+        {
+          ret = nxsem_clockwait(&waiter.sem, clockid, abstime);
+        }
+      else
+        {
+          ret = nxsem_wait(&waiter.sem);
+        }
+
+      /* A wakeup that raced with a timeout or a signal still counts as a
+       * wakeup, otherwise it would be lost.
+       */
+
+      if (waiter.woken)
+        {
+          ret = OK;
+        }
+      else
+        {
+          futex_remove(&waiter);
+        }
+    }
+
+  leave_critical_section(flags);
+  nxsem_destroy(&waiter.sem);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: nxfutex_wake
+ *
+ * Description:
+ *   This is the internal OS version of futex_wake().
+ *
+ * Input Parameters:
+ *   addr  - The address of the futex word
+ *   nwake - The maximum number of threads to wake
+ *
+ * Returned Value:
+ *   The number of threads woken or a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int nxfutex_wake(FAR volatile uint32_t *addr, int nwake)
+{
+  FAR struct futex_waiter_s **pprev;
+  FAR struct futex_waiter_s *waiter;
+  FAR void *key = FUTEX_KEY(this_task());
+  irqstate_t flags;
+  int nwoken = 0;
+
+  if (addr == NULL || ((uintptr_t)addr & 3) != 0)
+    {
+      return -EINVAL;
+    }
+
+  flags = enter_critical_section();
+
+  /* Don't let the woken threads run until all of them are dequeued */
+
+  sched_lock();
+
+  pprev = &g_futex_hash[FUTEX_HASH(addr)];
+  while ((waiter = *pprev) != NULL && nwoken < nwake)
+    {
+      if (waiter->addr == addr && waiter->key == key)
+        {
+          *pprev        = waiter->flink;
+          waiter->woken = true;
+          nxsem_post(&waiter->sem);
+          nwoken++;
+        }
+      else
+        {
+          pprev = &waiter->flink;
+        }
+    }
+
+  sched_unlock();
+  leave_critical_section(flags);
+  return nwoken;
+}
+
+/****************************************************************************
+ * Name: futex_wait
+ *
+ * Description:
+ *   Block the calling thread until futex_wake() is called on the same
+ *   address, provided that the 32-bit word at addr still contains val.
+ *
+ * Input Parameters:
+ *   addr    - The address of the futex word
+ *   val     - The value that the caller expects to find in the word
+ *   clockid - The clock that abstime refers to
+ *   abstime - The absolute time of the timeout.  NULL waits forever.
+ *
+ * Returned Value:
+ *   Zero (OK) is returned when woken.  Otherwise, -1 (ERROR) is returned
+ *   and the errno value is set appropriately.
+ *
+ ****************************************************************************/
+
+int futex_wait(FAR volatile uint32_t *addr, uint32_t val,
+               clockid_t clockid, FAR const struct timespec *abstime)
+{
+  int ret;
+
+  ret = nxfutex_wait(addr, val, clockid, abstime);
+  if (ret < 0)
+    {
+      set_errno(-ret);
+      ret = ERROR;
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: futex_wake
+ *
+ * Description:
+ *   Wake up to nwake threads waiting on the futex word at addr.
+ *
+ * Input Parameters:
+ *   addr  - The address of the futex word
+ *   nwake - The maximum number of threads to wake
+ *
+ * Returned Value:
+ *   The number of threads woken.  Otherwise, -1 (ERROR) is returned and
+ *   the errno value is set appropriately.
+ *
+ ****************************************************************************/
+
+int futex_wake(FAR volatile uint32_t *addr, int nwake)
+{
+  int ret;
+
+  ret = nxfutex_wake(addr, nwake);
+  if (ret < 0)
+    {
+      set_errno(-ret);
+      ret = ERROR;
+    }
+
+  return ret;
+}
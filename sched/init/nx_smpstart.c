@@ -80,6 +80,12 @@ void nx_idle_trampoline(void)
 
   for (; ; )
     {
+#ifdef CONFIG_SCHED_LOADBALANCE
+      /* Start any task that is waiting for a CPU while this one idles */
+
+      nxsched_balance();
+
+#endif
       /* Perform any processor-specific idle state operations */
 
       up_idle();
@@ -183,6 +183,14 @@ volatile dq_queue_t g_waitingforfill;
 volatile dq_queue_t g_stoppedtasks;
 #endif
 
+#ifdef CONFIG_SCHED_DEADLINE
+/* This is the list of all SCHED_DEADLINE threads that have used up their
+ * budget and wait for it to be replenished.
+ */
+
+volatile dq_queue_t g_throttledtasks;
+#endif
+
 /* This the list of all tasks that have been initialized, but not yet
  * activated. NOTE:  This is the only list that is not prioritized.
  */
@@ -280,7 +288,14 @@ const struct tasklist_s g_tasklisttable[NUM_TASK_STATES] =
   {                                              /* TSTATE_TASK_STOPPED */
     &g_stoppedtasks,
     0                                            /* See tcb->prev_state */
-  },
+  }
+#endif
+#ifdef CONFIG_SCHED_DEADLINE
+  ,
+  {                                              /* TSTATE_WAIT_DEADLINE */
+    &g_throttledtasks,
+    0
+  }
 #endif
 };
 
@@ -378,6 +393,9 @@ void nx_start(void)
 #endif
 #ifdef CONFIG_SIG_SIGSTOP_ACTION
   dq_init(&g_stoppedtasks);
+#endif
+#ifdef CONFIG_SCHED_DEADLINE
+  dq_init(&g_throttledtasks);
 #endif
   dq_init(&g_inactivetasks);
 
@@ -798,6 +816,12 @@ void nx_start(void)
         }
 #endif
 
+#ifdef CONFIG_SCHED_LOADBALANCE
+      /* Start any task that is waiting for a CPU while this one idles */
+
+      nxsched_balance();
+
+#endif
       /* Perform any processor-specific idle state operations */
 
       up_idle();
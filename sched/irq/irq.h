@@ -120,6 +120,12 @@ extern volatile cpu_set_t g_cpu_irqset;
 /* Handles nested calls to enter_critical section from interrupt handlers */
 
 extern volatile uint8_t g_cpu_nestcount[CONFIG_SMP_NCPUS];
+
+#ifdef CONFIG_SMP_CSECTION_TICKET
+/* The FIFO queue of CPUs waiting for g_cpu_irqlock */
+
+extern ticketlock_t g_cpu_irqqueue;
+#endif
 #endif
 
 /****************************************************************************
@@ -56,12 +56,72 @@ volatile cpu_set_t g_cpu_irqset;
 /* Handles nested calls to enter_critical section from interrupt handlers */
 
 volatile uint8_t g_cpu_nestcount[CONFIG_SMP_NCPUS];
+
+#ifdef CONFIG_SMP_CSECTION_TICKET
+/* The queue of CPUs waiting for g_cpu_irqlock.  Only the CPU whose ticket
+ * is being served tries to take g_cpu_irqlock.
+ */
+
+ticketlock_t g_cpu_irqqueue = TICKETLOCK_INITIALIZER;
+#endif
+#endif
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+#ifdef CONFIG_SMP_CSECTION_TICKET
+/* One plus the ticket that each CPU gave up when it had to service a pause
+ * request while waiting, or zero.  Abandoned tickets are skipped when the
+ * queue advances.  Protected by g_cpu_irqqueue.guard.
+ */
+
+static uint32_t g_cpu_irqabandoned[CONFIG_SMP_NCPUS];
 #endif
 
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: irq_advance
+ *
+ * Description:
+ *   Serve the next ticket in g_cpu_irqqueue, skipping tickets abandoned by
+ *   CPUs that left the queue.
+ *
+ * Assumptions:
+ *   The caller holds g_cpu_irqqueue.guard.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SMP_CSECTION_TICKET
+static void irq_advance(void)
+{
+  bool skipped;
+  int cpu;
+
+  do
+    {
+      skipped = false;
+      g_cpu_irqqueue.owner++;
+
+      for (cpu = 0; cpu < CONFIG_SMP_NCPUS; cpu++)
+        {
+          if (g_cpu_irqabandoned[cpu] == (uint32_t)g_cpu_irqqueue.owner + 1)
+            {
+              g_cpu_irqabandoned[cpu] = 0;
+              skipped = true;
+            }
+        }
+    }
+  while (skipped);
+
+  SP_DSB();
+  SP_SEV();
+}
+#endif
+
 /****************************************************************************
  * Name: irq_waitlock
  *
@@ -110,17 +170,51 @@ bool irq_waitlock(int cpu)
 {
 #ifdef CONFIG_SCHED_INSTRUMENTATION_SPINLOCKS
   FAR struct tcb_s *tcb = current_task(cpu);
+#endif
+#ifdef CONFIG_SMP_CSECTION_TICKET
+  uint32_t spins = 0;
+  uint16_t ticket;
+#endif
 
+#ifdef CONFIG_SCHED_INSTRUMENTATION_SPINLOCKS
   /* Notify that we are waiting for a spinlock */
 
   sched_note_spinlock(tcb, &g_cpu_irqlock);
 #endif
 
+#ifdef CONFIG_SMP_CSECTION_TICKET
+  /* Get in line.  The CPUs waiting for the critical section are served in
+   * the order in which they arrived instead of racing for g_cpu_irqlock.
+   */
+
+  spin_lock_wo_note(&g_cpu_irqqueue.guard);
+  if (g_cpu_irqabandoned[cpu] != 0)
+    {
+      /* The ticket given up on a pause request has not been reached yet.
+       * Take it back and keep our place in line.
+       */
+
+      ticket = g_cpu_irqabandoned[cpu] - 1;
+      g_cpu_irqabandoned[cpu] = 0;
+    }
+  else
+    {
+      ticket = g_cpu_irqqueue.next++;
+    }
+
+  spin_unlock_wo_note(&g_cpu_irqqueue.guard);
+#endif
+
   /* Duplicate the spin_lock() logic from spinlock.c, but adding the check
    * for the deadlock condition.
    */
 
+#ifdef CONFIG_SMP_CSECTION_TICKET
+  while (g_cpu_irqqueue.owner != ticket ||
+         spin_trylock_wo_note(&g_cpu_irqlock) == SP_LOCKED)
+#else
   while (spin_trylock_wo_note(&g_cpu_irqlock) == SP_LOCKED)
+#endif
     {
       /* Is a pause request pending? */
 
@@ -130,6 +224,25 @@ bool irq_waitlock(int cpu)
            * Abort the wait and return false.
            */
 
+#ifdef CONFIG_SMP_CSECTION_TICKET
+          /* The paused CPU may switch to another task, so it cannot keep
+           * its place in line.  Pass the turn on if it is ours already,
+           * otherwise leave the ticket to be skipped.
+           */
+
+          spin_lock_wo_note(&g_cpu_irqqueue.guard);
+          if (g_cpu_irqqueue.owner == ticket)
+            {
+              irq_advance();
+            }
+          else
+            {
+              g_cpu_irqabandoned[cpu] = (uint32_t)ticket + 1;
+            }
+
+          spin_unlock_wo_note(&g_cpu_irqqueue.guard);
+#endif
+
 #ifdef CONFIG_SCHED_INSTRUMENTATION_SPINLOCKS
           /* Notify that we are waiting for a spinlock */
 
@@ -138,10 +251,26 @@ bool irq_waitlock(int cpu)
 
           return false;
         }
+
+#ifdef CONFIG_SMP_CSECTION_TICKET
+      spins++;
+#endif
     }
 
   /* We have g_cpu_irqlock! */
 
+#ifdef CONFIG_SMP_CSECTION_TICKET
+  /* Let the next CPU in line wait for g_cpu_irqlock */
+
+  spin_lock_wo_note(&g_cpu_irqqueue.guard);
+  irq_advance();
+  spin_unlock_wo_note(&g_cpu_irqqueue.guard);
+
+#ifdef CONFIG_SPINLOCK_STATS
+  spin_stats_acquired(&g_cpu_irqqueue.stats, spins);
+#endif
+#endif
+
 #ifdef CONFIG_SCHED_INSTRUMENTATION_SPINLOCKS
   /* Notify that we have the spinlock */
 
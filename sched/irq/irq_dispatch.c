@@ -123,6 +123,9 @@ void irq_dispatch(int irq, FAR void *context)
   xcpt_t vector = irq_unexpected_isr;
   FAR void *arg = NULL;
   unsigned int ndx = irq;
+#ifdef CONFIG_SCHED_LATENCY_HIST
+  uint32_t start;
+#endif
 
 #if NR_IRQS > 0
   if ((unsigned)irq < NR_IRQS)
@@ -165,9 +168,17 @@ void irq_dispatch(int irq, FAR void *context)
 
   /* Then dispatch to the interrupt handler */
 
+#ifdef CONFIG_SCHED_LATENCY_HIST
+  start = up_critmon_gettime();
+#endif
+
   CALL_VECTOR(ndx, vector, irq, context, arg);
   UNUSED(ndx);
 
+#ifdef CONFIG_SCHED_LATENCY_HIST
+  nxsched_latency_record(NULL, LATENCY_IRQ, up_critmon_gettime() - start);
+#endif
+
 #ifdef CONFIG_SCHED_INSTRUMENTATION_IRQHANDLER
   /* Notify that we are leaving from the interrupt handler */
 
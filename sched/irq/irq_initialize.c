@@ -92,5 +92,11 @@ void irq_initialize(void)
   irqchain_initialize();
 #endif
 
+#if defined(CONFIG_SMP_CSECTION_TICKET) && defined(CONFIG_SPINLOCK_STATS)
+  /* Report the contention on the critical section */
+
+  spin_stats_register(&g_cpu_irqqueue.stats, "csection");
+#endif
+
   up_irqinitialize();
 }
@@ -117,4 +117,55 @@ int pthread_mutexattr_verifytype(int type);
 }
 #endif
 
+/****************************************************************************
+ * Inline Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: pthread_mutex_isfast
+ *
+ * Description:
+ *   Return true if the mutex is a NORMAL (or DEFAULT) mutex that is neither
+ *   robust nor uses priority inheritance.  With CONFIG_FUTEX, such a mutex
+ *   is locked and unlocked with a single atomic operation on the count of
+ *   its semaphore when uncontended.  It is never added to the list of
+ *   mutexes held by the thread, since only robust mutexes need to be
+ *   recovered when their holder exits.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FUTEX
+static inline bool pthread_mutex_isfast(FAR struct pthread_mutex_s *mutex)
+{
+#if defined(CONFIG_PTHREAD_MUTEX_ROBUST)
+  return false;
+#else
+#  ifdef CONFIG_PTHREAD_MUTEX_BOTH
+  if ((mutex->flags & _PTHREAD_MFLAGS_ROBUST) != 0)
+    {
+      return false;
+    }
+#  endif
+
+#  ifdef CONFIG_PTHREAD_MUTEX_TYPES
+  if (mutex->type != PTHREAD_MUTEX_NORMAL)
+    {
+      return false;
+    }
+#  endif
+
+#  ifdef CONFIG_PRIORITY_INHERITANCE
+  if ((mutex->sem.flags & PRIOINHERIT_FLAGS_DISABLE) == 0)
+    {
+      return false;
+    }
+#  endif
+
+  return true;
+#endif
+}
+#else
+#  define pthread_mutex_isfast(m) false
+#endif
+
 #endif /* __SCHED_PTHREAD_PTHREAD_H */
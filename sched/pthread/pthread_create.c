@@ -502,6 +502,18 @@ int nx_pthread_create(pthread_trampoline_t trampoline, FAR pthread_t *thread,
         break;
 #endif
 
+#ifdef CONFIG_SCHED_DEADLINE
+      case SCHED_DEADLINE:
+
+        /* A deadline reservation is not inherited.  The new thread runs
+         * SCHED_FIFO at the same priority until it is admitted with
+         * sched_setscheduler().
+         */
+
+        ptcb->cmn.flags    |= TCB_FLAG_SCHED_FIFO;
+        break;
+#endif
+
 #if 0 /* Not supported */
       case SCHED_OTHER:
         ptcb->cmn.flags    |= TCB_FLAG_SCHED_OTHER;
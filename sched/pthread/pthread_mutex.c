@@ -61,6 +61,11 @@ static void pthread_mutex_add(FAR struct pthread_mutex_s *mutex)
 
   DEBUGASSERT(mutex->flink == NULL);
 
+  if (pthread_mutex_isfast(mutex))
+    {
+      return;
+    }
+
   /* Add the mutex to the list of mutexes held by this pthread */
 
   flags        = enter_critical_section();
@@ -90,6 +95,11 @@ static void pthread_mutex_remove(FAR struct pthread_mutex_s *mutex)
   FAR struct pthread_mutex_s *prev;
   irqstate_t flags;
 
+  if (pthread_mutex_isfast(mutex))
+    {
+      return;
+    }
+
   flags = enter_critical_section();
 
   /* Remove the mutex from the list of mutexes held by this task */
@@ -34,6 +34,7 @@
 #include <nuttx/sched.h>
 
 #include "pthread/pthread.h"
+#include "semaphore/semaphore.h"
 
 /****************************************************************************
  * Public Functions
@@ -84,6 +85,20 @@ int pthread_mutex_timedlock(FAR pthread_mutex_t *mutex,
   sinfo("mutex=0x%p\n", mutex);
   DEBUGASSERT(mutex != NULL);
 
+#ifdef CONFIG_FUTEX
+  /* Lock a free fast mutex with a single atomic operation */
+
+  if (mutex != NULL && pthread_mutex_isfast(mutex) &&
+      nxsem_count_trydec(&mutex->sem))
+    {
+      mutex->pid    = mypid;
+#ifdef CONFIG_PTHREAD_MUTEX_TYPES
+      mutex->nlocks = 1;
+#endif
+      return OK;
+    }
+#endif
+
   if (mutex != NULL)
     {
       /* Make sure the semaphore is stable while we make the following
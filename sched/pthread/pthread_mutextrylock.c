@@ -32,6 +32,7 @@
 #include <debug.h>
 
 #include "pthread/pthread.h"
+#include "semaphore/semaphore.h"
 
 /****************************************************************************
  * Public Functions
@@ -74,6 +75,17 @@ int pthread_mutex_trylock(FAR pthread_mutex_t *mutex)
   sinfo("mutex=0x%p\n", mutex);
   DEBUGASSERT(mutex != NULL);
 
+#ifdef CONFIG_FUTEX
+  /* Lock a free fast mutex with a single atomic operation */
+
+  if (mutex != NULL && pthread_mutex_isfast(mutex) &&
+      nxsem_count_trydec(&mutex->sem))
+    {
+      mutex->pid = (int)getpid();
+      return OK;
+    }
+#endif
+
   if (mutex != NULL)
     {
       int mypid = (int)getpid();
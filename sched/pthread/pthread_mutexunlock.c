@@ -109,6 +109,25 @@ int pthread_mutex_unlock(FAR pthread_mutex_t *mutex)
       return EINVAL;
     }
 
+#ifdef CONFIG_FUTEX
+  /* Unlock a fast mutex that nobody waits for with a single atomic
+   * operation.  A mutex that is not locked is left to the checks below.
+   */
+
+  if (pthread_mutex_isfast(mutex))
+    {
+      int16_t count = 0;
+
+      mutex->pid = -1;
+      if (__atomic_compare_exchange_n(&mutex->sem.semcount, &count, 1,
+                                      false, __ATOMIC_RELEASE,
+                                      __ATOMIC_RELAXED))
+        {
+          return OK;
+        }
+    }
+#endif
+
   /* Make sure the semaphore is stable while we make the following checks.
    * This all needs to be one atomic action.
    */
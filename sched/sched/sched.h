@@ -76,8 +76,39 @@
 #define running_task() \
   (up_interrupt_context() ? g_running_tasks[this_cpu()] : this_task())
 
+/* True if the thread 'a' is to be run in preference to the thread 'b'.
+ * Threads of equal priority are run in FIFO order, except that
+ * SCHED_DEADLINE threads of equal priority are run in the order of their
+ * absolute deadlines.  All SCHED_DEADLINE threads share the priority
+ * CONFIG_SCHED_DEADLINE_PRIORITY, so unless one is boosted by priority
+ * inheritance they are all ordered by deadline.
+ */
+
+#ifdef CONFIG_SCHED_DEADLINE
+#  define nxsched_isdeadline(t) \
+     (((t)->flags & TCB_FLAG_POLICY_MASK) == TCB_FLAG_SCHED_DEADLINE)
+#  define nxsched_outranks(a,b) \
+     ((a)->sched_priority > (b)->sched_priority || \
+      ((a)->sched_priority == (b)->sched_priority && \
+       nxsched_isdeadline(a) && nxsched_isdeadline(b) && \
+       (sclock_t)((a)->deadline.abstime - (b)->deadline.abstime) < 0))
+#else
+#  define nxsched_outranks(a,b) ((a)->sched_priority > (b)->sched_priority)
+#endif
+
 /* List attribute flags */
 
+/* Record that a task was left in the g_readytorun list, so that the next
+ * IDLE loop pass looks for stranded tasks.  Setting the hint is cheap and
+ * lets the IDLE loop skip the critical section when nothing changed.
+ */
+
+#ifdef CONFIG_SCHED_LOADBALANCE
+#  define nxsched_balance_hint() do { g_balance_pending = true; } while (0)
+#else
+#  define nxsched_balance_hint()
+#endif
+
 #define TLIST_ATTR_PRIORITIZED   (1 << 0) /* Bit 0: List is prioritized */
 #define TLIST_ATTR_INDEXED       (1 << 1) /* Bit 1: List is indexed by CPU */
 #define TLIST_ATTR_RUNNABLE      (1 << 2) /* Bit 2: List includes running tasks */
@@ -145,6 +176,17 @@ struct tasklist_s
  * prioritized so that common list handling logic can be used (only the
  * g_readytorun, the g_pendingtasks, and the g_waitingforsemaphore lists
  * need to be prioritized).
+ *
+ * In SMP builds, these lists and the waiter lists of the semaphores are
+ * protected by the critical section (g_cpu_irqlock), not by a lock of
+ * their own.  Moving a task between them is one step with the context
+ * switch:  the blocking thread must still hold the lock when
+ * up_block_task() switches away, and the lock is handed to the next task
+ * through irqcount in its TCB.  A CPU whose g_assignedtasks[] list is
+ * changed is stopped with up_cpu_pause() by a CPU that holds the critical
+ * section, and the paused CPU must not be inside it.  A separate list lock
+ * would have to follow the same hand-over and pause rules, so it would
+ * still serialize all CPUs on every block and wakeup.
  */
 
 /* This is the list of all tasks that are ready to run.  This is a
@@ -239,6 +281,14 @@ extern volatile dq_queue_t g_waitingformqnotfull;
 extern volatile dq_queue_t g_waitingforfill;
 #endif
 
+/* This is the list of all SCHED_DEADLINE threads that have used up their
+ * budget and wait for it to be replenished.
+ */
+
+#ifdef CONFIG_SCHED_DEADLINE
+extern volatile dq_queue_t g_throttledtasks;
+#endif
+
 /* This the list of all tasks that have been initialized, but not yet
  * activated. NOTE:  This is the only list that is not prioritized.
  */
@@ -350,6 +400,22 @@ extern volatile spinlock_t g_cpu_tasklistlock;
 
 #endif /* CONFIG_SMP */
 
+/* Declared in sched_balance.c **********************************************/
+
+#ifdef CONFIG_SCHED_LOADBALANCE
+/* Per-CPU run queue counters.  Only the counters are maintained here, the
+ * remaining fields are filled in by nxsched_get_rqstats().
+ */
+
+extern struct sched_rqstats_s g_rqstats[CONFIG_SMP_NCPUS];
+
+/* Set when a task is left in the g_readytorun list; cleared by the next
+ * balance pass.
+ */
+
+extern volatile bool g_balance_pending;
+#endif
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -406,6 +472,18 @@ uint32_t nxsched_process_sporadic(FAR struct tcb_s *tcb, uint32_t ticks,
 void nxsched_sporadic_lowpriority(FAR struct tcb_s *tcb);
 #endif
 
+#ifdef CONFIG_SCHED_DEADLINE
+int  nxsched_start_deadline(FAR struct tcb_s *tcb,
+                            FAR const struct sched_param *param);
+void nxsched_stop_deadline(FAR struct tcb_s *tcb);
+void nxsched_wakeup_deadline(FAR struct tcb_s *tcb);
+void nxsched_resume_deadline(FAR struct tcb_s *tcb);
+void nxsched_suspend_deadline(FAR struct tcb_s *tcb);
+uint32_t nxsched_process_deadline(FAR struct tcb_s *tcb, bool noswitches);
+void nxsched_get_deadline(FAR struct tcb_s *tcb,
+                          FAR struct sched_param *param);
+#endif
+
 #ifdef CONFIG_SIG_SIGSTOP_ACTION
 void nxsched_suspend(FAR struct tcb_s *tcb);
 void nxsched_continue(FAR struct tcb_s *tcb);
@@ -414,18 +492,25 @@ void nxsched_continue(FAR struct tcb_s *tcb);
 #ifdef CONFIG_SMP
 FAR struct tcb_s *this_task(void);
 
-int  nxsched_select_cpu(cpu_set_t affinity);
+int  nxsched_select_cpu(FAR struct tcb_s *tcb);
 int  nxsched_pause_cpu(FAR struct tcb_s *tcb);
 
 #  define nxsched_islocked_global() spin_islocked(&g_cpu_schedlock)
 #  define nxsched_islocked_tcb(tcb) nxsched_islocked_global()
 
 #else
-#  define nxsched_select_cpu(a)     (0)
+#  define nxsched_select_cpu(t)     (0)
 #  define nxsched_pause_cpu(t)      (-38)  /* -ENOSYS */
 #  define nxsched_islocked_tcb(tcb) ((tcb)->lockcount > 0)
 #endif
 
+#ifdef CONFIG_SCHED_LOADBALANCE
+void nxsched_balance(void);
+#ifndef CONFIG_SCHED_TICKLESS
+void nxsched_process_balance(void);
+#endif
+#endif
+
 #if defined(CONFIG_SCHED_CPULOAD) && !defined(CONFIG_SCHED_CPULOAD_EXTCLK)
 /* CPU load measurement support */
 
@@ -441,6 +526,13 @@ void nxsched_resume_critmon(FAR struct tcb_s *tcb);
 void nxsched_suspend_critmon(FAR struct tcb_s *tcb);
 #endif
 
+/* Latency histograms */
+
+#ifdef CONFIG_SCHED_LATENCY_HIST
+void nxsched_latency_record(FAR struct tcb_s *tcb, int type,
+                            uint32_t elapsed);
+#endif
+
 /* TCB operations */
 
 bool nxsched_verify_tcb(FAR struct tcb_s *tcb);
@@ -31,6 +31,28 @@
 #include "irq/irq.h"
 #include "sched/sched.h"
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* READY_STAMP - Remember when the task became ready-to-run.  The time is
+ * kept if the task is only moved between lists while it is already ready.
+ */
+
+#ifdef CONFIG_SCHED_LATENCY_HIST
+#  define READY_STAMP(tcb) \
+     do \
+       { \
+         if ((tcb)->ready_start == 0) \
+           { \
+             (tcb)->ready_start = up_critmon_gettime(); \
+           } \
+       } \
+     while (0)
+#else
+#  define READY_STAMP(tcb)
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -69,13 +91,15 @@ bool nxsched_add_readytorun(FAR struct tcb_s *btcb)
   FAR struct tcb_s *rtcb = this_task();
   bool ret;
 
+  READY_STAMP(btcb);
+
   /* Check if pre-emption is disabled for the current running task and if
    * the new ready-to-run task would cause the current running task to be
    * pre-empted.  NOTE that IRQs disabled implies that pre-emption is
    * also disabled.
    */
 
-  if (rtcb->lockcount > 0 && rtcb->sched_priority < btcb->sched_priority)
+  if (rtcb->lockcount > 0 && nxsched_outranks(btcb, rtcb))
     {
       /* Yes.  Preemption would occur!  Add the new ready-to-run task to the
        * g_pendingtasks task list for now.
@@ -158,6 +182,8 @@ bool nxsched_add_readytorun(FAR struct tcb_s *btcb)
   int cpu;
   int me;
 
+  READY_STAMP(btcb);
+
   /* Check if the blocked TCB is locked to this CPU */
 
   if ((btcb->flags & TCB_FLAG_CPU_LOCKED) != 0)
@@ -172,7 +198,7 @@ bool nxsched_add_readytorun(FAR struct tcb_s *btcb)
        * (possibly its IDLE task).
        */
 
-      cpu = nxsched_select_cpu(btcb->affinity);
+      cpu = nxsched_select_cpu(btcb);
     }
 
   /* Get the task currently running on the CPU (may be the IDLE task) */
@@ -185,7 +211,7 @@ bool nxsched_add_readytorun(FAR struct tcb_s *btcb)
    * required.
    */
 
-  if (rtcb->sched_priority < btcb->sched_priority)
+  if (nxsched_outranks(btcb, rtcb))
     {
       task_state = TSTATE_TASK_RUNNING;
     }
@@ -244,6 +270,7 @@ bool nxsched_add_readytorun(FAR struct tcb_s *btcb)
        */
 
       nxsched_add_prioritized(btcb, (FAR dq_queue_t *)&g_readytorun);
+      nxsched_balance_hint();
 
       btcb->task_state = TSTATE_TASK_READYTORUN;
       doswitch         = false;
@@ -283,6 +310,13 @@ bool nxsched_add_readytorun(FAR struct tcb_s *btcb)
 
           DEBUGASSERT(task_state == TSTATE_TASK_RUNNING);
 
+#ifdef CONFIG_SCHED_LOADBALANCE
+          if (btcb->last_run != 0 && btcb->cpu != cpu)
+            {
+              g_rqstats[cpu].migrations++;
+            }
+
+#endif
           btcb->cpu        = cpu;
           btcb->task_state = TSTATE_TASK_RUNNING;
 
@@ -343,6 +377,7 @@ bool nxsched_add_readytorun(FAR struct tcb_s *btcb)
                 {
                   next->task_state = TSTATE_TASK_READYTORUN;
                   tasklist         = (FAR dq_queue_t *)&g_readytorun;
+                  nxsched_balance_hint();
                 }
 
               nxsched_add_prioritized(next, tasklist);
@@ -0,0 +1,303 @@
+/****************************************************************************
+ * sched/sched/sched_balance.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <queue.h>
+#include <assert.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/irq.h>
+#include <nuttx/sched.h>
+
+#include "irq/irq.h"
+#include "sched/sched.h"
+
+#ifdef CONFIG_SCHED_LOADBALANCE
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+#ifndef CONFIG_SCHED_TICKLESS
+/* System timer ticks since the last periodic balance pass */
+
+static uint32_t g_balance_ticks;
+#endif
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+/* Per-CPU run queue counters */
+
+struct sched_rqstats_s g_rqstats[CONFIG_SMP_NCPUS];
+
+/* Set by nxsched_balance_hint() when a task is left in g_readytorun */
+
+volatile bool g_balance_pending;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxsched_find_stranded
+ *
+ * Description:
+ *   Move every task in the g_readytorun list that could preempt the
+ *   running task of some CPU in its affinity set to the g_pendingtasks
+ *   list.  Such tasks were left behind when they were displaced from
+ *   their CPU or when the scheduler was locked; nothing else would start
+ *   them until some CPU blocks.
+ *
+ * Input Parameters:
+ *   me - The CPU performing the balance pass
+ *
+ * Returned Value:
+ *   True if any task was moved to the g_pendingtasks list.
+ *
+ * Assumptions:
+ *   Called from within a critical section with pre-emption enabled.
+ *
+ ****************************************************************************/
+
+static bool nxsched_find_stranded(int me)
+{
+  FAR struct tcb_s *rtcb;
+  FAR struct tcb_s *next;
+  FAR struct tcb_s *tcb;
+  bool found = false;
+  int cpu;
+
+  for (tcb = (FAR struct tcb_s *)g_readytorun.head; tcb != NULL; tcb = next)
+    {
+      next = tcb->flink;
+      cpu  = nxsched_select_cpu(tcb);
+      rtcb = current_task(cpu);
+
+      if (nxsched_outranks(tcb, rtcb))
+        {
+          dq_rem((FAR dq_entry_t *)tcb, (FAR dq_queue_t *)&g_readytorun);
+          nxsched_add_prioritized(tcb, (FAR dq_queue_t *)&g_pendingtasks);
+          tcb->task_state = TSTATE_TASK_PENDING;
+
+          g_rqstats[me].pulls++;
+          found = true;
+        }
+    }
+
+  return found;
+}
+
+/****************************************************************************
+ * Name: nxsched_balance_pass
+ *
+ * Description:
+ *   Perform one balance pass:  Start any task in the g_readytorun list
+ *   that could preempt the running task of some CPU in its affinity set.
+ *
+ * Input Parameters:
+ *   None
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+static void nxsched_balance_pass(void)
+{
+  irqstate_t flags;
+  int me;
+
+  /* Nothing to do unless some task is waiting for a CPU.  Peeking without
+   * the critical section is harmless:  A task added concurrently will be
+   * seen by the next pass.
+   */
+
+  if (dq_peek((FAR dq_queue_t *)&g_readytorun) == NULL)
+    {
+      return;
+    }
+
+  flags = enter_critical_section();
+
+  /* Tasks cannot be started while pre-emption is disabled or another CPU
+   * is in a critical section.  They will be merged when that ends.  Leave
+   * the hint set so that the IDLE loop tries again.
+   */
+
+  me = this_cpu();
+  if (!nxsched_islocked_global() && !irq_cpu_locked(me))
+    {
+      g_balance_pending = false;
+      g_rqstats[me].balances++;
+
+      if (nxsched_find_stranded(me))
+        {
+          up_release_pending();
+        }
+    }
+
+  leave_critical_section(flags);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxsched_balance
+ *
+ * Description:
+ *   Start any task that is waiting in the g_readytorun list although some
+ *   CPU that it may run on is idle or running a lower priority task.  The
+ *   stranded tasks are passed through the g_pendingtasks list so that
+ *   up_release_pending() places them with nxsched_select_cpu() and
+ *   performs any context switch, on this CPU or on another one.
+ *
+ *   This is called from the IDLE loop of each CPU.  It only enters the
+ *   critical section if a task was left in the g_readytorun list since the
+ *   last pass (see nxsched_balance_hint()); the periodic pass from the
+ *   system timer catches anything that the hint misses.
+ *
+ * Input Parameters:
+ *   None
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void nxsched_balance(void)
+{
+  if (g_balance_pending)
+    {
+      nxsched_balance_pass();
+    }
+}
+
+/****************************************************************************
+ * Name: nxsched_process_balance
+ *
+ * Description:
+ *   Called on each system timer tick.  Runs a balance pass every
+ *   CONFIG_SCHED_LOADBALANCE_INTERVAL ticks.  This wakes up CPUs that are
+ *   sleeping in their IDLE loop while tasks wait in the g_readytorun list.
+ *
+ * Input Parameters:
+ *   None
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   Called from the timer interrupt handler.
+ *
+ ****************************************************************************/
+
+#ifndef CONFIG_SCHED_TICKLESS
+void nxsched_process_balance(void)
+{
+  if (++g_balance_ticks >= CONFIG_SCHED_LOADBALANCE_INTERVAL)
+    {
+      g_balance_ticks = 0;
+      nxsched_balance_pass();
+    }
+}
+#endif
+
+/****************************************************************************
+ * Name: nxsched_get_rqstats
+ *
+ * Description:
+ *   Return a snapshot of the run queue statistics of one CPU.
+ *
+ * Input Parameters:
+ *   cpu   - The CPU of interest
+ *   stats - The location to return the statistics
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void nxsched_get_rqstats(int cpu, FAR struct sched_rqstats_s *stats)
+{
+  FAR struct tcb_s *tcb;
+  irqstate_t flags;
+#ifdef CONFIG_SCHED_CPULOAD
+  uint32_t total;
+  uint32_t idle;
+#endif
+
+  DEBUGASSERT(cpu >= 0 && cpu < CONFIG_SMP_NCPUS && stats != NULL);
+
+  flags = enter_critical_section();
+
+  *stats         = g_rqstats[cpu];
+  stats->runprio = current_task(cpu)->sched_priority;
+
+  /* Count the assigned tasks, the last of which is always the IDLE task */
+
+  stats->nassigned = 0;
+  for (tcb = (FAR struct tcb_s *)g_assignedtasks[cpu].head;
+       tcb != NULL && tcb->flink != NULL;
+       tcb = tcb->flink)
+    {
+      stats->nassigned++;
+    }
+
+  /* And the unassigned tasks that are permitted to run on this CPU */
+
+  stats->nwaiting = 0;
+  for (tcb = (FAR struct tcb_s *)g_readytorun.head;
+       tcb != NULL;
+       tcb = tcb->flink)
+    {
+      if (CPU_ISSET(cpu, &tcb->affinity))
+        {
+          stats->nwaiting++;
+        }
+    }
+
+#ifdef CONFIG_SCHED_CPULOAD
+  /* The load is the share of this CPU's ticks not spent in its IDLE task.
+   * The PID of the IDLE task of each CPU is the CPU index.
+   */
+
+  total = g_cpuload_total / CONFIG_SMP_NCPUS;
+  idle  = g_pidhash[PIDHASH(cpu)].ticks;
+
+  stats->load = total > idle ? (uint8_t)((total - idle) * 100 / total) : 0;
+#else
+  stats->load = 0;
+#endif
+
+  leave_critical_section(flags);
+}
+
+#endif /* CONFIG_SCHED_LOADBALANCE */
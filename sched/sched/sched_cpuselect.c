@@ -25,8 +25,10 @@
 #include <nuttx/config.h>
 
 #include <sys/types.h>
+#include <stdbool.h>
 #include <assert.h>
 
+#include <nuttx/clock.h>
 #include <nuttx/sched.h>
 
 #include "sched/sched.h"
@@ -39,6 +41,62 @@
 
 #define IMPOSSIBLE_CPU 0xff
 
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name:  nxsched_cache_hot
+ *
+ * Description:
+ *   Return true if the thread was suspended on 'cpu' recently enough that
+ *   its working set is probably still in that CPU's cache.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_LOADBALANCE
+static inline bool nxsched_cache_hot(FAR struct tcb_s *tcb, int cpu)
+{
+  return tcb->last_run != 0 && tcb->cpu == cpu &&
+         clock_systime_ticks() - tcb->last_run <=
+         CONFIG_SCHED_MIGRATION_COST;
+}
+
+/****************************************************************************
+ * Name:  nxsched_cpu_preferred
+ *
+ * Description:
+ *   Decide between two CPUs that are running tasks of the same priority.
+ *   The CPU that still holds the thread's working set wins, otherwise the
+ *   CPU that has spent the most time in its IDLE task.
+ *
+ * Returned Value:
+ *   True if 'cpu' should be used instead of 'best'.
+ *
+ ****************************************************************************/
+
+static bool nxsched_cpu_preferred(FAR struct tcb_s *tcb, int cpu, int best)
+{
+  if (nxsched_cache_hot(tcb, best))
+    {
+      return false;
+    }
+
+  if (nxsched_cache_hot(tcb, cpu))
+    {
+      return true;
+    }
+
+#ifdef CONFIG_SCHED_CPULOAD
+  /* The PID of the IDLE task of each CPU is the CPU index */
+
+  return g_pidhash[PIDHASH(cpu)].ticks > g_pidhash[PIDHASH(best)].ticks;
+#else
+  return false;
+#endif
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -50,8 +108,13 @@
  *   Return the index to the CPU with the lowest priority running task,
  *   possibly its IDLE task.
  *
+ *   With CONFIG_SCHED_LOADBALANCE, ties between CPUs running tasks of the
+ *   same priority are broken in favor of the CPU that the thread last ran
+ *   on, if its cache is still warm, and then of the least loaded CPU.
+ *
  * Input Parameters:
- *   affinity - The set of CPUs on which the thread is permitted to run.
+ *   tcb - The thread to be placed.  Only the CPUs in its affinity set are
+ *         considered.
  *
  * Returned Value:
  *   Index of the CPU with the lowest priority running task
@@ -61,7 +124,7 @@
  *
  ****************************************************************************/
 
-int nxsched_select_cpu(cpu_set_t affinity)
+int nxsched_select_cpu(FAR struct tcb_s *tcb)
 {
   uint8_t minprio;
   int cpu;
@@ -78,7 +141,7 @@ int nxsched_select_cpu(cpu_set_t affinity)
     {
       /* If the thread permitted to run on this CPU? */
 
-      if ((affinity & (1 << i)) != 0)
+      if ((tcb->affinity & (1 << i)) != 0)
         {
           FAR struct tcb_s *rtcb = (FAR struct tcb_s *)
                                    g_assignedtasks[i].head;
@@ -94,7 +157,25 @@ int nxsched_select_cpu(cpu_set_t affinity)
                */
 
               DEBUGASSERT(rtcb->sched_priority == 0);
+#ifdef CONFIG_SCHED_LOADBALANCE
+              /* Keep looking for a better idle CPU unless this is where
+               * the thread's cache is warm.
+               */
+
+              if (nxsched_cache_hot(tcb, i))
+                {
+                  return i;
+                }
+
+              if (minprio > 0 ||
+                  nxsched_cpu_preferred(tcb, i, cpu))
+                {
+                  minprio = 0;
+                  cpu     = i;
+                }
+#else
               return i;
+#endif
             }
           else if (rtcb->sched_priority < minprio)
             {
@@ -102,6 +183,14 @@ int nxsched_select_cpu(cpu_set_t affinity)
               minprio = rtcb->sched_priority;
               cpu = i;
             }
+#ifdef CONFIG_SCHED_LOADBALANCE
+          else if (rtcb->sched_priority == minprio &&
+                   cpu != IMPOSSIBLE_CPU &&
+                   nxsched_cpu_preferred(tcb, i, cpu))
+            {
+              cpu = i;
+            }
+#endif
         }
     }
 
@@ -114,6 +114,10 @@ void nxsched_critmon_preemption(FAR struct tcb_s *tcb, bool state)
           tcb->premp_max = elapsed;
         }
 
+#ifdef CONFIG_SCHED_LATENCY_HIST
+      nxsched_latency_record(tcb, LATENCY_SCHEDLOCK, elapsed);
+#endif
+
       /* Check for the global max elapsed time */
 
       if (g_premp_start[cpu] != 0)
@@ -178,6 +182,10 @@ void nxsched_critmon_csection(FAR struct tcb_s *tcb, bool state)
           tcb->crit_max = elapsed;
         }
 
+#ifdef CONFIG_SCHED_LATENCY_HIST
+      nxsched_latency_record(tcb, LATENCY_CSECTION, elapsed);
+#endif
+
       /* Check for the global max elapsed time */
 
       if (g_crit_start[cpu] != 0)
@@ -213,6 +221,17 @@ void nxsched_resume_critmon(FAR struct tcb_s *tcb)
 
   DEBUGASSERT(tcb->premp_start == 0 && tcb->crit_start == 0);
 
+#ifdef CONFIG_SCHED_LATENCY_HIST
+  /* Was this task woken up since it last ran? */
+
+  if (tcb->ready_start != 0)
+    {
+      nxsched_latency_record(tcb, LATENCY_WAKEUP,
+                             up_critmon_gettime() - tcb->ready_start);
+      tcb->ready_start = 0;
+    }
+#endif
+
   /* Did this task disable pre-emption? */
 
   if (tcb->lockcount > 0)
@@ -300,6 +319,10 @@ void nxsched_suspend_critmon(FAR struct tcb_s *tcb)
         {
           tcb->premp_max = elapsed;
         }
+
+#ifdef CONFIG_SCHED_LATENCY_HIST
+      nxsched_latency_record(tcb, LATENCY_SCHEDLOCK, elapsed);
+#endif
     }
 
   /* Is this task in a critical section? */
@@ -315,6 +338,10 @@ void nxsched_suspend_critmon(FAR struct tcb_s *tcb)
         {
           tcb->crit_max = elapsed;
         }
+
+#ifdef CONFIG_SCHED_LATENCY_HIST
+      nxsched_latency_record(tcb, LATENCY_CSECTION, elapsed);
+#endif
     }
 }
 
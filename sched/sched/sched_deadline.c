@@ -0,0 +1,477 @@
+/****************************************************************************
+ * sched/sched/sched_deadline.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <sched.h>
+#include <assert.h>
+#include <errno.h>
+
+#include <nuttx/sched.h>
+#include <nuttx/arch.h>
+#include <nuttx/irq.h>
+#include <nuttx/clock.h>
+
+#include "clock/clock.h"
+#include "sched/sched.h"
+
+#ifdef CONFIG_SCHED_DEADLINE
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Bandwidths (runtime/period) are kept as fixed point fractions */
+
+#define DEADLINE_BW_SHIFT 16
+#define DEADLINE_BW_ONE   ((uint32_t)1 << DEADLINE_BW_SHIFT)
+
+#ifdef CONFIG_SMP
+#  define DEADLINE_NCPUS  CONFIG_SMP_NCPUS
+#else
+#  define DEADLINE_NCPUS  1
+#endif
+
+/* The total bandwidth that may be reserved */
+
+#define DEADLINE_BW_LIMIT \
+  ((uint32_t)DEADLINE_NCPUS * CONFIG_SCHED_DEADLINE_UTIL * \
+   DEADLINE_BW_ONE / 100)
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* The sum of the bandwidths of all admitted reservations */
+
+static uint32_t g_deadline_bw;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: deadline_replenish
+ *
+ * Description:
+ *   Start a new server period at time 'now' with a full budget.
+ *
+ ****************************************************************************/
+
+static void deadline_replenish(FAR struct deadline_s *dl, clock_t now)
+{
+  dl->abstime = now + dl->deadline;
+  dl->budget  = dl->runtime;
+}
+
+/****************************************************************************
+ * Name: deadline_charge
+ *
+ * Description:
+ *   Charge the thread for the time that it has run since it was resumed
+ *   or last charged.
+ *
+ ****************************************************************************/
+
+static void deadline_charge(FAR struct deadline_s *dl)
+{
+  clock_t now = clock_systime_ticks();
+
+  dl->budget   -= (int32_t)(now - dl->eventtime);
+  dl->eventtime = now;
+}
+
+/****************************************************************************
+ * Name: deadline_unthrottle
+ *
+ * Description:
+ *   Watchdog handler that makes a throttled thread ready-to-run again at
+ *   the start of its next server period.
+ *
+ ****************************************************************************/
+
+static void deadline_unthrottle(wdparm_t arg)
+{
+  FAR struct tcb_s *tcb = (FAR struct tcb_s *)arg;
+  irqstate_t flags;
+
+  flags = enter_critical_section();
+
+  if (tcb->task_state == TSTATE_WAIT_DEADLINE)
+    {
+      up_unblock_task(tcb);
+    }
+
+  leave_critical_section(flags);
+}
+
+/****************************************************************************
+ * Name: deadline_preempted
+ *
+ * Description:
+ *   Return true if some other ready-to-run thread now outranks the running
+ *   thread 'tcb', i.e. after its deadline was postponed.
+ *
+ ****************************************************************************/
+
+static bool deadline_preempted(FAR struct tcb_s *tcb)
+{
+  FAR struct tcb_s *next = tcb->flink;
+
+  if (next != NULL && nxsched_outranks(next, tcb))
+    {
+      return true;
+    }
+
+#ifdef CONFIG_SMP
+  /* tcb->flink only leads to the tasks assigned to this CPU */
+
+  next = (FAR struct tcb_s *)g_readytorun.head;
+  if (next != NULL && CPU_ISSET(tcb->cpu, &next->affinity) &&
+      nxsched_outranks(next, tcb))
+    {
+      return true;
+    }
+#endif
+
+  return false;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxsched_start_deadline
+ *
+ * Description:
+ *   Admit a SCHED_DEADLINE reservation for a thread and start its first
+ *   server period.  If the thread already has a reservation, it is
+ *   replaced.  The caller sets the scheduling policy in the TCB.
+ *
+ * Input Parameters:
+ *   tcb   - The TCB of the thread
+ *   param - The runtime, deadline and period of the reservation.  A zero
+ *           deadline means the period and a zero period means the
+ *           deadline.
+ *
+ * Returned Value:
+ *   Zero (OK) on success, otherwise a negated errno value:
+ *
+ *   EINVAL The condition runtime <= deadline <= period is not met.
+ *   EBUSY  The new reservation would exceed CONFIG_SCHED_DEADLINE_UTIL.
+ *
+ ****************************************************************************/
+
+int nxsched_start_deadline(FAR struct tcb_s *tcb,
+                           FAR const struct sched_param *param)
+{
+  FAR struct deadline_s *dl = &tcb->deadline;
+  irqstate_t flags;
+  sclock_t runtime;
+  sclock_t deadline;
+  sclock_t period;
+  uint32_t bandwidth;
+  uint32_t oldbw;
+
+  DEBUGASSERT(tcb != NULL && param != NULL);
+
+  /* Convert timespec values to system clock ticks */
+
+  clock_time2ticks(&param->sched_dl_runtime, &runtime);
+  clock_time2ticks(&param->sched_dl_deadline, &deadline);
+  clock_time2ticks(&param->sched_dl_period, &period);
+
+  if (deadline <= 0)
+    {
+      deadline = period;
+    }
+
+  if (period <= 0)
+    {
+      period = deadline;
+    }
+
+  if (runtime < 1 || runtime > deadline || deadline > period)
+    {
+      return -EINVAL;
+    }
+
+  bandwidth = (uint32_t)(((uint64_t)runtime << DEADLINE_BW_SHIFT) /
+                         (uint64_t)period);
+
+  /* Admission control:  The reservation of the thread is replaced, so its
+   * current bandwidth does not count against the new one.
+   */
+
+  flags = enter_critical_section();
+
+  oldbw = nxsched_isdeadline(tcb) ? dl->bandwidth : 0;
+  if (g_deadline_bw - oldbw + bandwidth > DEADLINE_BW_LIMIT)
+    {
+      leave_critical_section(flags);
+      return -EBUSY;
+    }
+
+  g_deadline_bw += bandwidth - oldbw;
+
+  dl->runtime   = runtime;
+  dl->deadline  = deadline;
+  dl->period    = period;
+  dl->bandwidth = bandwidth;
+  dl->eventtime = clock_systime_ticks();
+
+  deadline_replenish(dl, dl->eventtime);
+
+  /* A thread throttled by its old reservation may run again */
+
+  if (tcb->task_state == TSTATE_WAIT_DEADLINE)
+    {
+      wd_cancel(&dl->timer);
+      up_unblock_task(tcb);
+    }
+
+  leave_critical_section(flags);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: nxsched_stop_deadline
+ *
+ * Description:
+ *   Release the reservation of a thread that leaves the SCHED_DEADLINE
+ *   policy or exits.  A throttled thread stays blocked, it is up to the
+ *   caller to wake it up if it does not exit.
+ *
+ * Input Parameters:
+ *   tcb - The TCB of the thread
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void nxsched_stop_deadline(FAR struct tcb_s *tcb)
+{
+  irqstate_t flags;
+
+  DEBUGASSERT(tcb != NULL);
+
+  flags = enter_critical_section();
+
+  DEBUGASSERT(g_deadline_bw >= tcb->deadline.bandwidth);
+  g_deadline_bw -= tcb->deadline.bandwidth;
+  tcb->deadline.bandwidth = 0;
+
+  wd_cancel(&tcb->deadline.timer);
+
+  leave_critical_section(flags);
+}
+
+/****************************************************************************
+ * Name: nxsched_wakeup_deadline
+ *
+ * Description:
+ *   Apply the CBS wakeup rule when a deadline thread leaves the blocked
+ *   state:  The current deadline and budget may be kept only if using the
+ *   budget before the deadline would not exceed the reserved bandwidth,
+ *   i.e. if budget / (deadline - now) <= runtime / period.  Otherwise a
+ *   new server period is started now.  This keeps a thread that sleeps
+ *   and wakes at arbitrary times from using more than its share.  An
+ *   exhausted budget is kept until the deadline, so the thread is
+ *   throttled at the next timer event instead of being refilled early.
+ *
+ * Input Parameters:
+ *   tcb - The TCB of the thread, not yet in any ready-to-run list
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   Called from within a critical section.
+ *
+ ****************************************************************************/
+
+void nxsched_wakeup_deadline(FAR struct tcb_s *tcb)
+{
+  FAR struct deadline_s *dl = &tcb->deadline;
+  clock_t now = clock_systime_ticks();
+  sclock_t left = (sclock_t)(dl->abstime - now);
+
+  if (left <= 0 || (dl->budget > 0 &&
+      (uint64_t)dl->budget * dl->period >= (uint64_t)left * dl->runtime))
+    {
+      deadline_replenish(dl, now);
+    }
+}
+
+/****************************************************************************
+ * Name: nxsched_resume_deadline
+ *
+ * Description:
+ *   Called when a deadline thread is about to run.  Start measuring the
+ *   execution time that will be charged to its budget.
+ *
+ * Input Parameters:
+ *   tcb - The TCB of the thread
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void nxsched_resume_deadline(FAR struct tcb_s *tcb)
+{
+  tcb->deadline.eventtime = clock_systime_ticks();
+}
+
+/****************************************************************************
+ * Name: nxsched_suspend_deadline
+ *
+ * Description:
+ *   Called when a deadline thread stops running.  Charge the execution
+ *   time to its budget.  An exhausted budget is dealt with when the
+ *   thread runs again, or when it wakes up after its deadline.
+ *
+ * Input Parameters:
+ *   tcb - The TCB of the thread
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void nxsched_suspend_deadline(FAR struct tcb_s *tcb)
+{
+  deadline_charge(&tcb->deadline);
+}
+
+/****************************************************************************
+ * Name: nxsched_process_deadline
+ *
+ * Description:
+ *   Process the budget of the running deadline thread on a timer event.
+ *   When the budget is exhausted, the thread is throttled:  It is blocked
+ *   until its next server period starts, when it gets the deadline of that
+ *   period and its budget is replenished.  An overrun is paid back from the
+ *   following periods.
+ *
+ * Input Parameters:
+ *   tcb        - The TCB of the running thread
+ *   noswitches - True: Can't do context switches now.
+ *
+ * Returned Value:
+ *   The number of ticks until the budget is exhausted.  The value one
+ *   means that a context switch is needed now but cannot be performed
+ *   because noswitches == true.
+ *
+ * Assumptions:
+ *   Interrupts are disabled.
+ *
+ ****************************************************************************/
+
+uint32_t nxsched_process_deadline(FAR struct tcb_s *tcb, bool noswitches)
+{
+  FAR struct deadline_s *dl = &tcb->deadline;
+  clock_t start;
+  sclock_t delay;
+
+  DEBUGASSERT(nxsched_isdeadline(tcb));
+
+  deadline_charge(dl);
+  if (dl->budget > 0)
+    {
+      return dl->budget;
+    }
+
+  /* The budget is exhausted.  Throttle the thread until the start of the
+   * period in which the overrun has been paid back.  Do it later if the
+   * thread cannot be moved now.
+   */
+
+  if (noswitches || nxsched_islocked_tcb(tcb))
+    {
+      return 1;
+    }
+
+  start = dl->abstime - dl->deadline;
+  do
+    {
+      start       += dl->period;
+      dl->abstime += dl->period;
+      dl->budget  += dl->runtime;
+    }
+  while (dl->budget <= 0);
+
+  delay = (sclock_t)(start - clock_systime_ticks());
+  if (delay > 0)
+    {
+      wd_start(&dl->timer, delay, deadline_unthrottle, (wdparm_t)tcb);
+      up_block_task(tcb, TSTATE_WAIT_DEADLINE);
+      return 0;
+    }
+
+  /* That period has already started, e.g. because the thread ran past
+   * its deadline with the scheduler locked.  Just resetting the task
+   * priority to its current value will place the thread behind any
+   * thread of the same priority with an earlier deadline.
+   */
+
+  if (deadline_preempted(tcb))
+    {
+      up_reprioritize_rtr(tcb, tcb->sched_priority);
+    }
+
+  return dl->budget;
+}
+
+/****************************************************************************
+ * Name: nxsched_get_deadline
+ *
+ * Description:
+ *   Return the reservation of a deadline thread.
+ *
+ * Input Parameters:
+ *   tcb   - The TCB of the thread
+ *   param - The location to return the runtime, deadline and period
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void nxsched_get_deadline(FAR struct tcb_s *tcb,
+                          FAR struct sched_param *param)
+{
+  clock_ticks2time((sclock_t)tcb->deadline.runtime,
+                   &param->sched_dl_runtime);
+  clock_ticks2time((sclock_t)tcb->deadline.deadline,
+                   &param->sched_dl_deadline);
+  clock_ticks2time((sclock_t)tcb->deadline.period,
+                   &param->sched_dl_period);
+}
+
+#endif /* CONFIG_SCHED_DEADLINE */
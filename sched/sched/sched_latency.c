@@ -0,0 +1,151 @@
+/****************************************************************************
+ * sched/sched/sched_latency.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+#include <assert.h>
+
+#include <nuttx/irq.h>
+#include <nuttx/sched.h>
+
+#include "sched/sched.h"
+
+#ifdef CONFIG_SCHED_LATENCY_HIST
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+/* Per-CPU latency histograms.  Each CPU only updates its own row, always
+ * with local interrupts disabled.
+ */
+
+#ifdef CONFIG_SMP_NCPUS
+struct latency_hist_s g_latency_hist[CONFIG_SMP_NCPUS][LATENCY_NTYPES];
+#else
+struct latency_hist_s g_latency_hist[1][LATENCY_NTYPES];
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: latency_add
+ ****************************************************************************/
+
+static inline void latency_add(FAR struct latency_hist_s *hist,
+                               uint32_t elapsed)
+{
+  unsigned int bucket = flsl((long)elapsed);
+
+  if (bucket >= CONFIG_SCHED_LATENCY_NBUCKETS)
+    {
+      bucket = CONFIG_SCHED_LATENCY_NBUCKETS - 1;
+    }
+
+  hist->count[bucket]++;
+  if (elapsed > hist->max)
+    {
+      hist->max = elapsed;
+    }
+}
+
+/****************************************************************************
+ * Name: latency_reset_tcb
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_LATENCY_HIST_PERTASK
+static void latency_reset_tcb(FAR struct tcb_s *tcb, FAR void *arg)
+{
+  memset(tcb->latency, 0, sizeof(tcb->latency));
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxsched_latency_record
+ *
+ * Description:
+ *   Add one elapsed time to the histogram of this CPU and, if enabled and
+ *   a thread is given, to the histogram of that thread.
+ *
+ * Input Parameters:
+ *   tcb     - The thread to charge, or NULL
+ *   type    - One of enum latency_type_e
+ *   elapsed - The elapsed time in up_critmon_gettime() units
+ *
+ * Assumptions:
+ *   - Local interrupts are disabled.
+ *   - May be called from an interrupt handler
+ *
+ ****************************************************************************/
+
+void nxsched_latency_record(FAR struct tcb_s *tcb, int type,
+                            uint32_t elapsed)
+{
+  DEBUGASSERT(type >= 0 && type < LATENCY_NTYPES);
+
+  latency_add(&g_latency_hist[this_cpu()][type], elapsed);
+
+#ifdef CONFIG_SCHED_LATENCY_HIST_PERTASK
+  if (tcb != NULL)
+    {
+      latency_add(&tcb->latency[type], elapsed);
+    }
+#else
+  UNUSED(tcb);
+#endif
+}
+
+/****************************************************************************
+ * Name: nxsched_latency_reset
+ *
+ * Description:
+ *   Clear the per-CPU latency histograms and, if enabled, the histograms
+ *   of every thread.
+ *
+ ****************************************************************************/
+
+void nxsched_latency_reset(void)
+{
+  irqstate_t flags;
+
+  flags = enter_critical_section();
+  memset(g_latency_hist, 0, sizeof(g_latency_hist));
+
+#ifdef CONFIG_SCHED_LATENCY_HIST_PERTASK
+  nxsched_foreach(latency_reset_tcb, NULL);
+#endif
+
+  leave_critical_section(flags);
+}
+
+#endif /* CONFIG_SCHED_LATENCY_HIST */
@@ -36,12 +36,6 @@
 #include "irq/irq.h"
 #include "sched/sched.h"
 
-/****************************************************************************
- * Pre-processor Definitions
- ****************************************************************************/
-
-#define ALL_CPUS ((cpu_set_t)-1)
-
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -99,7 +93,7 @@ bool nxsched_merge_pending(void)
        */
 
       for (;
-           (rtcb && ptcb->sched_priority <= rtcb->sched_priority);
+           (rtcb && !nxsched_outranks(ptcb, rtcb));
            rtcb = rtcb->flink)
         {
         }
@@ -203,7 +197,7 @@ bool nxsched_merge_pending(void)
           goto errout;
         }
 
-      cpu  = nxsched_select_cpu(ALL_CPUS); /* REVISIT:  Maybe ptcb->affinity */
+      cpu  = nxsched_select_cpu(ptcb);
       rtcb = current_task(cpu);
 
       /* Loop while there is a higher priority task in the pending task list
@@ -215,7 +209,7 @@ bool nxsched_merge_pending(void)
        * end up in the g_readytorun list.
        */
 
-      while (ptcb->sched_priority > rtcb->sched_priority)
+      while (nxsched_outranks(ptcb, rtcb))
         {
           /* Remove the task from the pending task list */
 
@@ -259,7 +253,7 @@ bool nxsched_merge_pending(void)
               goto errout;
             }
 
-          cpu  = nxsched_select_cpu(ALL_CPUS); /* REVISIT:  Maybe ptcb->affinity */
+          cpu  = nxsched_select_cpu(ptcb);
           rtcb = current_task(cpu);
         }
 
@@ -270,6 +264,7 @@ bool nxsched_merge_pending(void)
       nxsched_merge_prioritized((FAR dq_queue_t *)&g_pendingtasks,
                                 (FAR dq_queue_t *)&g_readytorun,
                                 TSTATE_TASK_READYTORUN);
+      nxsched_balance_hint();
     }
 
 errout:
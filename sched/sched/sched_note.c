@@ -787,6 +787,57 @@ void sched_note_irqhandler(int irq, FAR void *handler, bool enter)
 }
 #endif
 
+#ifdef CONFIG_SCHED_INSTRUMENTATION_PRIOINHERIT
+void sched_note_prio_boost(FAR struct tcb_s *tcb, FAR struct tcb_s *wtcb,
+                           int priority, int depth)
+{
+  struct note_prioinherit_s note;
+
+  if (!note_isenabled())
+    {
+      return;
+    }
+
+  /* Format the note */
+
+  note_common(tcb, &note.npi_cmn, sizeof(struct note_prioinherit_s),
+              NOTE_PRIO_BOOST);
+  note.npi_priority  = (uint8_t)priority;
+  note.npi_depth     = (uint8_t)depth;
+  note.npi_waiter[0] = (uint8_t)(wtcb->pid & 0xff);
+  note.npi_waiter[1] = (uint8_t)((wtcb->pid >> 8) & 0xff);
+
+  /* Add the note to circular buffer */
+
+  sched_note_add((FAR const uint8_t *)&note,
+                 sizeof(struct note_prioinherit_s));
+}
+
+void sched_note_prio_restore(FAR struct tcb_s *tcb, int priority)
+{
+  struct note_prioinherit_s note;
+
+  if (!note_isenabled())
+    {
+      return;
+    }
+
+  /* Format the note */
+
+  note_common(tcb, &note.npi_cmn, sizeof(struct note_prioinherit_s),
+              NOTE_PRIO_RESTORE);
+  note.npi_priority  = (uint8_t)priority;
+  note.npi_depth     = 0;
+  note.npi_waiter[0] = 0;
+  note.npi_waiter[1] = 0;
+
+  /* Add the note to circular buffer */
+
+  sched_note_add((FAR const uint8_t *)&note,
+                 sizeof(struct note_prioinherit_s));
+}
+#endif
+
 #ifdef CONFIG_SCHED_INSTRUMENTATION_FILTER
 
 /****************************************************************************
@@ -72,4 +72,15 @@ void nxsched_remove_blocked(FAR struct tcb_s *btcb)
    */
 
   btcb->task_state = TSTATE_TASK_INVALID;
+
+#ifdef CONFIG_SCHED_DEADLINE
+  /* A deadline thread that wakes up may need a new deadline.  A throttled
+   * thread already got the deadline of its new period.
+   */
+
+  if (nxsched_isdeadline(btcb) && task_state != TSTATE_WAIT_DEADLINE)
+    {
+      nxsched_wakeup_deadline(btcb);
+    }
+#endif
 }
@@ -209,20 +209,24 @@ bool nxsched_remove_readytorun(FAR struct tcb_s *rtcb)
 
       if (rtrtcb != NULL && rtrtcb->sched_priority >= nxttcb->sched_priority)
         {
-          FAR struct tcb_s *tmptcb;
-
-          /* The TCB at the head of the ready to run list has the higher
-           * priority.  Remove that task from the head of the g_readytorun
-           * list and add to the head of the g_assignedtasks[cpu] list.
+          /* The TCB from the g_readytorun list has the higher priority.
+           * Remove that task from the g_readytorun list (it is not
+           * necessarily the head if the affinity of the head excludes this
+           * CPU) and add to the head of the g_assignedtasks[cpu] list.
            */
 
-          tmptcb = (FAR struct tcb_s *)
-            dq_remfirst((FAR dq_queue_t *)&g_readytorun);
+          dq_rem((FAR dq_entry_t *)rtrtcb, (FAR dq_queue_t *)&g_readytorun);
+          dq_addfirst((FAR dq_entry_t *)rtrtcb, tasklist);
 
-          dq_addfirst((FAR dq_entry_t *)tmptcb, tasklist);
+#ifdef CONFIG_SCHED_LOADBALANCE
+          if (rtrtcb->last_run != 0 && rtrtcb->cpu != cpu)
+            {
+              g_rqstats[cpu].migrations++;
+            }
 
-          tmptcb->cpu = cpu;
-          nxttcb = tmptcb;
+#endif
+          rtrtcb->cpu = cpu;
+          nxttcb = rtrtcb;
         }
 
       /* Will pre-emption be disabled after the switch?  If the lockcount is
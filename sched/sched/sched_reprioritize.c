@@ -28,9 +28,11 @@
 #include <sched.h>
 #include <errno.h>
 
+#include <nuttx/irq.h>
 #include <nuttx/sched.h>
 
 #include "sched/sched.h"
+#include "semaphore/semaphore.h"
 
 #ifdef CONFIG_PRIORITY_INHERITANCE
 
@@ -42,7 +44,9 @@
  * Name:  nxsched_reprioritize
  *
  * Description:
- *   This function sets the priority of a specified task.
+ *   This function sets the base priority of a specified task.  The task
+ *   runs at the higher of the new base priority and any priority that it
+ *   currently inherits from threads waiting for semaphores that it holds.
  *
  *   NOTE: Setting a task's priority to the same value has a similar effect
  *   to sched_yield() -- The task will be moved to  after all other tasks
@@ -65,27 +69,40 @@
 
 int nxsched_reprioritize(FAR struct tcb_s *tcb, int sched_priority)
 {
-  /* This function is equivalent to nxsched_set_priority() BUT it also has
-   * the side effect of discarding all priority inheritance history.  This
-   * is done only on explicit, user-initiated reprioritization.
+  irqstate_t flags;
+  int ret;
+
+  /* This function is equivalent to nxsched_set_priority() BUT it also
+   * changes the base priority and discards the pending reprioritizations
+   * of the work queues.  The priority inherited through semaphores is not
+   * history; it is recomputed from the semaphores that are still held.
    */
 
-  int ret = nxsched_set_priority(tcb, sched_priority);
-  if (ret == 0)
+  if (sched_priority < SCHED_PRIORITY_MIN ||
+      sched_priority > SCHED_PRIORITY_MAX)
     {
-      /* Reset the base_priority -- the priority that the thread would return
-       * to once it posts the semaphore.
-       */
+      return -EINVAL;
+    }
+
+  flags = enter_critical_section();
 
-      tcb->base_priority  = (uint8_t)sched_priority;
+  /* Reset the base_priority -- the priority that the thread would return
+   * to once it posts the semaphore.
+   */
+
+  tcb->base_priority = (uint8_t)sched_priority;
 
+  ret = nxsched_set_priority(tcb, nxsem_effective_priority(tcb));
+  if (ret == 0)
+    {
       /* Discard any pending reprioritizations as well */
 
 #if CONFIG_SEM_NNESTPRIO > 0
-      tcb->npend_reprio   = 0;
+      tcb->npend_reprio = 0;
 #endif
     }
 
+  leave_critical_section(flags);
   return ret;
 }
 #endif /* CONFIG_PRIORITY_INHERITANCE */
@@ -71,6 +71,7 @@
  *          current scheduling policy.
  *   EPERM  The calling task does not have appropriate privileges.
  *   ESRCH  The task whose ID is pid could not be found.
+ *   EBUSY  A SCHED_DEADLINE reservation could not be admitted.
  *
  ****************************************************************************/
 
@@ -78,6 +79,7 @@ int nxsched_set_param(pid_t pid, FAR const struct sched_param *param)
 {
   FAR struct tcb_s *rtcb;
   FAR struct tcb_s *tcb;
+  int priority;
   int ret;
 
   /* Verify that the requested priority is in the valid range */
@@ -87,6 +89,8 @@ int nxsched_set_param(pid_t pid, FAR const struct sched_param *param)
       return -EINVAL;
     }
 
+  priority = param->sched_priority;
+
   /* Prohibit modifications to the head of the ready-to-run task
    * list while adjusting the priority
    */
@@ -203,9 +207,28 @@ int nxsched_set_param(pid_t pid, FAR const struct sched_param *param)
     }
 #endif
 
+#ifdef CONFIG_SCHED_DEADLINE
+  /* Replace the reservation of a SCHED_DEADLINE thread */
+
+  if (nxsched_isdeadline(tcb))
+    {
+      ret = nxsched_start_deadline(tcb, param);
+      if (ret < 0)
+        {
+          goto errout_with_lock;
+        }
+
+      /* All deadline threads share one priority, so that they are ordered
+       * by their deadlines alone.
+       */
+
+      priority = CONFIG_SCHED_DEADLINE_PRIORITY;
+    }
+#endif
+
   /* Then perform the reprioritization */
 
-  ret = nxsched_reprioritize(tcb, param->sched_priority);
+  ret = nxsched_reprioritize(tcb, priority);
 
 errout_with_lock:
   sched_unlock();
@@ -239,6 +262,7 @@ errout_with_lock:
  *         current scheduling policy.
  *  EPERM  The calling task does not have appropriate privileges.
  *  ESRCH  The task whose ID is pid could not be found.
+ *  EBUSY  A SCHED_DEADLINE reservation could not be admitted.
  *
  * Assumptions:
  *
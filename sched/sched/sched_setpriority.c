@@ -34,6 +34,7 @@
 
 #include "irq/irq.h"
 #include "sched/sched.h"
+#include "semaphore/semaphore.h"
 
 /****************************************************************************
  * Private Functions
@@ -189,7 +190,7 @@ static void nxsched_readytorun_setpriority(FAR struct tcb_s *tcb,
 
   if (tcb->task_state == TSTATE_TASK_READYTORUN)
     {
-      cpu = nxsched_select_cpu(tcb->affinity);
+      cpu = nxsched_select_cpu(tcb);
     }
 
   /* CASE 2b.  The task is ready to run, and assigned to a CPU.  An increase
@@ -303,6 +304,17 @@ static inline void nxsched_blocked_setpriority(FAR struct tcb_s *tcb,
 
       tcb->sched_priority = (uint8_t)sched_priority;
     }
+
+#ifdef CONFIG_PRIORITY_INHERITANCE
+  /* A task waiting for a semaphore is also queued in the semaphore's
+   * prioritized list of waiters.
+   */
+
+  if (task_state == TSTATE_WAIT_SEM && tcb->waitsem != NULL)
+    {
+      nxsem_reorder_waiter(tcb);
+    }
+#endif
 }
 
 /****************************************************************************
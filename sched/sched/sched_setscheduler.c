@@ -72,6 +72,7 @@
  *
  *   EINVAL The scheduling policy is not one of the recognized policies.
  *   ESRCH  The task whose ID is pid could not be found.
+ *   EBUSY  A SCHED_DEADLINE reservation could not be admitted.
  *
  ****************************************************************************/
 
@@ -90,6 +91,9 @@ int nxsched_set_scheduler(pid_t pid, int policy,
 #endif
 #ifdef CONFIG_SCHED_SPORADIC
       && policy != SCHED_SPORADIC
+#endif
+#ifdef CONFIG_SCHED_DEADLINE
+      && policy != SCHED_DEADLINE
 #endif
      )
     {
@@ -120,6 +124,33 @@ int nxsched_set_scheduler(pid_t pid, int policy,
   /* Further, disable timer interrupts while we set up scheduling policy. */
 
   flags = enter_critical_section();
+
+#ifdef CONFIG_SCHED_DEADLINE
+  /* Admit the new deadline reservation or release the old one.  This must
+   * be done while the TCB still holds the old policy.
+   */
+
+  if (policy == SCHED_DEADLINE)
+    {
+      ret = nxsched_start_deadline(tcb, param);
+      if (ret < 0)
+        {
+          goto errout_with_irq;
+        }
+    }
+  else if (nxsched_isdeadline(tcb))
+    {
+      nxsched_stop_deadline(tcb);
+
+      /* A thread throttled by its old reservation may run again */
+
+      if (tcb->task_state == TSTATE_WAIT_DEADLINE)
+        {
+          up_unblock_task(tcb);
+        }
+    }
+#endif
+
   tcb->flags &= ~TCB_FLAG_POLICY_MASK;
   switch (policy)
     {
@@ -258,6 +289,16 @@ int nxsched_set_scheduler(pid_t pid, int policy,
         break;
 #endif
 
+#ifdef CONFIG_SCHED_DEADLINE
+      case SCHED_DEADLINE:
+        {
+          /* The reservation was admitted above */
+
+          tcb->flags |= TCB_FLAG_SCHED_DEADLINE;
+        }
+        break;
+#endif
+
 #if 0 /* Not supported */
       case SCHED_OTHER:
         tcb->flags    |= TCB_FLAG_SCHED_OTHER;
@@ -267,13 +308,25 @@ int nxsched_set_scheduler(pid_t pid, int policy,
 
   leave_critical_section(flags);
 
-  /* Set the new priority */
+  /* Set the new priority.  All deadline threads share one priority so
+   * that they are ordered by their deadlines alone.
+   */
+
+#ifdef CONFIG_SCHED_DEADLINE
+  if (policy == SCHED_DEADLINE)
+    {
+      ret = nxsched_reprioritize(tcb, CONFIG_SCHED_DEADLINE_PRIORITY);
+    }
+  else
+#endif
+    {
+      ret = nxsched_reprioritize(tcb, param->sched_priority);
+    }
 
-  ret = nxsched_reprioritize(tcb, param->sched_priority);
   sched_unlock();
   return ret;
 
-#ifdef CONFIG_SCHED_SPORADIC
+#if defined(CONFIG_SCHED_SPORADIC) || defined(CONFIG_SCHED_DEADLINE)
 errout_with_irq:
   leave_critical_section(flags);
   sched_unlock();
@@ -307,6 +360,7 @@ errout_with_irq:
  *
  *   EINVAL The scheduling policy is not one of the recognized policies.
  *   ESRCH  The task whose ID is pid could not be found.
+ *   EBUSY  A SCHED_DEADLINE reservation could not be admitted.
  *
  ****************************************************************************/
 
@@ -68,6 +68,23 @@ void nxsched_suspend_scheduler(FAR struct tcb_s *tcb)
     }
 #endif
 
+#ifdef CONFIG_SCHED_DEADLINE
+  /* Charge the execution time to the deadline budget */
+
+  if ((tcb->flags & TCB_FLAG_POLICY_MASK) == TCB_FLAG_SCHED_DEADLINE)
+    {
+      nxsched_suspend_deadline(tcb);
+    }
+#endif
+
+#ifdef CONFIG_SCHED_LOADBALANCE
+  /* Remember when the task left its CPU.  This is used to judge whether
+   * its working set is still in that CPU's cache.
+   */
+
+  tcb->last_run = clock_systime_ticks();
+#endif
+
   /* Indicate that the task has been suspended */
 
 #ifdef CONFIG_SCHED_CRITMONITOR
@@ -24,10 +24,16 @@
 
 #include <nuttx/config.h>
 
+#include <stdint.h>
 #include <sched.h>
 #include <assert.h>
 #include <debug.h>
+
 #include <nuttx/arch.h>
+#include <nuttx/init.h>
+#include <nuttx/irq.h>
+#include <nuttx/kmalloc.h>
+#include <nuttx/sched_note.h>
 
 #include "sched/sched.h"
 #include "semaphore/semaphore.h"
@@ -44,6 +50,19 @@
 #  define CONFIG_SEM_PREALLOCHOLDERS 0
 #endif
 
+#ifndef CONFIG_SEM_PI_CHAINDEPTH
+#  define CONFIG_SEM_PI_CHAINDEPTH 8
+#endif
+
+/* When the holder pool may grow, it is refilled with SEM_HOLDERS_BATCH
+ * records whenever fewer than SEM_HOLDERS_LOWATER records are free.
+ */
+
+#ifdef CONFIG_SEM_HOLDERS_DYNAMIC
+#  define SEM_HOLDERS_LOWATER 4
+#  define SEM_HOLDERS_BATCH   8
+#endif
+
 /****************************************************************************
  * Private Type Declarations
  ****************************************************************************/
@@ -51,6 +70,20 @@
 typedef int (*holderhandler_t)(FAR struct semholder_s *pholder,
                                FAR sem_t *sem, FAR void *arg);
 
+/* State passed along an inheritance chain */
+
+struct semchain_s
+{
+  FAR struct tcb_s *wtcb;        /* The waiter that started the chain */
+  int depth;                     /* Number of semaphores traversed */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static void nxsem_adjustprio(FAR struct tcb_s *htcb, int depth);
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
@@ -60,13 +93,28 @@ typedef int (*holderhandler_t)(FAR struct semholder_s *pholder,
 #if CONFIG_SEM_PREALLOCHOLDERS > 0
 static struct semholder_s g_holderalloc[CONFIG_SEM_PREALLOCHOLDERS];
 static FAR struct semholder_s *g_freeholders;
+static int g_nfreeholders;
+#endif
+
+#ifdef CONFIG_SEM_HOLDERS_DYNAMIC
+static bool g_growing;
 #endif
 
+/* Number of holder records in use */
+
+static int g_nholders;
+
 /****************************************************************************
  * Name: nxsem_allocholder
+ *
+ * Description:
+ *   Allocate a holder record for htcb and link it both into the list of
+ *   holders of the semaphore and into the list of semaphores held by htcb.
+ *
  ****************************************************************************/
 
-static inline FAR struct semholder_s *nxsem_allocholder(sem_t *sem)
+static FAR struct semholder_s *nxsem_allocholder(FAR sem_t *sem,
+                                                 FAR struct tcb_s *htcb)
 {
   FAR struct semholder_s *pholder;
 
@@ -84,42 +132,43 @@ static inline FAR struct semholder_s *nxsem_allocholder(sem_t *sem)
        */
 
       g_freeholders    = pholder->flink;
+      g_nfreeholders--;
       pholder->flink   = sem->hhead;
       sem->hhead       = pholder;
-
-      /* Make sure the initial count is zero */
-
-      pholder->counts  = 0;
     }
 #else
   if (sem->holder[0].htcb == NULL)
     {
       pholder          = &sem->holder[0];
-      pholder->counts  = 0;
     }
   else if (sem->holder[1].htcb == NULL)
     {
       pholder          = &sem->holder[1];
-      pholder->counts  = 0;
     }
 #endif
   else
     {
       serr("ERROR: Insufficient pre-allocated holders\n");
-      pholder          = NULL;
+      DEBUGPANIC();
+      return NULL;
     }
 
-  DEBUGASSERT(pholder != NULL);
+  /* Make sure the initial count is zero and add the semaphore to the list
+   * of semaphores held by the thread.
+   */
+
+  pholder->sem     = sem;
+  pholder->htcb    = htcb;
+  pholder->counts  = 0;
+  pholder->tlink   = htcb->holdsem;
+  htcb->holdsem    = pholder;
+  g_nholders++;
+
   return pholder;
 }
 
 /****************************************************************************
  * Name: nxsem_findholder
- *
- * NOTE: htcb may be used only as a look-up key.  It certain cases, the task
- * may have exited and htcb may refer to a stale memory.  It must not be
- * dereferenced.
- *
  ****************************************************************************/
 
 static FAR struct semholder_s *nxsem_findholder(sem_t *sem,
@@ -143,7 +192,6 @@ static FAR struct semholder_s *nxsem_findholder(sem_t *sem,
     }
 #else
   int i;
-  pholder = NULL;
 
   /* We have two hard-allocated holder structures in sem_t */
 
@@ -165,37 +213,61 @@ static FAR struct semholder_s *nxsem_findholder(sem_t *sem,
 }
 
 /****************************************************************************
- * Name: nxsem_findorallocateholder
+ * Name: nxsem_discardholder
+ *
+ * Description:
+ *   Release a holder record that has already been unlinked from the lists
+ *   of its semaphore and of its holder thread.
+ *
  ****************************************************************************/
 
-static inline FAR struct semholder_s *
-nxsem_findorallocateholder(sem_t *sem, FAR struct tcb_s *htcb)
+static void nxsem_discardholder(FAR struct semholder_s *pholder)
 {
-  FAR struct semholder_s *pholder = nxsem_findholder(sem, htcb);
-  if (!pholder)
-    {
-      pholder = nxsem_allocholder(sem);
-    }
+  pholder->tlink  = NULL;
+  pholder->sem    = NULL;
+  pholder->htcb   = NULL;
+  pholder->counts = 0;
+  g_nholders--;
 
-  return pholder;
+#if CONFIG_SEM_PREALLOCHOLDERS > 0
+  /* Put it in the free list */
+
+  pholder->flink = g_freeholders;
+  g_freeholders  = pholder;
+  g_nfreeholders++;
+#endif
 }
 
 /****************************************************************************
  * Name: nxsem_freeholder
  ****************************************************************************/
 
-static inline void nxsem_freeholder(sem_t *sem,
-                                    FAR struct semholder_s *pholder)
+static void nxsem_freeholder(sem_t *sem, FAR struct semholder_s *pholder)
 {
-#if CONFIG_SEM_PREALLOCHOLDERS > 0
+  FAR struct tcb_s *htcb = pholder->htcb;
   FAR struct semholder_s *curr;
   FAR struct semholder_s *prev;
-#endif
 
-  /* Release the holder and counts */
+  /* Remove the holder from the list of semaphores held by the thread */
 
-  pholder->htcb   = NULL;
-  pholder->counts = 0;
+  if (htcb != NULL)
+    {
+      for (prev = NULL, curr = htcb->holdsem;
+           curr != NULL && curr != pholder;
+           prev = curr, curr = curr->tlink);
+
+      if (curr != NULL)
+        {
+          if (prev != NULL)
+            {
+              prev->tlink = pholder->tlink;
+            }
+          else
+            {
+              htcb->holdsem = pholder->tlink;
+            }
+        }
+    }
 
 #if CONFIG_SEM_PREALLOCHOLDERS > 0
   /* Search the list for the matching holder */
@@ -216,32 +288,10 @@ static inline void nxsem_freeholder(sem_t *sem,
         {
           sem->hhead = pholder->flink;
         }
-
-      /* And put it in the free list */
-
-      pholder->flink = g_freeholders;
-      g_freeholders  = pholder;
     }
 #endif
-}
-
-/****************************************************************************
- * Name: nxsem_findandfreeholder
- ****************************************************************************/
-
-static inline void nxsem_findandfreeholder(sem_t *sem,
-                                           FAR struct tcb_s *htcb)
-{
-  FAR struct semholder_s *pholder = nxsem_findholder(sem, htcb);
-
-  /* When no more counts are held, remove the holder from the list.  The
-   * count was decremented in nxsem_release_holder.
-   */
 
-  if (pholder != NULL && pholder->counts <= 0)
-    {
-      nxsem_freeholder(sem, pholder);
-    }
+  nxsem_discardholder(pholder);
 }
 
 /****************************************************************************
@@ -279,7 +329,7 @@ static int nxsem_foreachholder(FAR sem_t *sem, holderhandler_t handler,
 
   /* We have two hard-allocated holder structures in sem_t */
 
-  for (i = 0; i < 2; i++)
+  for (i = 0; i < 2 && ret == 0; i++)
     {
       pholder = &sem->holder[i];
 
@@ -301,388 +351,273 @@ static int nxsem_foreachholder(FAR sem_t *sem, holderhandler_t handler,
  * Name: nxsem_recoverholders
  ****************************************************************************/
 
-#if CONFIG_SEM_PREALLOCHOLDERS > 0
 static int nxsem_recoverholders(FAR struct semholder_s *pholder,
                                 FAR sem_t *sem, FAR void *arg)
 {
+  FAR struct tcb_s *htcb = pholder->htcb;
+
   nxsem_freeholder(sem, pholder);
+
+  /* The thread may have inherited its priority from the waiters of this
+   * semaphore.
+   */
+
+  nxsem_adjustprio(htcb, 0);
   return 0;
 }
-#endif
 
 /****************************************************************************
- * Name: nxsem_boostholderprio
+ * Name: nxsem_addwaiter
+ *
+ * Description:
+ *   Add a thread to the list of threads waiting for the semaphore.  The
+ *   list is kept in priority order, threads of equal priority in FIFO
+ *   order, so the head is always the waiter that will receive the next
+ *   count and the one that bounds the priority of the holders.
+ *
  ****************************************************************************/
 
-static int nxsem_boostholderprio(FAR struct semholder_s *pholder,
-                                 FAR sem_t *sem, FAR void *arg)
+static void nxsem_addwaiter(FAR sem_t *sem, FAR struct tcb_s *wtcb)
 {
-  FAR struct tcb_s *htcb = (FAR struct tcb_s *)pholder->htcb;
-  FAR struct tcb_s *rtcb = (FAR struct tcb_s *)arg;
+  FAR struct tcb_s *prev;
+  FAR struct tcb_s *curr;
 
-  /* Make sure that the holder thread is still active.  If it exited without
-   * releasing its counts, then that would be a bad thing.  But we can take
-   * no real action because we don't know what the program is doing.
-   * Perhaps its plan is to kill a thread, then destroy the semaphore.
-   */
+  for (prev = NULL, curr = sem->waitlist;
+       curr != NULL && curr->sched_priority >= wtcb->sched_priority;
+       prev = curr, curr = curr->waitlink);
 
-  if (!nxsched_verify_tcb(htcb))
+  wtcb->waitlink = curr;
+  if (prev != NULL)
     {
-      swarn("WARNING: TCB %p is a stale handle, counts lost\n", htcb);
-      nxsem_freeholder(sem, pholder);
+      prev->waitlink = wtcb;
     }
-
-#if CONFIG_SEM_NNESTPRIO > 0
-  /* If the priority of the thread that is waiting for a count is greater
-   * than the base priority of the thread holding a count, then we may need
-   * to adjust the holder's priority now or later to that priority.
-   */
-
-  else if (rtcb->sched_priority > htcb->base_priority)
+  else
     {
-      /* If the new priority is greater than the current, possibly already
-       * boosted priority of the holder thread, then we will have to raise
-       * the holder's priority now.
-       */
+      sem->waitlist = wtcb;
+    }
+}
 
-      if (rtcb->sched_priority > htcb->sched_priority)
-        {
-          /* If the current priority of holder thread has already been
-           * boosted, then add the boost priority to the list of restoration
-           * priorities.  When the higher priority waiter thread gets its
-           * count, then we need to revert the holder thread to this saved
-           * priority (not to its base priority).
-           */
-
-          if (htcb->sched_priority > htcb->base_priority)
-            {
-              /* Save the current, boosted priority of the holder thread. */
-
-              if (htcb->npend_reprio < CONFIG_SEM_NNESTPRIO)
-                {
-                  htcb->pend_reprios[htcb->npend_reprio] =
-                    htcb->sched_priority;
-                  htcb->npend_reprio++;
-                }
-              else
-                {
-                  serr("ERROR: CONFIG_SEM_NNESTPRIO exceeded\n");
-                  DEBUGASSERT(htcb->npend_reprio < CONFIG_SEM_NNESTPRIO);
-                }
-            }
+/****************************************************************************
+ * Name: nxsem_remwaiter
+ ****************************************************************************/
+
+static void nxsem_remwaiter(FAR sem_t *sem, FAR struct tcb_s *wtcb)
+{
+  FAR struct tcb_s *prev;
+  FAR struct tcb_s *curr;
 
-          /* Raise the priority of the thread holding of the semaphore.
-           * This cannot cause a context switch because we have preemption
-           * disabled.  The holder thread may be marked "pending" and the
-           * switch may occur during up_block_task() processing.
-           */
+  for (prev = NULL, curr = sem->waitlist;
+       curr != NULL && curr != wtcb;
+       prev = curr, curr = curr->waitlink);
 
-          nxsched_set_priority(htcb, rtcb->sched_priority);
+  if (curr != NULL)
+    {
+      if (prev != NULL)
+        {
+          prev->waitlink = wtcb->waitlink;
         }
       else
         {
-          /* The new priority is above the base priority of the holder,
-           * but not as high as its current working priority.  Just put it
-           * in the list of pending restoration priorities so that when the
-           * higher priority thread gets its count, we can revert to this
-           * saved priority and not to the base priority.
-           */
-
-          if (htcb->npend_reprio < CONFIG_SEM_NNESTPRIO)
-            {
-              htcb->pend_reprios[htcb->npend_reprio] = rtcb->sched_priority;
-              htcb->npend_reprio++;
-            }
-          else
-            {
-              serr("ERROR: CONFIG_SEM_NNESTPRIO exceeded\n");
-              DEBUGASSERT(htcb->npend_reprio < CONFIG_SEM_NNESTPRIO);
-            }
+          sem->waitlist = wtcb->waitlink;
         }
     }
 
-#else
-  /* If the priority of the thread that is waiting for a count is less than
-   * or equal to the priority of the thread holding a count, then do nothing
-   * because the thread is already running at a sufficient priority.
-   */
-
-  else if (rtcb->sched_priority > htcb->sched_priority)
-    {
-      /* Raise the priority of the holder of the semaphore.  This
-       * cannot cause a context switch because we have preemption
-       * disabled.  The task will be marked "pending" and the switch
-       * will occur during up_block_task() processing.
-       */
-
-      nxsched_set_priority(htcb, rtcb->sched_priority);
-    }
-#endif
-
-  return 0;
+  wtcb->waitlink = NULL;
 }
 
 /****************************************************************************
- * Name: nxsem_verifyholder
+ * Name: nxsem_topwaiter
+ *
+ * Description:
+ *   Return the highest priority thread waiting for any of the semaphores
+ *   held by htcb, or NULL if there is none.
+ *
  ****************************************************************************/
 
-#ifdef CONFIG_DEBUG_ASSERTIONS
-static int nxsem_verifyholder(FAR struct semholder_s *pholder,
-                              FAR sem_t *sem, FAR void *arg)
+static FAR struct tcb_s *nxsem_topwaiter(FAR struct tcb_s *htcb)
 {
-  /* Need to revisit this, but these assumptions seem to be untrue -- OR
-   * there is a bug???
-   */
-
-#if 0
-  FAR struct tcb_s *htcb = (FAR struct tcb_s *)pholder->htcb;
+  FAR struct semholder_s *pholder;
+  FAR struct tcb_s *wtcb;
+  FAR struct tcb_s *top = NULL;
 
-  /* Called after a semaphore has been released (incremented), the semaphore
-   * could be non-negative, and there is no thread waiting for the count.
-   * In this case, the priority of the holder should not be boosted.
-   */
+  for (pholder = htcb->holdsem; pholder != NULL; pholder = pholder->tlink)
+    {
+      wtcb = pholder->sem->waitlist;
+      if (wtcb != NULL &&
+          (top == NULL || wtcb->sched_priority > top->sched_priority))
+        {
+          top = wtcb;
+        }
+    }
 
-#if CONFIG_SEM_NNESTPRIO > 0
-  DEBUGASSERT(htcb->npend_reprio == 0);
-#endif
-  DEBUGASSERT(htcb->sched_priority == htcb->base_priority);
-#endif
-  return 0;
+  return top;
 }
-#endif
 
 /****************************************************************************
- * Name: nxsem_dumpholder
+ * Name: nxsem_chainholders
+ *
+ * Description:
+ *   If htcb is itself blocked waiting for a semaphore, return that
+ *   semaphore so that the change of the priority of htcb can be passed on
+ *   to its holders.  NULL is returned when the end of the chain, or the
+ *   maximum depth of the chain, is reached.
+ *
  ****************************************************************************/
 
-#if defined(CONFIG_DEBUG_INFO) && defined(CONFIG_SEM_PHDEBUG)
-static int nxsem_dumpholder(FAR struct semholder_s *pholder, FAR sem_t *sem,
-                            FAR void *arg)
+static FAR sem_t *nxsem_chainholders(FAR struct tcb_s *htcb, int depth)
 {
-#if CONFIG_SEM_PREALLOCHOLDERS > 0
-  _info("  %08x: %08x %08x %04x\n",
-        pholder, pholder->flink, pholder->htcb, pholder->counts);
-#else
-  _info("  %08x: %08x %04x\n", pholder, pholder->htcb, pholder->counts);
-#endif
-  return 0;
+  if (htcb->task_state == TSTATE_WAIT_SEM && htcb->waitsem != NULL &&
+      depth < CONFIG_SEM_PI_CHAINDEPTH)
+    {
+      return htcb->waitsem;
+    }
+
+  return NULL;
 }
-#endif
 
 /****************************************************************************
- * Name: nxsem_restoreholderprio
+ * Name: nxsem_boostholderprio
  ****************************************************************************/
 
-static int nxsem_restoreholderprio(FAR struct tcb_s *htcb,
-                                   FAR sem_t *sem, FAR void *arg)
+static int nxsem_boostholderprio(FAR struct semholder_s *pholder,
+                                 FAR sem_t *sem, FAR void *arg)
 {
-  FAR struct semholder_s *pholder = 0;
-#if CONFIG_SEM_NNESTPRIO > 0
-  FAR struct tcb_s *stcb = (FAR struct tcb_s *)arg;
-  int rpriority;
-  int i;
-  int j;
-#endif
+  FAR struct semchain_s *chain = (FAR struct semchain_s *)arg;
+  FAR struct tcb_s *htcb = pholder->htcb;
+  FAR struct tcb_s *wtcb = chain->wtcb;
+  FAR sem_t *next;
 
-  /* Make sure that the holder thread is still active.  If it exited without
-   * releasing its counts, then that would be a bad thing.  But we can take
-   * no real action because we don't know what the program is doing.
-   * Perhaps its plan is to kill a thread, then destroy the semaphore.
+  /* If the priority of the thread that is waiting for a count is less than
+   * or equal to the priority of the thread holding a count, then do nothing
+   * because the thread is already running at a sufficient priority.  The
+   * holder will not drop below the waiter's priority until the waiter is
+   * gone from the list of waiters.
    */
 
-  if (!nxsched_verify_tcb(htcb))
+  if (wtcb->sched_priority <= htcb->sched_priority)
     {
-      swarn("WARNING: TCB %p is a stale handle, counts lost\n", htcb);
-
-      pholder = nxsem_findholder(sem, htcb);
-      if (pholder != NULL)
-        {
-          nxsem_freeholder(sem, pholder);
-        }
+      return 0;
     }
 
-  /* Was the priority of the holder thread boosted? If so, then drop its
-   * priority back to the correct level.  What is the correct level?
+  /* Raise the priority of the holder of the semaphore.  This cannot cause
+   * a context switch because we have preemption disabled.  The task will
+   * be marked "pending" and the switch will occur during up_block_task()
+   * processing.
    */
 
-  else if (htcb->sched_priority != htcb->base_priority)
-    {
-#if CONFIG_SEM_NNESTPRIO > 0
-      /* Are there other, pending priority levels to revert to? */
-
-      if (htcb->npend_reprio < 1)
-        {
-          /* No... the holder thread has only been boosted once.
-           * npend_reprio should be 0 and the boosted priority should be the
-           * priority of the task that just got the semaphore
-           * (stcb->sched_priority)
-           *
-           * That latter assumption may not be true if the stcb's priority
-           * was also boosted so that it no longer matches the htcb's
-           * sched_priority.  Or if CONFIG_SEM_NNESTPRIO is too small (so
-           * that we do not have a proper record of the reprioritizations).
-           */
-
-          DEBUGASSERT(/* htcb->sched_priority == stcb->sched_priority && */
-            htcb->npend_reprio == 0);
-
-          /* Reset the holder's priority back to the base priority. */
-
-          nxsched_reprioritize(htcb, htcb->base_priority);
-        }
-
-      /* There are multiple pending priority levels. The holder thread's
-       * "boosted" priority could greater than or equal to
-       * "stcb->sched_priority" (it could be greater if its priority was
-       * boosted because it also holds another semaphore).
-       */
-
-      else if (htcb->sched_priority <= stcb->sched_priority)
-        {
-          /* The holder thread has been boosted to the same priority as the
-           * waiter thread that just received the count.  We will simply
-           * reprioritize to the next highest priority that we have in
-           * rpriority.
-           */
-
-          /* Find the highest pending priority and remove it from the list */
-
-          for (i = 1, j = 0; i < htcb->npend_reprio; i++)
-            {
-              if (htcb->pend_reprios[i] > htcb->pend_reprios[j])
-                {
-                  j = i;
-                }
-            }
-
-          /* Remove the highest priority pending priority from the list */
-
-          rpriority = htcb->pend_reprios[j];
-          i = htcb->npend_reprio - 1;
-          if (i > 0)
-            {
-              htcb->pend_reprios[j] = htcb->pend_reprios[i];
-            }
-
-          htcb->npend_reprio = i;
+  sched_note_prio_boost(htcb, wtcb, wtcb->sched_priority, chain->depth);
+  nxsched_set_priority(htcb, wtcb->sched_priority);
 
-          /* And apply that priority to the thread (while retaining the
-           * base_priority)
-           */
-
-          nxsched_set_priority(htcb, rpriority);
-        }
-      else
-        {
-          /* The holder thread has been boosted to a higher priority than the
-           * waiter task.  The pending priority should be in the list (unless
-           * it was lost because of list overflow or because the holder
-           * was reprioritized again unbeknownst to the priority inheritance
-           * logic).
-           *
-           * Search the list for the matching priority.
-           */
-
-          for (i = 0; i < htcb->npend_reprio; i++)
-            {
-              /* Does this pending priority match the priority of the thread
-               * that just received the count?
-               */
-
-              if (htcb->pend_reprios[i] == stcb->sched_priority)
-                {
-                  /* Yes, remove it from the list */
-
-                  j = htcb->npend_reprio - 1;
-                  if (j > 0)
-                    {
-                      htcb->pend_reprios[i] = htcb->pend_reprios[j];
-                    }
-
-                  htcb->npend_reprio = j;
-                  break;
-                }
-            }
-        }
-#else
-      /* There is no alternative restore priorities, drop the priority
-       * of the holder thread all the way back to the threads "base"
-       * priority.
-       */
+  /* If the holder is itself waiting for a semaphore, then the holders of
+   * that semaphore must be boosted as well.
+   */
 
-      nxsched_reprioritize(htcb, htcb->base_priority);
-#endif
+  next = nxsem_chainholders(htcb, chain->depth);
+  if (next != NULL)
+    {
+      chain->depth++;
+      nxsem_foreachholder(next, nxsem_boostholderprio, chain);
+      chain->depth--;
     }
 
   return 0;
 }
 
 /****************************************************************************
- * Name: nxsem_restoreholderprioall
- *
- * Description:
- *   Reprioritize all holders
- *
+ * Name: nxsem_adjustholderprio
  ****************************************************************************/
 
-static int nxsem_restoreholderprioall(FAR struct semholder_s *pholder,
-                                      FAR sem_t *sem, FAR void *arg)
+static int nxsem_adjustholderprio(FAR struct semholder_s *pholder,
+                                  FAR sem_t *sem, FAR void *arg)
 {
-  return nxsem_restoreholderprio(pholder->htcb, sem, arg);
+  nxsem_adjustprio(pholder->htcb, (int)(uintptr_t)arg);
+  return 0;
 }
 
 /****************************************************************************
- * Name: nxsem_restoreholderprio_others
+ * Name: nxsem_adjustprio
  *
  * Description:
- *   Reprioritize all holders except the currently executing task
+ *   Recompute the priority of a holder thread after the set of waiters on
+ *   the semaphores that it holds has changed.  The correct priority is the
+ *   higher of its base priority and the priority of the highest priority
+ *   waiter on any semaphore that it still holds.  If the priority of the
+ *   holder changes and the holder is itself waiting for a semaphore, the
+ *   holders of that semaphore are recomputed in turn.
  *
  ****************************************************************************/
 
-static int nxsem_restoreholderprio_others(FAR struct semholder_s *pholder,
-                                          FAR sem_t *sem, FAR void *arg)
+static void nxsem_adjustprio(FAR struct tcb_s *htcb, int depth)
 {
-  FAR struct tcb_s *rtcb = this_task();
-  if (pholder->htcb != rtcb)
+  FAR struct tcb_s *wtcb = nxsem_topwaiter(htcb);
+  FAR sem_t *next;
+  int priority = htcb->base_priority;
+
+  if (wtcb != NULL && wtcb->sched_priority > priority)
     {
-      return nxsem_restoreholderprio(pholder->htcb, sem, arg);
+      priority = wtcb->sched_priority;
     }
 
-  return 0;
+  if (priority == htcb->sched_priority)
+    {
+      return;
+    }
+
+  if (priority > htcb->sched_priority)
+    {
+      sched_note_prio_boost(htcb, wtcb, priority, depth);
+    }
+  else
+    {
+      sched_note_prio_restore(htcb, priority);
+    }
+
+  nxsched_set_priority(htcb, priority);
+
+  next = nxsem_chainholders(htcb, depth);
+  if (next != NULL)
+    {
+      nxsem_foreachholder(next, nxsem_adjustholderprio,
+                          (FAR void *)(uintptr_t)(depth + 1));
+    }
 }
 
 /****************************************************************************
- * Name: nxsem_restoreholderprio_self
+ * Name: nxsem_adjustholderprio_others
  *
  * Description:
- *   Reprioritize only the currently executing task
+ *   Reprioritize all holders except the currently executing task
  *
  ****************************************************************************/
 
-static int nxsem_restoreholderprio_self(FAR struct semholder_s *pholder,
-                                        FAR sem_t *sem, FAR void *arg)
+static int nxsem_adjustholderprio_others(FAR struct semholder_s *pholder,
+                                         FAR sem_t *sem, FAR void *arg)
 {
-  FAR struct tcb_s *rtcb = this_task();
-
-  if (pholder->htcb == rtcb)
+  if (pholder->htcb != this_task())
     {
-      /* The running task has given up a count on the semaphore */
+      nxsem_adjustprio(pholder->htcb, 0);
+    }
 
-#if CONFIG_SEM_PREALLOCHOLDERS == 0
-      /* In the case where there are only 2 holders. This step
-       * is necessary to ensure we have space. Release the holder
-       * if all counts have been given up before reprioritizing
-       * causes a context switch.
-       */
+  return 0;
+}
 
-      nxsem_findandfreeholder(sem, rtcb);
-#endif
-      nxsem_restoreholderprio(rtcb, sem, arg);
-      return 1;
-    }
+/****************************************************************************
+ * Name: nxsem_dumpholder
+ ****************************************************************************/
 
+#if defined(CONFIG_DEBUG_INFO) && defined(CONFIG_SEM_PHDEBUG)
+static int nxsem_dumpholder(FAR struct semholder_s *pholder, FAR sem_t *sem,
+                            FAR void *arg)
+{
+#if CONFIG_SEM_PREALLOCHOLDERS > 0
+  _info("  %08x: %08x %08x %04x\n",
+        pholder, pholder->flink, pholder->htcb, pholder->counts);
+#else
+  _info("  %08x: %08x %04x\n", pholder, pholder->htcb, pholder->counts);
+#endif
   return 0;
 }
+#endif
 
 /****************************************************************************
  * Name: nxsem_restore_baseprio_irq
@@ -694,19 +629,8 @@ static int nxsem_restoreholderprio_self(FAR struct semholder_s *pholder,
  *   been boosted while they held the count.
  *
  * Input Parameters:
- *   stcb - The TCB of the task that was just started (if any).  If the
- *     post action caused a count to be given to another thread, then stcb
- *     is the TCB that received the count.  Note, just because stcb received
- *     the count, it does not mean that it is higher priority than other
- *     threads.
+ *   stcb - The TCB of the task that was just started (if any).
  *   sem - A reference to the semaphore being posted.
- *     - If the semaphore count is <0 then there are still threads waiting
- *       for a count.  stcb should be non-null and will be higher priority
- *       than all of the other threads still waiting.
- *     - If it is ==0 then stcb refers to the thread that got the last count;
- *       no other threads are waiting.
- *     - If it is >0 then there should be no threads waiting for counts and
- *       stcb should be null.
  *
  * Returned Value:
  *   None
@@ -720,29 +644,14 @@ static inline void nxsem_restore_baseprio_irq(FAR struct tcb_s *stcb,
                                               FAR sem_t *sem)
 {
   /* Perform the following actions only if a new thread was given a count.
-   * The thread that received the count should be the highest priority
-   * of all threads waiting for a count from the semaphore.  So in that
-   * case, the priority of all holder threads should be dropped to the
-   * next highest pending priority.
+   * That thread was the head of the list of waiters, so the priority
+   * inherited by the holders may now be lower.
    */
 
   if (stcb != NULL)
     {
-      /* Drop the priority of all holder threads */
-
-      nxsem_foreachholder(sem, nxsem_restoreholderprioall, stcb);
+      nxsem_foreachholder(sem, nxsem_adjustholderprio, (FAR void *)0);
     }
-
-  /* If there are no tasks waiting for available counts, then all holders
-   * should be at their base priority.
-   */
-
-#ifdef CONFIG_DEBUG_ASSERTIONS
-  else
-    {
-      nxsem_foreachholder(sem, nxsem_verifyholder, NULL);
-    }
-#endif
 }
 
 /****************************************************************************
@@ -755,19 +664,8 @@ static inline void nxsem_restore_baseprio_irq(FAR struct tcb_s *stcb,
  *   have been boosted while they held the count.
  *
  * Input Parameters:
- *   stcb - The TCB of the task that was just started (if any).  If the
- *     post action caused a count to be given to another thread, then stcb
- *     is the TCB that received the count.  Note, just because stcb received
- *     the count, it does not mean that it is higher priority than other
- *     threads.
+ *   stcb - The TCB of the task that was just started (if any).
  *   sem - A reference to the semaphore being posted.
- *     - If the semaphore count is <0 then there are still threads waiting
- *       for a count.  stcb should be non-null and will be higher priority
- *       than all of the other threads still waiting.
- *     - If it is ==0 then stcb refers to the thread that got the last count;
- *       no other threads are waiting.
- *     - If it is >0 then there should be no threads waiting for counts and
- *       stcb should be null.
  *
  * Returned Value:
  *   None
@@ -781,49 +679,39 @@ static inline void nxsem_restore_baseprio_task(FAR struct tcb_s *stcb,
                                                FAR sem_t *sem)
 {
   FAR struct tcb_s *rtcb = this_task();
+  FAR struct semholder_s *pholder;
 
-  /* Perform the following actions only if a new thread was given a count.
-   * The thread that received the count should be the highest priority
-   * of all threads waiting for a count from the semaphore.  So in that
-   * case, the priority of all holder threads should be dropped to the
-   * next highest pending priority.
+  /* The currently executed thread should be the lower priority thread
+   * that just posted the count and caused this action.  However, we cannot
+   * drop the priority of the currently running thread before the others --
+   * because that will cause it to be suspended.
+   *
+   * So, do this in two passes.  First, reprioritizing all holders except
+   * for the running thread.  That is only necessary if a waiter was given
+   * the count;  otherwise the list of waiters did not change.
    */
 
   if (stcb != NULL)
     {
-      /* The currently executed thread should be the lower priority
-       * thread that just posted the count and caused this action.
-       * However, we cannot drop the priority of the currently running
-       * thread -- because that will cause it to be suspended.
-       *
-       * So, do this in two passes.  First, reprioritizing all holders
-       * except for the running thread.
-       */
-
-      nxsem_foreachholder(sem, nxsem_restoreholderprio_others, stcb);
-
-      /* Now, find an reprioritize only the ready to run task */
-
-      nxsem_foreachholder(sem, nxsem_restoreholderprio_self, stcb);
+      nxsem_foreachholder(sem, nxsem_adjustholderprio_others, NULL);
     }
 
-  /* If there are no tasks waiting for available counts, then all holders
-   * should be at their base priority.
+  /* The currently executing task should have an entry in the list.  Its
+   * counts were previously decremented; if it now holds no counts, then we
+   * need to remove it from the list of holders.  Then it no longer inherits
+   * anything from the waiters on this semaphore.
    */
 
-#ifdef CONFIG_DEBUG_ASSERTIONS
-  else
+  pholder = nxsem_findholder(sem, rtcb);
+  if (pholder != NULL)
     {
-      nxsem_foreachholder(sem, nxsem_verifyholder, NULL);
-    }
-#endif
-
-  /* In any case, the currently executing task should have an entry in the
-   * list.  Its counts were previously decremented; if it now holds no
-   * counts, then we need to remove it from the list of holders.
-   */
+      if (pholder->counts <= 0)
+        {
+          nxsem_freeholder(sem, pholder);
+        }
 
-  nxsem_findandfreeholder(sem, rtcb);
+      nxsem_adjustprio(rtcb, 0);
+    }
 }
 
 /****************************************************************************
@@ -860,9 +748,87 @@ void nxsem_initialize_holders(void)
     }
 
   g_holderalloc[CONFIG_SEM_PREALLOCHOLDERS - 1].flink = NULL;
+  g_nfreeholders = CONFIG_SEM_PREALLOCHOLDERS;
 #endif
 }
 
+/****************************************************************************
+ * Name: nxsem_grow_holders
+ *
+ * Description:
+ *   Called from nxsem_wait() before entering the critical section.  If the
+ *   pool of free holders is running low, allocate another batch of holders
+ *   from the kernel heap.
+ *
+ * Input Parameters:
+ *   None
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   Called from a task context that may block.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SEM_HOLDERS_DYNAMIC
+void nxsem_grow_holders(void)
+{
+  FAR struct semholder_s *pholders;
+  irqstate_t flags;
+  int i;
+
+  /* Nothing to do while the pool is comfortable.  This check is made
+   * without locking;  at worst one batch is allocated unnecessarily.
+   */
+
+  if (g_nfreeholders >= SEM_HOLDERS_LOWATER || !OSINIT_OS_READY())
+    {
+      return;
+    }
+
+  /* The heap is itself protected by a semaphore, so the allocation will
+   * recurse into nxsem_wait().  Only one thread refills the pool.
+   */
+
+  flags = enter_critical_section();
+  if (g_growing)
+    {
+      leave_critical_section(flags);
+      return;
+    }
+
+  g_growing = true;
+  leave_critical_section(flags);
+
+  pholders = (FAR struct semholder_s *)
+    kmm_malloc(SEM_HOLDERS_BATCH * sizeof(struct semholder_s));
+
+  flags = enter_critical_section();
+  if (pholders != NULL)
+    {
+      for (i = 0; i < SEM_HOLDERS_BATCH; i++)
+        {
+          pholders[i].tlink  = NULL;
+          pholders[i].sem    = NULL;
+          pholders[i].htcb   = NULL;
+          pholders[i].counts = 0;
+          pholders[i].flink  = g_freeholders;
+          g_freeholders      = &pholders[i];
+        }
+
+      g_nfreeholders += SEM_HOLDERS_BATCH;
+    }
+  else
+    {
+      serr("ERROR: Failed to grow the semaphore holder pool\n");
+    }
+
+  g_growing = false;
+  leave_critical_section(flags);
+}
+#endif
+
 /****************************************************************************
  * Name: nxsem_destroyholder
  *
@@ -882,6 +848,8 @@ void nxsem_initialize_holders(void)
 
 void nxsem_destroyholder(FAR sem_t *sem)
 {
+  irqstate_t flags;
+
   /* It might be an error if a semaphore is destroyed while there are any
    * holders of the semaphore (except perhaps the thread that release the
    * semaphore itself).  We actually have to assume that the caller knows
@@ -895,28 +863,25 @@ void nxsem_destroyholder(FAR sem_t *sem)
    *
    * Therefore, we cannot make any assumptions about the state of the
    * semaphore or the state of any of the holder threads.  So just recover
-   * any stranded holders and hope the task knows what it is doing.
+   * any stranded holders and hope the task knows what it is doing.  The
+   * holder records are also linked into the lists of the holder threads,
+   * so they must be released even if the semaphore memory is reused.
    */
 
-#if CONFIG_SEM_PREALLOCHOLDERS > 0
-  if (sem->hhead != NULL)
-    {
-      /* There may be an issue if there are multiple holders of
-       * the semaphore.
-       */
+  flags = enter_critical_section();
 
-      DEBUGASSERT(sem->hhead->flink == NULL);
-      nxsem_foreachholder(sem, nxsem_recoverholders, NULL);
-    }
+#if CONFIG_SEM_PREALLOCHOLDERS > 0
+  /* There may be an issue if there are multiple holders of the semaphore. */
 
+  DEBUGASSERT(sem->hhead == NULL || sem->hhead->flink == NULL);
 #else
   /* There may be an issue if there are multiple holders of the semaphore. */
 
   DEBUGASSERT(sem->holder[0].htcb == NULL || sem->holder[1].htcb == NULL);
-
-  sem->holder[0].htcb = NULL;
-  sem->holder[1].htcb = NULL;
 #endif
+
+  nxsem_foreachholder(sem, nxsem_recoverholders, NULL);
+  leave_critical_section(flags);
 }
 
 /****************************************************************************
@@ -931,7 +896,7 @@ void nxsem_destroyholder(FAR sem_t *sem)
  *   sem  - A reference to the incremented semaphore
  *
  * Returned Value:
- *   0 (OK) or -1 (ERROR) if unsuccessful
+ *   None
  *
  * Assumptions:
  *   Interrupts are disabled.
@@ -942,8 +907,9 @@ void nxsem_add_holder_tcb(FAR struct tcb_s *htcb, FAR sem_t *sem)
 {
   FAR struct semholder_s *pholder;
 
-  /* If priority inheritance is disabled for this thread, then do not add
-   * the holder.  If there are never holders of the semaphore, the priority
+  /* If priority inheritance is disabled for this semaphore, either with
+   * SEM_PRIO_NONE or because it is used for signaling, then do not add the
+   * holder.  If there are never holders of the semaphore, the priority
    * inheritance is effectively disabled.
    */
 
@@ -951,14 +917,16 @@ void nxsem_add_holder_tcb(FAR struct tcb_s *htcb, FAR sem_t *sem)
     {
       /* Find or allocate a container for this new holder */
 
-      pholder = nxsem_findorallocateholder(sem, htcb);
+      pholder = nxsem_findholder(sem, htcb);
+      if (pholder == NULL)
+        {
+          pholder = nxsem_allocholder(sem, htcb);
+        }
+
       if (pholder != NULL)
         {
-          /* Then set the holder and increment the number of counts held by
-           * this holder
-           */
+          /* Increment the number of counts held by this holder */
 
-          pholder->htcb = htcb;
           pholder->counts++;
         }
     }
@@ -974,7 +942,7 @@ void nxsem_add_holder_tcb(FAR struct tcb_s *htcb, FAR sem_t *sem)
  *   sem - A reference to the incremented semaphore
  *
  * Returned Value:
- *   0 (OK) or -1 (ERROR) if unsuccessful
+ *   None
  *
  * Assumptions:
  *   Interrupts are disabled.
@@ -987,31 +955,121 @@ void nxsem_add_holder(FAR sem_t *sem)
 }
 
 /****************************************************************************
- * Name: void nxsem_boost_priority(sem_t *sem)
+ * Name: nxsem_boost_priority
  *
  * Description:
+ *   Called from nxsem_wait() before the running task blocks waiting for a
+ *   count.  The task is added to the semaphore's list of waiters and the
+ *   priority of every holder of the semaphore that is lower in priority is
+ *   raised.  The boost is passed on along the chain of semaphores that the
+ *   holders are themselves waiting for.
+ *
+ * Input Parameters:
+ *   sem - A reference to the semaphore to be waited for
  *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   Interrupts are disabled and the scheduler is locked.
+ *
+ ****************************************************************************/
+
+void nxsem_boost_priority(FAR sem_t *sem)
+{
+  struct semchain_s chain;
+
+  chain.wtcb  = this_task();
+  chain.depth = 0;
+
+  nxsem_addwaiter(sem, chain.wtcb);
+  nxsem_foreachholder(sem, nxsem_boostholderprio, &chain);
+}
+
+/****************************************************************************
+ * Name: nxsem_remove_waiter
+ *
+ * Description:
+ *   Called from sem_post() to remove the thread that receives the count
+ *   from the semaphore's list of waiters.
  *
  * Input Parameters:
+ *   sem  - A reference to the semaphore
+ *   wtcb - The TCB of the thread that is no longer waiting
+ *
+ * Returned Value:
  *   None
  *
+ * Assumptions:
+ *   Interrupts are disabled.
+ *
+ ****************************************************************************/
+
+void nxsem_remove_waiter(FAR sem_t *sem, FAR struct tcb_s *wtcb)
+{
+  nxsem_remwaiter(sem, wtcb);
+}
+
+/****************************************************************************
+ * Name: nxsem_reorder_waiter
+ *
+ * Description:
+ *   Called from nxsched_set_priority() when the priority of a thread that
+ *   is waiting for a semaphore changes, to keep the semaphore's list of
+ *   waiters in priority order.
+ *
+ * Input Parameters:
+ *   wtcb - The TCB of the thread whose priority changed
+ *
  * Returned Value:
- *   0 (OK) or -1 (ERROR) if unsuccessful
+ *   None
  *
  * Assumptions:
+ *   Interrupts are disabled.
  *
  ****************************************************************************/
 
-void nxsem_boost_priority(FAR sem_t *sem)
+void nxsem_reorder_waiter(FAR struct tcb_s *wtcb)
 {
-  FAR struct tcb_s *rtcb = this_task();
+  FAR sem_t *sem = wtcb->waitsem;
 
-  /* Boost the priority of every thread holding counts on this semaphore
-   * that are lower in priority than the new thread that is waiting for a
-   * count.
-   */
+  DEBUGASSERT(sem != NULL);
+
+  nxsem_remwaiter(sem, wtcb);
+  nxsem_addwaiter(sem, wtcb);
+}
+
+/****************************************************************************
+ * Name: nxsem_effective_priority
+ *
+ * Description:
+ *   Return the priority that the thread should run at: the higher of its
+ *   base priority and the priority of the highest priority thread waiting
+ *   for any semaphore that it holds.
+ *
+ * Input Parameters:
+ *   tcb - The TCB of the thread
+ *
+ * Returned Value:
+ *   The effective priority of the thread
+ *
+ ****************************************************************************/
+
+int nxsem_effective_priority(FAR struct tcb_s *tcb)
+{
+  FAR struct tcb_s *wtcb;
+  irqstate_t flags;
+  int priority = tcb->base_priority;
+
+  flags = enter_critical_section();
+  wtcb  = nxsem_topwaiter(tcb);
+  if (wtcb != NULL && wtcb->sched_priority > priority)
+    {
+      priority = wtcb->sched_priority;
+    }
 
-  nxsem_foreachholder(sem, nxsem_boostholderprio, rtcb);
+  leave_critical_section(flags);
+  return priority;
 }
 
 /****************************************************************************
@@ -1019,7 +1077,9 @@ void nxsem_boost_priority(FAR sem_t *sem)
  *
  * Description:
  *   Called from sem_post() after a thread releases one count on the
- *   semaphore.
+ *   semaphore.  A count posted by an interrupt handler or by a thread that
+ *   does not hold the semaphore marks it as a signaling semaphore, which
+ *   has no holder records from then on.
  *
  * Input Parameters:
  *   sem - A reference to the semaphore being posted
@@ -1033,19 +1093,74 @@ void nxsem_boost_priority(FAR sem_t *sem)
 
 void nxsem_release_holder(FAR sem_t *sem)
 {
-  FAR struct tcb_s *rtcb = this_task();
-  FAR struct semholder_s *pholder;
+  FAR struct semholder_s *pholder = NULL;
 
-  /* Find the container for this holder */
+  if ((sem->flags & PRIOINHERIT_FLAGS_DISABLE) != 0)
+    {
+      return;
+    }
 
-  pholder = nxsem_findholder(sem, rtcb);
-  if (pholder != NULL && pholder->counts > 0)
+  /* Find the container for this holder.  An interrupt handler is never a
+   * holder.
+   */
+
+  if (!up_interrupt_context())
+    {
+      pholder = nxsem_findholder(sem, this_task());
+    }
+
+  if (pholder != NULL)
     {
       /* Decrement the counts on this holder -- the holder will be freed
        * later in nxsem_restore_baseprio.
        */
 
-      pholder->counts--;
+      if (pholder->counts > 0)
+        {
+          pholder->counts--;
+        }
+    }
+  else
+    {
+      /* The count is posted by an interrupt handler or by a thread that
+       * does not hold it, so the semaphore is used for signaling.  Its
+       * holders are not owners that a waiter could wait for:  disable
+       * priority inheritance and drop their records.
+       */
+
+      sem->flags |= PRIOINHERIT_FLAGS_DISABLE;
+      nxsem_foreachholder(sem, nxsem_recoverholders, NULL);
+    }
+}
+
+/****************************************************************************
+ * Name: nxsem_release_all
+ *
+ * Description:
+ *   Called from nxsem_recover() when a thread exits or is restarted.  All
+ *   of the holder records of the thread are released.  The counts that
+ *   the thread held are lost.
+ *
+ * Input Parameters:
+ *   htcb - The TCB of the terminated thread
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   Interrupts are disabled.
+ *
+ ****************************************************************************/
+
+void nxsem_release_all(FAR struct tcb_s *htcb)
+{
+  FAR struct semholder_s *pholder;
+
+  while ((pholder = htcb->holdsem) != NULL)
+    {
+      swarn("WARNING: PID %d exited holding %d counts on %p\n",
+            htcb->pid, pholder->counts, pholder->sem);
+      nxsem_freeholder(pholder->sem, pholder);
     }
 }
 
@@ -1062,17 +1177,9 @@ void nxsem_release_holder(FAR sem_t *sem)
  * Input Parameters:
  *   stcb - The TCB of the task that was just started (if any).  If the
  *     post action caused a count to be given to another thread, then stcb
- *     is the TCB that received the count.  Note, just because stcb received
- *     the count, it does not mean that it is higher priority than other
- *     threads.
+ *     is the TCB that received the count.  It has already been removed
+ *     from the list of waiters.
  *   sem - A reference to the semaphore being posted.
- *     - If the semaphore count is <0 then there are still threads waiting
- *       for a count.  stcb should be non-null and will be higher priority
- *       than all of the other threads still waiting.
- *     - If it is ==0 then stcb refers to the thread that got the last count;
- *       no other threads are waiting.
- *     - If it is >0 then there should be no threads waiting for counts and
- *       stcb should be null.
  *
  * Returned Value:
  *   None
@@ -1084,13 +1191,6 @@ void nxsem_release_holder(FAR sem_t *sem)
 
 void nxsem_restore_baseprio(FAR struct tcb_s *stcb, FAR sem_t *sem)
 {
-#if 0  /* DSA: sometimes crashes when Telnet calls external cmd (i.e. 'i2c') */
-  /* Check our assumptions */
-
-  DEBUGASSERT((sem->semcount > 0  && stcb == NULL) ||
-              (sem->semcount <= 0 && stcb != NULL));
-#endif
-
   /* Handler semaphore counts posed from an interrupt handler differently
    * from interrupts posted from threads.  The primary difference is that
    * if the semaphore is posted from a thread, then the poster thread is
@@ -1115,10 +1215,12 @@ void nxsem_restore_baseprio(FAR struct tcb_s *stcb, FAR sem_t *sem)
  * Description:
  *   Called from nxsem_wait_irq() after a thread that was waiting for a
  *   semaphore count was awakened because of a signal and the semaphore wait
- *   has been canceled.  This function restores the correct thread priority
- *   of each holder of the semaphore.
+ *   has been canceled.  This function removes the thread from the list of
+ *   waiters and restores the correct thread priority of each holder of the
+ *   semaphore.
  *
  * Input Parameters:
+ *   stcb - The TCB of the thread that is no longer waiting
  *   sem - A reference to the semaphore no longer being waited for
  *
  * Returned Value:
@@ -1136,7 +1238,90 @@ void nxsem_canceled(FAR struct tcb_s *stcb, FAR sem_t *sem)
 
   /* Adjust the priority of every holder as necessary */
 
-  nxsem_foreachholder(sem, nxsem_restoreholderprioall, stcb);
+  nxsem_remwaiter(sem, stcb);
+  nxsem_foreachholder(sem, nxsem_adjustholderprio, (FAR void *)0);
+}
+
+/****************************************************************************
+ * Name: nxsem_drop_holders
+ *
+ * Description:
+ *   Called from nxsem_init() to release any holder records left over from
+ *   an earlier use of the memory of the semaphore, e.g. a held semaphore
+ *   on the stack of a function that has returned.  The old contents of
+ *   the semaphore may be garbage, so the holder lists of the threads are
+ *   searched instead.
+ *
+ * Input Parameters:
+ *   sem - The semaphore about to be initialized.  Its contents are not
+ *         examined.
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void nxsem_drop_holders(FAR sem_t *sem)
+{
+  FAR struct semholder_s *pholder;
+  FAR struct semholder_s *prev;
+  FAR struct semholder_s *next;
+  FAR struct tcb_s *htcb;
+  irqstate_t flags;
+  bool dropped;
+  int i;
+
+  /* Nothing to do while no thread holds any semaphore */
+
+  if (g_nholders == 0 || !OSINIT_OS_READY())
+    {
+      return;
+    }
+
+  flags = enter_critical_section();
+  for (i = 0; i < CONFIG_MAX_TASKS; i++)
+    {
+      htcb = g_pidhash[i].tcb;
+      if (htcb == NULL)
+        {
+          continue;
+        }
+
+      dropped = false;
+      for (prev = NULL, pholder = htcb->holdsem; pholder != NULL;
+           pholder = next)
+        {
+          next = pholder->tlink;
+          if (pholder->sem != sem)
+            {
+              prev = pholder;
+              continue;
+            }
+
+          if (prev != NULL)
+            {
+              prev->tlink = next;
+            }
+          else
+            {
+              htcb->holdsem = next;
+            }
+
+          nxsem_discardholder(pholder);
+          dropped = true;
+        }
+
+      /* The thread may have inherited its priority from the waiters of
+       * the old semaphore.
+       */
+
+      if (dropped)
+        {
+          nxsem_adjustprio(htcb, 0);
+        }
+    }
+
+  leave_critical_section(flags);
 }
 
 /****************************************************************************
@@ -1185,15 +1370,7 @@ void sem_enumholders(FAR sem_t *sem)
 int nxsem_nfreeholders(void)
 {
 #if CONFIG_SEM_PREALLOCHOLDERS > 0
-  FAR struct semholder_s *pholder;
-  int n;
-
-  for (pholder = g_freeholders, n = 0; pholder; pholder = pholder->flink)
-    {
-      n++;
-    }
-
-  return n;
+  return g_nfreeholders;
 #else
   return 0;
 #endif
@@ -71,8 +71,18 @@ int nxsem_post(FAR sem_t *sem)
 {
   FAR struct tcb_s *stcb = NULL;
   irqstate_t flags;
+  int16_t count;
   int ret = -EINVAL;
 
+#ifdef CONFIG_FUTEX
+  /* Release the count without the critical section if nobody waits */
+
+  if (sem != NULL && nxsem_is_fast(sem) && nxsem_count_tryinc(sem))
+    {
+      return OK;
+    }
+#endif
+
   /* Make sure we were supplied with a valid semaphore. */
 
   if (sem != NULL)
@@ -96,21 +106,17 @@ int nxsem_post(FAR sem_t *sem)
        * holder then also incrementing the count on the semaphore.
        *
        * NOTE:  When semaphores are used for signaling purposes, the holder
-       * of the semaphore may not be this thread!  In this case,
-       * nxsem_release_holder() will do nothing.
-       *
-       * In the case of a mutex this could be simply resolved since there is
-       * only one holder but for the case of counting semaphores, there may
-       * be many holders and if the holder is not this thread, then it is
-       * not possible to know which thread/holder should be released.
-       *
-       * For this reason, it is recommended that priority inheritance be
-       * disabled via nxsem_set_protocol(SEM_PRIO_NONE) when the semaphore is
-       * initialized if the semaphore is to used for signaling purposes.
+       * of the semaphore may not be this thread!  It is not possible to
+       * know which thread/holder should be released, so
+       * nxsem_release_holder() then disables priority inheritance for the
+       * semaphore and drops all of its holder records.  It is still
+       * recommended to disable priority inheritance via
+       * nxsem_set_protocol(SEM_PRIO_NONE) when a semaphore that is to be
+       * used for signaling purposes is initialized.
        */
 
       nxsem_release_holder(sem);
-      sem->semcount++;
+      count = nxsem_count_add(sem, 1);
 
 #ifdef CONFIG_PRIORITY_INHERITANCE
       /* Don't let any unblocked tasks run until we complete any priority
@@ -127,8 +133,15 @@ int nxsem_post(FAR sem_t *sem)
        * there must be some task waiting for the semaphore.
        */
 
-      if (sem->semcount <= 0)
+      if (count <= 0)
         {
+#ifdef CONFIG_PRIORITY_INHERITANCE
+          /* The semaphore keeps its own prioritized list of waiters, so
+           * the one that we want is at the head of the list.
+           */
+
+          stcb = sem->waitlist;
+#else
           /* Check if there are any tasks in the waiting for semaphore
            * task list that are waiting for this semaphore. This is a
            * prioritized list so the first one we encounter is the one
@@ -138,9 +151,14 @@ int nxsem_post(FAR sem_t *sem)
           for (stcb = (FAR struct tcb_s *)g_waitingforsemaphore.head;
                (stcb && stcb->waitsem != sem);
                stcb = stcb->flink);
+#endif
 
           if (stcb != NULL)
             {
+              /* It no longer waits for the semaphore */
+
+              nxsem_remove_waiter(sem, stcb);
+
               /* The task will be the new holder of the semaphore when
                * it is awakened.
                */
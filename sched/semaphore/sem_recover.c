@@ -41,15 +41,14 @@
  *
  * Description:
  *   This function is called from nxtask_recover() when a task is deleted via
- *   task_delete() or via pthread_cancel().  It current only checks on the
- *   case where a task is waiting for semaphore at the time that is was
- *   killed.
+ *   task_delete() or via pthread_cancel().  It checks on the case where a
+ *   task is waiting for semaphore at the time that is was killed.  If
+ *   priority inheritance is enabled, it also releases the holder records
+ *   of all semaphores held by the thread.
  *
- *   REVISIT:  A more complete implementation would release counts on all
- *   semaphores held by the thread.  That would, however, require some
- *   significant extension to the semaphore data structures because given
- *   only the task, there is not mechanism to traverse all of the semaphores
- *   with counts held by the task.
+ *   REVISIT:  A more complete implementation would also release the counts
+ *   held by the thread.  This is not done because the protected resource
+ *   may have been left in an inconsistent state.
  *
  * Input Parameters:
  *   tcb - The TCB of the terminated task or thread
@@ -97,7 +96,7 @@ void nxsem_recover(FAR struct tcb_s *tcb)
        * place.
        */
 
-      sem->semcount++;
+      nxsem_count_add(sem, 1);
 
       /* Clear the semaphore to assure that it is not reused.  But leave the
        * state as TSTATE_WAIT_SEM.  This is necessary because this is a
@@ -108,5 +107,8 @@ void nxsem_recover(FAR struct tcb_s *tcb)
       tcb->waitsem = NULL;
     }
 
+  /* Forget about the semaphores held by the thread */
+
+  nxsem_release_all(tcb);
   leave_critical_section(flags);
 }
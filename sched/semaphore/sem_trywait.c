@@ -73,6 +73,15 @@ int nxsem_trywait(FAR sem_t *sem)
 
   DEBUGASSERT(sem != NULL && up_interrupt_context() == false);
 
+#ifdef CONFIG_FUTEX
+  /* Take an available count without the critical section */
+
+  if (sem != NULL && nxsem_is_fast(sem) && nxsem_count_trydec(sem))
+    {
+      return OK;
+    }
+#endif
+
   if (sem != NULL)
     {
       /* The following operations must be performed with interrupts disabled
@@ -83,11 +92,11 @@ int nxsem_trywait(FAR sem_t *sem)
 
       /* If the semaphore is available, give it to the requesting task */
 
-      if (sem->semcount > 0)
+      if (nxsem_count_trydec(sem))
         {
           /* It is, let the task take the semaphore */
 
-          sem->semcount--;
+          nxsem_add_holder(sem);
           rtcb->waitsem = NULL;
           ret = OK;
         }
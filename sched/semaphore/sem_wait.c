@@ -71,12 +71,30 @@ int nxsem_wait(FAR sem_t *sem)
 {
   FAR struct tcb_s *rtcb = this_task();
   irqstate_t flags;
+#ifdef CONFIG_SCHED_LATENCY_HIST
+  uint32_t start;
+#endif
   int ret = -EINVAL;
 
   /* This API should not be called from interrupt handlers */
 
   DEBUGASSERT(sem != NULL && up_interrupt_context() == false);
 
+#ifdef CONFIG_FUTEX
+  /* Take an available count without the critical section */
+
+  if (sem != NULL && nxsem_is_fast(sem) && nxsem_count_trydec(sem))
+    {
+      return OK;
+    }
+#endif
+
+  /* Make sure that a holder record will be available.  This may allocate
+   * memory, so it must be done before interrupts are disabled.
+   */
+
+  nxsem_grow_holders();
+
   /* The following operations must be performed with interrupts
    * disabled because nxsem_post() may be called from an interrupt
    * handler.
@@ -88,13 +106,14 @@ int nxsem_wait(FAR sem_t *sem)
 
   if (sem != NULL)
     {
-      /* Check if the lock is available */
+      /* Take a count.  If one was available, the new count is not
+       * negative.
+       */
 
-      if (sem->semcount > 0)
+      if (nxsem_count_add(sem, -1) >= 0)
         {
-          /* It is, let the task take the semaphore. */
+          /* It was, let the task take the semaphore. */
 
-          sem->semcount--;
           nxsem_add_holder(sem);
           rtcb->waitsem = NULL;
           ret = OK;
@@ -112,10 +131,6 @@ int nxsem_wait(FAR sem_t *sem)
 
           DEBUGASSERT(rtcb->waitsem == NULL);
 
-          /* Handle the POSIX semaphore (but don't set the owner yet) */
-
-          sem->semcount--;
-
           /* Save the waited on semaphore in the TCB */
 
           rtcb->waitsem = sem;
@@ -131,8 +146,8 @@ int nxsem_wait(FAR sem_t *sem)
 
           sched_lock();
 
-          /* Boost the priority of any threads holding a count on the
-           * semaphore.
+          /* Add the thread to the semaphore's list of waiters and boost
+           * the priority of any threads holding a count on the semaphore.
            */
 
           nxsem_boost_priority(sem);
@@ -150,7 +165,14 @@ int nxsem_wait(FAR sem_t *sem)
            */
 
           DEBUGASSERT(NULL != rtcb->flink);
+#ifdef CONFIG_SCHED_LATENCY_HIST
+          start = up_critmon_gettime();
+#endif
           up_block_task(rtcb, TSTATE_WAIT_SEM);
+#ifdef CONFIG_SCHED_LATENCY_HIST
+          nxsched_latency_record(rtcb, LATENCY_SEMWAIT,
+                                 up_critmon_gettime() - start);
+#endif
 
           /* When we resume at this point, either (1) the semaphore has been
            * assigned to this thread of execution, or (2) the semaphore wait
@@ -161,7 +183,8 @@ int nxsem_wait(FAR sem_t *sem)
            * signal or a timeout, certain semaphore clean-up operations have
            * already been performed (see sem_waitirq.c).  Specifically:
            *
-           * - nxsem_canceled() was called to restore the priority of all
+           * - nxsem_canceled() was called to remove this thread from the
+           *   semaphore's waiters and to restore the priority of all
            *   threads that hold a reference to the semaphore,
            * - The semaphore count was decremented, and
            * - tcb->waitsem was nullifed.
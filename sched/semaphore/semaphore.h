@@ -34,6 +34,29 @@
 #include <stdbool.h>
 #include <queue.h>
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* With CONFIG_FUTEX, semaphores without priority inheritance holder records
+ * take and release uncontended counts with a single atomic operation on
+ * semcount and no critical section.  Every other update of semcount must
+ * then be atomic as well, because the fast paths may run concurrently on
+ * another CPU.  nxsem_count_add() returns the new count.
+ */
+
+#ifdef CONFIG_FUTEX
+#  define nxsem_count_add(s,n) \
+     __atomic_add_fetch(&(s)->semcount, (n), __ATOMIC_ACQ_REL)
+#  ifdef CONFIG_PRIORITY_INHERITANCE
+#    define nxsem_is_fast(s) (((s)->flags & PRIOINHERIT_FLAGS_DISABLE) != 0)
+#  else
+#    define nxsem_is_fast(s) true
+#  endif
+#else
+#  define nxsem_count_add(s,n) ((s)->semcount += (n))
+#endif
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -76,7 +99,11 @@ void nxsem_destroyholder(FAR sem_t *sem);
 void nxsem_add_holder(FAR sem_t *sem);
 void nxsem_add_holder_tcb(FAR struct tcb_s *htcb, FAR sem_t *sem);
 void nxsem_boost_priority(FAR sem_t *sem);
+void nxsem_remove_waiter(FAR sem_t *sem, FAR struct tcb_s *wtcb);
+void nxsem_reorder_waiter(FAR struct tcb_s *wtcb);
+int  nxsem_effective_priority(FAR struct tcb_s *tcb);
 void nxsem_release_holder(FAR sem_t *sem);
+void nxsem_release_all(FAR struct tcb_s *htcb);
 void nxsem_restore_baseprio(FAR struct tcb_s *stcb, FAR sem_t *sem);
 void nxsem_canceled(FAR struct tcb_s *stcb, FAR sem_t *sem);
 #else
@@ -85,14 +112,91 @@ void nxsem_canceled(FAR struct tcb_s *stcb, FAR sem_t *sem);
 #  define nxsem_add_holder(sem)
 #  define nxsem_add_holder_tcb(htcb,sem)
 #  define nxsem_boost_priority(sem)
+#  define nxsem_remove_waiter(sem,wtcb)
+#  define nxsem_reorder_waiter(wtcb)
 #  define nxsem_release_holder(sem)
+#  define nxsem_release_all(htcb)
 #  define nxsem_restore_baseprio(stcb,sem)
 #  define nxsem_canceled(stcb,sem)
 #endif
 
+#ifdef CONFIG_SEM_HOLDERS_DYNAMIC
+void nxsem_grow_holders(void);
+#else
+#  define nxsem_grow_holders()
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
 #endif
 
+/****************************************************************************
+ * Inline Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxsem_count_trydec
+ *
+ * Description:
+ *   Take one count of the semaphore if one is available.  Returns true on
+ *   success.  Without CONFIG_FUTEX, the caller must be in a critical
+ *   section.
+ *
+ ****************************************************************************/
+
+static inline bool nxsem_count_trydec(FAR sem_t *sem)
+{
+#ifdef CONFIG_FUTEX
+  int16_t count = __atomic_load_n(&sem->semcount, __ATOMIC_RELAXED);
+
+  while (count > 0)
+    {
+      if (__atomic_compare_exchange_n(&sem->semcount, &count, count - 1,
+                                      false, __ATOMIC_ACQUIRE,
+                                      __ATOMIC_RELAXED))
+        {
+          return true;
+        }
+    }
+#else
+  if (sem->semcount > 0)
+    {
+      sem->semcount--;
+      return true;
+    }
+#endif
+
+  return false;
+}
+
+/****************************************************************************
+ * Name: nxsem_count_tryinc
+ *
+ * Description:
+ *   Release one count of the semaphore if no thread is waiting for it.
+ *   Returns true on success; false if there are waiters to wake or the
+ *   count would overflow.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FUTEX
+static inline bool nxsem_count_tryinc(FAR sem_t *sem)
+{
+  int16_t count = __atomic_load_n(&sem->semcount, __ATOMIC_RELAXED);
+
+  while (count >= 0 && count < SEM_VALUE_MAX)
+    {
+      if (__atomic_compare_exchange_n(&sem->semcount, &count, count + 1,
+                                      false, __ATOMIC_RELEASE,
+                                      __ATOMIC_RELAXED))
+        {
+          return true;
+        }
+    }
+
+  return false;
+}
+#endif
+
 #endif /* __SCHED_SEMAPHORE_SEMAPHORE_H */
@@ -0,0 +1,221 @@
+/****************************************************************************
+ * sched/semaphore/spinlock_mcs.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <nuttx/spinlock.h>
+
+#ifdef CONFIG_SPINLOCK
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mcs_initialize
+ *
+ * Description:
+ *   Initialize a queued lock to its unlocked state.
+ *
+ * Input Parameters:
+ *   lock - A reference to the queued lock to initialize.
+ *   name - The name used to register the lock statistics, or NULL.
+ *
+ * Returned Value:
+ *   None.
+ *
+ ****************************************************************************/
+
+void mcs_initialize(FAR mcslock_t *lock, FAR const char *name)
+{
+  lock->tail = NULL;
+  spin_initialize(&lock->guard, SP_UNLOCKED);
+
+#ifdef CONFIG_SPINLOCK_STATS
+  memset(&lock->stats, 0, sizeof(struct spinlock_stats_s));
+  if (name != NULL)
+    {
+      spin_stats_register(&lock->stats, name);
+    }
+#else
+  UNUSED(name);
+#endif
+}
+
+/****************************************************************************
+ * Name: mcs_lock
+ *
+ * Description:
+ *   Append 'node' to the lock queue and spin on the node until the previous
+ *   holder hands the lock over.
+ *
+ * Input Parameters:
+ *   lock - A reference to the queued lock.
+ *   node - A queue node owned by the caller until mcs_unlock().
+ *
+ * Returned Value:
+ *   None.  When the function returns, the lock is held by this CPU.
+ *
+ * Assumptions:
+ *   The caller has disabled local interrupts if the lock is also taken by
+ *   interrupt handlers.
+ *
+ ****************************************************************************/
+
+void mcs_lock(FAR mcslock_t *lock, FAR struct mcs_node_s *node)
+{
+  FAR struct mcs_node_s *prev;
+  uint32_t spins = 0;
+
+  node->next   = NULL;
+  node->locked = true;
+
+  /* Swap ourselves in as the new tail */
+
+  spin_lock_wo_note(&lock->guard);
+  prev       = lock->tail;
+  lock->tail = node;
+  spin_unlock_wo_note(&lock->guard);
+
+  if (prev != NULL)
+    {
+      /* Link behind the previous tail and wait for it to hand over */
+
+      prev->next = node;
+      SP_DSB();
+
+      while (node->locked)
+        {
+          spins++;
+          SP_DSB();
+          SP_WFE();
+        }
+    }
+
+  SP_DMB();
+
+#ifdef CONFIG_SPINLOCK_STATS
+  spin_stats_acquired(&lock->stats, spins);
+#else
+  UNUSED(spins);
+#endif
+}
+
+/****************************************************************************
+ * Name: mcs_trylock
+ *
+ * Description:
+ *   Take the queued lock only if it is free.
+ *
+ * Input Parameters:
+ *   lock - A reference to the queued lock.
+ *   node - A queue node owned by the caller until mcs_unlock().
+ *
+ * Returned Value:
+ *   True if the lock was acquired.
+ *
+ ****************************************************************************/
+
+bool mcs_trylock(FAR mcslock_t *lock, FAR struct mcs_node_s *node)
+{
+  bool locked = false;
+
+  node->next   = NULL;
+  node->locked = false;
+
+  spin_lock_wo_note(&lock->guard);
+  if (lock->tail == NULL)
+    {
+      lock->tail = node;
+      locked     = true;
+    }
+
+  spin_unlock_wo_note(&lock->guard);
+
+#ifdef CONFIG_SPINLOCK_STATS
+  if (locked)
+    {
+      spin_stats_acquired(&lock->stats, 0);
+    }
+#endif
+
+  return locked;
+}
+
+/****************************************************************************
+ * Name: mcs_unlock
+ *
+ * Description:
+ *   Hand the queued lock to the next waiter or release it.
+ *
+ * Input Parameters:
+ *   lock - A reference to the queued lock.
+ *   node - The node that was passed to mcs_lock() or mcs_trylock().
+ *
+ * Returned Value:
+ *   None.
+ *
+ ****************************************************************************/
+
+void mcs_unlock(FAR mcslock_t *lock, FAR struct mcs_node_s *node)
+{
+  FAR struct mcs_node_s *next;
+
+  SP_DMB();
+
+  if (node->next == NULL)
+    {
+      /* No successor is linked yet.  If we are still the tail there is
+       * none, and the lock becomes free.
+       */
+
+      spin_lock_wo_note(&lock->guard);
+      if (lock->tail == node)
+        {
+          lock->tail = NULL;
+          spin_unlock_wo_note(&lock->guard);
+          return;
+        }
+
+      spin_unlock_wo_note(&lock->guard);
+
+      /* A successor has swapped itself in but has not linked to us yet */
+
+      while (node->next == NULL)
+        {
+          SP_DSB();
+        }
+    }
+
+  next         = node->next;
+  next->locked = false;
+  SP_DSB();
+  SP_SEV();
+}
+
+#endif /* CONFIG_SPINLOCK */
@@ -0,0 +1,312 @@
+/****************************************************************************
+ * sched/semaphore/spinlock_rw.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <nuttx/spinlock.h>
+
+#ifdef CONFIG_SPINLOCK
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define RW_WRITER  -1  /* 'count' value while a writer holds the lock */
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: read_acquire
+ *
+ * Description:
+ *   Take the lock for reading if no writer holds it or waits for it.
+ *
+ ****************************************************************************/
+
+static bool read_acquire(FAR rwlock_t *lock)
+{
+  bool locked = false;
+
+  spin_lock_wo_note(&lock->guard);
+  if (lock->count >= 0 && lock->wwait == 0)
+    {
+      lock->count++;
+      locked = true;
+    }
+
+  spin_unlock_wo_note(&lock->guard);
+  return locked;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: rwlock_initialize
+ *
+ * Description:
+ *   Initialize a reader-writer spinlock to its unlocked state.
+ *
+ * Input Parameters:
+ *   lock - A reference to the lock to initialize.
+ *   name - The name used to register the lock statistics, or NULL.
+ *
+ * Returned Value:
+ *   None.
+ *
+ ****************************************************************************/
+
+void rwlock_initialize(FAR rwlock_t *lock, FAR const char *name)
+{
+  lock->count = 0;
+  lock->wwait = 0;
+  spin_initialize(&lock->guard, SP_UNLOCKED);
+
+#ifdef CONFIG_SPINLOCK_STATS
+  memset(&lock->stats, 0, sizeof(struct spinlock_stats_s));
+  if (name != NULL)
+    {
+      spin_stats_register(&lock->stats, name);
+    }
+#else
+  UNUSED(name);
+#endif
+}
+
+/****************************************************************************
+ * Name: read_lock
+ *
+ * Description:
+ *   Spin until the lock can be taken for reading.
+ *
+ * Input Parameters:
+ *   lock - A reference to the reader-writer spinlock.
+ *
+ * Returned Value:
+ *   None.  When the function returns, this CPU holds a read lock.
+ *
+ ****************************************************************************/
+
+void read_lock(FAR rwlock_t *lock)
+{
+  uint32_t spins = 0;
+
+  for (; ; )
+    {
+      /* Only touch the guard when the lock looks available */
+
+      if (lock->count >= 0 && lock->wwait == 0 && read_acquire(lock))
+        {
+          break;
+        }
+
+      spins++;
+      SP_DSB();
+      SP_WFE();
+    }
+
+  SP_DMB();
+
+#ifdef CONFIG_SPINLOCK_STATS
+  spin_stats_acquired(&lock->stats, spins);
+#else
+  UNUSED(spins);
+#endif
+}
+
+/****************************************************************************
+ * Name: read_trylock
+ *
+ * Description:
+ *   Take the lock for reading if no writer holds it or waits for it.
+ *
+ * Input Parameters:
+ *   lock - A reference to the reader-writer spinlock.
+ *
+ * Returned Value:
+ *   True if the lock was acquired.
+ *
+ ****************************************************************************/
+
+bool read_trylock(FAR rwlock_t *lock)
+{
+  if (!read_acquire(lock))
+    {
+      return false;
+    }
+
+#ifdef CONFIG_SPINLOCK_STATS
+  spin_stats_acquired(&lock->stats, 0);
+#endif
+  return true;
+}
+
+/****************************************************************************
+ * Name: read_unlock
+ *
+ * Description:
+ *   Release a read lock.
+ *
+ * Input Parameters:
+ *   lock - A reference to the reader-writer spinlock.
+ *
+ * Returned Value:
+ *   None.
+ *
+ ****************************************************************************/
+
+void read_unlock(FAR rwlock_t *lock)
+{
+  SP_DMB();
+
+  spin_lock_wo_note(&lock->guard);
+  lock->count--;
+  spin_unlock_wo_note(&lock->guard);
+}
+
+/****************************************************************************
+ * Name: write_trylock
+ *
+ * Description:
+ *   Take the lock for writing if nobody holds it.
+ *
+ * Input Parameters:
+ *   lock - A reference to the reader-writer spinlock.
+ *
+ * Returned Value:
+ *   True if the lock was acquired.
+ *
+ ****************************************************************************/
+
+bool write_trylock(FAR rwlock_t *lock)
+{
+  bool locked = false;
+
+  spin_lock_wo_note(&lock->guard);
+  if (lock->count == 0)
+    {
+      lock->count = RW_WRITER;
+      locked      = true;
+    }
+
+  spin_unlock_wo_note(&lock->guard);
+
+#ifdef CONFIG_SPINLOCK_STATS
+  if (locked)
+    {
+      spin_stats_acquired(&lock->stats, 0);
+    }
+#endif
+
+  return locked;
+}
+
+/****************************************************************************
+ * Name: write_lock
+ *
+ * Description:
+ *   Spin until the lock can be taken for writing.  New readers are held
+ *   off while the writer waits.
+ *
+ * Input Parameters:
+ *   lock - A reference to the reader-writer spinlock.
+ *
+ * Returned Value:
+ *   None.  When the function returns, this CPU holds the write lock.
+ *
+ ****************************************************************************/
+
+void write_lock(FAR rwlock_t *lock)
+{
+  uint32_t spins = 0;
+  bool locked = false;
+
+  spin_lock_wo_note(&lock->guard);
+  lock->wwait++;
+  spin_unlock_wo_note(&lock->guard);
+
+  while (!locked)
+    {
+      if (lock->count == 0)
+        {
+          spin_lock_wo_note(&lock->guard);
+          if (lock->count == 0)
+            {
+              lock->count = RW_WRITER;
+              lock->wwait--;
+              locked      = true;
+            }
+
+          spin_unlock_wo_note(&lock->guard);
+        }
+
+      if (!locked)
+        {
+          spins++;
+          SP_DSB();
+          SP_WFE();
+        }
+    }
+
+  SP_DMB();
+
+#ifdef CONFIG_SPINLOCK_STATS
+  spin_stats_acquired(&lock->stats, spins);
+#else
+  UNUSED(spins);
+#endif
+}
+
+/****************************************************************************
+ * Name: write_unlock
+ *
+ * Description:
+ *   Release the write lock.
+ *
+ * Input Parameters:
+ *   lock - A reference to the reader-writer spinlock.
+ *
+ * Returned Value:
+ *   None.
+ *
+ ****************************************************************************/
+
+void write_unlock(FAR rwlock_t *lock)
+{
+  /* Nobody else modifies 'count' while a writer holds the lock */
+
+  SP_DMB();
+  lock->count = 0;
+  SP_DSB();
+  SP_SEV();
+}
+
+#endif /* CONFIG_SPINLOCK */
@@ -0,0 +1,199 @@
+/****************************************************************************
+ * sched/semaphore/spinlock_stats.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+
+#include <nuttx/spinlock.h>
+
+#ifdef CONFIG_SPINLOCK_STATS
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* The list of registered locks and the spinlock that protects it */
+
+static FAR struct spinlock_stats_s *g_spin_stats;
+static spinlock_t g_spin_statslock = SP_UNLOCKED;
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: spin_stats_register
+ *
+ * Description:
+ *   Register the contention statistics of a lock under 'name'.
+ *
+ * Input Parameters:
+ *   stats - The statistics embedded in the lock.
+ *   name  - The name of the lock.  The string must persist.
+ *
+ * Returned Value:
+ *   None.
+ *
+ ****************************************************************************/
+
+void spin_stats_register(FAR struct spinlock_stats_s *stats,
+                         FAR const char *name)
+{
+  irqstate_t flags;
+
+  flags = spin_lock_irqsave(&g_spin_statslock);
+
+  stats->name  = name;
+  stats->flink = g_spin_stats;
+  g_spin_stats = stats;
+
+  spin_unlock_irqrestore(&g_spin_statslock, flags);
+}
+
+/****************************************************************************
+ * Name: spin_stats_unregister
+ *
+ * Description:
+ *   Remove registered statistics.
+ *
+ * Input Parameters:
+ *   stats - The statistics passed to spin_stats_register().
+ *
+ * Returned Value:
+ *   None.
+ *
+ ****************************************************************************/
+
+void spin_stats_unregister(FAR struct spinlock_stats_s *stats)
+{
+  FAR struct spinlock_stats_s **pprev;
+  irqstate_t flags;
+
+  flags = spin_lock_irqsave(&g_spin_statslock);
+
+  for (pprev = &g_spin_stats; *pprev != NULL; pprev = &(*pprev)->flink)
+    {
+      if (*pprev == stats)
+        {
+          *pprev = stats->flink;
+          break;
+        }
+    }
+
+  spin_unlock_irqrestore(&g_spin_statslock, flags);
+}
+
+/****************************************************************************
+ * Name: spin_stats_acquired
+ *
+ * Description:
+ *   Account for one acquisition of a lock after 'spins' iterations of its
+ *   wait loop.
+ *
+ * Input Parameters:
+ *   stats - The statistics of the lock just acquired.
+ *   spins - The number of wait loop iterations.  Zero if uncontended.
+ *
+ * Returned Value:
+ *   None.
+ *
+ * Assumptions:
+ *   Called by the holder of the lock.
+ *
+ ****************************************************************************/
+
+void spin_stats_acquired(FAR struct spinlock_stats_s *stats, uint32_t spins)
+{
+  stats->acquired++;
+
+  if (spins > 0)
+    {
+      stats->contended++;
+      stats->spins += spins;
+
+      if (spins > stats->maxspins)
+        {
+          stats->maxspins = spins;
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: spin_stats_foreach
+ *
+ * Description:
+ *   Call 'handler' for each registered lock.
+ *
+ * Input Parameters:
+ *   handler - The function to call.
+ *   arg     - An opaque argument passed to the handler.
+ *
+ * Returned Value:
+ *   None.
+ *
+ ****************************************************************************/
+
+void spin_stats_foreach(spin_stats_handler_t handler, FAR void *arg)
+{
+  FAR struct spinlock_stats_s *stats;
+  irqstate_t flags;
+
+  flags = spin_lock_irqsave(&g_spin_statslock);
+
+  for (stats = g_spin_stats; stats != NULL; stats = stats->flink)
+    {
+      handler(stats, arg);
+    }
+
+  spin_unlock_irqrestore(&g_spin_statslock, flags);
+}
+
+/****************************************************************************
+ * Name: spin_stats_reset
+ *
+ * Description:
+ *   Clear the counters of all registered locks.
+ *
+ ****************************************************************************/
+
+void spin_stats_reset(void)
+{
+  FAR struct spinlock_stats_s *stats;
+  irqstate_t flags;
+
+  flags = spin_lock_irqsave(&g_spin_statslock);
+
+  for (stats = g_spin_stats; stats != NULL; stats = stats->flink)
+    {
+      stats->acquired  = 0;
+      stats->contended = 0;
+      stats->spins     = 0;
+      stats->maxspins  = 0;
+    }
+
+  spin_unlock_irqrestore(&g_spin_statslock, flags);
+}
+
+#endif /* CONFIG_SPINLOCK_STATS */
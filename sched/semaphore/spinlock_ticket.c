@@ -0,0 +1,180 @@
+/****************************************************************************
+ * sched/semaphore/spinlock_ticket.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <nuttx/spinlock.h>
+
+#ifdef CONFIG_SPINLOCK
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: ticket_initialize
+ *
+ * Description:
+ *   Initialize a ticket lock to its unlocked state.  If 'name' is not NULL
+ *   and CONFIG_SPINLOCK_STATS is enabled, the lock's contention statistics
+ *   are registered under that name.
+ *
+ * Input Parameters:
+ *   lock - A reference to the ticket lock to initialize.
+ *   name - The name of the lock, or NULL.
+ *
+ * Returned Value:
+ *   None.
+ *
+ ****************************************************************************/
+
+void ticket_initialize(FAR ticketlock_t *lock, FAR const char *name)
+{
+  lock->next  = 0;
+  lock->owner = 0;
+  spin_initialize(&lock->guard, SP_UNLOCKED);
+
+#ifdef CONFIG_SPINLOCK_STATS
+  memset(&lock->stats, 0, sizeof(struct spinlock_stats_s));
+  if (name != NULL)
+    {
+      spin_stats_register(&lock->stats, name);
+    }
+#else
+  UNUSED(name);
+#endif
+}
+
+/****************************************************************************
+ * Name: ticket_lock
+ *
+ * Description:
+ *   Take a ticket and spin until it is served.  Waiting CPUs acquire the
+ *   lock in FIFO order.
+ *
+ * Input Parameters:
+ *   lock - A reference to the ticket lock.
+ *
+ * Returned Value:
+ *   None.  When the function returns, the lock is held by this CPU.
+ *
+ * Assumptions:
+ *   The caller has disabled local interrupts if the lock is also taken by
+ *   interrupt handlers.
+ *
+ ****************************************************************************/
+
+void ticket_lock(FAR ticketlock_t *lock)
+{
+  uint32_t spins = 0;
+  uint16_t ticket;
+
+  /* Taking the ticket is the only read-modify-write on the lock */
+
+  spin_lock_wo_note(&lock->guard);
+  ticket = lock->next++;
+  spin_unlock_wo_note(&lock->guard);
+
+  while (lock->owner != ticket)
+    {
+      spins++;
+      SP_DSB();
+      SP_WFE();
+    }
+
+  SP_DMB();
+
+#ifdef CONFIG_SPINLOCK_STATS
+  spin_stats_acquired(&lock->stats, spins);
+#else
+  UNUSED(spins);
+#endif
+}
+
+/****************************************************************************
+ * Name: ticket_trylock
+ *
+ * Description:
+ *   Take the ticket lock only if it is free and nobody is waiting.
+ *
+ * Input Parameters:
+ *   lock - A reference to the ticket lock.
+ *
+ * Returned Value:
+ *   True if the lock was acquired.
+ *
+ ****************************************************************************/
+
+bool ticket_trylock(FAR ticketlock_t *lock)
+{
+  bool locked = false;
+
+  spin_lock_wo_note(&lock->guard);
+  if (lock->next == lock->owner)
+    {
+      lock->next++;
+      locked = true;
+    }
+
+  spin_unlock_wo_note(&lock->guard);
+
+#ifdef CONFIG_SPINLOCK_STATS
+  if (locked)
+    {
+      spin_stats_acquired(&lock->stats, 0);
+    }
+#endif
+
+  return locked;
+}
+
+/****************************************************************************
+ * Name: ticket_unlock
+ *
+ * Description:
+ *   Release the ticket lock to the next waiter, if any.
+ *
+ * Input Parameters:
+ *   lock - A reference to the ticket lock.
+ *
+ * Returned Value:
+ *   None.
+ *
+ ****************************************************************************/
+
+void ticket_unlock(FAR ticketlock_t *lock)
+{
+  /* Only the holder writes 'owner', so no guard is needed */
+
+  SP_DMB();
+  lock->owner++;
+  SP_DSB();
+  SP_SEV();
+}
+
+#endif /* CONFIG_SPINLOCK */
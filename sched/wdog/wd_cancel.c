@@ -40,34 +40,30 @@
  ****************************************************************************/
 
 /****************************************************************************
- * Name: wd_cancel
+ * Name: wd_remove
  *
  * Description:
- *   This function cancels a currently running watchdog timer. Watchdog
- *   timers may be canceled from the interrupt level.
+ *   Remove an active watchdog from the timer queue.  This is wd_cancel()
+ *   for callers that already hold the watchdog list lock.
  *
  * Input Parameters:
  *   wdog - ID of the watchdog to cancel.
  *
  * Returned Value:
- *   Zero (OK) is returned on success;  A negated errno value is returned to
- *   indicate the nature of any failure.
+ *   Zero (OK) is returned on success;  -EINVAL is returned if the watchdog
+ *   was not active.
+ *
+ * Assumptions:
+ *   The caller holds wd_lock().
  *
  ****************************************************************************/
 
-int wd_cancel(FAR struct wdog_s *wdog)
+int wd_remove(FAR struct wdog_s *wdog)
 {
   FAR struct wdog_s *curr;
   FAR struct wdog_s *prev;
-  irqstate_t flags;
   int ret = -EINVAL;
 
-  /* Prohibit timer interactions with the timer queue until the
-   * cancellation is complete
-   */
-
-  flags = enter_critical_section();
-
   /* Make sure that the watchdog is initialized (non-NULL) and is still
    * active.
    */
@@ -134,6 +130,60 @@ int wd_cancel(FAR struct wdog_s *wdog)
       ret = OK;
     }
 
-  leave_critical_section(flags);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: wd_cancel
+ *
+ * Description:
+ *   This function cancels a currently running watchdog timer. Watchdog
+ *   timers may be canceled from the interrupt level.
+ *
+ *   If the watchdog function is running on another CPU, this function
+ *   waits until it has returned.  The caller may then release the data
+ *   that the watchdog function uses.
+ *
+ * Input Parameters:
+ *   wdog - ID of the watchdog to cancel.
+ *
+ * Returned Value:
+ *   Zero (OK) is returned on success;  A negated errno value is returned to
+ *   indicate the nature of any failure.
+ *
+ ****************************************************************************/
+
+int wd_cancel(FAR struct wdog_s *wdog)
+{
+  irqstate_t flags;
+#ifdef WDOG_SPINLOCK
+  bool running;
+#endif
+  int ret;
+
+  /* Prohibit timer interactions with the timer queue until the
+   * cancellation is complete
+   */
+
+  flags = wd_lock();
+  ret   = wd_remove(wdog);
+#ifdef WDOG_SPINLOCK
+  running = wdog != NULL && wdog == g_wdrunning;
+#endif
+  wd_unlock(flags);
+
+#ifdef WDOG_SPINLOCK
+  /* The watchdog functions run inside the critical section.  If this one
+   * is running, entering the critical section waits until it returns.
+   * This is a no-op if it runs on this CPU, i.e. it cancels itself.
+   */
+
+  if (running)
+    {
+      flags = enter_critical_section();
+      leave_critical_section(flags);
+    }
+#endif
+
   return ret;
 }
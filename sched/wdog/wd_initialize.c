@@ -47,6 +47,16 @@ sq_queue_t g_wdactivelist;
 clock_t g_wdtickbase;
 #endif
 
+/* Protects g_wdactivelist when WDOG_SPINLOCK is defined */
+
+#ifdef WDOG_SPINLOCK
+spinlock_t g_wdspinlock = SP_UNLOCKED;
+
+/* The watchdog whose function is running, if any */
+
+FAR struct wdog_s *volatile g_wdrunning;
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
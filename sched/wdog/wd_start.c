@@ -69,6 +69,69 @@
  *
  ****************************************************************************/
 
+#ifdef WDOG_SPINLOCK
+static inline void wd_expiration(void)
+{
+  FAR struct wdog_s *wdog;
+  wdentry_t func;
+  wdparm_t arg;
+  irqstate_t wflags;
+  irqstate_t flags;
+
+  /* Watchdog functions run inside the critical section, as they always
+   * have.  The critical section is taken before the watchdog leaves the
+   * list so that wd_cancel() from within a critical section never races
+   * with the watchdog function.  The list lock is only held while the
+   * list is modified and is never held while taking the critical section.
+   */
+
+  flags = enter_critical_section();
+
+  for (; ; )
+    {
+      wflags = wd_lock();
+
+      wdog = (FAR struct wdog_s *)g_wdactivelist.head;
+      if (wdog == NULL || wdog->lag > 0)
+        {
+          wd_unlock(wflags);
+          break;
+        }
+
+      /* Remove the watchdog from the head of the list */
+
+      sq_remfirst(&g_wdactivelist);
+
+      /* If there is another watchdog behind this one, update its
+       * its lag (this shouldn't be necessary).
+       */
+
+      if (g_wdactivelist.head)
+        {
+          ((FAR struct wdog_s *)g_wdactivelist.head)->lag += wdog->lag;
+        }
+
+      /* Indicate that the watchdog is no longer active.  The function may
+       * restart the watchdog, so sample it first.
+       */
+
+      WDOG_CLRACTIVE(wdog);
+      up_setpicbase(wdog->picbase);
+      func = wdog->func;
+      arg  = wdog->arg;
+
+      g_wdrunning = wdog;
+      wd_unlock(wflags);
+
+      /* Execute the watchdog function */
+
+      func(arg);
+      g_wdrunning = NULL;
+    }
+
+  leave_critical_section(flags);
+}
+#else
 static inline void wd_expiration(void)
 {
   FAR struct wdog_s *wdog;
@@ -108,6 +171,7 @@ static inline void wd_expiration(void)
         }
     }
 }
+#endif
 
 /****************************************************************************
  * Public Functions
@@ -171,10 +235,10 @@ int wd_start(FAR struct wdog_s *wdog, int32_t delay,
    * the critical section is established.
    */
 
-  flags = enter_critical_section();
+  flags = wd_lock();
   if (WDOG_ISACTIVE(wdog))
     {
-      wd_cancel(wdog);
+      wd_remove(wdog);
     }
 
   /* Save the data in the watchdog structure */
@@ -308,7 +372,7 @@ int wd_start(FAR struct wdog_s *wdog, int32_t delay,
   nxsched_resume_timer();
 #endif
 
-  leave_critical_section(flags);
+  wd_unlock(flags);
   return OK;
 }
 
@@ -412,23 +476,41 @@ unsigned int wd_timer(int ticks)
 #else
 void wd_timer(void)
 {
-#ifdef CONFIG_SMP
+#ifdef WDOG_SPINLOCK
+  FAR struct wdog_s *wdog;
   irqstate_t flags;
+  bool expired = false;
 
   /* We are in an interrupt handler as, as a consequence, interrupts are
    * disabled.  But in the SMP case, interrupts MAY be disabled only on
    * the local CPU since most architectures do not permit disabling
-   * interrupts on other CPUS.
-   *
-   * Hence, we must follow rules for critical sections even here in the
-   * SMP case.
+   * interrupts on other CPUS.  The watchdog list has its own lock, so
+   * the critical section is only needed when a watchdog expires.
    */
 
-  flags = enter_critical_section();
-#endif
+  flags = wd_lock();
 
   /* Check if there are any active watchdogs to process */
 
+  wdog = (FAR struct wdog_s *)g_wdactivelist.head;
+  if (wdog != NULL)
+    {
+      /* There are.  Decrement the lag counter */
+
+      expired = (--wdog->lag <= 0);
+    }
+
+  wd_unlock(flags);
+
+  /* Run the watchdogs at the head of the list that are ready to run */
+
+  if (expired)
+    {
+      wd_expiration();
+    }
+#else
+  /* Check if there are any active watchdogs to process */
+
   if (g_wdactivelist.head)
     {
       /* There are.  Decrement the lag counter */
@@ -439,9 +521,6 @@ void wd_timer(void)
 
       wd_expiration();
     }
-
-#ifdef CONFIG_SMP
-  leave_critical_section(flags);
 #endif
 }
 #endif /* CONFIG_SCHED_TICKLESS */
@@ -32,12 +32,31 @@
 
 #include <nuttx/compiler.h>
 #include <nuttx/clock.h>
+#include <nuttx/irq.h>
+#include <nuttx/spinlock.h>
 #include <nuttx/wdog.h>
 
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
 
+/* In SMP builds with a periodic timer tick, the active list is protected
+ * by its own spinlock so that starting and canceling watchdogs does not
+ * serialize all CPUs on the global critical section.  Expired watchdog
+ * functions still run inside the critical section.  The tickless timer
+ * logic in sched_timerexpiration.c depends on the critical section, so
+ * the tickless build keeps using it for the list as well.
+ */
+
+#if defined(CONFIG_SMP) && !defined(CONFIG_SCHED_TICKLESS)
+#  define WDOG_SPINLOCK  1
+#  define wd_lock()      spin_lock_irqsave(&g_wdspinlock)
+#  define wd_unlock(f)   spin_unlock_irqrestore(&g_wdspinlock, (f))
+#else
+#  define wd_lock()      enter_critical_section()
+#  define wd_unlock(f)   leave_critical_section(f)
+#endif
+
 /****************************************************************************
  * Name: wd_elapse
  *
@@ -82,6 +101,18 @@ extern sq_queue_t g_wdactivelist;
 extern clock_t g_wdtickbase;
 #endif
 
+/* Protects g_wdactivelist when WDOG_SPINLOCK is defined */
+
+#ifdef WDOG_SPINLOCK
+extern spinlock_t g_wdspinlock;
+
+/* The watchdog whose function is running.  Set under g_wdspinlock when the
+ * watchdog leaves the list; lets wd_cancel() wait for the function.
+ */
+
+extern FAR struct wdog_s *volatile g_wdrunning;
+#endif
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -107,6 +138,27 @@ extern clock_t g_wdtickbase;
 
 void weak_function wd_initialize(void);
 
+/****************************************************************************
+ * Name: wd_remove
+ *
+ * Description:
+ *   Remove an active watchdog from the timer queue.  This is wd_cancel()
+ *   for callers that already hold the watchdog list lock.
+ *
+ * Input Parameters:
+ *   wdog - ID of the watchdog to cancel.
+ *
+ * Returned Value:
+ *   Zero (OK) is returned on success;  -EINVAL is returned if the watchdog
+ *   was not active.
+ *
+ * Assumptions:
+ *   The caller holds wd_lock().
+ *
+ ****************************************************************************/
+
+int wd_remove(FAR struct wdog_s *wdog);
+
 /****************************************************************************
  * Name: wd_timer
  *
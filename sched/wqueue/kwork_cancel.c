@@ -74,7 +74,7 @@ static int work_qcancel(FAR struct kwork_wqueue_s *wqueue,
    * new work is typically added to the work queue from interrupt handlers.
    */
 
-  flags = enter_critical_section();
+  flags = work_lock(wqueue);
   if (work->worker != NULL)
     {
       /* A little test of the integrity of the work queue */
@@ -93,7 +93,7 @@ static int work_qcancel(FAR struct kwork_wqueue_s *wqueue,
       ret = OK;
     }
 
-  leave_critical_section(flags);
+  work_unlock(wqueue, flags);
   return ret;
 }
 
@@ -88,6 +88,7 @@ void work_process(FAR struct kwork_wqueue_s *wqueue, int wndx)
 {
   volatile FAR struct work_s *work;
   worker_t  worker;
+  irqstate_t wflags;
   irqstate_t flags;
   FAR void *arg;
   clock_t elapsed;
@@ -96,12 +97,18 @@ void work_process(FAR struct kwork_wqueue_s *wqueue, int wndx)
   clock_t ctick;
   clock_t next;
 
-  /* Then process queued work.  We need to keep interrupts disabled while
-   * we process items in the work list.
+  /* Then process queued work.  The critical section is held from here
+   * until this thread sleeps, except while work is performed, and 'busy'
+   * is clear whenever work is not being performed.  work_signal() sends
+   * SIGWORK from within the critical section, so a signal for work that is
+   * queued while we scan the list is delivered once we sleep instead of
+   * being lost.  The list itself is protected by the work queue lock.
    */
 
-  next  = WORK_DELAY_MAX;
-  flags = enter_critical_section();
+  next   = WORK_DELAY_MAX;
+  flags  = enter_critical_section();
+  wqueue->worker[wndx].busy = false;
+  wflags = work_lock(wqueue);
 
   /* Get the time that we started processing the queue in clock ticks. */
 
@@ -153,7 +160,10 @@ void work_process(FAR struct kwork_wqueue_s *wqueue, int wndx)
                * performed... we don't have any idea how long this will take!
                */
 
+              work_unlock(wqueue, wflags);
+              wqueue->worker[wndx].busy = true;
               leave_critical_section(flags);
+
               worker(arg);
 
               /* Now, unfortunately, since we re-enabled interrupts we don't
@@ -161,8 +171,10 @@ void work_process(FAR struct kwork_wqueue_s *wqueue, int wndx)
                * back at the head of the list.
                */
 
-              flags = enter_critical_section();
-              work  = (FAR struct work_s *)wqueue->q.head;
+              flags  = enter_critical_section();
+              wqueue->worker[wndx].busy = false;
+              wflags = work_lock(wqueue);
+              work   = (FAR struct work_s *)wqueue->q.head;
             }
           else
             {
@@ -215,6 +227,8 @@ void work_process(FAR struct kwork_wqueue_s *wqueue, int wndx)
    * over the queue again.
    */
 
+  work_unlock(wqueue, wflags);
+
   if (wndx > 0 || next == WORK_DELAY_MAX)
     {
       sigset_t set;
@@ -224,9 +238,7 @@ void work_process(FAR struct kwork_wqueue_s *wqueue, int wndx)
       sigemptyset(&set);
       nxsig_addset(&set, SIGWORK);
 
-      wqueue->worker[wndx].busy = false;
       DEBUGVERIFY(nxsig_waitinfo(&set, NULL));
-      wqueue->worker[wndx].busy = true;
     }
   else
     {
@@ -235,11 +247,10 @@ void work_process(FAR struct kwork_wqueue_s *wqueue, int wndx)
        * Interrupts will be re-enabled while we wait.
        */
 
-      wqueue->worker[wndx].busy = false;
       nxsig_usleep(next * USEC_PER_TICK);
-      wqueue->worker[wndx].busy = true;
     }
 
+  wqueue->worker[wndx].busy = true;
   leave_critical_section(flags);
 }
 
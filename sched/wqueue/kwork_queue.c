@@ -83,7 +83,7 @@ static void work_qqueue(FAR struct kwork_wqueue_s *wqueue,
    * task logic or ifrom nterrupt handling logic.
    */
 
-  flags = enter_critical_section();
+  flags = work_lock(wqueue);
 
   /* Is there already pending work? */
 
@@ -108,7 +108,7 @@ static void work_qqueue(FAR struct kwork_wqueue_s *wqueue,
 
   dq_addlast((FAR dq_entry_t *)work, &wqueue->q);
 
-  leave_critical_section(flags);
+  work_unlock(wqueue, flags);
 }
 
 /****************************************************************************
@@ -31,6 +31,8 @@
 #include <queue.h>
 
 #include <nuttx/clock.h>
+#include <nuttx/irq.h>
+#include <nuttx/spinlock.h>
 
 #ifdef CONFIG_SCHED_WORKQUEUE
 
@@ -43,6 +45,18 @@
 #define HPWORKNAME "hpwork"
 #define LPWORKNAME "lpwork"
 
+/* In SMP builds, each work queue has its own spinlock so that queuing and
+ * canceling work does not take the global critical section.
+ */
+
+#ifdef CONFIG_SMP
+#  define work_lock(wq)      spin_lock_irqsave(&(wq)->lock)
+#  define work_unlock(wq, f) spin_unlock_irqrestore(&(wq)->lock, (f))
+#else
+#  define work_lock(wq)      enter_critical_section()
+#  define work_unlock(wq, f) leave_critical_section(f)
+#endif
+
 /****************************************************************************
  * Public Type Definitions
  ****************************************************************************/
@@ -60,6 +74,9 @@ struct kworker_s
 struct kwork_wqueue_s
 {
   struct dq_queue_s q;         /* The queue of pending work */
+#ifdef CONFIG_SMP
+  spinlock_t        lock;      /* Protects the queue */
+#endif
   struct kworker_s  worker[1]; /* Describes a worker thread */
 };
 
@@ -71,6 +88,9 @@ struct kwork_wqueue_s
 struct hp_wqueue_s
 {
   struct dq_queue_s q;         /* The queue of pending work */
+#ifdef CONFIG_SMP
+  spinlock_t        lock;      /* Protects the queue */
+#endif
 
   /* Describes each thread in the high priority queue's thread pool */
 
@@ -86,6 +106,9 @@ struct hp_wqueue_s
 struct lp_wqueue_s
 {
   struct dq_queue_s q;      /* The queue of pending work */
+#ifdef CONFIG_SMP
+  spinlock_t        lock;   /* Protects the queue */
+#endif
 
   /* Describes each thread in the low priority queue's thread pool */
 
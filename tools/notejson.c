@@ -0,0 +1,414 @@
+/****************************************************************************
+ * tools/notejson.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/* Convert a binary scheduler note stream, as read from /dev/note, into the
+ * Chrome trace event JSON format.  The output can be loaded by
+ * chrome://tracing and by the Perfetto UI (https://ui.perfetto.dev).
+ *
+ * The note stream is a sequence of notes packed back to back, each one
+ * starting with the common note header of include/nuttx/sched_note.h.  The
+ * layout of that header depends on the target configuration, which is
+ * described with the command line options.
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <unistd.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Note types from enum note_type_e */
+
+#define NOTE_START            0
+#define NOTE_STOP             1
+#define NOTE_SUSPEND          2
+#define NOTE_RESUME           3
+#define NOTE_CPU_START        4
+#define NOTE_CPU_STARTED      5
+#define NOTE_CPU_PAUSE        6
+#define NOTE_CPU_PAUSED       7
+#define NOTE_CPU_RESUME       8
+#define NOTE_CPU_RESUMED      9
+#define NOTE_PREEMPT_LOCK     10
+#define NOTE_PREEMPT_UNLOCK   11
+#define NOTE_CSECTION_ENTER   12
+#define NOTE_CSECTION_LEAVE   13
+#define NOTE_SPINLOCK_LOCK    14
+#define NOTE_SPINLOCK_LOCKED  15
+#define NOTE_SPINLOCK_UNLOCK  16
+#define NOTE_SPINLOCK_ABORT   17
+#define NOTE_SYSCALL_ENTER    18
+#define NOTE_SYSCALL_LEAVE    19
+#define NOTE_IRQ_ENTER        20
+#define NOTE_IRQ_LEAVE        21
+#define NOTE_PRIO_BOOST       22
+#define NOTE_PRIO_RESTORE     23
+#define NTYPES                24
+
+#define MAX_NOTE              256
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct note_s
+{
+  unsigned int length;
+  unsigned int type;
+  unsigned int priority;
+  unsigned int cpu;
+  unsigned int pid;
+  double       ts;              /* Timestamp in microseconds */
+  const uint8_t *payload;       /* Type specific data after the header */
+  unsigned int paylen;
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const char *g_noteid[NTYPES] =
+{
+  "start", "stop", "suspend", "resume",
+  "cpu_start", "cpu_started", "cpu_pause", "cpu_paused",
+  "cpu_resume", "cpu_resumed",
+  "preempt_lock", "preempt_unlock",
+  "csection_enter", "csection_leave",
+  "spinlock_lock", "spinlock_locked", "spinlock_unlock", "spinlock_abort",
+  "syscall_enter", "syscall_leave",
+  "irq_enter", "irq_leave",
+  "prio_boost", "prio_restore"
+};
+
+static bool g_smp;               /* Notes carry nc_cpu */
+static bool g_hires;             /* Notes carry sec/nsec timestamps */
+static double g_usec_per_tick = 10000.0;
+static bool g_first = true;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static void show_usage(const char *progname, int exitcode)
+{
+  fprintf(stderr, "USAGE: %s [-s] [-r] [-t <usec>] [-o <outfile>] "
+                  "<infile>\n",
+          progname);
+  fprintf(stderr, "\nWhere:\n");
+  fprintf(stderr, "  -s        Target is SMP (notes include nc_cpu)\n");
+  fprintf(stderr, "  -r        Target uses "
+                  "CONFIG_SCHED_INSTRUMENTATION_HIRES\n");
+  fprintf(stderr, "  -t <usec> Microseconds per system tick "
+                  "(CONFIG_USEC_PER_TICK, default 10000)\n");
+  fprintf(stderr, "  -o <file> Output file (default stdout)\n");
+  fprintf(stderr, "  <infile>  Binary note stream read from /dev/note\n");
+  exit(exitcode);
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+  return (uint32_t)p[0] | (uint32_t)p[1] << 8 |
+         (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static int parse_note(const uint8_t *buf, unsigned int len,
+                      struct note_s *note)
+{
+  unsigned int hdrlen = 3 + (g_smp ? 1 : 0) + 2 + (g_hires ? 8 : 4);
+  const uint8_t *p = buf + 3;
+
+  if (len < hdrlen)
+    {
+      return -1;
+    }
+
+  note->length   = buf[0];
+  note->type     = buf[1];
+  note->priority = buf[2];
+  note->cpu      = g_smp ? *p++ : 0;
+  note->pid      = p[0] | p[1] << 8;
+  p             += 2;
+
+  if (g_hires)
+    {
+      note->ts = (double)get32(p) * 1000000.0 + get32(p + 4) / 1000.0;
+    }
+  else
+    {
+      note->ts = (double)get32(p) * g_usec_per_tick;
+    }
+
+  note->payload = buf + hdrlen;
+  note->paylen  = len - hdrlen;
+  return 0;
+}
+
+static void emit_begin(FILE *out)
+{
+  fprintf(out, "%s\n    {", g_first ? "" : ",");
+  g_first = false;
+}
+
+static void emit_event(FILE *out, const struct note_s *note,
+                       const char *ph, const char *name,
+                       const char *argname, long argval)
+{
+  emit_begin(out);
+  fprintf(out, "\"name\": \"%s\", \"ph\": \"%s\", \"ts\": %.3f, "
+               "\"pid\": 0, \"tid\": %u",
+          name, ph, note->ts, note->pid);
+
+  if (ph[0] == 'i')
+    {
+      fprintf(out, ", \"s\": \"t\"");
+    }
+
+  fprintf(out, ", \"args\": {\"cpu\": %u, \"prio\": %u",
+          note->cpu, note->priority);
+  if (argname != NULL)
+    {
+      fprintf(out, ", \"%s\": %ld", argname, argval);
+    }
+
+  fprintf(out, "}}");
+}
+
+static void emit_thread_name(FILE *out, const struct note_s *note)
+{
+  char name[MAX_NOTE];
+  unsigned int i;
+
+  for (i = 0; i < note->paylen && i < sizeof(name) - 1; i++)
+    {
+      char ch = (char)note->payload[i];
+
+      if (ch == '\0')
+        {
+          break;
+        }
+
+      name[i] = (ch == '"' || ch == '\\' || ch < ' ') ? '_' : ch;
+    }
+
+  name[i] = '\0';
+
+  emit_begin(out);
+  fprintf(out, "\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, "
+               "\"tid\": %u, \"args\": {\"name\": \"%s\"}",
+          note->pid, name[0] != '\0' ? name : "unnamed");
+  fprintf(out, "}");
+}
+
+static void convert_note(FILE *out, const struct note_s *note)
+{
+  char name[32];
+  long arg = note->paylen > 0 ? note->payload[0] : 0;
+
+  switch (note->type)
+    {
+      case NOTE_START:
+        emit_thread_name(out, note);
+        emit_event(out, note, "i", "start", NULL, 0);
+        break;
+
+      case NOTE_STOP:
+        emit_event(out, note, "i", "stop", NULL, 0);
+        break;
+
+      /* A task is running between NOTE_RESUME and NOTE_SUSPEND */
+
+      case NOTE_RESUME:
+        emit_event(out, note, "B", "running", NULL, 0);
+        break;
+
+      case NOTE_SUSPEND:
+        emit_event(out, note, "E", "running", "state", arg);
+        break;
+
+      case NOTE_IRQ_ENTER:
+      case NOTE_IRQ_LEAVE:
+        snprintf(name, sizeof(name), "irq %ld", arg);
+        emit_event(out, note, note->type == NOTE_IRQ_ENTER ? "B" : "E",
+                   name, "irq", arg);
+        break;
+
+      case NOTE_SYSCALL_ENTER:
+      case NOTE_SYSCALL_LEAVE:
+        snprintf(name, sizeof(name), "syscall %ld", arg);
+        emit_event(out, note, note->type == NOTE_SYSCALL_ENTER ? "B" : "E",
+                   name, "nr", arg);
+        break;
+
+      case NOTE_CPU_START:
+      case NOTE_CPU_PAUSE:
+      case NOTE_CPU_RESUME:
+        emit_event(out, note, "i", g_noteid[note->type], "target", arg);
+        break;
+
+      case NOTE_PREEMPT_LOCK:
+      case NOTE_PREEMPT_UNLOCK:
+      case NOTE_CSECTION_ENTER:
+      case NOTE_CSECTION_LEAVE:
+        if (note->paylen >= 2)
+          {
+            arg = note->payload[0] | note->payload[1] << 8;
+          }
+
+        emit_event(out, note, "i", g_noteid[note->type], "count", arg);
+        break;
+
+      case NOTE_SPINLOCK_LOCK:
+      case NOTE_SPINLOCK_LOCKED:
+      case NOTE_SPINLOCK_UNLOCK:
+      case NOTE_SPINLOCK_ABORT:
+
+        /* The value byte follows the spinlock address */
+
+        arg = note->paylen > 0 ? note->payload[note->paylen - 1] : 0;
+        emit_event(out, note, "i", g_noteid[note->type], "value", arg);
+        break;
+
+      case NOTE_PRIO_BOOST:
+      case NOTE_PRIO_RESTORE:
+
+        /* "prio" is the priority before the change, "to" the new one */
+
+        emit_event(out, note, "i", g_noteid[note->type], "to", arg);
+        break;
+
+      default:
+        emit_event(out, note, "i",
+                   note->type < NTYPES ? g_noteid[note->type] : "unknown",
+                   "type", note->type);
+        break;
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(int argc, char **argv)
+{
+  const char *outname = NULL;
+  uint8_t buffer[MAX_NOTE];
+  struct note_s note;
+  unsigned long nnotes = 0;
+  FILE *out = stdout;
+  FILE *in;
+  int ch;
+
+  while ((ch = getopt(argc, argv, ":hrst:o:")) > 0)
+    {
+      switch (ch)
+        {
+          case 'h':
+            show_usage(argv[0], EXIT_SUCCESS);
+            break;
+
+          case 'r':
+            g_hires = true;
+            break;
+
+          case 's':
+            g_smp = true;
+            break;
+
+          case 't':
+            g_usec_per_tick = atof(optarg);
+            break;
+
+          case 'o':
+            outname = optarg;
+            break;
+
+          default:
+            show_usage(argv[0], EXIT_FAILURE);
+            break;
+        }
+    }
+
+  if (optind != argc - 1)
+    {
+      show_usage(argv[0], EXIT_FAILURE);
+    }
+
+  in = fopen(argv[optind], "rb");
+  if (in == NULL)
+    {
+      fprintf(stderr, "ERROR: Failed to open %s\n", argv[optind]);
+      return EXIT_FAILURE;
+    }
+
+  if (outname != NULL)
+    {
+      out = fopen(outname, "w");
+      if (out == NULL)
+        {
+          fprintf(stderr, "ERROR: Failed to open %s\n", outname);
+          fclose(in);
+          return EXIT_FAILURE;
+        }
+    }
+
+  fprintf(out, "{\n  \"displayTimeUnit\": \"ns\",\n  \"traceEvents\": [");
+
+  while ((ch = fgetc(in)) != EOF)
+    {
+      unsigned int length = (unsigned int)ch;
+
+      buffer[0] = (uint8_t)ch;
+      if (length < 2 ||
+          fread(&buffer[1], 1, length - 1, in) != length - 1)
+        {
+          fprintf(stderr, "ERROR: Truncated note at note %lu\n", nnotes);
+          break;
+        }
+
+      if (parse_note(buffer, length, &note) < 0)
+        {
+          fprintf(stderr, "ERROR: Short note at note %lu\n", nnotes);
+          break;
+        }
+
+      convert_note(out, &note);
+      nnotes++;
+    }
+
+  fprintf(out, "\n  ]\n}\n");
+
+  fclose(in);
+  if (out != stdout)
+    {
+      fclose(out);
+    }
+
+  fprintf(stderr, "%lu notes converted\n", nnotes);
+  return EXIT_SUCCESS;
+}